@@ -120,6 +120,7 @@
  * - nanos interface family: deps_api
  *   - 1000: First implementation of dependencies plugins.
  *   - 1001: Commutative clause support.
+ *   - 1002: Task graph record and replay services.
  * - nanos interface family: openmp
  *   - 1: First Nanos OpenMP interface: nanos_omp_single ( b ) service
  *   - 2: Including nanos_omp_barrier() service
@@ -150,6 +151,7 @@ typedef void * nanos_sched_t;
 typedef void * nanos_slicer_t;
 typedef void * nanos_dd_t;
 typedef void * nanos_sync_cond_t;
+typedef void * nanos_tdg_t;
 typedef unsigned int nanos_copy_id_t;
 
 typedef struct nanos_const_wd_definition_tag {
@@ -284,6 +286,10 @@ NANOS_API_DECL(nanos_err_t, nanos_expel_current_thread, (void));
 NANOS_API_DECL(nanos_err_t, nanos_dependence_release_all, ( void ) );
 NANOS_API_DECL(nanos_err_t, nanos_dependence_pendant_writes, ( bool *res, void *addr ));
 NANOS_API_DECL(nanos_err_t, nanos_dependence_create, ( nanos_wd_t pred, nanos_wd_t succ ) );
+NANOS_API_DECL(nanos_err_t, nanos_tdg_record_begin, ( nanos_tdg_t *tdg ) );
+NANOS_API_DECL(nanos_err_t, nanos_tdg_record_end, ( nanos_tdg_t tdg ) );
+NANOS_API_DECL(nanos_err_t, nanos_tdg_replay, ( nanos_tdg_t tdg, size_t num_rebinds, nanos_tdg_rebind_t *rebinds ) );
+NANOS_API_DECL(nanos_err_t, nanos_tdg_destroy, ( nanos_tdg_t tdg ) );
 
 // worksharing
 NANOS_API_DECL(nanos_err_t, nanos_worksharing_create ,( nanos_ws_desc_t **wsd, nanos_ws_t ws, nanos_ws_info_t *info, bool *b ) );
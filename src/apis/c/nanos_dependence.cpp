@@ -25,6 +25,7 @@
 #include "instrumentationmodule_decl.hpp"
 #include "basethread.hpp"
 #include "workdescriptor.hpp"
+#include "taskgraph_decl.hpp"
 
 /*! \defgroup capi_dependence Dependence services.
  *  \ingroup capi
@@ -83,6 +84,75 @@ NANOS_API_DEF(nanos_err_t, nanos_dependence_create, ( nanos_wd_t pred, nanos_wd_
    }
    return NANOS_OK;
 }
+
+//! \brief Starts recording the tasks submitted by the current WorkDescriptor into a task graph
+//!
+//! Recorded tasks are not run: they are only kept, together with the dependences among them,
+//! until the recording ends. The graph is then run as many times as needed by nanos_tdg_replay.
+//!
+//! \param [out] tdg is the new task graph
+NANOS_API_DEF(nanos_err_t, nanos_tdg_record_begin, ( nanos_tdg_t *tdg ) )
+{
+   NANOS_INSTRUMENT( InstrumentStateAndBurst inst("api","tdg_record_begin", NANOS_RUNTIME) );
+   try {
+      WD *wd = myThread->getCurrentWD();
+      if ( wd->getRecordingTaskGraph() != NULL ) return NANOS_INVALID_REQUEST;
+      *tdg = (nanos_tdg_t) NEW TaskGraph( *wd );
+   } catch ( nanos_err_t e) {
+      return e;
+   }
+   return NANOS_OK;
+}
+
+//! \brief Stops recording a task graph
+//!
+//! \param [in] tdg is the task graph being recorded by the current WorkDescriptor
+NANOS_API_DEF(nanos_err_t, nanos_tdg_record_end, ( nanos_tdg_t tdg ) )
+{
+   NANOS_INSTRUMENT( InstrumentStateAndBurst inst("api","tdg_record_end", NANOS_RUNTIME) );
+   try {
+      if ( myThread->getCurrentWD()->getRecordingTaskGraph() != (TaskGraph *) tdg ) return NANOS_INVALID_REQUEST;
+      ( (TaskGraph *) tdg )->endRecording();
+   } catch ( nanos_err_t e) {
+      return e;
+   }
+   return NANOS_OK;
+}
+
+//! \brief Submits the tasks of a recorded task graph as children of the current WorkDescriptor
+//!
+//! Replayed tasks are only ordered among themselves, so any other task of the current
+//! WorkDescriptor accessing the same data must be waited for before and after the replay.
+//!
+//! \param [in] tdg is the task graph
+//! \param [in] num_rebinds is the number of elements in rebinds
+//! \param [in] rebinds moves addresses used while recording to the data of this replay
+NANOS_API_DEF(nanos_err_t, nanos_tdg_replay, ( nanos_tdg_t tdg, size_t num_rebinds, nanos_tdg_rebind_t *rebinds ) )
+{
+   NANOS_INSTRUMENT( InstrumentStateAndBurst inst("api","tdg_replay", NANOS_RUNTIME) );
+   try {
+      TaskGraph *graph = (TaskGraph *) tdg;
+      if ( graph->isRecording() ) return NANOS_INVALID_REQUEST;
+      graph->replay( *myThread->getCurrentWD(), num_rebinds, rebinds );
+   } catch ( nanos_err_t e) {
+      return e;
+   }
+   return NANOS_OK;
+}
+
+//! \brief Frees a task graph, ending its recording if needed
+//!
+//! \param [in] tdg is the task graph
+NANOS_API_DEF(nanos_err_t, nanos_tdg_destroy, ( nanos_tdg_t tdg ) )
+{
+   NANOS_INSTRUMENT( InstrumentStateAndBurst inst("api","tdg_destroy", NANOS_RUNTIME) );
+   try {
+      delete (TaskGraph *) tdg;
+   } catch ( nanos_err_t e) {
+      return e;
+   }
+   return NANOS_OK;
+}
 /*!
  * \}
  */ 
@@ -25,6 +25,7 @@
 #include "debug.hpp"
 #include "system.hpp"
 #include "workdescriptor.hpp"
+#include "taskgraph_decl.hpp"
 #include "smpdd.hpp"
 #include "gpudd.hpp"
 #include "plugin.hpp"
@@ -116,7 +117,7 @@ NANOS_API_DEF( nanos_err_t, nanos_create_wd_compact, ( nanos_wd_t *uwd, nanos_co
       if ( ( 
               &const_data->props == NULL  || 
               ( &const_data->props != NULL  && !const_data->props.mandatory_creation ) 
-           ) && !sys.throttleTaskIn() 
+           ) && myThread->getCurrentWD()->getRecordingTaskGraph() == NULL && !sys.throttleTaskIn() 
          ) {
          *uwd = 0;
          return NANOS_OK;
@@ -200,6 +201,13 @@ NANOS_API_DEF(nanos_err_t, nanos_submit, ( nanos_wd_t uwd, size_t num_data_acces
          *myThread->_file << "Submitting WD " << wd->getId() << " " << (wd->getDescription() == NULL ? "n/a" : wd->getDescription()) << std::endl;
       }
 
+      //! A task graph being recorded keeps the task instead of running it
+      TaskGraph *graph = myThread->getCurrentWD()->getRecordingTaskGraph();
+      if ( graph != NULL ) {
+         graph->record( *wd, data_accesses == NULL ? 0 : num_data_accesses, data_accesses );
+         return NANOS_OK;
+      }
+
       sys.setupWD( *wd, myThread->getCurrentWD() );
 
       NANOS_INSTRUMENT ( static InstrumentationDictionary *ID = sys.getInstrumentation()->getInstrumentationDictionary(); )
@@ -264,6 +272,9 @@ NANOS_API_DEF( nanos_err_t, nanos_create_wd_and_run_compact, ( nanos_const_wd_de
    nanos_const_wd_definition_internal_t *const_data = reinterpret_cast<nanos_const_wd_definition_internal_t*>(const_data_ext);
 
    try {
+      //! Tasks run inline cannot be part of a task graph
+      if ( myThread->getCurrentWD()->getRecordingTaskGraph() != NULL ) return NANOS_INVALID_REQUEST;
+
       if ( const_data->num_devices > 1 ) warning( "Multiple devices not yet supported. Using first one" );
 
       //! \todo if multiple devices we need to choose one of them
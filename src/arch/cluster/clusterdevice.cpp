@@ -90,27 +90,21 @@ bool ClusterDevice::_copyDevToDev( uint64_t devDestAddr, uint64_t devOrigAddr, s
 }
 
 void ClusterDevice::_copyInStrided1D( uint64_t devAddr, uint64_t hostAddr, std::size_t len, std::size_t count, std::size_t ld, SeparateMemoryAddressSpace &mem, DeviceOps *ops, WD const *wd, void *hostObject, reg_t hostRegionId ) {
-   char *hostAddrPtr = (char *) hostAddr;
    char *packedAddr = NULL;
    ops->addOp();
    //NANOS_INSTRUMENT( InstrumentState inst2(NANOS_STRIDED_COPY_PACK); );
       //*myThread->_file << "Allocate " << len * count << " to pack data (len=" << len << " count=" << count << " ld=" <<ld << ")"<< std::endl;
    do {
-      packedAddr = (char *) _packer.give_pack( hostAddr, len, count );
+      packedAddr = (char *) sys.getNetwork()->getPacker().give_pack( hostAddr, len, count );
       if (!packedAddr ) {
          myThread->processTransfers();
       }
    } while ( packedAddr == NULL );
       //*myThread->_file << "Got address " << (void *)packedAddr << std::endl;
 
-   if ( packedAddr != NULL) { 
-      for ( unsigned int i = 0; i < count; i += 1 ) {
-         ::memcpy( &packedAddr[ i * len ], &hostAddrPtr[ i * ld ], len );
-      }
-   } else { std::cerr << "copyInStrided ERROR!!! could not get a packet to gather data." << std::endl; }
-   //NANOS_INSTRUMENT( inst2.close(); );
+   /* the data is gathered into the pack while it is being sent */
    sys.getNetwork()->putStrided1D( mem.getNodeNumber(),  devAddr, ( void * ) hostAddr, packedAddr, len, count, ld, wd->getId(), wd, hostObject, hostRegionId );
-   if ( _packer.free_pack( hostAddr, len, count, packedAddr ) == false ) {
+   if ( sys.getNetwork()->getPacker().free_pack( hostAddr, len, count, packedAddr ) == false ) {
       *myThread->_file << "Error freeing pack after sending copyIn to node " << mem.getNodeNumber() << " HostAddr " << (void *) hostAddr << " wd: " << wd->getId() << " region: " << (void *) hostObject << ":" << hostRegionId << std::endl;
    }
    ops->completeOp();
@@ -127,14 +121,14 @@ void ClusterDevice::_copyOutStrided1D( uint64_t hostAddr, uint64_t devAddr, std:
          unsigned int thisCount = ( i + maxCount > count ) ? count - i : maxCount; 
          char * packedAddr = NULL;
          do {
-            packedAddr = (char *) _packer.give_pack( hostAddr, len, thisCount );
+            packedAddr = (char *) sys.getNetwork()->getPacker().give_pack( hostAddr, len, thisCount );
             if (!packedAddr ) {
                myThread->processTransfers();
             }
          } while ( packedAddr == NULL );
 
          if ( packedAddr != NULL) { 
-            GetRequestStrided *newreq = NEW GetRequestStrided( &hostAddrPtr[ i * ld ] , len, thisCount, ld, packedAddr, ops, &_packer );
+            GetRequestStrided *newreq = NEW GetRequestStrided( &hostAddrPtr[ i * ld ] , len, thisCount, ld, packedAddr, ops, &sys.getNetwork()->getPacker() );
             myThread->_pendingRequests.insert( newreq );
             ops->addOp();
             sys.getNetwork()->getStrided1D( packedAddr, mem.getNodeNumber(), devAddr, devAddr + ( i * ld ), len, thisCount, ld, newreq, hostObject, hostRegionId );
@@ -22,7 +22,6 @@
 
 #include "functor_decl.hpp"
 #include "workdescriptor_decl.hpp"
-#include "packer_decl.hpp"
 
 namespace nanos {
 namespace ext {
@@ -32,7 +31,6 @@ namespace ext {
  */
    class ClusterDevice : public Device
    {
-         Packer _packer;
       public:
 
 
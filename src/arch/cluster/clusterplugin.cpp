@@ -63,7 +63,7 @@ ClusterPlugin::ClusterPlugin() : ArchPlugin( "Cluster PE Plugin", 1 ),
    _nodeMem( DEFAULT_NODE_MEM ), _allocFit( false ), _allowSharedThd( false ),
    _unalignedNodeMem( false ), _gpuPresend( 1 ), _smpPresend( 1 ),
    _cachePolicy( System::DEFAULT ), _remoteNodes( NULL ), _cpu( NULL ),
-   _clusterThread( NULL ), _gasnetSegmentSize( 0 ) {
+   _clusterThread( NULL ), _gasnetSegmentSize( 0 ), _amBatchSize( 8192 ), _amBatchDelay( 0 ) {
 }
 
 void ClusterPlugin::config( Config& cfg )
@@ -74,6 +74,7 @@ void ClusterPlugin::config( Config& cfg )
 
 void ClusterPlugin::init()
 {
+   _gasnetApi->setAMBatching( _amBatchSize, (double) _amBatchDelay );
    _gasnetApi->initialize( sys.getNetwork() );
    //sys.getNetwork()->setAPI(_gasnetApi);
    _gasnetApi->setGASNetSegmentSize( _gasnetSegmentSize );
@@ -226,6 +227,14 @@ void ClusterPlugin::prepare( Config& cfg ) {
    cfg.registerArgOption ( "gasnet-segment", "gasnet-segment-size" );
    cfg.registerEnvOption ( "gasnet-segment", "NX_GASNET_SEGMENT_SIZE" );
 
+   cfg.registerConfigOption ( "cluster-am-batch-size", NEW Config::SizeVar ( _amBatchSize ), "Maximum size of the batches in which small control messages to a node are sent together (0 disables batching)." );
+   cfg.registerArgOption ( "cluster-am-batch-size", "cluster-am-batch-size" );
+   cfg.registerEnvOption ( "cluster-am-batch-size", "NX_CLUSTER_AM_BATCH_SIZE" );
+
+   cfg.registerConfigOption ( "cluster-am-batch-delay", NEW Config::IntegerVar ( _amBatchDelay ), "Microseconds a batched message can wait for others before being sent (0: sent at the next network poll)." );
+   cfg.registerArgOption ( "cluster-am-batch-delay", "cluster-am-batch-delay" );
+   cfg.registerEnvOption ( "cluster-am-batch-delay", "NX_CLUSTER_AM_BATCH_DELAY" );
+
 }
 
 ProcessingElement * ClusterPlugin::createPE( unsigned id, unsigned uid ){
@@ -48,6 +48,8 @@ class ClusterPlugin : public ArchPlugin
       ext::SMPProcessor *_cpu;
       ext::SMPMultiThread *_clusterThread;
       std::size_t _gasnetSegmentSize;
+      std::size_t _amBatchSize;
+      int _amBatchDelay;
 
    public:
       ClusterPlugin();
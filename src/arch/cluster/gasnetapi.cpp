@@ -71,6 +71,9 @@ using namespace ext;
 
 #define _emitPtPEvents 1
 
+#define AM_BATCH_HANDLER 227
+#define AM_BATCH_ALIGN( _Len ) ( ( ( _Len ) + 7 ) & ~( ( std::size_t ) 7 ) )
+
 
 
 GASNetAPI::WorkBufferManager::WorkBufferManager() : _buffers(), _lock() {
@@ -129,6 +132,11 @@ GASNetAPI::GASNetAPI() : _net( 0 ),
    _nodeBarrierCounter( 0 ),
    _GASNetSegmentSize( 0 ),
    _unalignedNodeMemory( false ),
+   _amBatches( NULL ),
+   _amBatchSize( 0 ),
+   _amBatchDelay( 0.0 ),
+   _amBatchedMsgs( 0 ),
+   _amBatchesSent( 0 ),
    _rwgs( 0 ) {
    _instance = this;
 }
@@ -216,6 +224,7 @@ void GASNetAPI::SendDataGetRequest::doSingleChunk() {
    NANOS_INSTRUMENT ( static nanos_event_key_t network_transfer_key = ID->getEventKey("network-transfer"); )
    NANOS_INSTRUMENT( instr->raiseOpenBurstEvent( network_transfer_key, (nanos_event_value_t) 1 ); )
    NANOS_INSTRUMENT ( static nanos_event_key_t sizeKey = ID->getEventKey("xfer-size"); )
+   _gasnetApi->flushAMBatch( _destination );
    while ( sent < _len )
    {
       thisReqSize = ( ( _len - sent ) <= MAX_LONG_REQUEST ) ? _len - sent : MAX_LONG_REQUEST;
@@ -248,6 +257,8 @@ void GASNetAPI::SendDataGetRequest::doStrided( void *localAddr ) {
    NANOS_INSTRUMENT ( static InstrumentationDictionary *ID = instr->getInstrumentationDictionary(); )
    NANOS_INSTRUMENT ( static nanos_event_key_t network_transfer_key = ID->getEventKey("network-transfer"); )
    NANOS_INSTRUMENT( instr->raiseOpenBurstEvent( network_transfer_key, (nanos_event_value_t) 1 ); )
+   Packer::pack( (char *) localAddr, (char const *) _origAddr, _len, _count, _ld );
+   _gasnetApi->flushAMBatch( _destination );
    VERBOSE_AM( (myThread != NULL ? (*myThread->_file) : std::cerr) << __FUNCTION__ << " send amGetReply" << std::endl; );
    if ( gasnet_AMRequestLong2( _destination, 212, localAddr, _len*_count, _destAddr, ARG_LO( _req ), ARG_HI( _req ) ) != GASNET_OK )
    {
@@ -265,8 +276,12 @@ void GASNetAPI::checkForPutReqs()
 {
    SendDataRequest *req = _dataSendRequests.tryFetch();
    if ( req != NULL ) {
-      req->doSend();
-      delete req;
+      if ( req->doSend() ) {
+         delete req;
+      } else {
+         /* no pack buffer yet, the ones in use are freed as their transfers complete */
+         _dataSendRequests.add( req );
+      }
    }
 }
 
@@ -278,8 +293,9 @@ void GASNetAPI::enqueueFreeBufferNotify( unsigned int dest, void *tmpBuffer, WD
 
 void GASNetAPI::checkForFreeBufferReqs()
 {
-   FreeBufferRequest *req = _freeBufferReqs.tryFetch();
-   if ( req != NULL ) {
+   // All of them, so that the notifications to the same node go in the same batch
+   FreeBufferRequest *req;
+   while ( ( req = _freeBufferReqs.tryFetch() ) != NULL ) {
       sendFreeTmpBuffer( req->destination, req->address, req->wd );
       delete req;
    }
@@ -287,8 +303,8 @@ void GASNetAPI::checkForFreeBufferReqs()
 
 void GASNetAPI::checkWorkDoneReqs()
 {
-   std::pair<void const *, unsigned int> *rwd = _workDoneReqs.tryFetch();
-   if ( rwd != NULL ) {
+   std::pair<void const *, unsigned int> *rwd;
+   while ( ( rwd = _workDoneReqs.tryFetch() ) != NULL ) {
       _sendWorkDoneMsg( rwd->second, rwd->first );
       delete rwd;
    }
@@ -606,10 +622,7 @@ void GASNetAPI::amPutStrided1D( gasnet_token_t token,
       char* realAddrPtr = (char *) realTag;
       char* localAddrPtr = ( (char *) ( ( ( uintptr_t ) buf ) + ( ( uintptr_t ) len ) - ( uintptr_t ) totalLen ) );
       //NANOS_INSTRUMENT( InstrumentState inst2(NANOS_STRIDED_COPY_UNPACK); );
-      for ( int i = 0; i < count; i += 1 ) {
-         ::memcpy( &realAddrPtr[ i * ld ], &localAddrPtr[ i * size ], size );
-         //if (i == 0)fprintf(stderr, "[%d] amPutStrided1D from %d: dst[%p]=%f buff[%p]=%f\n", gasnet_mynode(), src_node, &realAddrPtr[ i * ld], *((double*)&realAddrPtr[i*ld]), &localAddrPtr[i*size], *((double*)&localAddrPtr[i*size]) );
-      }
+      Packer::unpack( realAddrPtr, localAddrPtr, size, count, ld );
       //NANOS_INSTRUMENT( inst2.close(); );
       uintptr_t localAddr = ( ( uintptr_t ) buf ) + ( ( uintptr_t ) len ) - ( uintptr_t ) totalLen;
       getInstance()->enqueueFreeBufferNotify( issueNode, ( void * ) localAddr, wd );
@@ -905,6 +918,33 @@ void GASNetAPI::amIdle( gasnet_token_t token ) {
    getInstance()->_net->notifyIdle( src_node );
 }
 
+void GASNetAPI::amBatch( gasnet_token_t token, void *buff, std::size_t nbytes ) {
+   char *entry = (char *) buff;
+   char *end = entry + nbytes;
+   VERBOSE_AM( (myThread != NULL ? (*myThread->_file) : std::cerr) << __FUNCTION__ << std::endl; );
+
+   // Each message is handled as if it had come in its own AM, so the handlers get the source from the same token
+   while ( entry < end ) {
+      AMBatchEntry *header = (AMBatchEntry *) entry;
+      gasnet_handlerarg_t *args = (gasnet_handlerarg_t *) ( entry + sizeof( AMBatchEntry ) );
+      char *payload = entry + AM_BATCH_ALIGN( sizeof( AMBatchEntry ) + header->_numArgs * sizeof( gasnet_handlerarg_t ) );
+      std::size_t len = header->_payloadLen;
+
+      switch ( header->_handler ) {
+         case 205: amWork( token, payload, len, args[0], args[1], args[2], args[3], args[4], args[5] ); break;
+         case 206: amWorkDone( token, args[0], args[1], args[2] ); break;
+         case 214: amRequestPut( token, payload, len ); break;
+         case 218: amWaitRequestPut( token, args[0], args[1], args[2], args[3] ); break;
+         case 219: amFreeTmpBuffer( token, args[0], args[1], args[2], args[3] ); break;
+         case 222: amRequestPutStrided1D( token, payload, len ); break;
+         case 224: amRegionMetadata( token, payload, len, args[0] ); break;
+         default: fatal( "gasnet: Unexpected handler " << header->_handler << " in a batch of messages" );
+      }
+      entry = payload + AM_BATCH_ALIGN( len );
+   }
+   VERBOSE_AM( (myThread != NULL ? (*myThread->_file) : std::cerr) << __FUNCTION__ << " done." << std::endl; );
+}
+
 void GASNetAPI::initialize ( Network *net )
 {
    int my_argc = OS::getArgc();
@@ -937,7 +977,8 @@ void GASNetAPI::initialize ( Network *net )
       { 223, (void (*)()) amGetReplyStrided1D },
       { 224, (void (*)()) amRegionMetadata },
       { 225, (void (*)()) amSynchronizeDirectory },
-      { 226, (void (*)()) amIdle }
+      { 226, (void (*)()) amIdle },
+      { AM_BATCH_HANDLER, (void (*)()) amBatch }
    };
 
    gasnet_init( &my_argc, &my_argv );
@@ -953,6 +994,9 @@ void GASNetAPI::initialize ( Network *net )
    _net->setNumNodes( gasnet_nodes() );
    _net->setNodeNum( gasnet_mynode() );
 
+   if ( _amBatchSize > gasnet_AMMaxMedium() ) _amBatchSize = gasnet_AMMaxMedium();
+   if ( _amBatchSize != 0 ) _amBatches = NEW AMBatch[ gasnet_nodes() ];
+
    nodeBarrier();
   
    {
@@ -1017,6 +1061,7 @@ void GASNetAPI::initialize ( Network *net )
 void GASNetAPI::finalize ()
 {
    unsigned int i;
+   verbose0( "Node " << gasnet_mynode() << " sent " << getAMBatchedMessages() << " messages in " << getAMBatchesSent() << " batches" );
    nodeBarrier();
    for ( i = 0; i < _net->getNumNodes(); i += 1 )
    {
@@ -1032,6 +1077,7 @@ void GASNetAPI::finalize ()
 
 void GASNetAPI::finalizeNoBarrier ()
 {
+   flushAMBatches( true );
    _this_exit(0);
 }
 
@@ -1043,6 +1089,7 @@ void GASNetAPI::poll ()
       checkForPutReqs();
       checkForFreeBufferReqs();
       checkWorkDoneReqs();
+      flushAMBatches( false );
    } else if ( myThread == NULL ) {
       gasnet_AMPoll();
    }
@@ -1050,6 +1097,7 @@ void GASNetAPI::poll ()
 
 void GASNetAPI::sendExitMsg ( unsigned int dest )
 {
+   flushAMBatch( dest );
    VERBOSE_AM( (myThread != NULL ? (*myThread->_file) : std::cerr) << __FUNCTION__ << " send amFinalize" << std::endl; );
    if (gasnet_AMRequestShort0( dest, 203 ) != GASNET_OK)
    {
@@ -1066,6 +1114,8 @@ void GASNetAPI::sendWorkMsg ( unsigned int dest, WorkDescriptor const &wd, std::
 
    WD2Net nwd( wd );
 
+   // Messages already batched for this node must arrive before this work
+   if ( nwd.getBufferSize() > gasnet_AMMaxMedium() ) flushAMBatch( dest );
    while ( (nwd.getBufferSize() - sent) > gasnet_AMMaxMedium() )
    {
    VERBOSE_AM( (myThread != NULL ? (*myThread->_file) : std::cerr) << __FUNCTION__ << " send amWorkData" << std::endl; );
@@ -1091,13 +1141,15 @@ void GASNetAPI::sendWorkMsg ( unsigned int dest, WorkDescriptor const &wd, std::
    }
 
    VERBOSE_AM( (myThread != NULL ? (*myThread->_file) : std::cerr) << __FUNCTION__ << " send amWork" << std::endl; );
-   if (gasnet_AMRequestMedium6( dest, 205, &(nwd.getBuffer()[ sent ]), nwd.getBufferSize() - sent,
-            wd.getId(),
+   gasnet_handlerarg_t args[6] = { ( gasnet_handlerarg_t ) wd.getId(),
             ARG_LO( nwd.getBufferSize() ),
             ARG_HI( nwd.getBufferSize() ),
             ARG_LO( expectedData ),
             ARG_HI( expectedData ),
-            _seqN[dest]++ ) != GASNET_OK)
+            ( gasnet_handlerarg_t ) _seqN[dest]++ };
+   if ( !batchAM( dest, 205, &(nwd.getBuffer()[ sent ]), nwd.getBufferSize() - sent, 6, args ) &&
+         gasnet_AMRequestMedium6( dest, 205, &(nwd.getBuffer()[ sent ]), nwd.getBufferSize() - sent,
+            args[0], args[1], args[2], args[3], args[4], args[5] ) != GASNET_OK )
    {
       fprintf(stderr, "gasnet: Error sending a message to node %d.\n", dest);
    }
@@ -1121,10 +1173,9 @@ void GASNetAPI::_sendWorkDoneMsg ( unsigned int dest, void const *remoteWdAddr )
    if ( wdindc-- == 2 ) { sys.submit( *buffWD ); /*(myThread != NULL ? (*myThread->_file) : std::cerr)<<"n:" <<gasnet_mynode()<< " submitted wd " << buffWD->getId() <<std::endl;*/} 
 #endif
    VERBOSE_AM( (myThread != NULL ? (*myThread->_file) : std::cerr) << __FUNCTION__ << " send amWorkDone" << std::endl; );
-   if (gasnet_AMRequestShort3( dest, 206, 
-            ARG_LO( remoteWdAddr ),
-            ARG_HI( remoteWdAddr ),
-            0 /* FIXME: unused, must be removed */ ) != GASNET_OK)
+   gasnet_handlerarg_t args[3] = { ARG_LO( remoteWdAddr ), ARG_HI( remoteWdAddr ), 0 /* FIXME: unused, must be removed */ };
+   if ( !batchAM( dest, 206, NULL, 0, 3, args ) &&
+         gasnet_AMRequestShort3( dest, 206, args[0], args[1], args[2] ) != GASNET_OK )
    {
       fprintf(stderr, "gasnet: Error sending a message to node %d.\n", dest);
    }
@@ -1138,14 +1189,18 @@ void GASNetAPI::_put ( unsigned int issueNode, unsigned int remoteNode, uint64_t
    _totalBytes += size;
    {
       //Extra copy as the Firehose mechanism by gasnet seems buggy in MN3 (data is corrupted, apparently an invalid frame is sent)
-      _packSegment->lock();
-      void *sndBuff = _packSegment->allocate( size );
-      _packSegment->unlock();
-      ::memcpy( sndBuff, localAddr, size );
+      //Taken from the Packer, which gives back the packs it caches when the segment is full
+      void *sndBuff = sys.getNetwork()->getPacker().give_pack( ( uint64_t ) localAddr, size, 1 );
+      if ( sndBuff != NULL ) {
+         ::memcpy( sndBuff, localAddr, size );
+      } else {
+         sndBuff = localAddr;
+      }
    NANOS_INSTRUMENT ( static Instrumentation *instr = sys.getInstrumentation(); )
    NANOS_INSTRUMENT ( static InstrumentationDictionary *ID = instr->getInstrumentationDictionary(); )
    NANOS_INSTRUMENT ( static nanos_event_key_t network_transfer_key = ID->getEventKey("network-transfer"); )
    NANOS_INSTRUMENT( instr->raiseOpenBurstEvent( network_transfer_key, (nanos_event_value_t) remoteNode+1 ); )
+      flushAMBatch( remoteNode );
       while ( sent < size )
       {
          thisReqSize = ( ( size - sent ) <= MAX_LONG_REQUEST ) ? size - sent : MAX_LONG_REQUEST;
@@ -1193,9 +1248,9 @@ void GASNetAPI::_put ( unsigned int issueNode, unsigned int remoteNode, uint64_t
       }
    NANOS_INSTRUMENT( sys.getInstrumentation()->raiseCloseBurstEvent( network_transfer_key, 0 ); )
       //this->freeReceiveMemory( sndBuff );
-      _packSegment->lock();
-      _packSegment->free( sndBuff );
-      _packSegment->unlock();
+      if ( sndBuff != localAddr ) {
+         sys.getNetwork()->getPacker().free_pack( ( uint64_t ) localAddr, size, 1, sndBuff );
+      }
    }
 }
 
@@ -1209,6 +1264,7 @@ void GASNetAPI::_putStrided1D ( unsigned int issueNode, unsigned int remoteNode,
    NANOS_INSTRUMENT ( static InstrumentationDictionary *ID = instr->getInstrumentationDictionary(); )
    NANOS_INSTRUMENT ( static nanos_event_key_t network_transfer_key = ID->getEventKey("network-transfer"); )
    NANOS_INSTRUMENT( instr->raiseOpenBurstEvent( network_transfer_key, (nanos_event_value_t) remoteNode+1 ); )
+   flushAMBatch( remoteNode );
    {
       while ( sent < realSize )
       {
@@ -1218,6 +1274,8 @@ void GASNetAPI::_putStrided1D ( unsigned int issueNode, unsigned int remoteNode,
 
          if ( remoteTmpBuffer != NULL )
          { 
+            /* Gather this chunk while the previous one is being transferred */
+            Packer::packRange( ( char * ) localPack, ( char const * ) localAddr, size, ld, sent, thisReqSize );
             if ( _emitPtPEvents ) {
                NANOS_INSTRUMENT ( nanos_event_value_t xferSize = thisReqSize; )
                NANOS_INSTRUMENT ( nanos_event_id_t id = (nanos_event_id_t) ( ((uint64_t)remoteTmpBuffer) + sent ) ; )
@@ -1305,6 +1363,7 @@ void GASNetAPI::get ( void *localAddr, unsigned int remoteNode, uint64_t remoteA
    nanos_region_dimension_internal_t *dims = ( nanos_region_dimension_internal_t * ) ( buffer + sizeof( SendDataGetRequestPayload ) );
    ::memcpy( dims, cd.getDimensions(), sizeof( nanos_region_dimension_internal_t ) * cd.getNumDimensions() );
 
+   flushAMBatch( remoteNode );
    VERBOSE_AM( (myThread != NULL ? (*myThread->_file) : std::cerr) << __FUNCTION__ << " send amGet" << std::endl; );
    if ( gasnet_AMRequestMedium0( remoteNode, 211, buffer, buffer_size ) != GASNET_OK )
    {
@@ -1342,6 +1401,7 @@ void GASNetAPI::getStrided1D ( void *packedAddr, unsigned int remoteNode, uint64
    nanos_region_dimension_internal_t *dims = ( nanos_region_dimension_internal_t * ) ( buffer + sizeof( SendDataGetRequestPayload ) );
    ::memcpy( dims, cd.getDimensions(), sizeof( nanos_region_dimension_internal_t ) * cd.getNumDimensions() );
 
+   flushAMBatch( remoteNode );
    VERBOSE_AM( (myThread != NULL ? (*myThread->_file) : std::cerr) << __FUNCTION__ << " send amGetStrided1D" << std::endl; );
    if ( gasnet_AMRequestMedium0( remoteNode, 221, buffer, buffer_size ) != GASNET_OK )
    {
@@ -1356,6 +1416,7 @@ void GASNetAPI::getStrided1D ( void *packedAddr, unsigned int remoteNode, uint64
 void GASNetAPI::malloc ( unsigned int remoteNode, std::size_t size, void * waitObjAddr )
 {
    //message0("Requesting alloc of " << size << " bytes (" << (void *) size << ") to node " << remoteNode );
+   flushAMBatch( remoteNode );
    VERBOSE_AM( (myThread != NULL ? (*myThread->_file) : std::cerr) << __FUNCTION__ << " send amMalloc" << std::endl; );
    if (gasnet_AMRequestShort4( remoteNode, 207,
             ARG_LO( size ), ARG_HI( size ),
@@ -1368,6 +1429,7 @@ void GASNetAPI::malloc ( unsigned int remoteNode, std::size_t size, void * waitO
 
 void GASNetAPI::memRealloc ( unsigned int remoteNode, void *oldAddr, std::size_t oldSize, void *newAddr, std::size_t newSize )
 {
+   flushAMBatch( remoteNode );
    VERBOSE_AM( (myThread != NULL ? (*myThread->_file) : std::cerr) << __FUNCTION__ << " send amRealloc" << std::endl; );
    if (gasnet_AMRequestShort8( remoteNode, 217,
             ARG_LO( oldAddr ), ARG_HI( oldAddr ),
@@ -1382,6 +1444,7 @@ void GASNetAPI::memRealloc ( unsigned int remoteNode, void *oldAddr, std::size_t
 
 void GASNetAPI::memFree ( unsigned int remoteNode, void *addr )
 {
+   flushAMBatch( remoteNode );
    VERBOSE_AM( (myThread != NULL ? (*myThread->_file) : std::cerr) << __FUNCTION__ << " send amFree" << std::endl; );
    if (gasnet_AMRequestShort2( remoteNode, 216,
             ARG_LO( addr ), ARG_HI( addr ) ) != GASNET_OK)
@@ -1394,6 +1457,7 @@ void GASNetAPI::memFree ( unsigned int remoteNode, void *addr )
 
 void GASNetAPI::nodeBarrier()
 {
+   flushAMBatches( true );
    unsigned int id = _nodeBarrierCounter;
    _nodeBarrierCounter += 1;
    gasnet_barrier_notify( id, !(GASNET_BARRIERFLAG_ANONYMOUS) );
@@ -1407,6 +1471,7 @@ void GASNetAPI::sendMyHostName( unsigned int dest )
    if ( masterHostname == NULL )
       fprintf(stderr, "Error, master hostname not set!\n" );
 
+   flushAMBatch( dest );
    VERBOSE_AM( (myThread != NULL ? (*myThread->_file) : std::cerr) << __FUNCTION__ << " send amMasterHostname" << std::endl; );
    if ( gasnet_AMRequestMedium0( dest, 209, ( void * ) masterHostname, ::strlen( masterHostname ) + 1 ) != GASNET_OK ) //+1 to add the last \0 character
    {
@@ -1441,7 +1506,8 @@ void GASNetAPI::sendRequestPut( unsigned int dest, uint64_t origAddr, unsigned i
       NANOS_INSTRUMENT ( instr->raiseOpenPtPEvent( NANOS_XFER_REQ, id, sizeKey, xferSize, dest ); )
    }
    VERBOSE_AM( (myThread != NULL ? (*myThread->_file) : std::cerr) << __FUNCTION__ << " send amRequestPut" << std::endl; );
-   if ( gasnet_AMRequestMedium0( dest, 214, (void *) &msg, sizeof( msg ) ) != GASNET_OK )
+   if ( !batchAM( dest, 214, (void *) &msg, sizeof( msg ), 0, NULL ) &&
+         gasnet_AMRequestMedium0( dest, 214, (void *) &msg, sizeof( msg ) ) != GASNET_OK )
    {
       fprintf(stderr, "gasnet: Error sending a message to node %d.\n", dest);
    }
@@ -1480,7 +1546,8 @@ void GASNetAPI::sendRequestPutStrided1D( unsigned int dest, uint64_t origAddr, u
       NANOS_INSTRUMENT ( instr->raiseOpenPtPEvent( NANOS_XFER_REQ, id, sizeKey, xferSize, dest ); )
    }
    VERBOSE_AM( (myThread != NULL ? (*myThread->_file) : std::cerr) << __FUNCTION__ << " send amRequestPutStrided1D" << std::endl; );
-   if ( gasnet_AMRequestMedium0( dest, 222, (void *) &msg, sizeof( msg ) ) != GASNET_OK )
+   if ( !batchAM( dest, 222, (void *) &msg, sizeof( msg ), 0, NULL ) &&
+         gasnet_AMRequestMedium0( dest, 222, (void *) &msg, sizeof( msg ) ) != GASNET_OK )
 
    {
       fprintf(stderr, "gasnet: Error sending a message to node %d.\n", dest);
@@ -1503,8 +1570,9 @@ void GASNetAPI::sendWaitForRequestPut( unsigned int dest, uint64_t addr, unsigne
    unsigned int seq_number = sys.getNetwork()->getPutRequestSequenceNumber( dest );
 
    VERBOSE_AM( (myThread != NULL ? (*myThread->_file) : std::cerr) << __FUNCTION__ << " send amWaitRequestPut" << std::endl; );
-   if ( gasnet_AMRequestShort4( dest, 218,
-            ARG_LO( addr ), ARG_HI( addr ), wdId, seq_number ) != GASNET_OK )
+   gasnet_handlerarg_t args[4] = { ARG_LO( addr ), ARG_HI( addr ), ( gasnet_handlerarg_t ) wdId, ( gasnet_handlerarg_t ) seq_number };
+   if ( !batchAM( dest, 218, NULL, 0, 4, args ) &&
+         gasnet_AMRequestShort4( dest, 218, args[0], args[1], args[2], args[3] ) != GASNET_OK )
    {
       fprintf(stderr, "gasnet: Error sending a message to node %d.\n", dest);
    }
@@ -1522,8 +1590,9 @@ void GASNetAPI::sendFreeTmpBuffer( unsigned int dest, void *addr, WD const *wd )
       NANOS_INSTRUMENT ( instr->raiseOpenPtPEvent( NANOS_XFER_FREE_TMP_BUFF, id, sizeKey, xferSize, 0 ); )
    }
    VERBOSE_AM( (myThread != NULL ? (*myThread->_file) : std::cerr) << __FUNCTION__ << " send amFreeTmpBuffer" << std::endl; );
-   if ( gasnet_AMRequestShort4( dest, 219,
-            ARG_LO( addr ), ARG_HI( addr ), ARG_LO( wd ), ARG_HI( wd ) ) != GASNET_OK )
+   gasnet_handlerarg_t args[4] = { ARG_LO( addr ), ARG_HI( addr ), ARG_LO( wd ), ARG_HI( wd ) };
+   if ( !batchAM( dest, 219, NULL, 0, 4, args ) &&
+         gasnet_AMRequestShort4( dest, 219, args[0], args[1], args[2], args[3] ) != GASNET_OK )
    {
       fprintf(stderr, "gasnet: Error sending a message to node %d.\n", dest);
    }
@@ -1538,7 +1607,9 @@ void GASNetAPI::sendRegionMetadata( unsigned int dest, CopyData *cd, unsigned in
    ::memcpy(buffer + sizeof(CopyData), cd->getDimensions(), cd->getNumDimensions() * sizeof(nanos_region_dimension_internal_t));
 
    VERBOSE_AM( (myThread != NULL ? (*myThread->_file) : std::cerr) << __FUNCTION__ << " send amRegionMetadata" << std::endl; );
-   if ( gasnet_AMRequestMedium1( dest, 224, (void *) buffer, data_size, seq ) != GASNET_OK )
+   gasnet_handlerarg_t args[1] = { ( gasnet_handlerarg_t ) seq };
+   if ( !batchAM( dest, 224, (void *) buffer, data_size, 1, args ) &&
+         gasnet_AMRequestMedium1( dest, 224, (void *) buffer, data_size, args[0] ) != GASNET_OK )
    {
       fprintf(stderr, "gasnet: Error sending a message to node %d.\n", dest);
    }
@@ -1546,6 +1617,7 @@ void GASNetAPI::sendRegionMetadata( unsigned int dest, CopyData *cd, unsigned in
 }
 
 void GASNetAPI::synchronizeDirectory(unsigned int dest, void *addr ) {
+   flushAMBatch( dest );
    VERBOSE_AM( (myThread != NULL ? (*myThread->_file) : std::cerr) << __FUNCTION__ << " send amSynchronizeDirectory" << std::endl; );
    if ( gasnet_AMRequestShort2( dest, 225, ARG_LO( addr ), ARG_HI( addr ) ) != GASNET_OK )
    {
@@ -1559,6 +1631,7 @@ void GASNetAPI::broadcastIdle() {
    {
       if ( node != _net->getNodeNum() ) 
       {
+         flushAMBatch( node );
          VERBOSE_AM( (myThread != NULL ? (*myThread->_file) : std::cerr) << __FUNCTION__ << " send amIdle to node " << node << std::endl; );
          if ( gasnet_AMRequestShort0( node, 226 ) != GASNET_OK )
          {
@@ -1569,6 +1642,85 @@ void GASNetAPI::broadcastIdle() {
    }
 }
 
+bool GASNetAPI::batchAM( unsigned int dest, unsigned int handler, void const *payload, std::size_t len,
+      unsigned int numArgs, gasnet_handlerarg_t const *args )
+{
+   std::size_t argsLen = AM_BATCH_ALIGN( sizeof( AMBatchEntry ) + numArgs * sizeof( gasnet_handlerarg_t ) );
+   std::size_t entryLen = argsLen + AM_BATCH_ALIGN( len );
+   if ( _amBatches == NULL || entryLen > _amBatchSize ) {
+      // Sent on its own, after the messages already waiting for the same node
+      flushAMBatch( dest );
+      return false;
+   }
+
+   AMBatch &batch = _amBatches[ dest ];
+   bool full;
+   do {
+      {
+         LockBlock lock( batch._lock );
+         std::size_t used = batch._buffer.size();
+         full = used + entryLen > _amBatchSize;
+         if ( !full ) {
+            if ( used == 0 ) batch._firstMsgTime = OS::getMonotonicTimeUs();
+            batch._buffer.resize( used + entryLen );
+            char *entry = &batch._buffer[ used ];
+            AMBatchEntry *header = (AMBatchEntry *) entry;
+            header->_handler = handler;
+            header->_numArgs = numArgs;
+            header->_payloadLen = len;
+            if ( numArgs != 0 ) ::memcpy( entry + sizeof( AMBatchEntry ), args, numArgs * sizeof( gasnet_handlerarg_t ) );
+            if ( len != 0 ) ::memcpy( entry + argsLen, payload, len );
+         }
+      }
+      if ( full ) flushAMBatch( dest );
+   } while ( full );
+
+   _amBatchedMsgs++;
+   return true;
+}
+
+void GASNetAPI::flushAMBatch( unsigned int dest, bool force, double now )
+{
+   if ( _amBatches == NULL ) return;
+   AMBatch &batch = _amBatches[ dest ];
+   if ( batch._buffer.empty() ) return;
+
+   // Sent without holding the lock, as sending may run handlers
+   std::vector<char> buffer;
+   {
+      LockBlock lock( batch._lock );
+      if ( batch._buffer.empty() || ( !force && now - batch._firstMsgTime < _amBatchDelay ) ) return;
+      buffer.swap( batch._buffer );
+   }
+
+   VERBOSE_AM( (myThread != NULL ? (*myThread->_file) : std::cerr) << __FUNCTION__ << " send amBatch" << std::endl; );
+   if ( gasnet_AMRequestMedium0( dest, AM_BATCH_HANDLER, (void *) &buffer[0], buffer.size() ) != GASNET_OK )
+   {
+      fprintf(stderr, "gasnet: Error sending a message to node %d.\n", dest);
+   }
+   VERBOSE_AM( (myThread != NULL ? (*myThread->_file) : std::cerr) << __FUNCTION__ << " send amBatch done" << std::endl; );
+   _amBatchesSent++;
+
+   // Give the buffer back, so that the next batch reuses its memory
+   buffer.clear();
+   LockBlock lock( batch._lock );
+   if ( batch._buffer.empty() && batch._buffer.capacity() < buffer.capacity() ) batch._buffer.swap( buffer );
+}
+
+void GASNetAPI::flushAMBatch( unsigned int dest )
+{
+   flushAMBatch( dest, true, 0.0 );
+}
+
+void GASNetAPI::flushAMBatches( bool force )
+{
+   if ( _amBatches == NULL ) return;
+   double now = force ? 0.0 : OS::getMonotonicTimeUs();
+   for ( unsigned int node = 0; node < gasnet_nodes(); node += 1 ) {
+      flushAMBatch( node, force, now );
+   }
+}
+
 std::size_t GASNetAPI::getRxBytes()
 {
    return _rxBytes;
@@ -1625,3 +1777,16 @@ void GASNetAPI::setGASNetSegmentSize( std::size_t segmentSize ) {
 void GASNetAPI::setUnalignedNodeMemory( bool flag ) {
    _unalignedNodeMemory = flag;
 }
+
+void GASNetAPI::setAMBatching( std::size_t size, double delay ) {
+   _amBatchSize = size;
+   _amBatchDelay = delay;
+}
+
+std::size_t GASNetAPI::getAMBatchedMessages() const {
+   return _amBatchedMsgs.value();
+}
+
+std::size_t GASNetAPI::getAMBatchesSent() const {
+   return _amBatchesSent.value();
+}
@@ -165,6 +165,25 @@ namespace ext {
          std::size_t _GASNetSegmentSize;
          bool _unalignedNodeMemory;
 
+         /* Small control messages to a node waiting to be sent together in a single Medium AM */
+         struct AMBatch {
+            Lock              _lock;
+            std::vector<char> _buffer;
+            double            _firstMsgTime;   /**< When the oldest pending message was added (us) */
+            AMBatch() : _lock(), _buffer(), _firstMsgTime( 0.0 ) {}
+         };
+         /* Header of each message in a batch, followed by its arguments and its payload */
+         struct AMBatchEntry {
+            uint16_t _handler;
+            uint16_t _numArgs;
+            uint32_t _payloadLen;
+         };
+         AMBatch *_amBatches;
+         std::size_t _amBatchSize;             /**< Maximum size of a batch, 0 disables batching */
+         double _amBatchDelay;                 /**< Time a message can wait for others before being sent (us) */
+         Atomic<std::size_t> _amBatchedMsgs;
+         Atomic<std::size_t> _amBatchesSent;
+
       public:
          typedef RemoteWorkDescriptor *ArchRWDs[4]; //0: smp, 1: cuda, 2: opencl, 3: fpga
          ArchRWDs *_rwgs; //archs
@@ -209,6 +228,9 @@ namespace ext {
 
          void setGASNetSegmentSize(std::size_t segmentSize);
          void setUnalignedNodeMemory(bool flag);
+         void setAMBatching( std::size_t size, double delay );
+         std::size_t getAMBatchedMessages() const;
+         std::size_t getAMBatchesSent() const;
 
       private:
          void _put ( unsigned int issueNode, unsigned int remoteNode, uint64_t remoteAddr, void *localAddr, std::size_t size, void *remoteTmpBuffer, unsigned int wdId, WD const *wd, void *hostObject, reg_t hostRegId, unsigned int metaSeq );
@@ -221,6 +243,11 @@ namespace ext {
          void checkForFreeBufferReqs();
          void checkWorkDoneReqs();
          unsigned int getPutRequestSequenceNumber( unsigned int dest );
+         bool batchAM( unsigned int dest, unsigned int handler, void const *payload, std::size_t len,
+               unsigned int numArgs, gasnet_handlerarg_t const *args );
+         void flushAMBatch( unsigned int dest, bool force, double now );
+         void flushAMBatch( unsigned int dest );
+         void flushAMBatches( bool force );
 
          // Active Message handlers
          static void amFinalize( gasnet_token_t token );
@@ -313,6 +340,7 @@ namespace ext {
                void *arg, std::size_t argSize, gasnet_handlerarg_t seq );
          static void amSynchronizeDirectory(gasnet_token_t token, gasnet_handlerarg_t addrLo, gasnet_handlerarg_t addrHi);
          static void amIdle(gasnet_token_t token);
+         static void amBatch( gasnet_token_t token, void *buff, std::size_t nbytes );
    };
 } // namespace ext
 } // namespace nanos
@@ -45,6 +45,7 @@ size_t MPIProcessor::_cacheDefaultSize = (size_t) -1;
 size_t MPIProcessor::_alignThreshold = 128;
 size_t MPIProcessor::_alignment = 4096;
 size_t MPIProcessor::_maxWorkers = 1;
+size_t MPIProcessor::_inflightCommands = 16;
 std::string MPIProcessor::_mpiExecFile;
 std::string MPIProcessor::_mpiLauncherFile=NANOX_PREFIX"/bin/offload_slave_launch.sh";
 std::string MPIProcessor::_mpiNodeType;
@@ -71,6 +72,8 @@ MPIProcessor::MPIProcessor( MPI_Comm communicator, int rank, bool owner,
     _currExecutingDD(0),
     _pendingReqs(),
     _taskEndRequest(),
+    _commandQueue( NULL ),
+    _cacheCommandQueue( NULL ),
     _commOfParents( communicatorOfParents ),
     _core(core),
     _peLock()
@@ -79,6 +82,13 @@ MPIProcessor::MPIProcessor( MPI_Comm communicator, int rank, bool owner,
     _busy.clear();
     MPI_Recv_init( &_currExecutingFunctionId, 1, MPI_INT, _rank, TAG_END_TASK, _communicator, _taskEndRequest );
 
+    // Create the persistent requests used to send commands (the
+    // auxiliary cache thread PE of a remote process has no valid rank)
+    if ( _rank >= 0 ) {
+        _commandQueue = NEW command_queue_type( _rank, _communicator, _inflightCommands );
+        _cacheCommandQueue = NEW cache_command_queue_type( _rank, _communicator, _inflightCommands );
+    }
+
     // Synchronize linker arrays
     if( owner ) {
         int arrSize = 0;
@@ -107,6 +117,10 @@ MPIProcessor::MPIProcessor( MPI_Comm communicator, int rank, bool owner,
 MPIProcessor::~MPIProcessor() {
     // Free taskEnd reception persistent request
     _taskEndRequest.free();
+
+    // Wait for the commands in flight and free their requests
+    delete _commandQueue;
+    delete _cacheCommandQueue;
 }
 
 void MPIProcessor::prepareConfig(Config &config) {
@@ -175,6 +189,11 @@ void MPIProcessor::prepareConfig(Config &config) {
     config.registerArgOption("offl-workers", "offl-max-workers");
     config.registerEnvOption("offl-workers", "NX_OFFL_MAX_WORKERS");
 
+    config.registerConfigOption("offl-inflight-commands", NEW Config::SizeVar(_inflightCommands), "Defines the maximum number of commands in flight to each "
+                                 "offload process before the sender has to wait for their delivery (Default: 16)");
+    config.registerArgOption("offl-inflight-commands", "offl-inflight-commands");
+    config.registerEnvOption("offl-inflight-commands", "NX_OFFL_INFLIGHT_COMMANDS");
+
     config.registerConfigOption("offl-cache-threads", NEW Config::BoolVar(_useMultiThread), "Defines if offload processes will have an extra cache thread,"
         " this is good for applications which need data from other tasks so they don't have to wait until task in owner node finishes. "
         "(Default: False, but if this kind of behaviour is detected, the thread will be created)");
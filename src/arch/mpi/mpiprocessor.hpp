@@ -21,6 +21,7 @@
 #define _NANOS_MPI_PROCESSOR
 
 #include "mpiprocessor_decl.hpp"
+#include "commandqueue.hpp"
 
 namespace nanos {
 namespace ext {
@@ -61,6 +62,10 @@ inline bool MPIProcessor::isUseMultiThread() {
     return _useMultiThread;
 }
 
+inline size_t MPIProcessor::getInflightCommands() {
+    return _inflightCommands;
+}
+
 inline std::string MPIProcessor::getMpiLauncherFile() {
     return _mpiLauncherFile;
 }
@@ -150,6 +155,26 @@ inline void MPIProcessor::setCurrExecutingDD(int currExecutingDD) {
     this->_currExecutingDD = currExecutingDD;
 }
 
+inline void MPIProcessor::postCommand( mpi::command::CommandPayload const& data ) const {
+    ensure0( _commandQueue != NULL, "Sending a command to a remote process without a valid rank" );
+    _commandQueue->post( data );
+}
+
+inline void MPIProcessor::postCommand( mpi::command::CachePayload const& data ) const {
+    ensure0( _cacheCommandQueue != NULL, "Sending a command to a remote process without a valid rank" );
+    _cacheCommandQueue->post( data );
+}
+
+inline void MPIProcessor::progressCommands() {
+    if ( _commandQueue != NULL ) _commandQueue->progress();
+    if ( _cacheCommandQueue != NULL ) _cacheCommandQueue->progress();
+}
+
+inline void MPIProcessor::drainCommands() {
+    if ( _commandQueue != NULL ) _commandQueue->drain();
+    if ( _cacheCommandQueue != NULL ) _cacheCommandQueue->drain();
+}
+
 inline void MPIProcessor::appendToPendingRequests( mpi::request const& req ) {
     _pendingReqs.push_back(req);
 }
@@ -26,6 +26,11 @@
 #include "request.hpp"
 #include "system_decl.hpp"
 
+#include "commandid.hpp"
+#include "commandpayload.hpp"
+#include "cachepayload.hpp"
+#include "commandqueue_decl.hpp"
+
 #include "mpithread_fwd.hpp"
 
 #include <mpi.h>
@@ -60,6 +65,7 @@ namespace ext {
             static size_t _alignThreshold;          
             static size_t _alignment;          
             static size_t _maxWorkers;
+            static size_t _inflightCommands;
             
             MPI_Comm _communicator;
             int _rank;
@@ -76,6 +82,13 @@ namespace ext {
             std::list<mpi::request> _pendingReqs;
             mpi::persistent_request _taskEndRequest;
 
+            typedef mpi::command::CommandQueue<mpi::command::CommandPayload,TAG_M2S_COMMAND>     command_queue_type;
+            typedef mpi::command::CommandQueue<mpi::command::CachePayload,TAG_M2S_CACHE_COMMAND> cache_command_queue_type;
+
+            //! Commands sent to the remote process, NULL if it has no valid rank
+            command_queue_type *_commandQueue;
+            cache_command_queue_type *_cacheCommandQueue;
+
             MPI_Comm _commOfParents;
 
             SMPProcessor* _core;
@@ -117,6 +130,8 @@ namespace ext {
             static size_t getMaxWorkers();
 
             static bool isUseMultiThread();
+
+            static size_t getInflightCommands();
             /* End config options*/           
             
             MPI_Comm getCommunicator() const;
@@ -189,6 +204,25 @@ namespace ext {
 
             mpi::persistent_request& getTaskEndRequest();
 
+            /**
+             * Sends a command to the remote process without waiting
+             * for its delivery, unless too many are already in flight
+             */
+            void postCommand( mpi::command::CommandPayload const& data ) const;
+
+            void postCommand( mpi::command::CachePayload const& data ) const;
+
+            /**
+             * Lets MPI progress the commands in flight
+             * Thread-safe function
+             */
+            void progressCommands();
+
+            /**
+             * Waits until the commands in flight have been sent
+             */
+            void drainCommands();
+
             MPIThread& startMPIThread(WD* work);
             
             WD & getWorkerWD() const;
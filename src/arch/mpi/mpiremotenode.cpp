@@ -163,9 +163,6 @@ void MPIRemoteNode::nanosMPIFinalize() {
         }
     }
 
-    nanos::mpi::command::CachePayload::freeDataType();
-    nanos::mpi::command::CommandPayload::freeDataType();
-
     int mpi_finalized;
     MPI_Finalized(&mpi_finalized);
 
@@ -174,6 +171,10 @@ void MPIRemoteNode::nanosMPIFinalize() {
       //Free every node before finalizing
       DEEP_Booster_free(NULL,-1);
 
+      // Command datatypes are used by the remote nodes command queues
+      nanos::mpi::command::CachePayload::freeDataType();
+      nanos::mpi::command::CommandPayload::freeDataType();
+
       // In the case of slave processes,
       // disconnect from parent communicator
       MPI_Comm parent;
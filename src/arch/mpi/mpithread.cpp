@@ -110,6 +110,11 @@ bool MPIThread::switchToPE(int rank, int uuid) {
 }
 
 void MPIThread::idle( bool debug ) {
+    // Progress the commands in flight before checking finished tasks
+    std::vector<MPIProcessor*>& remotes = getSpawnGroup().getRemoteProcessors();
+    for ( std::vector<MPIProcessor*>::iterator it = remotes.begin(); it != remotes.end(); ++it ) {
+        (*it)->progressCommands();
+    }
     getSpawnGroup().waitFinishedTasks();
 }
 
@@ -4,6 +4,7 @@
 
 #include "mpidevice.hpp"
 #include "mpiremotenode_decl.hpp"
+#include "mpiprocessor.hpp"
 #include "commanddispatcher.hpp"
 
 #include "createauxthread.hpp"
@@ -86,9 +87,10 @@ inline void MPIRemoteNode::mpiOffloadSlaveMain() {
     // create offload task queue
     MPIRemoteNode::_pendingTasksWithParent =
                                  new ProducerConsumerQueue<std::pair<int,int> >();
-    // reserve space for 10 elements of each generic command type
+    // reserve space for as many elements of each generic command type
+    // as the master may have in flight
     MPIRemoteNode::_commandDispatcher =
-                                 new mpi::command::Dispatcher(parentcomm, 10 );
+                                 new mpi::command::Dispatcher(parentcomm, MPIProcessor::getInflightCommands() );
 
     nanosMPIWorker();
 }
@@ -34,14 +34,14 @@ class CommandRequestor< id, CachePayload, Channel > {
 			_data(), _channel( destination )
 		{
 			_data.initialize( id );
-			_channel.send( _data );
+			_channel.post( _data );
 		}
 
 		CommandRequestor( MPIProcessor const& destination, size_t size ) :
 			_data(), _channel( destination )
 		{
 			_data.initialize( id, size );
-			_channel.send( _data );
+			_channel.post( _data );
 		}
 
 		CommandRequestor( MPIProcessor const& destination,
@@ -50,13 +50,13 @@ class CommandRequestor< id, CachePayload, Channel > {
 			_data(), _channel( destination )
 		{
 			_data.initialize( id, hostAddr, deviceAddr, size );
-			_channel.send( _data );
+			_channel.post( _data );
 		}
 
 		CommandRequestor( MPIProcessor const& destination, CachePayload const& data ) :
 			_data(data), _channel( destination )
 		{
-			_channel.send( _data );
+			_channel.post( _data );
 		}
 
 		virtual ~CommandRequestor()
@@ -30,21 +30,21 @@ class CommandRequestor< id, CommandPayload, Channel > {
 			_data(), _channel( destination )
 		{
 			_data.initialize(id);
-			_channel.send( _data );
+			_channel.post( _data );
 		}
 
 		CommandRequestor( MPIProcessor const& destination, int code ) :
 			_data(), _channel( destination )
 		{
 			_data.initialize(id, code);
-			_channel.send( _data );
+			_channel.post( _data );
 		}
 
 		CommandRequestor( int destination, MPI_Comm communicator, int code ) :
 			_data(), _channel( destination, communicator )
 		{
 			_data.initialize(id, code);
-			_channel.send( _data );
+			_channel.post( _data );
 		}
 
 		virtual ~CommandRequestor()
@@ -4,6 +4,7 @@
 
 #include "memoryaddress.hpp"
 #include "mpiprocessor_decl.hpp"
+#include "mpidd.hpp"
 
 #include <mpi.h>
 
@@ -37,37 +38,39 @@ class CommandChannel {
 		int _source;
 		int _destination;
 		MPI_Comm _communicator;
+		const ext::MPIProcessor* _remote; //!< Owner of the command queue to the destination, if known
 
 	public:
 		CommandChannel() :
 			_source( MPI_ANY_SOURCE ), _destination( MPI_PROC_NULL ),
-			_communicator( MPI_COMM_NULL )
+			_communicator( MPI_COMM_NULL ), _remote( NULL )
 		{
 		}
 
 		CommandChannel( int destination, MPI_Comm communicator ) :
 			_source( MPI_ANY_SOURCE ), _destination( destination ),
-			_communicator( communicator )
+			_communicator( communicator ), _remote( NULL )
 		{
 			checkDestinationRank();
+			findRemote();
 		}
 
 		CommandChannel( int source, int destination, MPI_Comm communicator ) :
 			_source( source ), _destination( destination ),
-			_communicator( communicator )
+			_communicator( communicator ), _remote( NULL )
 		{
 			checkDestinationRank();
 		}
 
 		CommandChannel( const ext::MPIProcessor& destination ) :
 			_source( MPI_ANY_SOURCE ), _destination( destination.getRank() ),
-			_communicator( destination.getCommunicator() )
+			_communicator( destination.getCommunicator() ), _remote( &destination )
 		{
 		}
 
 		CommandChannel( const ext::MPIProcessor& source, const ext::MPIProcessor& destination ) :
 			_source( source.getRank() ), _destination( destination.getRank() ),
-			_communicator( source.getCommunicator() )
+			_communicator( source.getCommunicator() ), _remote( &destination )
 		{
 			// TODO: ensure both source and destination communicators are the same
 		}
@@ -75,7 +78,7 @@ class CommandChannel {
 		template < typename OldPayload, int other_tag >
 		CommandChannel( const CommandChannel<command_id,OldPayload,other_tag>& other ) :
 			_source( other.getSource() ), _destination( other.getDestination() ),
-			_communicator( other.getCommunicator() )
+			_communicator( other.getCommunicator() ), _remote( other.getRemote() )
 		{
 		}
 
@@ -104,6 +107,11 @@ class CommandChannel {
 			return _communicator;
 		}
 
+		const ext::MPIProcessor* getRemote() const
+		{
+			return _remote;
+		}
+
 		int getId() const
 		{
 			return command_id;
@@ -120,6 +128,8 @@ class CommandChannel {
 
 		void send( Payload const& data, size_t n = 1 );
 
+		void post( Payload const& data );
+
 		void checkDestinationRank()
 		{
 			using namespace nanos::ext;
@@ -129,6 +139,22 @@ class CommandChannel {
 				_communicator = remote.getCommunicator();
 			}
 		}
+
+		/**
+		 * Looks for the remote process among the ones that the
+		 * current thread is running on, so that commands can be
+		 * queued instead of sent synchronously.
+		 */
+		void findRemote()
+		{
+			using namespace nanos::ext;
+			ProcessingElement *pe = myThread->runningOn();
+			if( pe != NULL && pe->supports( MPI ) ) {
+				MPIProcessor *remote = static_cast<MPIProcessor*>( pe );
+				if( remote->getRank() == _destination && remote->getCommunicator() == _communicator )
+					_remote = remote;
+			}
+		}
 };
 
 template< int command_id, typename Payload, int tag >
@@ -147,6 +173,21 @@ inline void CommandChannel<command_id,Payload,tag>::send( Payload const& data, s
 	fatal_cond0( err != MPI_SUCCESS, "MPI_Send finished with errors" );
 }
 
+/**
+ * Sends a command through the destination's command queue, so that
+ * the caller does not wait for it to be delivered. Falls back to a
+ * synchronous send when the destination process is not known.
+ */
+template< int command_id, typename Payload, int tag >
+inline void CommandChannel<command_id,Payload,tag>::post( Payload const& data )
+{
+	if( _remote != NULL ) {
+		_remote->postCommand( data );
+	} else {
+		send( data );
+	}
+}
+
 template< int command_id, typename Payload, int tag >
 inline request CommandChannel<command_id,Payload,tag>::isend( Payload const& data, size_t n )
 {
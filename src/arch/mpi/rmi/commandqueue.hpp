@@ -0,0 +1,89 @@
+
+#ifndef COMMAND_QUEUE_HPP
+#define COMMAND_QUEUE_HPP
+
+#include "commandqueue_decl.hpp"
+
+#include "lock.hpp"
+#include "debug.hpp"
+
+namespace nanos {
+namespace mpi {
+namespace command {
+
+template < class Payload, int tag >
+inline CommandQueue<Payload,tag>::CommandQueue( int destination, MPI_Comm communicator, size_t size ) :
+	_buffers( size > 0 ? size : 1 ), _requests( _buffers.size() ), _next( 0 ), _lock()
+{
+	typename buffer_storage::iterator buffer_it = _buffers.begin();
+	request_storage::iterator request_it;
+	for( request_it = _requests.begin(); request_it != _requests.end(); request_it++ ) {
+		buffer_it->initialize();
+		int err = MPI_Send_init( &(*buffer_it), 1, Payload::getDataType(),
+		                         destination, tag, communicator, *request_it );
+		fatal_cond0( err != MPI_SUCCESS, "MPI_Send_init finished with errors" );
+		buffer_it++;
+	}
+}
+
+template < class Payload, int tag >
+inline CommandQueue<Payload,tag>::~CommandQueue()
+{
+	drain();
+
+	request_storage::iterator request_it;
+	for( request_it = _requests.begin(); request_it != _requests.end(); request_it++ ) {
+		request_it->free();
+	}
+}
+
+template < class Payload, int tag >
+inline size_t CommandQueue<Payload,tag>::size() const
+{
+	return _requests.size();
+}
+
+template < class Payload, int tag >
+inline void CommandQueue<Payload,tag>::post( Payload const& data )
+{
+	LockBlock guard( _lock );
+
+	// Waiting on an inactive persistent request returns immediately
+	persistent_request &slot = _requests[_next];
+	slot.wait();
+
+	_buffers[_next] = data;
+	slot.start();
+
+	_next = ( _next + 1 ) % _requests.size();
+}
+
+template < class Payload, int tag >
+inline void CommandQueue<Payload,tag>::progress()
+{
+	if ( !_lock.tryAcquire() ) return;
+
+	request_storage::iterator request_it;
+	for( request_it = _requests.begin(); request_it != _requests.end(); request_it++ ) {
+		request_it->test();
+	}
+
+	_lock.release();
+}
+
+template < class Payload, int tag >
+inline void CommandQueue<Payload,tag>::drain()
+{
+	LockBlock guard( _lock );
+
+	request_storage::iterator request_it;
+	for( request_it = _requests.begin(); request_it != _requests.end(); request_it++ ) {
+		request_it->wait();
+	}
+}
+
+} // namespace command
+} // namespace mpi
+} // namespace nanos
+
+#endif // COMMAND_QUEUE_HPP
@@ -0,0 +1,69 @@
+
+#ifndef COMMAND_QUEUE_DECL_HPP
+#define COMMAND_QUEUE_DECL_HPP
+
+#include "request.hpp"
+#include "lock_decl.hpp"
+
+#include <vector>
+#include <mpi.h>
+
+namespace nanos {
+namespace mpi {
+namespace command {
+
+/**
+ * Outgoing command messages to a single remote process.
+ *
+ * Each slot owns a payload buffer and a persistent send request,
+ * so up to size() commands can be in flight at the same time
+ * without blocking the sender. Slots are reused in a round robin
+ * fashion: the next slot to be reused is always the oldest one,
+ * and MPI non-overtaking rules keep the commands in issue order.
+ */
+template < class Payload, int tag >
+class CommandQueue {
+	private:
+		typedef std::vector<persistent_request> request_storage;
+		typedef std::vector<Payload>            buffer_storage;
+
+		buffer_storage                          _buffers;
+		request_storage                         _requests;
+		size_t                                  _next;
+		Lock                                    _lock;
+
+		// Not copyable nor copy-assignable
+		CommandQueue( const CommandQueue& );
+
+		CommandQueue& operator=( const CommandQueue& );
+
+	public:
+		CommandQueue( int destination, MPI_Comm communicator, size_t size );
+
+		~CommandQueue();
+
+		size_t size() const;
+
+		/**
+		 * Copies the command to the oldest slot and starts its send.
+		 * Only waits if all the slots are still in flight.
+		 */
+		void post( Payload const& data );
+
+		/**
+		 * Tests the commands in flight so that MPI can progress
+		 * them. Does nothing if another thread is using the queue.
+		 */
+		void progress();
+
+		/**
+		 * Waits until all the commands in flight have been sent.
+		 */
+		void drain();
+};
+
+} // namespace command
+} // namespace mpi
+} // namespace nanos
+
+#endif // COMMAND_QUEUE_DECL_HPP
@@ -21,7 +21,7 @@ class CommandRequestor {
 			_channel( channel )
 		{
 			_data.initialize(command_id);
-			_channel.send( _data );
+			_channel.post( _data );
 		}
 
 		virtual ~CommandRequestor()
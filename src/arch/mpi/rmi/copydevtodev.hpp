@@ -39,10 +39,8 @@ class CommandRequestor<CopyDeviceToDevice::id,CopyDeviceToDevice::payload_type,C
 			_data.initialize( CopyDeviceToDevice::id, source.getRank(), destination.getRank(),
 			       sourceAddr, destinationAddr, size );
 
-			std::vector<mpi::request> reqs(2);
-			reqs[0] = _channelSource.isend( _data );
-			reqs[1] = _channelDestination.isend( _data );
-			mpi::request::wait_all( reqs.begin(), reqs.end() );
+			_channelSource.post( _data );
+			_channelDestination.post( _data );
 		}
 
 		virtual ~CommandRequestor()
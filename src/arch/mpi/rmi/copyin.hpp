@@ -35,7 +35,7 @@ class CommandRequestor<CopyIn::id,CopyIn::payload_type,CopyIn::main_channel_type
 			_remoteProcess( destination )
 		{
 			_data.initialize( CopyIn::id, MPI_ANY_SOURCE, destination.getRank(), hostAddress, deviceAddress, size );
-			_channel.send( _data );
+			_channel.post( _data );
 		}
 
 		virtual ~CommandRequestor()
@@ -25,7 +25,10 @@
 #include "taskexecutionexception.hpp"
 #include "smpdevice.hpp"
 #include "schedule.hpp"
+#include "lock.hpp"
 #include <string>
+#include <unistd.h>
+#include <sys/mman.h>
 
 using namespace nanos;
 using namespace nanos::ext;
@@ -37,6 +40,53 @@ SMPDevice &nanos::ext::getSMPDevice() {
 }
 
 size_t SMPDD::_stackSize = 256*1024;
+size_t SMPDD::_stackCacheSize = 4;
+size_t SMPDD::_stackWatermark = 64;
+
+namespace {
+   //! \brief List of free task stacks, linked through the last word of each stack
+   struct StackList {
+      void     *_head;
+      size_t    _size;
+   };
+
+   __thread StackList threadStacks = { NULL, 0 };  //!< Stacks cached by the current thread
+   StackList          sharedStacks = { NULL, 0 };  //!< Stacks shared by all threads
+   Lock               sharedStacksLock;
+
+   inline size_t getPageSize ()
+   {
+      static const size_t pageSize = (size_t) sysconf( _SC_PAGESIZE );
+      return pageSize;
+   }
+
+   //! \brief Usable size of a mapped stack (the guard page is not included)
+   inline size_t getMappedStackSize ( size_t stackSize )
+   {
+      const size_t pageSize = getPageSize();
+      return ( stackSize + pageSize - 1 ) & ~( pageSize - 1 );
+   }
+
+   inline void * & nextStack ( void *stack, size_t mappedSize )
+   {
+      return * ( (void **) ( (char *) stack + mappedSize ) - 1 );
+   }
+
+   inline void pushStack ( StackList &list, void *stack, size_t mappedSize )
+   {
+      nextStack( stack, mappedSize ) = list._head;
+      list._head = stack;
+      list._size++;
+   }
+
+   inline void * popStack ( StackList &list, size_t mappedSize )
+   {
+      void *stack = list._head;
+      list._head = nextStack( stack, mappedSize );
+      list._size--;
+      return stack;
+   }
+}
 
 //! \brief Registers the Device's configuration options
 //! \param reference to a configuration object.
@@ -50,6 +100,58 @@ void SMPDD::prepareConfig ( Config &config )
    //! \note Get the stack size for this specific device
    config.registerConfigOption ( "smp-stack-size", NEW Config::SizeVar( _stackSize ), "Defines SMP::task stack size" );
    config.registerArgOption("smp-stack-size", "smp-stack-size");
+
+   config.registerConfigOption ( "smp-stack-cache", NEW Config::SizeVar( _stackCacheSize ), "Defines the number of free SMP::task stacks cached by each thread" );
+   config.registerArgOption("smp-stack-cache", "smp-stack-cache");
+
+   config.registerConfigOption ( "smp-stack-watermark", NEW Config::SizeVar( _stackWatermark ),
+                                 "Defines the number of free SMP::task stacks shared by all threads before their pages are returned to the system" );
+   config.registerArgOption("smp-stack-watermark", "smp-stack-watermark");
+}
+
+void * SMPDD::allocateStack ()
+{
+   const size_t mappedSize = getMappedStackSize( _stackSize );
+
+   if ( threadStacks._head != NULL ) return popStack( threadStacks, mappedSize );
+
+   if ( sharedStacks._head != NULL ) {
+      LockBlock lock( sharedStacksLock );
+      if ( sharedStacks._head != NULL ) return popStack( sharedStacks, mappedSize );
+   }
+
+   const size_t pageSize = getPageSize();
+   int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+#ifdef MAP_NORESERVE
+   flags |= MAP_NORESERVE;
+#endif
+#ifdef MAP_STACK
+   flags |= MAP_STACK;
+#endif
+   char *region = (char *) mmap( NULL, mappedSize + pageSize, PROT_READ | PROT_WRITE, flags, -1, 0 );
+   if ( region == MAP_FAILED ) fatal0( "Could not map a " << mappedSize << " bytes SMP::task stack" );
+
+   //! \note Stacks grow downwards on all supported architectures: guard the lowest page
+   if ( mprotect( region, pageSize, PROT_NONE ) != 0 ) warning0( "Could not protect SMP::task stack guard page" );
+
+   verbose0("   new stack mapped: " << mappedSize << " bytes");
+   return region + pageSize;
+}
+
+void SMPDD::releaseStack ( void *stack )
+{
+   const size_t mappedSize = getMappedStackSize( _stackSize );
+
+   if ( threadStacks._size < _stackCacheSize ) {
+      pushStack( threadStacks, stack, mappedSize );
+      return;
+   }
+
+   //! \note Beyond the watermark, touched pages are given back before pooling the stack
+   if ( sharedStacks._size >= _stackWatermark ) madvise( stack, mappedSize, MADV_DONTNEED );
+
+   LockBlock lock( sharedStacksLock );
+   pushStack( sharedStacks, stack, mappedSize );
 }
 
 void SMPDD::initStack ( WD *wd )
@@ -87,8 +189,7 @@ void SMPDD::lazyInit ( WD &wd, bool isUserLevelThread, WD *previous )
    verbose0("Task " << wd.getId() << " initialization"); 
    if (isUserLevelThread) {
       if (previous == NULL) {
-         _stack = (void *) NEW char[_stackSize];
-         verbose0("   new stack created: " << _stackSize << " bytes");
+         _stack = allocateStack();
       } else {
          verbose0("   reusing stacks");
          SMPDD &oldDD = (SMPDD &) previous->getActiveDevice();
@@ -38,6 +38,8 @@ namespace ext {
          void               *_stack;             //!< Stack base
          void               *_state;             //!< Stack pointer
          static size_t       _stackSize;         //!< Stack size
+         static size_t       _stackCacheSize;    //!< Number of free stacks cached by each thread
+         static size_t       _stackWatermark;    //!< Number of pooled stacks kept resident in memory
       protected:
          SMPDD( work_fct w, Device *dd ) : DD( dd, w ),_stack( 0 ),_state( 0 ) {}
          SMPDD( Device *dd ) : DD( dd, NULL ), _stack( 0 ),_state( 0 ) {}
@@ -51,10 +53,19 @@ namespace ext {
          //! \brief Assignment operator
          const SMPDD & operator= ( const SMPDD &wd );
          //! \brief Destructor
-         virtual ~SMPDD() { if ( _stack ) delete[] (char *) _stack; }
+         virtual ~SMPDD() { if ( _stack ) releaseStack( _stack ); }
 
          bool hasStack() { return _state != NULL; }
 
+         /*! \brief Gets a task stack from the calling thread cache, the shared pool or a new mapping
+          *  Stacks are mapped with a guard page below their base.
+          */
+         static void * allocateStack ();
+         /*! \brief Returns a task stack to the calling thread cache or to the shared pool
+          *  Stacks returned to the shared pool beyond the watermark have their pages reclaimed.
+          */
+         static void releaseStack ( void *stack );
+
          void initStack( WD *wd );
 
         /*! \brief Wrapper called to be able to instrument the
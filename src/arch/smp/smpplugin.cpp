@@ -26,6 +26,7 @@
 #include "smpprocessor.hpp"
 #include "os.hpp"
 #include "osallocator_decl.hpp"
+#include "smptransferqueue_decl.hpp"
 
 #include "cpuset.hpp"
 #include <limits>
@@ -84,6 +85,7 @@ nanos::PE * smpProcessorFactory ( int id, int uid )
       cfg.setOptionsSection( "SMP Arch", "SMP specific options" );
       SMPProcessor::prepareConfig( cfg );
       SMPDD::prepareConfig( cfg );
+      SMPTransferQueue::prepareConfig( cfg );
       cfg.registerConfigOption ( "smp-num-pes", NEW Config::PositiveVar ( _requestedCPUs ), "CPUs requested." );
       cfg.registerArgOption ( "smp-num-pes", "smp-cpus" );
       cfg.registerEnvOption( "smp-num-pes", "NX_SMP_CPUS" );
@@ -252,7 +254,10 @@ nanos::PE * smpProcessorFactory ( int id, int uid )
             OSAllocator a;
             memory_space_id_t id = sys.addSeparateMemoryAddressSpace( ext::getSMPDevice(), _smpAllocWide, sys.getRegionCacheSlabSize() );
             SeparateMemoryAddressSpace &numaMem = sys.getSeparateMemory( id );
-            numaMem.setSpecificData( NEW SimpleAllocator( ( uintptr_t ) a.allocate(_smpPrivateMemorySize), _smpPrivateMemorySize ) );
+            void *pool = a.allocate( _smpPrivateMemorySize );
+            // The pool has not been touched yet, so its pages will be placed in the node of the CPU using it
+            if ( sys._hwloc.isHwlocAvailable() ) sys._hwloc.bindMemoryToNumaNode( pool, _smpPrivateMemorySize, numaNode );
+            numaMem.setSpecificData( NEW SimpleAllocator( ( uintptr_t ) pool, _smpPrivateMemorySize ) );
             numaMem.setAcceleratorNumber( sys.getNewAcceleratorId() );
             cpu = NEW SMPProcessor( *it, id, active, numaNode, socket );
          } else {
@@ -3,131 +3,174 @@
 #include "smptransferqueue_decl.hpp"
 #include "atomic.hpp"
 #include "deviceops.hpp"
+#include <unistd.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 namespace nanos {
 
-SMPTransfer::SMPTransfer() :
-   _ops((DeviceOps *) NULL),
-   _dst((char *)0xdeadbeef),
-   _src((char *)0xbeefdead),
-   _len(133),
-   _count(0),
-   _ld(0),
-   _in( false ) {
+std::size_t SMPTransferQueue::_chunkSize = 64 * 1024;
+std::size_t SMPTransferQueue::_streamingThreshold = 0;
+
+/* Copy of a line bypassing the caches, so that copying a buffer larger than the
+ * last level cache does not evict the working set of the running tasks.
+ */
+static void streamingCopy( char *dst, char const *src, std::size_t len ) {
+#ifdef __SSE2__
+   std::size_t head = ( 16 - ( (uintptr_t) dst & 15 ) ) & 15;
+   if ( head > len ) head = len;
+   ::memcpy( dst, src, head );
+   dst += head;
+   src += head;
+   len -= head;
+   __m128i *d = (__m128i *) dst;
+   __m128i const *s = (__m128i const *) src;
+   for ( ; len >= 64; len -= 64, d += 4, s += 4 ) {
+      __m128i v0 = _mm_loadu_si128( s );
+      __m128i v1 = _mm_loadu_si128( s + 1 );
+      __m128i v2 = _mm_loadu_si128( s + 2 );
+      __m128i v3 = _mm_loadu_si128( s + 3 );
+      _mm_stream_si128( d, v0 );
+      _mm_stream_si128( d + 1, v1 );
+      _mm_stream_si128( d + 2, v2 );
+      _mm_stream_si128( d + 3, v3 );
+   }
+   for ( ; len >= 16; len -= 16, d += 1, s += 1 ) {
+      _mm_stream_si128( d, _mm_loadu_si128( s ) );
+   }
+   ::memcpy( d, s, len );
+#else
+   ::memcpy( dst, src, len );
+#endif
 }
 
-SMPTransfer::SMPTransfer( DeviceOps *ops, char *dst, char *src, std::size_t len, std::size_t count, std::size_t ld, bool in ) : _ops(ops), _dst(dst), _src(src), _len(len), _count(count), _ld(ld), _in( in ) {
+SMPTransfer::SMPTransfer( DeviceOps *ops, char *dst, char *src, std::size_t len, std::size_t count, std::size_t ld, bool in,
+      std::size_t chunkSize, bool streaming ) : _ops(ops), _dst(dst), _src(src), _len(len), _count(count), _ld(ld), _in( in ),
+   _streaming( streaming ), _pieceLen(0), _pieceLines(0), _piecesPerLine(0), _numPieces(0), _claimedPieces(0), _donePieces(0) {
+   // Consecutive lines are copied as a single one
+   if ( _count > 1 && _ld == _len ) {
+      _len *= _count;
+      _count = 1;
+   }
+   if ( _count == 1 ) _ld = _len;
+   if ( chunkSize == 0 ) chunkSize = _len * _count;
+
+   _piecesPerLine = _len > chunkSize ? ( _len + chunkSize - 1 ) / chunkSize : 1;
+   if ( _piecesPerLine > 1 ) {
+      _pieceLen = chunkSize;
+      _pieceLines = 1;
+      _numPieces = _piecesPerLine * _count;
+   } else {
+      _pieceLen = _len;
+      _pieceLines = _len == 0 || chunkSize / _len == 0 ? 1 : chunkSize / _len;
+      _numPieces = ( _count + _pieceLines - 1 ) / _pieceLines;
+   }
+   if ( _numPieces == 0 ) _numPieces = 1;
    ops->addOp();
 }
-SMPTransfer::SMPTransfer( SMPTransfer const &s ) : _ops(s._ops), _dst(s._dst), _src(s._src), _len(s._len), _count(s._count), _ld(s._ld), _in(s._in) {
+
+SMPTransfer::~SMPTransfer() {}
+
+std::size_t SMPTransfer::claimPiece() {
+   return _claimedPieces++;
 }
-SMPTransfer &SMPTransfer::operator=( SMPTransfer const &s ) {
-   _ops = s._ops;
-   _dst = s._dst;
-   _src = s._src;
-   _len = s._len;
-   _count = s._count;
-   _ld = s._ld;
-   _in = s._in;
-   return *this;
+
+bool SMPTransfer::allPiecesClaimed() const {
+   return _claimedPieces == _numPieces;
 }
-SMPTransfer::~SMPTransfer() {}
 
-void SMPTransfer::execute() {
+bool SMPTransfer::executePiece( std::size_t piece ) {
+   std::size_t firstLine = ( piece / _piecesPerLine ) * _pieceLines;
+   std::size_t offset = ( piece % _piecesPerLine ) * _pieceLen;
+   std::size_t len = _len - offset < _pieceLen ? _len - offset : _pieceLen;
+   std::size_t lines = _count - firstLine < _pieceLines ? _count - firstLine : _pieceLines;
+   char *dst = _dst + firstLine * _ld + offset;
+   char *src = _src + firstLine * _ld + offset;
+
    NANOS_INSTRUMENT ( static InstrumentationDictionary *ID = sys.getInstrumentation()->getInstrumentationDictionary(); )
    NANOS_INSTRUMENT ( static nanos_event_key_t key_in = ID->getEventKey("cache-copy-in"); )
    NANOS_INSTRUMENT ( static nanos_event_key_t key_out = ID->getEventKey("cache-copy-out"); )
-   NANOS_INSTRUMENT( sys.getInstrumentation()->raiseOpenBurstEvent( _in ? key_in : key_out , (nanos_event_value_t) _count * _len ); )
-   for ( std::size_t count = 0; count < _count; count += 1) {
-      //if ( sys.getVerboseDevOps()){ 
-      //   std::cerr << "memcpy( " << (void*)(_dst + count) << ", " << (void*)(_src + count *_ld) << ", " << _len << " ) [ld= " << _ld << " count= " << _count << " _dst= " << (void*)_dst << " _src= " << (void*)_src << " ]" << std::endl;
-      //}
+   NANOS_INSTRUMENT( sys.getInstrumentation()->raiseOpenBurstEvent( _in ? key_in : key_out , (nanos_event_value_t) lines * len ); )
+   for ( std::size_t count = 0; count < lines; count += 1) {
       if (sys._watchAddr != NULL ) {
-         if ((uint64_t )sys._watchAddr >= (uint64_t)(_dst + count *_ld ) && (uint64_t )sys._watchAddr < (uint64_t)(_dst + count *_ld + _len)) {
+         if ((uint64_t )sys._watchAddr >= (uint64_t)(dst + count *_ld ) && (uint64_t )sys._watchAddr < (uint64_t)(dst + count *_ld + len)) {
             char buff[256];
             snprintf(buff, 256, "WATCH update: old value %a", *((double *) sys._watchAddr ) );
             *myThread->_file << buff << std::endl;
          }
-         if ((uint64_t )sys._watchAddr >= (uint64_t)(_src + count *_ld ) && (uint64_t )sys._watchAddr < (uint64_t)(_dst + count * _ld + _len)) {
+         if ((uint64_t )sys._watchAddr >= (uint64_t)(src + count *_ld ) && (uint64_t )sys._watchAddr < (uint64_t)(src + count * _ld + len)) {
             char buff[256];
             snprintf(buff, 256, "WATCH read: value %a", *((double *) sys._watchAddr ) );
             *myThread->_file << buff << std::endl;
          }
       }
-      ::memcpy( _dst + count * _ld, _src + count * _ld, _len );
+      if ( _streaming ) {
+         streamingCopy( dst + count * _ld, src + count * _ld, len );
+      } else {
+         ::memcpy( dst + count * _ld, src + count * _ld, len );
+      }
       if (sys._watchAddr != NULL ) {
-         if ((uint64_t )sys._watchAddr >= (uint64_t)(_dst + count *_ld ) && (uint64_t )sys._watchAddr < (uint64_t)(_dst + count * _ld + _len)) {
+         if ((uint64_t )sys._watchAddr >= (uint64_t)(dst + count *_ld ) && (uint64_t )sys._watchAddr < (uint64_t)(dst + count * _ld + len)) {
             char buff[256];
             snprintf(buff, 256, "WATCH update: new value %a", *((double *) sys._watchAddr ) );
             *myThread->_file << buff << std::endl;
          }
       }
    }
-   //*myThread->_file << "Execueted op " << (void *) _dst  << " ops: " << (void *) _ops << " is in " << _in << " content (dst): [" << ((double *)_dst)[0] << " " << ((double *)_dst)[1] << "]" << std::endl; 
-   _ops->completeOp();
+#ifdef __SSE2__
+   // Non-temporal stores must be visible before the operation is seen as completed
+   if ( _streaming ) _mm_sfence();
+#endif
    NANOS_INSTRUMENT( sys.getInstrumentation()->raiseCloseBurstEvent( _in ? key_in : key_out, (nanos_event_value_t) 0 ); )
-}
 
-#define CHUNK_SIZE 4096
+   if ( ++_donePieces < _numPieces ) return false;
+   _ops->completeOp();
+   return true;
+}
 
 SMPTransferQueue::SMPTransferQueue() : _lock(), _transfers() {}
+
+void SMPTransferQueue::prepareConfig( Config &config ) {
+   // By default, stream the transfers that do not fit in the last level cache
+#ifdef _SC_LEVEL3_CACHE_SIZE
+   long llcSize = sysconf( _SC_LEVEL3_CACHE_SIZE );
+   if ( llcSize <= 0 ) llcSize = sysconf( _SC_LEVEL2_CACHE_SIZE );
+   if ( llcSize > 0 ) _streamingThreshold = (std::size_t) llcSize;
+#endif
+
+   config.registerConfigOption( "smp-transfer-chunk", NEW Config::SizeVar( _chunkSize ),
+         "Size of the pieces in which asynchronous SMP transfers are split among idle threads (0: do not split)" );
+   config.registerArgOption( "smp-transfer-chunk", "smp-transfer-chunk" );
+   config.registerEnvOption( "smp-transfer-chunk", "NX_SMP_TRANSFER_CHUNK" );
+
+   config.registerConfigOption( "smp-transfer-streaming", NEW Config::SizeVar( _streamingThreshold ),
+         "Size from which asynchronous SMP transfers use non-temporal stores (0: never, default: last level cache size)" );
+   config.registerArgOption( "smp-transfer-streaming", "smp-transfer-streaming" );
+   config.registerEnvOption( "smp-transfer-streaming", "NX_SMP_TRANSFER_STREAMING" );
+}
+
 void SMPTransferQueue::addTransfer( DeviceOps *ops, char *dst, char *src, std::size_t len, std::size_t count, std::size_t ld, bool in ) {
-   _lock.acquire();
-   // NANOS_INSTRUMENT ( static InstrumentationDictionary *ID = sys.getInstrumentation()->getInstrumentationDictionary(); )
-   // NANOS_INSTRUMENT ( static nanos_event_key_t key = ID->getEventKey("cache-copy-out"); )
-   // NANOS_INSTRUMENT( sys.getInstrumentation()->raiseOpenBurstEvent( key, (nanos_event_value_t) 4 ); )
-   if ( len * count > CHUNK_SIZE*2 && ( true /* FRAGMENT FLAG */ ) ) {
-      if ( count == 1 ) {
-         std::size_t current_chunk = CHUNK_SIZE;
-         std::size_t total_processed = 0;
-         while ( total_processed < len ) {
-            _transfers.push_back( SMPTransfer(ops, dst+total_processed, src+total_processed, current_chunk, 1, ld, in) );
-            total_processed += current_chunk;
-            current_chunk = total_processed + (CHUNK_SIZE*2) > len ? CHUNK_SIZE : len - total_processed;
-         }
-      } else {
-         if ( len > CHUNK_SIZE*2 ) {
-            for ( std::size_t count_idx = 0; count_idx < count; count_idx += 1 ) {
-               std::size_t current_line_chunk = CHUNK_SIZE;
-               std::size_t total_line = 0;
-               while ( total_line < len ) {
-                  _transfers.push_back( SMPTransfer(ops, dst+(ld*count_idx)+total_line, src+(ld*count_idx)+total_line, current_line_chunk, 1, ld, in) );
-                  total_line += current_line_chunk;
-                  current_line_chunk = total_line + (CHUNK_SIZE*2) > len ?  len - total_line : CHUNK_SIZE;
-               }
-            }
-         } else {
-            std::size_t current_count_chunk = CHUNK_SIZE / len;
-            std::size_t total_count = 0;
-            while ( total_count < count ) {
-               _transfers.push_back( SMPTransfer(ops, dst+(ld*total_count), src+(ld*total_count), len, current_count_chunk, ld, in) );
-               total_count += current_count_chunk;
-               current_count_chunk = total_count + (CHUNK_SIZE/len)*2 > count ? count - total_count : (CHUNK_SIZE/len);
-            }
-         }
-      }
-   } else {
-      _transfers.push_back( SMPTransfer(ops, dst, src, len, count, ld, in) );
-   }
-   // NANOS_INSTRUMENT( sys.getInstrumentation()->raiseCloseBurstEvent( key, (nanos_event_value_t) 0 ); )
-   _lock.release();
+   bool streaming = _streamingThreshold != 0 && len * count >= _streamingThreshold;
+   SMPTransfer *t = NEW SMPTransfer( ops, dst, src, len, count, ld, in, _chunkSize, streaming );
+   LockBlock lock( _lock );
+   _transfers.push_back( t );
 }
+
 void SMPTransferQueue::tryExecuteOne() {
-   if ( !_transfers.empty() ) {
-      if ( true /*_lock.tryAcquire()*/ ) {
-         _lock.acquire();
-         bool found = false;
-         SMPTransfer t;
-         if ( !_transfers.empty() ) {
-            found = true;
-            t = _transfers.front();
-            _transfers.pop_front();
-         }
-         _lock.release();
-         if ( found ) 
-            t.execute();
-      }
+   if ( _transfers.empty() ) return;
+
+   SMPTransfer *t = NULL;
+   std::size_t piece = 0;
+   {
+      LockBlock lock( _lock );
+      if ( _transfers.empty() ) return;
+      t = _transfers.front();
+      piece = t->claimPiece();
+      // Other threads keep copying the pieces of the transfer at the front
+      if ( t->allPiecesClaimed() ) _transfers.pop_front();
    }
+   if ( t->executePiece( piece ) ) delete t;
 }
 
 } // namespace nanos
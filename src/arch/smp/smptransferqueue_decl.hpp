@@ -4,9 +4,13 @@
 #include <list>
 #include "atomic_decl.hpp"
 #include "deviceops_fwd.hpp"
+#include "config_decl.hpp"
 
 namespace nanos {
 
+/* A transfer of count lines of len bytes, split in pieces that any idle
+ * thread can copy. The thread copying the last piece completes the operation.
+ */
 class SMPTransfer {
    DeviceOps   *_ops;
    char        *_dst;
@@ -15,20 +19,34 @@ class SMPTransfer {
    std::size_t  _count;
    std::size_t  _ld;
    bool         _in;
-   public:
-   SMPTransfer();
-   SMPTransfer( DeviceOps *ops, char *dst, char *src, std::size_t len, std::size_t count, std::size_t ld, bool in );
+   bool         _streaming;       /* use non-temporal stores */
+   std::size_t  _pieceLen;        /* bytes of a line copied by each piece */
+   std::size_t  _pieceLines;      /* lines copied by each piece */
+   std::size_t  _piecesPerLine;
+   std::size_t  _numPieces;
+   std::size_t  _claimedPieces;   /* protected by the queue lock */
+   Atomic<std::size_t> _donePieces;
+
    SMPTransfer( SMPTransfer const &s );
    SMPTransfer &operator=( SMPTransfer const &s );
+   public:
+   SMPTransfer( DeviceOps *ops, char *dst, char *src, std::size_t len, std::size_t count, std::size_t ld, bool in,
+         std::size_t chunkSize, bool streaming );
    ~SMPTransfer();
-   void execute();
+   std::size_t claimPiece();
+   bool allPiecesClaimed() const;
+   /* returns true if this was the last piece to finish */
+   bool executePiece( std::size_t piece );
 };
 
 class SMPTransferQueue {
    Lock _lock;
-   std::list< SMPTransfer > _transfers;
+   std::list< SMPTransfer * > _transfers;
+   static std::size_t _chunkSize;
+   static std::size_t _streamingThreshold;
    public:
    SMPTransferQueue();
+   static void prepareConfig( Config &config );
    void addTransfer( DeviceOps *ops, char *dst, char *src, std::size_t len, std::size_t count, std::size_t ld, bool in );
    void tryExecuteOne();
 };
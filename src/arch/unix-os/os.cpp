@@ -23,6 +23,11 @@
 #include <unistd.h>
 #include <string.h>
 
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
 #ifdef IS_BGQ_MACHINE
 #include <spi/include/kernel/location.h>
 #include <spi/include/kernel/process.h>
@@ -167,3 +172,23 @@ int OS::nanosleep ( unsigned long long nanoseconds )
    req.tv_nsec = (long) ( nanoseconds % 1000000000ULL );
    return ::nanosleep( &req, &rem );
 }
+
+void OS::futexWait ( volatile int *addr, int value, unsigned long long nanoseconds )
+{
+#ifdef __linux__
+   struct timespec timeout;
+   timeout.tv_sec = (time_t) ( nanoseconds / 1000000000ULL );
+   timeout.tv_nsec = (long) ( nanoseconds % 1000000000ULL );
+   // Spurious wake ups, EAGAIN and timeouts are handled by the caller
+   syscall( SYS_futex, addr, FUTEX_WAIT_PRIVATE, value, &timeout, NULL, 0 );
+#else
+   if ( *addr == value ) nanosleep( nanoseconds );
+#endif
+}
+
+void OS::futexWake ( volatile int *addr, int count )
+{
+#ifdef __linux__
+   syscall( SYS_futex, addr, FUTEX_WAKE_PRIVATE, count, NULL, NULL, 0 );
+#endif
+}
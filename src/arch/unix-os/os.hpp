@@ -111,6 +111,11 @@ namespace nanos {
          static double getMonotonicTimeResolution ();
 
          static int nanosleep ( unsigned long long nanoseconds );
+
+         /*! \brief Blocks while *addr == value, at most 'nanoseconds' (futex where available, sleep otherwise) */
+         static void futexWait ( volatile int *addr, int value, unsigned long long nanoseconds );
+         /*! \brief Wakes up to 'count' threads blocked in futexWait on addr */
+         static void futexWake ( volatile int *addr, int count );
          
          static const InitList & getInitializationFunctions ( ) { return *_initList;}
          static const InitList & getPostInitializationFunctions ( ) { return *_postInitList;}
@@ -0,0 +1,183 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+#include "bufferedinstrumentation_decl.hpp"
+#include "instrumentation.hpp"
+#include "basethread.hpp"
+#include "config.hpp"
+#include "os.hpp"
+#include <time.h>
+
+using namespace nanos;
+
+size_t BufferedInstrumentation::_bufferSize = 1 << 16;
+unsigned int BufferedInstrumentation::_drainPeriod = 1000;
+
+void BufferedInstrumentation::config ( Config &cfg )
+{
+   cfg.setOptionsSection( "Buffered instrumentation", "Options of the instrumentation plugins which record events in per thread buffers" );
+
+   cfg.registerConfigOption( "instrument-buffer-size", NEW Config::SizeVar( _bufferSize ),
+                             "Number of events each thread can record before they are processed (rounded up to a power of two)" );
+   cfg.registerArgOption( "instrument-buffer-size", "instrument-buffer-size" );
+
+   cfg.registerConfigOption( "instrument-drain-period", NEW Config::UintVar( _drainPeriod ),
+                             "Microseconds the drainer thread sleeps when there are no events to process" );
+   cfg.registerArgOption( "instrument-drain-period", "instrument-drain-period" );
+}
+
+#ifdef NANOS_INSTRUMENTATION_ENABLED
+
+namespace {
+   /*! \brief Buffer of the current thread (a BufferedInstrumentation::EventBuffer) */
+   __thread void *myEventBuffer = NULL;
+
+   inline unsigned long long getTime ()
+   {
+      struct timespec ts;
+      clock_gettime( CLOCK_MONOTONIC, &ts );
+      return (unsigned long long) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+   }
+}
+
+BufferedInstrumentation::EventBuffer::EventBuffer ( size_t capacity ) : _head( 0 ), _tail( 0 ), _mask( 0 ), _records( NULL )
+{
+   size_t size = 1;
+   while ( size < capacity ) size <<= 1;
+   _mask = size - 1;
+   _records = NEW EventRecord[size];
+}
+
+BufferedInstrumentation::EventBuffer::~EventBuffer ()
+{
+   delete[] _records;
+}
+
+BufferedInstrumentation::~BufferedInstrumentation ()
+{
+   for ( EventBuffers::iterator it = _buffers.begin(); it != _buffers.end(); it++ ) {
+      delete *it;
+   }
+}
+
+BufferedInstrumentation::EventBuffer & BufferedInstrumentation::getMyBuffer ()
+{
+   if ( myEventBuffer == NULL ) {
+      EventBuffer *buffer = NEW EventBuffer( _bufferSize > 0 ? _bufferSize : 1 );
+      LockBlock lock( _buffersLock );
+      _buffers.push_back( buffer );
+      myEventBuffer = buffer;
+   }
+   return *(EventBuffer *) myEventBuffer;
+}
+
+size_t BufferedInstrumentation::drain ()
+{
+   size_t drained = 0;
+
+   LockBlock lock( _buffersLock );
+
+   for ( EventBuffers::iterator it = _buffers.begin(); it != _buffers.end(); it++ ) {
+      EventBuffer &buffer = **it;
+      size_t head = buffer._head;
+      size_t tail = buffer._tail;
+      // Records are read after the tail which published them
+      memoryFence();
+
+      while ( head != tail ) {
+         size_t first = head & buffer._mask;
+         size_t count = std::min( tail - head, buffer.capacity() - first );
+         processEvents( count, &buffer._records[first] );
+         head += count;
+         drained += count;
+      }
+
+      // Records must be processed before the owner can overwrite them
+      memoryFence();
+      buffer._head = head;
+   }
+
+   return drained;
+}
+
+void * BufferedInstrumentation::drainerLoop ( void *arg )
+{
+   BufferedInstrumentation *instr = (BufferedInstrumentation *) arg;
+
+   while ( instr->_draining ) {
+      if ( instr->drain() == 0 ) OS::nanosleep( (unsigned long long) _drainPeriod * 1000ULL );
+   }
+
+   return NULL;
+}
+
+void BufferedInstrumentation::initialize ( void )
+{
+   _draining = true;
+   memoryFence();
+   if ( pthread_create( &_drainer, NULL, drainerLoop, this ) != 0 ) {
+      _draining = false;
+      warning0( "Could not create the instrumentation drainer thread, events will be processed when buffers get full" );
+   }
+}
+
+void BufferedInstrumentation::finalize ( void )
+{
+   if ( _draining ) {
+      _draining = false;
+      pthread_join( _drainer, NULL );
+   }
+   drain();
+
+   if ( _fullWaits.value() > 0 ) {
+      message0( "Instrumentation buffers got full " << _fullWaits.value() << " times, consider increasing --instrument-buffer-size" );
+   }
+}
+
+void BufferedInstrumentation::addEventList ( unsigned int count, Event *events )
+{
+   if ( count == 0 ) return;
+
+   EventBuffer &buffer = getMyBuffer();
+   unsigned long long time = getTime();
+   BaseThread *thread = getMyThreadSafe();
+   int thread_id = thread ? thread->getId() : -1;
+   size_t tail = buffer._tail;
+
+   for ( unsigned int i = 0; i < count; i++ ) {
+      if ( tail - buffer._head >= buffer.capacity() ) {
+         // Publish what we have and process the buffers ourselves
+         memoryFence();
+         buffer._tail = tail;
+         _fullWaits++;
+         drain();
+      }
+      EventRecord &record = buffer._records[tail & buffer._mask];
+      record._time = time;
+      record._thread = thread_id;
+      record._event = events[i];
+      tail++;
+   }
+
+   // Records must be visible before the new tail
+   memoryFence();
+   buffer._tail = tail;
+}
+
+#endif
@@ -0,0 +1,144 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+#ifndef __NANOS_BUFFERED_INSTRUMENTATION_DECL_H
+#define __NANOS_BUFFERED_INSTRUMENTATION_DECL_H
+
+#include <vector>
+#include <pthread.h>
+#include "instrumentation_decl.hpp"
+#include "atomic_decl.hpp"
+#include "lock_decl.hpp"
+#include "config_decl.hpp"
+
+namespace nanos {
+
+/*!\class BufferedInstrumentation
+ * \brief Instrumentation back end which defers event processing to a drainer thread
+ *
+ * addEventList() only copies the events, together with a timestamp and the id of the thread
+ * which raised them, into a ring buffer owned by that thread. A drainer thread hands the records
+ * to the plugin in batches through processEvents(). Producers never take a lock: each buffer is
+ * only written by its thread. Draining takes a lock, and a thread finding its buffer full publishes
+ * it and drains all the buffers itself. Calls to processEvents() are thus serialized, but may run
+ * on any thread, including workers raising events.
+ *
+ * Records are processed after the fact, so plugins must not dereference event values which are
+ * pointers (e.g. create-wd-ptr): the object may no longer exist.
+ *
+ * Plugins overriding initialize() or finalize() must call the ones of this class, which start and
+ * stop the drainer. Options are registered by the plugin calling BufferedInstrumentation::config().
+ */
+   class BufferedInstrumentation : public Instrumentation
+   {
+      public:
+         /*! \brief Fixed size record of an event */
+         struct EventRecord {
+            unsigned long long   _time;      /**< Nanoseconds of the monotonic clock */
+            int                  _thread;    /**< Id of the thread which raised the event (-1 if not a runtime thread) */
+            Event                _event;
+         };
+
+         /*! \brief Registers the buffer options (buffer size, drain period) */
+         static void config ( Config &cfg );
+
+      private:
+         static size_t           _bufferSize;      /**< Records per thread buffer (a power of two) */
+         static unsigned int     _drainPeriod;     /**< Microseconds the drainer sleeps when buffers are empty */
+
+#ifndef NANOS_INSTRUMENTATION_ENABLED
+      public:
+         BufferedInstrumentation () : Instrumentation() {}
+         virtual ~BufferedInstrumentation () {}
+#else
+      private:
+         /*! \brief Single producer single consumer ring of records */
+         class EventBuffer {
+            public:
+               volatile size_t      _head;       /**< Next record to be drained (written by the drainer) */
+               char                 _pad0[64];   /**< Keeps producer and consumer indexes in different cache lines */
+               volatile size_t      _tail;       /**< Next free record (written by the owner thread) */
+               char                 _pad1[64];
+               size_t               _mask;       /**< Capacity - 1 */
+               EventRecord         *_records;
+            private:
+               /*! \brief EventBuffer copy constructor (private) */
+               EventBuffer ( const EventBuffer & );
+               /*! \brief EventBuffer copy assignment operator (private) */
+               const EventBuffer & operator= ( const EventBuffer & );
+            public:
+               EventBuffer ( size_t capacity );
+               ~EventBuffer ();
+
+               size_t capacity () const { return _mask + 1; }
+         };
+
+         typedef std::vector<EventBuffer *> EventBuffers;
+
+         EventBuffers            _buffers;         /**< Buffers of all the threads which raised events */
+         Lock                    _buffersLock;     /**< Protects _buffers (and serializes drains) */
+         pthread_t               _drainer;         /**< Drainer thread */
+         volatile bool           _draining;        /**< The drainer thread is running */
+         Atomic<unsigned long>   _fullWaits;       /**< Times a thread found its buffer full */
+
+      private:
+         /*! \brief BufferedInstrumentation default constructor (private) */
+         BufferedInstrumentation ();
+         /*! \brief BufferedInstrumentation copy constructor (private) */
+         BufferedInstrumentation ( BufferedInstrumentation & );
+         /*! \brief BufferedInstrumentation copy assignment operator (private) */
+         BufferedInstrumentation & operator= ( BufferedInstrumentation & );
+
+         /*! \brief Returns the buffer of the current thread, creating it the first time */
+         EventBuffer & getMyBuffer ();
+
+         /*! \brief Body of the drainer thread */
+         static void * drainerLoop ( void *arg );
+
+         /*! \brief Hands all the buffered records to the plugin, returns the number of records */
+         size_t drain ();
+
+      protected:
+         /*! \brief Processes a batch of records of a single thread, in the order they were raised
+          *
+          *  Never executed concurrently, but may run on the drainer thread, on a thread whose buffer
+          *  got full, or in finalize().
+          */
+         virtual void processEvents ( unsigned int count, const EventRecord *records ) = 0;
+
+      public:
+         /*! \brief BufferedInstrumentation constructor */
+         BufferedInstrumentation ( InstrumentationContext &ic ) : Instrumentation( ic ), _buffers(), _buffersLock(),
+            _drainer(), _draining( false ), _fullWaits( 0 ) {}
+         /*! \brief BufferedInstrumentation destructor */
+         virtual ~BufferedInstrumentation ();
+
+         /*! \brief Starts the drainer thread */
+         virtual void initialize ( void );
+         /*! \brief Stops the drainer thread and drains the remaining records */
+         virtual void finalize ( void );
+
+         /*! \brief Records the events in the buffer of the current thread */
+         virtual void addEventList ( unsigned int count, Event *events );
+#endif
+   };
+
+} // namespace nanos
+
+#endif
@@ -277,7 +277,7 @@ bool global_reg_t::isRegistered() const {
    return entry != NULL;
 }
 
-std::set< memory_space_id_t > const &global_reg_t::getLocations() const {
+LocationSet const &global_reg_t::getLocations() const {
    DirectoryEntryData *entry = RegionDirectory::getDirectoryEntry( *key, id );
    ensure(entry != NULL, "invalid entry.");
    return entry->getLocations();
@@ -316,7 +316,7 @@ bool global_reg_t::isLocatedInSeparateMemorySpaces() const {
    DirectoryEntryData *entry = RegionDirectory::getDirectoryEntry( *key, id );
    ensure(entry != NULL, "invalid entry.");
    entry->lock();
-   std::set< memory_space_id_t > const &locs = entry->getLocations();
+   LocationSet const &locs = entry->getLocations();
    res = ( locs.size() > 1 || locs.count(0) == 0 );
    entry->unlock();
    return res;
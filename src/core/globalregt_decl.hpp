@@ -24,6 +24,7 @@
 
 #include "addressspace_fwd.hpp"
 #include "deviceops_decl.hpp"
+#include "locationset_decl.hpp"
 #include "processingelement_fwd.hpp"
 
 namespace nanos {
@@ -63,7 +64,7 @@ struct global_reg_t {
    bool isLocatedIn( memory_space_id_t loc ) const;
    void fillCopyData( CopyData &cd, uint64_t baseAddress ) const;
    bool isRegistered() const;
-   std::set< memory_space_id_t > const &getLocations() const;
+   LocationSet const &getLocations() const;
    //void setRooted() const;
    bool isRooted() const;
    memory_space_id_t getRootedLocation() const;
@@ -30,6 +30,11 @@ using namespace nanos;
 
 #ifdef NANOS_INSTRUMENTATION_ENABLED
 
+namespace {
+   /* Whether the work descriptor running in this thread is sampled (see InstrumentationSampler) */
+   __thread bool currentTaskSampled = true;
+}
+
 /* ************************************************************************** */
 /* ***                   C R E A T I N G   E V E N T S                    *** */
 /* ************************************************************************** */
@@ -95,7 +100,8 @@ void Instrumentation::closeBurstEvent ( Event *e, nanos_event_key_t key, nanos_e
 
    /* If not needed to show stacked bursts then close current event by openning next one (if any)  */
    if ( ( !_instrumentationContext.showStackedBursts()) && (_instrumentationContext.findBurstByKey( icd, key, it )) ) {
-      new (e) Event(*it);
+      /* ...unless the sampler dropped the next one, then the current one is just closed */
+      if ( (*it).getSampling() != Event::SAMPLING_DROPPED ) new (e) Event(*it);
    }
 }
 void Instrumentation::createPointEvent ( Event *e, nanos_event_key_t key, nanos_event_value_t value )
@@ -141,7 +147,7 @@ void Instrumentation::createDeferredPointEvent ( WorkDescriptor &wd, unsigned in
    if ( ne == 0 ) return;
 
    /* Spawning point events */
-   addEventList ( ne, e );
+   filterEventList ( ne, e, _sampler.isSampled( wd ), icd );
 }
 
 void Instrumentation::createDeferredPtPStart ( WorkDescriptor &wd, nanos_event_domain_t domain, nanos_event_id_t id,
@@ -187,7 +193,7 @@ void Instrumentation::raisePointEvents ( unsigned int nkvs, nanos_event_key_t *k
    if ( ne == 0 ) return;
 
    /* Spawning point events */
-   addEventList ( ne, e );
+   emitEventList ( ne, e );
 }
 
 void Instrumentation::raiseOpenStateEvent ( nanos_event_state_value_t state )
@@ -199,7 +205,7 @@ void Instrumentation::raiseOpenStateEvent ( nanos_event_state_value_t state )
    createStateEvent( &e, state );
 
    /* Spawning state event */
-   addEventList ( 1, &e );
+   emitEventList ( 1, &e );
 }
 
 void Instrumentation::raiseCloseStateEvent ( void )
@@ -211,7 +217,7 @@ void Instrumentation::raiseCloseStateEvent ( void )
    returnPreviousStateEvent( &e );
 
    /* Spawning state event */
-   addEventList ( 1, &e );
+   emitEventList ( 1, &e );
 
 }
 
@@ -224,7 +230,7 @@ void Instrumentation::raiseOpenBurstEvent ( nanos_event_key_t key, nanos_event_v
    createBurstEvent( &e, key, val );
 
    /* Spawning event: specific instrumentation call */
-   addEventList ( 1, &e );
+   emitEventList ( 1, &e );
 }
 
 void Instrumentation::raiseCloseBurstEvent ( nanos_event_key_t key, nanos_event_value_t value )
@@ -237,7 +243,7 @@ void Instrumentation::raiseCloseBurstEvent ( nanos_event_key_t key, nanos_event_
    closeBurstEvent( &e, key, value );
 
    /* Spawning event: specific instrumentation call */
-   addEventList ( 1, &e );
+   emitEventList ( 1, &e );
 }
 
 void Instrumentation::raiseOpenPtPEvent ( nanos_event_domain_t domain, nanos_event_id_t id, nanos_event_key_t key, nanos_event_value_t val, unsigned int partner )
@@ -251,7 +257,7 @@ void Instrumentation::raiseOpenPtPEvent ( nanos_event_domain_t domain, nanos_eve
    createPtPStart( &e, domain, id, key, val, partner );
 
    /* Spawning event: specific instrumentation call */
-   addEventList ( 1, &e );
+   emitEventList ( 1, &e );
 }
 void Instrumentation::raiseClosePtPEvent ( nanos_event_domain_t domain, nanos_event_id_t id, nanos_event_key_t key, nanos_event_value_t val, unsigned int partner )
 {
@@ -264,7 +270,7 @@ void Instrumentation::raiseClosePtPEvent ( nanos_event_domain_t domain, nanos_ev
    createPtPEnd( &e, domain, id, key, val, partner );
 
    /* Spawning event: specific instrumentation call */
-   addEventList ( 1, &e );
+   emitEventList ( 1, &e );
 
 }
 void Instrumentation::raiseOpenStateAndBurst ( nanos_event_state_value_t state, nanos_event_key_t key, nanos_event_value_t val )
@@ -281,7 +287,7 @@ void Instrumentation::raiseOpenStateAndBurst ( nanos_event_state_value_t state,
    if ( ne == 0 ) return;
 
    /* Spawning ne events: specific instrumentation call */
-   addEventList ( ne, e );
+   emitEventList ( ne, e );
 
 }
 
@@ -299,7 +305,92 @@ void Instrumentation::raiseCloseStateAndBurst ( nanos_event_key_t key, nanos_eve
    if ( ne == 0 ) return;
 
    /* Spawning ne events: specific instrumentation call */
-   addEventList ( ne, e );
+   emitEventList ( ne, e );
+}
+
+/* ************************************************************************** */
+/* ***                  S A M P L I N G   E V E N T S                     *** */
+/* ************************************************************************** */
+void Instrumentation::setupSampling ( unsigned int taskPeriod, unsigned int windowStart, unsigned int windowLength,
+                                      const std::list<std::string> &keyRates )
+{
+   _sampler.configure( _instrumentationDictionary, taskPeriod, windowStart, windowLength, keyRates );
+}
+
+void Instrumentation::emitEventList ( unsigned int count, Event *events )
+{
+   if ( !_sampler.isActive() ) {
+      addEventList ( count, events );
+      return;
+   }
+   BaseThread *thread = getMyThreadSafe();
+   WorkDescriptor *wd = thread != NULL ? thread->getCurrentWD() : NULL;
+   filterEventList ( count, events, currentTaskSampled, wd != NULL ? wd->getInstrumentationContextData() : NULL );
+}
+
+void Instrumentation::filterEventList ( unsigned int count, Event *events, bool taskSampled, InstrumentationContextData *icd )
+{
+   if ( !_sampler.isActive() ) {
+      addEventList ( count, events );
+      return;
+   }
+
+   unsigned long long time = InstrumentationSampler::getTime();
+   bool window = _sampler.inWindow( time );
+
+   unsigned int i, ne = 0;
+   bool dropDirection = false;
+   nanos_event_key_t dependence = _sampler.getDependenceKey();
+   nanos_event_key_t depDirection = _sampler.getDepDirectionKey();
+
+   for ( i = 0; i < count; i++ ) {
+      nanos_event_type_t type = events[i].getType();
+      nanos_event_key_t key = events[i].getKey();
+      bool keep = true;
+
+      if ( key != 0 && ( type == NANOS_BURST_START || type == NANOS_BURST_END ) &&
+           events[i].getSampling() != Event::SAMPLING_UNDECIDED ) {
+         /* Copy of a burst which is kept in the context: same decision as its first start */
+         keep = events[i].getSampling() == Event::SAMPLING_RECORDED;
+      } else if ( key != 0 && type == NANOS_BURST_END ) {
+         /* An end is kept if and only if the start of its burst was */
+         keep = window || taskSampled;
+         if ( icd != NULL ) keep = _instrumentationContext.getOpenBursts( icd ).close( key, keep );
+      } else if ( window ) {
+         keep = true;
+      } else if ( !taskSampled ) {
+         /* Events of a task which is not sampled */
+         keep = false;
+      } else if ( key != 0 && ( type == NANOS_POINT || type == NANOS_BURST_START ) ) {
+         /* Only events opening something are limited */
+         if ( key == dependence ) {
+            /* Value is ( sender << 32 | receiver ), the dependence belongs to the receiver */
+            keep = _sampler.isSampled( (int64_t) ( events[i].getValue() & 0xFFFFFFFF ) ) && _sampler.takeToken( key, time );
+            /* The direction comes right after the dependence */
+            dropDirection = !keep;
+         } else if ( key == depDirection && dropDirection ) {
+            keep = false;
+            dropDirection = false;
+         } else {
+            keep = _sampler.takeToken( key, time );
+         }
+      }
+
+      if ( key != 0 && type == NANOS_BURST_START && icd != NULL && events[i].getSampling() == Event::SAMPLING_UNDECIDED ) {
+         /* Later copies of the burst get the decision from the context, otherwise its end finds it here */
+         Event::Sampling sampling = keep ? Event::SAMPLING_RECORDED : Event::SAMPLING_DROPPED;
+         if ( !_instrumentationContext.setBurstSampling( icd, events[i], sampling ) ) {
+            _instrumentationContext.getOpenBursts( icd ).open( key, keep );
+         }
+      }
+
+      if ( keep ) {
+         if ( ne != i ) events[ne] = events[i];
+         ne++;
+      }
+   }
+
+   if ( ne != 0 ) addEventList ( ne, events );
 }
 
 /* ************************************************************************** */
@@ -361,7 +452,7 @@ void Instrumentation::flushDeferredEvents ( WorkDescriptor* wd )
    }
    _instrumentationContext.clearDeferredEvents( icd );
 
-   addEventList ( numEvents, e );
+   filterEventList ( numEvents, e, _sampler.isSampled( *wd ), icd );
 
 }
 
@@ -469,7 +560,21 @@ void Instrumentation::wdSwitch( WorkDescriptor* oldWD, WorkDescriptor* newWD, bo
    ensure0( i == numEvents , "Computed number of events doesn't fit with number of real events");
 
    /* Spawning 'numEvents' events: specific instrumentation call */
-   if ( _instrumentationContext.isContextSwitchEnabled() ) {
+   if ( _sampler.isActive() ) {
+      /* Each half is recorded only if its work descriptor is sampled */
+      bool oldSampled = oldWD == NULL || _sampler.isSampled( *oldWD );
+      bool newSampled = newWD == NULL || _sampler.isSampled( *newWD );
+      bool contextSwitch = _instrumentationContext.isContextSwitchEnabled();
+      if ( oldWD != NULL ) {
+         if ( numOldEvents != 0 ) filterEventList ( numOldEvents, &e[0], oldSampled, old_icd );
+         if ( !contextSwitch ) addSuspendTask( *oldWD, last );
+      }
+      currentTaskSampled = newSampled;
+      if ( newWD != NULL ) {
+         if ( !contextSwitch ) addResumeTask( *newWD );
+         if ( numNewEvents != 0 ) filterEventList ( numNewEvents, &e[numOldEvents], newSampled, new_icd );
+      }
+   } else if ( _instrumentationContext.isContextSwitchEnabled() ) {
       if ( numEvents != 0 ) addEventList ( numEvents, &e[0] );
    } else {
       if ( oldWD != NULL) {
@@ -387,6 +387,10 @@ inline long long Instrumentation::Event::getId( void ) const { return _ptpId; }
 
 inline unsigned int Instrumentation::Event::getPartner( void ) const { return _partner; }
 
+inline Instrumentation::Event::Sampling Instrumentation::Event::getSampling( void ) const { return _sampling; }
+
+inline void Instrumentation::Event::setSampling( Sampling sampling ) { _sampling = sampling; }
+
 inline bool Instrumentation::isStateEnabled() const { return _emitStateEvents; }
 inline bool Instrumentation::isPtPEnabled() const { return _emitPtPEvents; }
 inline bool Instrumentation::isInternalsEnabled() const { return _emitInternalEvents; }
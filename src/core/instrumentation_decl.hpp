@@ -211,6 +211,7 @@
 #include "workdescriptor_fwd.hpp"
 #include "allocator_decl.hpp"
 #include "basethread_fwd.hpp"
+#include "instrumentationsampler_decl.hpp"
 
 
 #define NANOX_INSTRUMENTATION_PARTNER_MYSELF 0xFFFFFFFF
@@ -674,6 +675,8 @@ namespace nanos {
             /* 70 */ registerEventKey("network-transfer", "Network transfer to node ", false, EVENT_ADVANCED);
             /* 71 */ registerEventKey("cache-evict", "Cache eviction", false, EVENT_ADVANCED);
             /* 72 */ registerEventKey("copy-data-alloc","Cache allocation", false, EVENT_ADVANCED);
+            /* 73 */ registerEventKey("lock-contended","Number of contended lock acquires", true, EVENT_DEVELOPER );
+            /* 74 */ registerEventKey("lock-spins","Number of pauses waiting for a lock", true, EVENT_DEVELOPER );
 
             /* ** */ registerEventKey("debug","Debug Key", true, EVENT_ADVANCED ); /* Keep this key as the last one */
          }
@@ -806,6 +809,9 @@ namespace nanos {
    {
       public:
          class Event {
+            public:
+               /*! \brief Whether the burst an event belongs to is recorded (see InstrumentationSampler) */
+               enum Sampling { SAMPLING_UNDECIDED, SAMPLING_RECORDED, SAMPLING_DROPPED };
             private:
                nanos_event_type_t          _type;         /**< Event type */
                nanos_event_key_t           _key;          /**< Event key */
@@ -813,6 +819,7 @@ namespace nanos {
                nanos_event_domain_t        _ptpDomain;    /**< A specific domain in which ptpId is unique */
                nanos_event_id_t            _ptpId;        /**< PtP event id */
                unsigned int                _partner;      /**< PtP communication partner (destination or origin), only applies to Cluster (is always 0 in smp) */
+               Sampling                    _sampling;     /**< Sampling decision, copied to every event of the same burst */
 
 
             public:
@@ -821,7 +828,8 @@ namespace nanos {
                 *  \see State Burst Point PtP
                 */
                Event () : _type((nanos_event_type_t) 0), _key(0), _value(0),
-                          _ptpDomain((nanos_event_domain_t) 0), _ptpId(0), _partner( NANOX_INSTRUMENTATION_PARTNER_MYSELF ) {}
+                          _ptpDomain((nanos_event_domain_t) 0), _ptpId(0), _partner( NANOX_INSTRUMENTATION_PARTNER_MYSELF ),
+                          _sampling( SAMPLING_UNDECIDED ) {}
                /*! \brief Event constructor
                 *
                 *  Generic constructor used by all other specific constructors
@@ -831,7 +839,7 @@ namespace nanos {
                Event ( nanos_event_type_t type, nanos_event_key_t key, nanos_event_value_t value,
                        nanos_event_domain_t ptp_domain, nanos_event_id_t ptp_id, unsigned int partner = NANOX_INSTRUMENTATION_PARTNER_MYSELF ) :
                      _type (type), _key(key), _value (value),
-                     _ptpDomain (ptp_domain), _ptpId (ptp_id), _partner(partner)
+                     _ptpDomain (ptp_domain), _ptpId (ptp_id), _partner(partner), _sampling( SAMPLING_UNDECIDED )
                { }
 
                /*! \brief Event copy constructor
@@ -844,6 +852,7 @@ namespace nanos {
                   _ptpDomain = evt._ptpDomain;
                   _ptpId     = evt._ptpId;
                   _partner   = evt._partner;
+                  _sampling  = evt._sampling;
 
                }
 
@@ -860,6 +869,7 @@ namespace nanos {
                   _ptpDomain = evt._ptpDomain;
                   _ptpId     = evt._ptpId;
                   _partner   = evt._partner;
+                  _sampling  = evt._sampling;
 
                }
 
@@ -898,6 +908,14 @@ namespace nanos {
                 */
                unsigned int getPartner( void ) const;
 
+               /*! \brief Get the sampling decision of the burst this event belongs to
+                */
+               Sampling getSampling ( void ) const;
+
+               /*! \brief Set the sampling decision of the burst this event belongs to
+                */
+               void setSampling ( Sampling sampling );
+
                /*! \brief Change event type to the complementary value (i.e. if type is BURST_START it changes to BURST_END)
                 */
                void reverseType ( );
@@ -983,6 +1001,7 @@ namespace nanos {
          bool                           _emitPtPEvents;
          bool                           _emitInternalEvents;
       private:
+         InstrumentationSampler         _sampler; /**< Sampling and rate limits of the events raised through this class */
          /*! \brief Instrumentation default constructor (private)
           */
          Instrumentation();
@@ -995,7 +1014,7 @@ namespace nanos {
       public:
          /*! \brief Instrumentation constructor
           */
-         Instrumentation( InstrumentationContext &ic ) : _instrumentationDictionary(), _instrumentationContext(ic), _emitStateEvents(true), _emitPtPEvents(true), _emitInternalEvents(false) {}
+         Instrumentation( InstrumentationContext &ic ) : _instrumentationDictionary(), _instrumentationContext(ic), _emitStateEvents(true), _emitPtPEvents(true), _emitInternalEvents(false), _sampler() {}
 
          /*! \brief Instrumentation destructor
           */
@@ -1013,6 +1032,12 @@ namespace nanos {
           */
          void filterEvents(std::string event_default, std::list<std::string> &enable_events, std::list<std::string> &disable_events );
 
+         /*! \brief Sets up task sampling, the full detail window and the per key rate limits
+          *  \see InstrumentationSampler::configure
+          */
+         void setupSampling ( unsigned int taskPeriod, unsigned int windowStart, unsigned int windowLength,
+                              const std::list<std::string> &keyRates );
+
          // low-level instrumentation interface (pure virtual functions)
 
          /*! \brief Pure virtual functions executed at the beginning of instrumentation phase
@@ -1190,6 +1215,16 @@ namespace nanos {
 
          void raiseOpenStateAndBurst ( nanos_event_state_value_t state, nanos_event_key_t key, nanos_event_value_t val );
          void raiseCloseStateAndBurst ( nanos_event_key_t key, nanos_event_value_t value );
+      private:
+         /*! \brief Hands events raised by the current thread to addEventList(), applying the sampler
+          */
+         void emitEventList ( unsigned int count, Event *events );
+
+         /*! \brief Applies the sampler to events of a task (sampled or not) and hands the kept ones to addEventList()
+          *
+          *  icd is the context of the task, where the decisions on its bursts are kept (NULL if none)
+          */
+         void filterEventList ( unsigned int count, Event *events, bool taskSampled, InstrumentationContextData *icd );
 #endif
    };
 
@@ -84,6 +84,23 @@ void InstrumentationContextStackedStatesAndBursts::insertBurst ( Instrumentation
 void InstrumentationContextDisabled::insertBurst ( InstrumentationContextData *icd, const Event &e ) { }
 
 
+bool InstrumentationContext::setBurstSampling ( InstrumentationContextData *icd, const Event &e, Event::Sampling sampling )
+{
+   InstrumentationContextData::EventList *lists[2] = { &icd->_burstList, &icd->_burstBackup };
+
+   for ( int l = 0; l < 2; l++ ) {
+      InstrumentationContextData::EventList::iterator it;
+      for ( it = lists[l]->begin(); it != lists[l]->end(); it++ ) {
+         if ( it->getKey() == e.getKey() && it->getValue() == e.getValue() &&
+              it->getSampling() == Event::SAMPLING_UNDECIDED ) {
+            it->setSampling( sampling );
+            return true;
+         }
+      }
+   }
+   return false;
+}
+
 /* InstrumentationContext is default implementation: removeBurst */
 void InstrumentationContext::removeBurst ( InstrumentationContextData *icd, InstrumentationContextData::BurstIterator it )
 {
@@ -68,6 +68,12 @@ inline void InstrumentationContext::clearDeferredEvents ( InstrumentationContext
    icd->_deferredEvents.clear();
 }
 
+inline InstrumentationSampler::OpenBursts & InstrumentationContext::getOpenBursts ( InstrumentationContextData *icd )
+{
+   if ( icd->_openBursts == NULL ) icd->_openBursts = NEW InstrumentationSampler::OpenBursts();
+   return *icd->_openBursts;
+}
+
 inline size_t InstrumentationContext::getNumDeferredEvents( InstrumentationContextData *icd ) const
 {
    return icd->_deferredEvents.size();
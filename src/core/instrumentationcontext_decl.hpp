@@ -53,6 +53,7 @@ namespace nanos {
          EventList                  _burstBackup;            /**< Backup list (non-active) of opened bursts */
          EventList                  _deferredEvents;         /**< List of deferred events */
          Lock                       _deferredEventsLock;     /**< Lock in deferred event list */
+         InstrumentationSampler::OpenBursts *_openBursts;    /**< Sampling decisions of open bursts not kept in _burstList (created on first use) */
       private:
          /*! \brief InstrumentationContextData copy assignment operator (private)
           */
@@ -61,18 +62,18 @@ namespace nanos {
          /*! \brief InstrumentationContextData copy constructor
           */
          explicit InstrumentationContextData(const InstrumentationContextData &icd) : _startingWD(false), _stateStack(),
-                  _stateEventEnabled(icd._stateEventEnabled), _burstList(), _burstBackup(), _deferredEvents(), _deferredEventsLock() {}
+                  _stateEventEnabled(icd._stateEventEnabled), _burstList(), _burstBackup(), _deferredEvents(), _deferredEventsLock(), _openBursts( NULL ) {}
          /*! \brief InstrumentationContextData copy constructor
           */
          explicit InstrumentationContextData(const InstrumentationContextData *icd) : _startingWD(false), _stateStack(),
-                  _stateEventEnabled(icd->_stateEventEnabled), _burstList(), _burstBackup(), _deferredEvents(), _deferredEventsLock() {}
+                  _stateEventEnabled(icd->_stateEventEnabled), _burstList(), _burstBackup(), _deferredEvents(), _deferredEventsLock(), _openBursts( NULL ) {}
          /*! \brief InstrumentationContextData default constructor
           */
          InstrumentationContextData() : _startingWD(false), _stateStack(),
-                   _stateEventEnabled(true), _burstList(), _burstBackup(), _deferredEvents(), _deferredEventsLock() { }
+                   _stateEventEnabled(true), _burstList(), _burstBackup(), _deferredEvents(), _deferredEventsLock(), _openBursts( NULL ) { }
          /*! \brief InstrumentationContextData destructor
           */
-         ~InstrumentationContextData() {}
+         ~InstrumentationContextData() { delete _openBursts; }
          /*! \brief Sets _startingWD attribute
           */
          void setStartingWD ( bool value ) { _startingWD = value; }
@@ -181,6 +182,14 @@ namespace nanos {
          /*! \brief Look for a specific event given its key value
           */
          bool findBurstByKey ( InstrumentationContextData *icd, nanos_event_key_t key, InstrumentationContextData::BurstIterator &ret );
+         /*! \brief Sets the sampling decision of the kept burst e is a copy of
+          *
+          *  \return false if the burst is not kept (e.g. the context is disabled)
+          */
+         bool setBurstSampling ( InstrumentationContextData *icd, const Event &e, Event::Sampling sampling );
+         /*! \brief Gets the sampling decisions of the open bursts which are not kept
+          */
+         InstrumentationSampler::OpenBursts & getOpenBursts ( InstrumentationContextData *icd );
          /*! \brief Get the number of bursts in the main list
           */
          virtual size_t getNumBursts( InstrumentationContextData *icd ) const ; 
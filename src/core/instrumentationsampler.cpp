@@ -0,0 +1,130 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+#include "instrumentationsampler_decl.hpp"
+#include "instrumentation.hpp"
+#include "workdescriptor.hpp"
+#include "atomic.hpp"
+#include "debug.hpp"
+#include <stdlib.h>
+#include <time.h>
+
+using namespace nanos;
+
+InstrumentationSampler::~InstrumentationSampler ()
+{
+   for ( KeyRates::iterator it = _keyRates.begin(); it != _keyRates.end(); it++ ) delete *it;
+}
+
+void InstrumentationSampler::configure ( InstrumentationDictionary &dictionary, unsigned int taskPeriod, unsigned int windowStart,
+                                         unsigned int windowLength, const std::list<std::string> &keyRates )
+{
+   _taskPeriod = taskPeriod > 1 ? taskPeriod : 1;
+
+   if ( windowLength != 0 ) {
+      unsigned long long now = getTime();
+      _windowStart = now + (unsigned long long) windowStart * 1000000ULL;
+      _windowEnd = _windowStart + (unsigned long long) windowLength * 1000000ULL;
+   }
+
+   for ( std::list<std::string>::const_iterator it = keyRates.begin(); it != keyRates.end(); it++ ) {
+      // key:events-per-second[:burst]
+      size_t sep = it->find( ':' );
+      if ( sep == std::string::npos ) {
+         warning0( "Ignoring instrumentation rate '" << *it << "', expected key:events-per-second[:burst]" );
+         continue;
+      }
+      std::string key = it->substr( 0, sep );
+      char *end;
+      unsigned long rate = strtoul( it->c_str() + sep + 1, &end, 10 );
+      unsigned long burst = rate;
+      if ( *end == ':' ) burst = strtoul( end + 1, &end, 10 );
+      if ( rate == 0 || burst == 0 || *end != '\0' ) {
+         warning0( "Ignoring instrumentation rate '" << *it << "', expected key:events-per-second[:burst]" );
+         continue;
+      }
+
+      nanos_event_key_t id = dictionary.getEventKey( key );
+      if ( id == 0 ) {
+         warning0( "Ignoring instrumentation rate of '" << key << "', the key is unknown or disabled" );
+         continue;
+      }
+
+      if ( _keyRates.size() <= id ) _keyRates.resize( id + 1, NULL );
+      unsigned long long interval = 1000000000ULL / rate;
+      if ( interval == 0 ) interval = 1;
+      delete _keyRates[id];
+      _keyRates[id] = NEW KeyRate( interval, interval * ( burst - 1 ) );
+   }
+
+   _dependenceKey = dictionary.getEventKey( "dependence" );
+   _depDirectionKey = dictionary.getEventKey( "dep-direction" );
+
+   _active = _taskPeriod > 1 || !_keyRates.empty();
+}
+
+unsigned long long InstrumentationSampler::getTime ()
+{
+   struct timespec ts;
+   clock_gettime( CLOCK_MONOTONIC, &ts );
+   return (unsigned long long) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+bool InstrumentationSampler::isSampled ( int64_t id ) const
+{
+   if ( _taskPeriod <= 1 ) return true;
+   unsigned long long h = (unsigned long long) id * 0x9E3779B97F4A7C15ULL;
+   return ( h >> 32 ) % _taskPeriod == 0;
+}
+
+bool InstrumentationSampler::isSampled ( WorkDescriptor &wd ) const
+{
+   if ( _taskPeriod <= 1 || wd.isImplicit() || wd.getParent() == NULL ) return true;
+   return isSampled( (int64_t) wd.getId() );
+}
+
+void InstrumentationSampler::OpenBursts::open ( nanos_event_key_t key, bool recorded )
+{
+   if ( _recorded.size() <= key ) _recorded.resize( key + 1 );
+   _recorded[key].push_back( recorded );
+}
+
+bool InstrumentationSampler::OpenBursts::close ( nanos_event_key_t key, bool unknown )
+{
+   if ( key >= _recorded.size() || _recorded[key].empty() ) return unknown;
+   bool recorded = _recorded[key].back();
+   _recorded[key].pop_back();
+   return recorded;
+}
+
+bool InstrumentationSampler::takeToken ( nanos_event_key_t key, unsigned long long time )
+{
+   if ( key >= _keyRates.size() || _keyRates[key] == NULL ) return true;
+
+   KeyRate &rate = *_keyRates[key];
+   unsigned long long next, updated;
+   do {
+      next = rate._nextTime.value();
+      unsigned long long base = next > time ? next : time;
+      if ( base - time > rate._tolerance ) return false;
+      updated = base + rate._interval;
+   } while ( !compareAndSwap( &rate._nextTime.override(), next, updated ) );
+
+   return true;
+}
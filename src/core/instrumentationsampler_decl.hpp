@@ -0,0 +1,140 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+#ifndef __NANOS_INSTRUMENTATION_SAMPLER_DECL_H
+#define __NANOS_INSTRUMENTATION_SAMPLER_DECL_H
+
+#include <list>
+#include <string>
+#include <vector>
+#include "nanos-int.h"
+#include "atomic_decl.hpp"
+#include "workdescriptor_fwd.hpp"
+
+namespace nanos {
+
+   class InstrumentationDictionary;
+
+/*!\class InstrumentationSampler
+ * \brief Decides which of the events raised through Instrumentation reach the plugin
+ *
+ * Three independent mechanisms, all of them disabled by default:
+ *  - Task sampling: only the lifecycle events (context switches, deferred events, dependences) of
+ *    one in N tasks are recorded. Implicit tasks and tasks without a parent are always recorded.
+ *  - Full detail window: during [start, start + length) milliseconds after the runtime start up,
+ *    neither task sampling nor rate limits are applied.
+ *  - Rate limits: a token bucket per key bounds the number of point and burst start events of that
+ *    key per second.
+ *
+ * Whole bursts are recorded or dropped: the decision taken on the first start of a burst is kept with
+ * the burst in the instrumentation context of its task, so its end and the copies regenerated on
+ * context switches follow it. Contexts which do not keep bursts use OpenBursts instead. Thus the
+ * trace has no burst ends without a start, whichever mechanism dropped the start.
+ */
+   class InstrumentationSampler
+   {
+      public:
+         /*! \brief Whether the start of each open burst of a task was recorded
+          *
+          *  Used when the instrumentation context does not keep the bursts. Then bursts of a key are
+          *  nested in a task, so an end always closes the innermost open burst.
+          */
+         class OpenBursts {
+            private:
+               std::vector< std::vector<bool> > _recorded;   /**< Indexed by key, innermost burst last */
+            public:
+               OpenBursts () : _recorded() {}
+
+               /*! \brief Registers the start of a burst of key */
+               void open ( nanos_event_key_t key, bool recorded );
+
+               /*! \brief Closes the innermost burst of key
+                *
+                *  \return whether its start was recorded, or unknown if no burst of key is open
+                */
+               bool close ( nanos_event_key_t key, bool unknown );
+         };
+
+      private:
+         /*! \brief Token bucket of a key, implemented as a generic cell rate algorithm */
+         struct KeyRate {
+            Atomic<unsigned long long>   _nextTime;     /**< Theoretical arrival time of the next event (ns) */
+            unsigned long long           _interval;     /**< Nanoseconds between events at the sustained rate */
+            unsigned long long           _tolerance;    /**< How early an event may arrive (burst size) */
+            KeyRate ( unsigned long long interval, unsigned long long tolerance ) : _nextTime( 0 ), _interval( interval ),
+                                                                                    _tolerance( tolerance ) {}
+         };
+         typedef std::vector<KeyRate *> KeyRates;
+
+         bool                 _active;          /**< Some mechanism is enabled */
+         unsigned int         _taskPeriod;      /**< Record one in _taskPeriod tasks */
+         unsigned long long   _windowStart;     /**< Full detail window (ns of the monotonic clock) */
+         unsigned long long   _windowEnd;
+         KeyRates             _keyRates;        /**< Indexed by key, NULL if the key is not limited */
+         nanos_event_key_t    _dependenceKey;
+         nanos_event_key_t    _depDirectionKey;
+
+      private:
+         /*! \brief InstrumentationSampler copy constructor (private) */
+         InstrumentationSampler ( const InstrumentationSampler & );
+         /*! \brief InstrumentationSampler copy assignment operator (private) */
+         const InstrumentationSampler & operator= ( const InstrumentationSampler & );
+      public:
+         /*! \brief InstrumentationSampler default constructor (everything recorded) */
+         InstrumentationSampler () : _active( false ), _taskPeriod( 1 ), _windowStart( 0 ), _windowEnd( 0 ), _keyRates(),
+                                     _dependenceKey( 0 ), _depDirectionKey( 0 ) {}
+         /*! \brief InstrumentationSampler destructor */
+         ~InstrumentationSampler ();
+
+         /*! \brief Sets up the sampler
+          *
+          *  \param dictionary resolves the keys named in keyRates
+          *  \param taskPeriod records one in taskPeriod tasks (0 or 1 record all of them)
+          *  \param windowStart, windowLength full detail window, in ms since now (no window if length is 0)
+          *  \param keyRates list of "key:events-per-second[:burst]" (burst defaults to one second of events)
+          */
+         void configure ( InstrumentationDictionary &dictionary, unsigned int taskPeriod, unsigned int windowStart,
+                          unsigned int windowLength, const std::list<std::string> &keyRates );
+
+         bool isActive () const { return _active; }
+         bool hasTaskSampling () const { return _taskPeriod > 1; }
+         bool hasKeyRates () const { return !_keyRates.empty(); }
+
+         nanos_event_key_t getDependenceKey () const { return _dependenceKey; }
+         nanos_event_key_t getDepDirectionKey () const { return _depDirectionKey; }
+
+         /*! \brief Current time (ns of the monotonic clock) */
+         static unsigned long long getTime ();
+
+         /*! \brief Whether time is inside the full detail window */
+         bool inWindow ( unsigned long long time ) const { return time >= _windowStart && time < _windowEnd; }
+
+         /*! \brief Whether the task with the given id is sampled (hashed, so that regular task patterns do not alias) */
+         bool isSampled ( int64_t id ) const;
+
+         /*! \brief Whether the lifecycle of wd is sampled */
+         bool isSampled ( WorkDescriptor &wd ) const;
+
+         /*! \brief Consumes a token of key, returns false if the event must be dropped */
+         bool takeToken ( nanos_event_key_t key, unsigned long long time );
+   };
+
+} // namespace nanos
+
+#endif
@@ -0,0 +1,167 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+#ifndef NANOS_LOCATIONSET_HPP
+#define NANOS_LOCATIONSET_HPP
+
+#include "locationset_decl.hpp"
+#include "new_decl.hpp"
+
+namespace nanos {
+
+inline LocationSet::const_iterator::const_iterator( uint64_t bits, OtherLocations const &others, bool atEnd ) :
+   _bits( atEnd ? 0 : bits ), _other( atEnd ? others.end() : others.begin() ), _otherEnd( others.end() ), _current( 0 ) {
+   settle();
+}
+
+inline void LocationSet::const_iterator::settle() {
+   if ( _bits != 0 ) {
+      _current = (memory_space_id_t) __builtin_ctzll( _bits );
+   } else if ( _other != _otherEnd ) {
+      _current = *_other;
+   }
+}
+
+inline memory_space_id_t const &LocationSet::const_iterator::operator*() const {
+   return _current;
+}
+
+inline memory_space_id_t const *LocationSet::const_iterator::operator->() const {
+   return &_current;
+}
+
+inline LocationSet::const_iterator &LocationSet::const_iterator::operator++() {
+   if ( _bits != 0 ) {
+      _bits &= _bits - 1;
+   } else {
+      ++_other;
+   }
+   settle();
+   return *this;
+}
+
+inline LocationSet::const_iterator LocationSet::const_iterator::operator++( int ) {
+   const_iterator it( *this );
+   ++( *this );
+   return it;
+}
+
+inline bool LocationSet::const_iterator::operator==( const_iterator const &it ) const {
+   return _bits == it._bits && _other == it._other;
+}
+
+inline bool LocationSet::const_iterator::operator!=( const_iterator const &it ) const {
+   return !( *this == it );
+}
+
+inline LocationSet::OtherLocations const &LocationSet::noOthers() {
+   static OtherLocations const none;
+   return none;
+}
+
+inline uint64_t LocationSet::bit( memory_space_id_t loc ) {
+   return ( (uint64_t) 1 ) << loc;
+}
+
+inline LocationSet::LocationSet() : _mask( 0 ), _others( NULL ) {
+}
+
+inline LocationSet::LocationSet( LocationSet const &ls ) : _mask( ls._mask ),
+   _others( ls._others != NULL ? NEW OtherLocations( *ls._others ) : NULL ) {
+}
+
+inline LocationSet::~LocationSet() {
+   delete _others;
+}
+
+inline LocationSet &LocationSet::operator=( LocationSet const &ls ) {
+   if ( this != &ls ) {
+      _mask = ls._mask;
+      if ( ls._others != NULL ) {
+         if ( _others == NULL ) _others = NEW OtherLocations( *ls._others );
+         else *_others = *ls._others;
+      } else if ( _others != NULL ) {
+         _others->clear();
+      }
+   }
+   return *this;
+}
+
+inline void LocationSet::insert( memory_space_id_t loc ) {
+   if ( loc < MaskWidth ) {
+      _mask = _mask | bit( loc );
+   } else {
+      if ( _others == NULL ) _others = NEW OtherLocations();
+      _others->insert( loc );
+   }
+}
+
+inline void LocationSet::erase( memory_space_id_t loc ) {
+   if ( loc < MaskWidth ) {
+      _mask = _mask & ~bit( loc );
+   } else if ( _others != NULL ) {
+      _others->erase( loc );
+   }
+}
+
+inline void LocationSet::clear() {
+   _mask = 0;
+   if ( _others != NULL ) _others->clear();
+}
+
+inline std::size_t LocationSet::count( memory_space_id_t loc ) const {
+   if ( loc < MaskWidth ) {
+      return ( _mask & bit( loc ) ) != 0 ? 1 : 0;
+   }
+   return _others != NULL ? _others->count( loc ) : 0;
+}
+
+inline std::size_t LocationSet::size() const {
+   return __builtin_popcountll( _mask ) + ( _others != NULL ? _others->size() : 0 );
+}
+
+inline bool LocationSet::empty() const {
+   return _mask == 0 && ( _others == NULL || _others->empty() );
+}
+
+inline LocationSet::const_iterator LocationSet::begin() const {
+   return const_iterator( _mask, _others != NULL ? *_others : noOthers(), false );
+}
+
+inline LocationSet::const_iterator LocationSet::end() const {
+   return const_iterator( _mask, _others != NULL ? *_others : noOthers(), true );
+}
+
+inline memory_space_id_t LocationSet::first() const {
+   uint64_t mask = _mask;
+   if ( mask != 0 ) return (memory_space_id_t) __builtin_ctzll( mask );
+   return ( _others != NULL && !_others->empty() ) ? *_others->begin() : 0;
+}
+
+inline uint64_t LocationSet::getMask() const {
+   return _mask;
+}
+
+inline bool LocationSet::hasOthers() const {
+   return _others != NULL;
+}
+
+} // namespace nanos
+
+#endif /* NANOS_LOCATIONSET_HPP */
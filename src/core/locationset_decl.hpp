@@ -0,0 +1,92 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+#ifndef NANOS_LOCATIONSET_DECL_HPP
+#define NANOS_LOCATIONSET_DECL_HPP
+
+#include <set>
+#include <iterator>
+#include <stdint.h>
+#include "nanos-int.h"
+
+namespace nanos {
+
+/*! \class LocationSet
+ *  \brief Set of memory spaces, stored as a bitmask
+ *
+ *  Memory spaces below MaskWidth (all of them, unless there are a lot of nodes or devices) are
+ *  bits of a single word, which can be queried without locking while another thread modifies
+ *  the set. Larger ids go to a std::set, allocated on demand, which must be protected by the
+ *  owner of the LocationSet. Iteration is in increasing id order, as with a std::set.
+ */
+class LocationSet {
+   public:
+      static const memory_space_id_t MaskWidth = 64;
+      typedef std::set< memory_space_id_t > OtherLocations;
+
+      class const_iterator : public std::iterator< std::forward_iterator_tag, memory_space_id_t, std::ptrdiff_t,
+         memory_space_id_t const *, memory_space_id_t const & > {
+         uint64_t                         _bits;     /**< Bits of the mask not visited yet */
+         OtherLocations::const_iterator   _other;
+         OtherLocations::const_iterator   _otherEnd;
+         memory_space_id_t                _current;
+
+         void settle();
+         public:
+         const_iterator( uint64_t bits, OtherLocations const &others, bool atEnd );
+         memory_space_id_t const &operator*() const;
+         memory_space_id_t const *operator->() const;
+         const_iterator &operator++();
+         const_iterator operator++( int );
+         bool operator==( const_iterator const &it ) const;
+         bool operator!=( const_iterator const &it ) const;
+      };
+
+   private:
+      volatile uint64_t  _mask;
+      OtherLocations    *_others;
+
+      static OtherLocations const &noOthers();
+   public:
+      LocationSet();
+      LocationSet( LocationSet const &ls );
+      ~LocationSet();
+      LocationSet &operator=( LocationSet const &ls );
+
+      void insert( memory_space_id_t loc );
+      void erase( memory_space_id_t loc );
+      void clear();
+      std::size_t count( memory_space_id_t loc ) const;
+      std::size_t size() const;
+      bool empty() const;
+      const_iterator begin() const;
+      const_iterator end() const;
+
+      //! \brief Lowest memory space of the set (0 if empty)
+      memory_space_id_t first() const;
+      //! \brief Memory spaces below MaskWidth, safe to read while the set is modified
+      uint64_t getMask() const;
+      //! \brief Whether a memory space beyond the mask was ever added (queries must then be protected)
+      bool hasOthers() const;
+      static uint64_t bit( memory_space_id_t loc );
+};
+
+} // namespace nanos
+
+#endif /* NANOS_LOCATIONSET_DECL_HPP */
@@ -152,6 +152,15 @@ typedef struct {
    void *deducted_cd;
 } nanos_copy_data_internal_t;
 
+/* Moves a range of the data used when a task graph was recorded
+ * to the data used by one of its replays
+ */
+typedef struct {
+   void *original;
+   void *replacement;
+   size_t size;
+} nanos_tdg_rebind_t;
+
 typedef nanos_access_type_internal_t nanos_access_type_t;
 typedef nanos_region_dimension_internal_t nanos_region_dimension_t;
 
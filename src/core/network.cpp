@@ -45,7 +45,7 @@ Atomic<uint64_t> Network::_nodeRCAaddrOther;
 
 Network::Network () : _numNodes(1), _api((NetworkAPI *) 0), _nodeNum(0),
    _masterHostname(NULL), _checkForDataInOtherAddressSpaces(false),
-   _putRequestSequence(NULL), _recvWdData(), _sentWdData(), _deferredWorkReqs(),
+   _putRequestSequence(NULL), _packer(), _recvWdData(), _sentWdData(), _deferredWorkReqs(),
    _deferredWorkReqsLock(), _recvSeqN(0), _waitingPutRequestsLock(),
    _waitingPutRequests(), _receivedUnmatchedPutRequests(),
    _delayedBySeqNumberPutReqs(), _delayedBySeqNumberPutReqsLock(),
@@ -469,6 +469,11 @@ SimpleAllocator *Network::getPackerAllocator() const
    //std::cerr <<" PACK SEGMENT IS " << res << std::endl;
    return res;
 }
+
+Packer &Network::getPacker()
+{
+   return _packer;
+}
 std::size_t Network::getMaxGetStridedLen() const {
    std::size_t result = 0;
    if ( _api != NULL ) {
@@ -739,7 +744,14 @@ SendDataRequest::SendDataRequest( NetworkAPI *api, unsigned int issueNode, unsig
 SendDataRequest::~SendDataRequest() {
 }
 
-void SendDataRequest::doSend() {
+bool SendDataRequest::doSend() {
+   char *localPack = NULL;
+   if ( _ld != 0 ) {
+      /* packs cached by the Packer would not be given back to a direct allocation of the segment */
+      //NANOS_INSTRUMENT( InstrumentState inst2(NANOS_STRIDED_COPY_PACK); );
+      localPack = ( char * ) sys.getNetwork()->getPacker().give_pack( ( uint64_t ) _origAddr, _len, _count );
+      if ( localPack == NULL ) return false;
+   }
    if ( sys.getNetwork()->doIHaveToCheckForDataInOtherAddressSpaces() ) {
       sys.getNetwork()->getDataFromDevice( (uint64_t) _origAddr, _len, _count, _ld, _hostObject, _hostRegId );
    }
@@ -749,25 +761,12 @@ void SendDataRequest::doSend() {
       doSingleChunk();
       //NANOS_INSTRUMENT( sys.getInstrumentation()->raiseCloseStateAndBurst( key ) );
    } else {
-      char *localPack, *origAddrPtr = (char*) _origAddr;
-
-      //NANOS_INSTRUMENT( InstrumentState inst2(NANOS_STRIDED_COPY_PACK); );
-      _api->getPackSegment()->lock();
-      localPack = ( char * ) _api->getPackSegment()->allocate( _len * _count );
-      if ( localPack == NULL ) { fprintf(stderr, "ERROR!!! could not get an addr to pack strided data\n" ); }
-      _api->getPackSegment()->unlock();
-
-      for ( unsigned int i = 0; i < _count; i += 1 ) {
-         memcpy( &localPack[ i * _len ], &origAddrPtr[ i * _ld ], _len );
-      }
-      //NANOS_INSTRUMENT( inst2.close(); );
-
+      /* doStrided gathers the data into localPack */
       doStrided( localPack );
 
-      _api->getPackSegment()->lock();
-      _api->getPackSegment()->free( localPack );
-      _api->getPackSegment()->unlock();
+      sys.getNetwork()->getPacker().free_pack( ( uint64_t ) _origAddr, _len, _count, localPack );
    }
+   return true;
 }
 void *SendDataRequest::getOrigAddr() const {
    return _origAddr;
@@ -919,9 +918,7 @@ GetRequestStrided::~GetRequestStrided() {
 
 void GetRequestStrided::clear() {
    //NANOS_INSTRUMENT( InstrumentState inst2(NANOS_STRIDED_COPY_UNPACK); );
-   for ( unsigned int j = 0; j < _count; j += 1 ) {
-      ::memcpy( &_hostAddr[ j  * _ld ], &_recvAddr[ j * _size ], _size );
-   }
+   Packer::unpack( _hostAddr, _recvAddr, _size, _count, _ld );
    if ( VERBOSE_COMPLETION ) {
       (*myThread->_file) << std::setprecision(std::numeric_limits<double>::digits10) << OS::getMonotonicTime() << " Completed copyOutStrided request, hostAddr="<< (void*)_hostAddr <<" ["<< *((double*) _hostAddr) <<"] ops=" << (void *) _ops << std::endl;
    }
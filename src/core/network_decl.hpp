@@ -53,7 +53,8 @@ namespace nanos {
       public:
          SendDataRequest( NetworkAPI *api, unsigned int issueNode, unsigned int seqNumber, void *origAddr, void *destAddr, std::size_t len, std::size_t count, std::size_t ld, unsigned int dst, unsigned int wdId, void *hostObject, reg_t hostRegId, unsigned int metaSeq );
          virtual ~SendDataRequest();
-         void doSend();
+         //! \brief Sends the data, returns false if there was no pack buffer and it has to be retried
+         bool doSend();
          void *getOrigAddr() const;
          unsigned int getDestination() const;
          unsigned int getIssueNode() const;
@@ -140,6 +141,7 @@ namespace nanos {
          char * _masterHostname;
          bool _checkForDataInOtherAddressSpaces;
          Atomic<unsigned int> *_putRequestSequence;
+         Packer _packer; //!< Pack buffers for strided transfers, shared by all the users of the pack segment
 
          class ReceivedWDData {
             private:
@@ -301,6 +303,7 @@ namespace nanos {
          bool doIHaveToCheckForDataInOtherAddressSpaces() const;
 
          SimpleAllocator *getPackerAllocator() const;
+         Packer &getPacker();
          std::size_t getMaxGetStridedLen() const;
 
          void *allocateReceiveMemory( std::size_t len );
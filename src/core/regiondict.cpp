@@ -32,24 +32,21 @@ reg_t RegionNode::addNode( nanos_region_dimension_internal_t const *dimensions,
    bool lastNode = ( deep == ( 2 * numDimensions - 1 ) );
    std::size_t value = ( ( deep & 1 ) == 0 ) ? dimensions[ (deep >> 1) ].lower_bound : dimensions[ (deep >> 1) ].accessed_length;
    //std::cerr << "this node value is "<< _value << " gonna add value " << value << " this deep " << deep<< std::endl;
-   if ( !_sons ) {
-      _sons = new std::map<std::size_t, RegionNode *>();
-   }
-
-   std::map<std::size_t, RegionNode *>::iterator it = _sons->lower_bound( value );
-   bool haveToInsert = ( it == _sons->end() || _sons->key_comp()(value, it->first) );
-   reg_t newId = ( lastNode && haveToInsert ) ? container.getNewRegionId() : 0;
+   RegionNode *son = findSon( value );
    reg_t retId = 0;
 
-   if ( haveToInsert ) {
-      it = _sons->insert( it, std::map<std::size_t, RegionNode *>::value_type( value, NEW RegionNode( this, value, newId ) ) );
-      if ( lastNode ) container.addRegionNode( it->second );
+   if ( son == NULL ) {
+      reg_t newId = lastNode ? container.getNewRegionId() : 0;
+      son = NEW RegionNode( this, value, newId );
+      // register the leaf before publishing it, lock-free lookups may find it right away
+      if ( lastNode ) container.addRegionNode( son );
+      insertSon( value, son );
    }
 
    if ( lastNode ) {
-      retId = it->second->getId();
+      retId = son->getId();
    } else {
-      retId = it->second->addNode( dimensions, numDimensions, deep + 1, container );
+      retId = son->addNode( dimensions, numDimensions, deep + 1, container );
    }
    return retId;
 }
@@ -58,22 +55,17 @@ reg_t RegionNode::checkNode( nanos_region_dimension_internal_t const *dimensions
    bool lastNode = ( deep == ( 2 * numDimensions - 1 ) );
    std::size_t value = ( ( deep & 1 ) == 0 ) ? dimensions[ (deep >> 1) ].lower_bound : dimensions[ (deep >> 1) ].accessed_length;
    //std::cerr << "this node value is "<< _value << " gonna add value " << value << " this deep " << deep<< std::endl;
-   if ( !_sons ) {
-      return 0;
-   }
-
-   std::map<std::size_t, RegionNode *>::iterator it = _sons->lower_bound( value );
-   bool haveToInsert = ( it == _sons->end() || _sons->key_comp()(value, it->first) );
+   RegionNode *son = findSon( value );
    reg_t retId = 0;
 
-   if ( haveToInsert ) {
+   if ( son == NULL ) {
       return 0;
    }
 
    if ( lastNode ) {
-      retId = it->second->getId();
+      retId = son->getId();
    } else {
-      retId = it->second->checkNode( dimensions, numDimensions, deep + 1 );
+      retId = son->checkNode( dimensions, numDimensions, deep + 1 );
    }
    return retId;
 }
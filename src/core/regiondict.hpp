@@ -61,7 +61,8 @@ inline Version *RegionVectorEntry::getData() const {
    return _data;
 }
 
-inline RegionNode::RegionNode( RegionNode *parent, std::size_t value, reg_t id ) : _parent( parent ), _value( value ), _id( id ), _sons( NULL ) {
+inline RegionNode::RegionNode( RegionNode *parent, std::size_t value, reg_t id ) : _parent( parent ), _value( value ), _id( id ), _sons( NULL ),
+   _numSons( 0 ), _sonsCapacity( 0 ), _sonsVersion( 0 ), _retiredSons( NULL ) {
    if ( id > 1 ) {
       _memoIntersectInfo = NEW reg_t[ id - 1 ];
       ::memset(_memoIntersectInfo, 0, sizeof( reg_t ) * (id - 1) );
@@ -72,7 +73,8 @@ inline RegionNode::RegionNode( RegionNode *parent, std::size_t value, reg_t id )
 }
 
 inline RegionNode::RegionNode( RegionNode const& rn ) : _parent( rn._parent ),
-   _value( rn._value ), _id( rn._id ), _sons( rn._sons ),
+   _value( rn._value ), _id( rn._id ), _sons( rn._sons ), _numSons( rn._numSons ),
+   _sonsCapacity( rn._sonsCapacity ), _sonsVersion( rn._sonsVersion ), _retiredSons( rn._retiredSons ),
    _memoIntersectInfo( rn._memoIntersectInfo ) {
 }
 
@@ -81,22 +83,83 @@ inline RegionNode &RegionNode::operator=( RegionNode const& rn ) {
    _value = rn._value;
    _id = rn._id;
    _sons = rn._sons;
+   _numSons = rn._numSons;
+   _sonsCapacity = rn._sonsCapacity;
+   _sonsVersion = rn._sonsVersion;
+   _retiredSons = rn._retiredSons;
    _memoIntersectInfo = rn._memoIntersectInfo;
    return *this;
 }
 
 inline RegionNode::~RegionNode() {
-   if ( _sons != NULL ) {
-      for (std::map<std::size_t, RegionNode *>::const_iterator it = _sons->begin();
-            it != _sons->end(); it++ ) {
-         delete it->second;
+   for ( unsigned int idx = 0; idx < _numSons; idx += 1 ) {
+      delete _sons[ idx ]._node;
+   }
+   delete[] _sons;
+   if ( _retiredSons != NULL ) {
+      for ( std::vector< Son * >::const_iterator it = _retiredSons->begin(); it != _retiredSons->end(); it++ ) {
+         delete[] *it;
       }
-      delete _sons;
+      delete _retiredSons;
    }
    delete[] _memoIntersectInfo;
    _memoIntersectInfo = NULL;
 }
 
+inline RegionNode *RegionNode::findSon( std::size_t value ) const {
+   RegionNode *son;
+   unsigned int version;
+   do {
+      while ( ( version = _sonsVersion ) & 1 ) {
+         cpuRelax();
+      }
+      memoryFence();
+      // The count is read before the array: an array is never published with fewer entries than _numSons
+      unsigned int count = _numSons;
+      memoryFence();
+      Son const *sons = _sons;
+      unsigned int lo = 0, hi = count;
+      while ( lo < hi ) {
+         unsigned int mid = ( lo + hi ) >> 1;
+         if ( sons[ mid ]._value < value ) lo = mid + 1;
+         else hi = mid;
+      }
+      son = ( lo < count && sons[ lo ]._value == value ) ? sons[ lo ]._node : NULL;
+      memoryFence();
+   } while ( version != _sonsVersion );
+   return son;
+}
+
+inline void RegionNode::insertSon( std::size_t value, RegionNode *son ) {
+   _sonsVersion = _sonsVersion + 1;
+   memoryFence();
+   if ( _numSons == _sonsCapacity ) {
+      unsigned int capacity = _sonsCapacity == 0 ? 4 : _sonsCapacity * 2;
+      Son *sons = NEW Son[ capacity ];
+      for ( unsigned int idx = 0; idx < _numSons; idx += 1 ) {
+         sons[ idx ] = _sons[ idx ];
+      }
+      if ( _sons != NULL ) {
+         if ( _retiredSons == NULL ) _retiredSons = NEW std::vector< Son * >();
+         _retiredSons->push_back( (Son *) _sons );
+      }
+      _sons = sons;
+      _sonsCapacity = capacity;
+      memoryFence();
+   }
+   unsigned int pos = _numSons;
+   while ( pos > 0 && _sons[ pos - 1 ]._value > value ) {
+      _sons[ pos ] = _sons[ pos - 1 ];
+      pos -= 1;
+   }
+   _sons[ pos ]._value = value;
+   _sons[ pos ]._node = son;
+   memoryFence();
+   _numSons = _numSons + 1;
+   memoryFence();
+   _sonsVersion = _sonsVersion + 1;
+}
+
 inline reg_t RegionNode::getId() const {
    return _id;
 }
@@ -117,9 +180,81 @@ inline RegionNode *RegionNode::getParent() const {
    return _parent;
 }
 
+template <class T>
+typename RegionIdTable< T >::Directory *RegionIdTable< T >::newDirectory( unsigned int size ) {
+   Directory *dir = NEW Directory;
+   dir->_size = size;
+   dir->_chunks = NEW T * volatile[ size ];
+   for ( unsigned int idx = 0; idx < size; idx += 1 ) {
+      dir->_chunks[ idx ] = NULL;
+   }
+   return dir;
+}
+
+template <class T>
+void RegionIdTable< T >::deleteDirectory( Directory *dir ) {
+   delete[] dir->_chunks;
+   delete dir;
+}
+
+template <class T>
+RegionIdTable< T >::RegionIdTable() : _directory( newDirectory( 4 ) ), _retired() {
+}
+
+template <class T>
+RegionIdTable< T >::~RegionIdTable() {
+   Directory *dir = _directory;
+   for ( unsigned int idx = 0; idx < dir->_size; idx += 1 ) {
+      delete[] dir->_chunks[ idx ];
+   }
+   deleteDirectory( dir );
+   for ( typename std::vector< Directory * >::const_iterator it = _retired.begin(); it != _retired.end(); it++ ) {
+      deleteDirectory( *it );
+   }
+}
+
+template <class T>
+void RegionIdTable< T >::grow( reg_t id ) {
+   unsigned int chunk = id / ChunkSize;
+   Directory *dir = _directory;
+   if ( chunk < dir->_size && dir->_chunks[ chunk ] != NULL ) return;
+
+   if ( chunk >= dir->_size ) {
+      unsigned int size = dir->_size * 2;
+      while ( size <= chunk ) size *= 2;
+      Directory *newDir = newDirectory( size );
+      for ( unsigned int idx = 0; idx < dir->_size; idx += 1 ) {
+         newDir->_chunks[ idx ] = dir->_chunks[ idx ];
+      }
+      memoryFence();
+      _directory = newDir;
+      _retired.push_back( dir );
+      dir = newDir;
+   }
+   T *entries = NEW T[ ChunkSize ]();
+   memoryFence();
+   dir->_chunks[ chunk ] = entries;
+}
+
+template <class T>
+T &RegionIdTable< T >::operator[]( reg_t id ) const {
+   return _directory->_chunks[ id / ChunkSize ][ id % ChunkSize ];
+}
+
+template <class T>
+T *RegionIdTable< T >::find( reg_t id ) const {
+   unsigned int chunk = id / ChunkSize;
+   Directory *dir = _directory;
+   if ( chunk < dir->_size ) {
+      T *entries = dir->_chunks[ chunk ];
+      if ( entries != NULL ) return &entries[ id % ChunkSize ];
+   }
+   return NULL;
+}
+
 
 template <class T>
-ContainerDense< T >::ContainerDense( CopyData const &cd ) : _container(64, T())
+ContainerDense< T >::ContainerDense( CopyData const &cd ) : _container()
 	, _leafCount( 0 )
 	, _idSeed( 1 )
 	, _dimensionSizes( cd.getNumDimensions(), 0 )
@@ -130,14 +265,10 @@ ContainerDense< T >::ContainerDense( CopyData const &cd ) : _container(64, T())
 	, _keepAtOrigin( false )
 	, _registeredObject( NULL )
 	, sparse( false ) {
-   //_container.reserve( 64 );
+   _container.grow( 0 );
    for ( unsigned int idx = 0; idx < cd.getNumDimensions(); idx += 1 ) {
       _dimensionSizes[ idx ] = cd.getDimensions()[ idx ].size;
    }
-   if ( pthread_rwlock_init( &_containerLock, NULL ) ) {
-      message0("error initializing containerlock ");
-      fatal("can not continue")
-   }
 }
 
 template <class T>
@@ -146,22 +277,12 @@ ContainerDense< T >::~ContainerDense() {
 
 template <class T>
 RegionNode * ContainerDense< T >::getRegionNode( reg_t id ) {
-   RegionNode *n = NULL;
-   if ( pthread_rwlock_rdlock(&_containerLock) ) {
-      message0("lock error " );
-      fatal("can not continue");
-   }
-   n = _container[ id ].getLeaf();
-   if ( pthread_rwlock_unlock(&_containerLock) ) {
-      message0("lock error " );
-      fatal("can not continue");
-   }
-   return n;
+   return _container[ id ].getLeaf();
 }
 
 template <class T>
 void ContainerDense< T >::addRegionNode( RegionNode *leaf ) {
-   // no locking needed, only called from addRegion -> _root.addNode() -> addRegionNode
+   // only called from addRegion -> _root.addNode() -> addRegionNode, with _containerLock held
    _container[ leaf->getId() ].setLeaf( leaf );
    _container[ leaf->getId() ].setData( NULL );
    _leafCount++;
@@ -169,44 +290,12 @@ void ContainerDense< T >::addRegionNode( RegionNode *leaf ) {
 
 template <class T>
 Version *ContainerDense< T >::getRegionData( reg_t id ) {
-   Version *v = NULL;
-   //_containerLock.acquire();
-   //while ( !_containerLock.tryAcquire() ) {
-   //   myThread->idle();
-   //}
-   //std::cerr << "acquired @ " << __func__ << std::endl;
-   if ( pthread_rwlock_rdlock(&_containerLock) ) {
-      message0("lock error ");
-      fatal("can not continue");
-   }
-   v = _container[ id ].getData();
-   //std::cerr << "released @ " << __func__ << std::endl;
-   //_containerLock.release();
-   if ( pthread_rwlock_unlock(&_containerLock) ) {
-      message0("lock error ");
-      fatal("can not continue");
-   }
-   return v;
+   return _container[ id ].getData();
 }
 
 template <class T>
 void ContainerDense< T >::setRegionData( reg_t id, Version *data ) {
-   //_containerLock.acquire();
-   //while ( !_containerLock.tryAcquire() ) {
-   //   myThread->idle();
-   //}
-   //std::cerr << "acquired @ " << __func__ << std::endl;
-   if ( pthread_rwlock_rdlock(&_containerLock) ) {
-      message0("lock error ");
-      fatal("can not continue");
-   }
    _container[ id ].setData( data );
-   //std::cerr << "released @ " << __func__ << std::endl;
-   if ( pthread_rwlock_unlock(&_containerLock) ) {
-      message0("lock error ");
-      fatal("can not continue");
-   }
-   //_containerLock.release();
 }
 
 template <class T>
@@ -221,44 +310,26 @@ unsigned int ContainerDense< T >::getNumDimensions() const {
 
 template <class T>
 reg_t ContainerDense< T >::addRegion( nanos_region_dimension_internal_t const region[] ) {
-   if ( pthread_rwlock_wrlock(&_containerLock) ) {
-      message0("lock error " );
-      fatal("can not continue");
-   }
-
-   reg_t id = _root.addNode( region, _dimensionSizes.size(), 0, *this );
-
-   if ( pthread_rwlock_unlock(&_containerLock) ) {
-      message0("lock error " );
-      fatal("can not continue");
+   // most regions are registered more than once, look them up before serializing
+   reg_t id = _root.checkNode( region, _dimensionSizes.size(), 0 );
+   if ( id == 0 ) {
+      LockBlock lock( _containerLock );
+      id = _root.addNode( region, _dimensionSizes.size(), 0, *this );
    }
-
    return id;
 }
 
 template <class T>
 reg_t ContainerDense< T >::getNewRegionId() {
    reg_t id = _idSeed++;
-   if ( id % 64 == 0 ) {
-      _container.resize( id + 64 );
-   }
+   _container.grow( id );
    if (id >= MAX_REG_ID) { std::cerr <<"Max regions reached."<<std::endl;}
    return id;
 }
 
 template <class T>
 reg_t ContainerDense< T >::checkIfRegionExists( nanos_region_dimension_internal_t const region[] ) {
-   bool result;
-   if ( pthread_rwlock_rdlock(&_containerLock) ) {
-      message0("lock error ");
-      fatal("can not continue");
-   }
-   result = _root.checkNode( region, _dimensionSizes.size(), 0 );
-   if ( pthread_rwlock_unlock(&_containerLock) ) {
-      message0("lock error " );
-      fatal("can not continue");
-   }
-   return result;
+   return _root.checkNode( region, _dimensionSizes.size(), 0 );
 }
 
 template <class T>
@@ -286,20 +357,15 @@ void ContainerDense< T >::invalUnlock() {
 template <class T>
 void ContainerDense< T >::addMasterRegionId( reg_t masterId, reg_t localId ) {
    _containerMi2LiLock.acquire();
+   _masterIdToLocalId.grow( masterId );
    _masterIdToLocalId[ masterId ] = localId;
    _containerMi2LiLock.release();
 }
 
 template <class T>
 reg_t ContainerDense< T >::getLocalRegionIdFromMasterRegionId( reg_t masterId ) {
-   reg_t result = 0;
-   _containerMi2LiLock.acquire();
-   std::map< reg_t, reg_t >::const_iterator it = _masterIdToLocalId.find( masterId );
-   if ( it != _masterIdToLocalId.end() ) {
-      result = it->second;
-   }
-   _containerMi2LiLock.release();
-   return result;
+   reg_t const *localId = _masterIdToLocalId.find( masterId );
+   return localId != NULL ? *localId : 0;
 }
 
 template <class T>
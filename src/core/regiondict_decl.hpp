@@ -44,13 +44,33 @@ typedef unsigned int reg_t;
 
    class RegionVectorEntry;
 
+   /*! \brief Node of the region tree of an object
+    *
+    *  Each level of the tree holds the lower bound or the accessed length of a dimension. Children
+    *  are kept in an array sorted by value, which is read without locking: insertions (serialized
+    *  by the container lock) bump _sonsVersion to an odd value while they modify the array, and
+    *  readers retry when they observe a change. Arrays replaced when growing are kept until the
+    *  node is destroyed, as a reader may still be looking at them.
+    */
    class RegionNode {
+      struct Son {
+         std::size_t  _value;
+         RegionNode  *_node;
+      };
+
       RegionNode  *_parent;
       std::size_t  _value;
       reg_t _id;
-      std::map<std::size_t, RegionNode *> *_sons;
+      Son * volatile _sons;
+      volatile unsigned int _numSons;
+      unsigned int _sonsCapacity;
+      volatile unsigned int _sonsVersion;
+      std::vector< Son * > *_retiredSons;
       reg_t *_memoIntersectInfo;
 
+      RegionNode *findSon( std::size_t value ) const;
+      void insertSon( std::size_t value, RegionNode *son );
+
       public:
       RegionNode( RegionNode *parent, std::size_t value, reg_t id );
       RegionNode( RegionNode const & rn );
@@ -82,18 +102,51 @@ typedef unsigned int reg_t;
       Version *getData() const;
    };
 
+   /*! \brief Table indexed by region id which is read without locking
+    *
+    *  Entries live in chunks which never move, so they stay valid while the table grows. The
+    *  chunk directory is replaced (not resized) when it is full; the old one is kept until the
+    *  table is destroyed, as a reader may still be using it. Calls to grow() must be serialized.
+    */
+   template < class T >
+   class RegionIdTable {
+      struct Directory {
+         unsigned int   _size;
+         T * volatile  *_chunks;
+      };
+      static const unsigned int ChunkSize = 64;
+
+      Directory * volatile       _directory;
+      std::vector< Directory * > _retired;
+
+      RegionIdTable( RegionIdTable const &table );
+      RegionIdTable &operator=( RegionIdTable const &table );
+      static Directory *newDirectory( unsigned int size );
+      static void deleteDirectory( Directory *dir );
+
+      public:
+      RegionIdTable();
+      ~RegionIdTable();
+      //! \brief Makes entry id available (entries are value initialized)
+      void grow( reg_t id );
+      //! \brief Entry id, which must have been made available by grow()
+      T &operator[]( reg_t id ) const;
+      //! \brief Entry id, or NULL if it has not been made available
+      T *find( reg_t id ) const;
+   };
+
    template < class T >
    class ContainerDense {
-      std::vector< T >           _container;
+      RegionIdTable< T >         _container;
       Atomic<unsigned int>       _leafCount;
       Atomic<reg_t>              _idSeed;
       std::vector< std::size_t > _dimensionSizes;
       RegionNode                 _root;
-      pthread_rwlock_t           _containerLock;
+      Lock                       _containerLock;    /**< Serializes region insertions, lookups do not lock */
 
 
       Lock                       _invalidationsLock;
-      std::map< reg_t, reg_t >   _masterIdToLocalId;
+      RegionIdTable< reg_t >     _masterIdToLocalId;
       Lock                       _containerMi2LiLock;
       bool                       _keepAtOrigin;
       CopyData                  *_registeredObject;
@@ -60,7 +60,7 @@ std::ostream & operator<< (std::ostream &o, DirectoryEntryData const &ent)
 {
    //o << "WL: " << ent._writeLocation << " V: " << ent.getVersion() << " Locs: ";
    o << " V: " << ent.getVersion() << " Locs: ";
-   for ( std::set<memory_space_id_t>::iterator it = ent._location.begin(); it != ent._location.end(); it++ ) {
+   for ( LocationSet::const_iterator it = ent._location.begin(); it != ent._location.end(); it++ ) {
       o << *it << " ";
    }
    o << "R: " << ent.getRootedLocation();
@@ -22,6 +22,7 @@
 
 #include "deviceops.hpp"
 #include "version.hpp"
+#include "locationset.hpp"
 
 namespace nanos {
 
@@ -29,10 +30,10 @@ inline DirectoryEntryData::DirectoryEntryData() : Version( 1 )
    //, _writeLocation( -1 )
    , _ops()
    , _location()
-   , _pes()
    , _rooted( (memory_space_id_t) -1 )
    , _home( (memory_space_id_t) -1 )
    , _setLock() 
+   , _updateSeq( 0 )
    , _firstWriterPE( NULL )
    , _baseAddress( 0 )
 {
@@ -43,10 +44,10 @@ inline DirectoryEntryData::DirectoryEntryData( memory_space_id_t home ) : Versio
    //, _writeLocation( -1 )
    , _ops()
    , _location()
-   , _pes()
    , _rooted( (memory_space_id_t) -1 )
    , _home( home )
    , _setLock() 
+   , _updateSeq( 0 )
    , _firstWriterPE( NULL )
    , _baseAddress( 0 )
 {
@@ -57,10 +58,10 @@ inline DirectoryEntryData::DirectoryEntryData( const DirectoryEntryData &de ) :
    //, _writeLocation( de._writeLocation )
    , _ops()
    , _location( de._location )
-   , _pes( de._pes )
    , _rooted( de._rooted )
    , _home( de._home )
    , _setLock()
+   , _updateSeq( 0 )
    , _firstWriterPE( de._firstWriterPE )
    , _baseAddress( de._baseAddress )
 {
@@ -70,27 +71,54 @@ inline DirectoryEntryData::~DirectoryEntryData() {
 }
 
 inline DirectoryEntryData & DirectoryEntryData::operator= ( DirectoryEntryData &de ) {
-   Version::operator=( de );
-   //_writeLocation = de._writeLocation;
    while ( !_setLock.tryAcquire() ) {
       //myThread->processTransfers();
    }
    while ( !de._setLock.tryAcquire() ) {
       //myThread->processTransfers();
    }
-   _location.clear();
-   _pes.clear();
-   _location.insert( de._location.begin(), de._location.end() );
-   _pes.insert( de._pes.begin(), de._pes.end() );
+   beginUpdate();
+   Version::operator=( de );
+   //_writeLocation = de._writeLocation;
+   _location = de._location;
    _rooted = de._rooted;
    _home = de._home;
    _firstWriterPE = de._firstWriterPE;
    _baseAddress = de._baseAddress;
+   endUpdate();
    de._setLock.release();
    _setLock.release();
    return *this;
 }
 
+inline void DirectoryEntryData::beginUpdate() {
+   _updateSeq = _updateSeq + 1;
+   memoryFence();
+}
+
+inline void DirectoryEntryData::endUpdate() {
+   memoryFence();
+   _updateSeq = _updateSeq + 1;
+}
+
+/*! \brief Reads a consistent version and location mask, returns false if the
+ *  locations do not fit in the mask and the caller has to lock the entry
+ */
+inline bool DirectoryEntryData::readLocations( unsigned int &version, uint64_t &mask ) const {
+   unsigned int seq;
+   do {
+      while ( ( seq = _updateSeq ) & 1 ) {
+         cpuRelax();
+      }
+      memoryFence();
+      if ( _location.hasOthers() ) return false;
+      version = this->getVersion();
+      mask = _location.getMask();
+      memoryFence();
+   } while ( seq != _updateSeq );
+   return true;
+}
+
 //inline bool DirectoryEntryData::hasWriteLocation() const {
 //   return ( _writeLocation != -1 );
 //}
@@ -110,23 +138,22 @@ inline void DirectoryEntryData::addAccess( ProcessingElement *pe, memory_space_i
    //*myThread->_file << "+++++++++++++++++v entry " << (void *) this << " v++++++++++++++++++++++" << std::endl;
    if ( version > this->getVersion() ) {
       //*myThread->_file << "Upgrading version to " << version << " @location " << id << std::endl;
+      beginUpdate();
       _location.clear();
       //_writeLocation = id;
       this->setVersion( version );
       _location.insert( loc );
-      if ( pe != NULL && loc == pe->getMemorySpaceId() ) {
-         _pes.insert( pe );
-      }
+      endUpdate();
       if ( version == 2 ) {
          _firstWriterPE = pe;
       }
    } else if ( version == this->getVersion() ) {
       //*myThread->_file << "Equal version (" << version << ") @location " << id << std::endl;
       // entry is going to be replicated, so it must be that multiple copies are used as inputs only
+      // (adding a location does not need to be seen atomically with the version)
+      beginUpdate();
       _location.insert( loc );
-      if ( pe != NULL && loc == pe->getMemorySpaceId() ) {
-         _pes.insert( pe );
-      }
+      endUpdate();
       // if ( _location.size() > 1 )
       // {
       //    _writeLocation = -1;
@@ -143,10 +170,12 @@ inline void DirectoryEntryData::addRootedAccess( memory_space_id_t loc, unsigned
       //myThread->processTransfers();
    }
    ensure(version == this->getVersion(), "addRootedAccess of already accessed entry." );
+   beginUpdate();
    _location.clear();
    //_writeLocation = id;
    this->setVersion( version );
    _location.insert( loc );
+   endUpdate();
    _rooted = loc;
    _setLock.release();
 }
@@ -156,17 +185,9 @@ inline bool DirectoryEntryData::delAccess( memory_space_id_t from ) {
    while ( !_setLock.tryAcquire() ) {
       //myThread->processTransfers();
    }
+   beginUpdate();
    _location.erase( from );
-   std::set< ProcessingElement * >::iterator it = _pes.begin();
-   while ( it != _pes.end() ) {
-      if ( (*it)->getMemorySpaceId() == from ) {
-         std::set< ProcessingElement * >::iterator toBeErased = it;
-         ++it;
-         _pes.erase( toBeErased );
-      } else {
-         ++it;
-      }
-   }
+   endUpdate();
    result = _location.empty();
    _setLock.release();
    return result;
@@ -174,13 +195,22 @@ inline bool DirectoryEntryData::delAccess( memory_space_id_t from ) {
 
 inline bool DirectoryEntryData::isLocatedIn( ProcessingElement *pe, unsigned int version ) {
    bool result;
+   unsigned int currentVersion;
+   uint64_t mask;
+   memory_space_id_t loc = pe->getMemorySpaceId();
+   if ( loc < LocationSet::MaskWidth && readLocations( currentVersion, mask ) ) {
+      if ( mask == 0 ) {
+         *myThread->_file << " Warning: empty _location set, it is likely that an invalidation is ongoing for this region. " << std::endl;
+      }
+      return version <= currentVersion && ( mask & LocationSet::bit( loc ) ) != 0;
+   }
    while ( !_setLock.tryAcquire() ) {
       //myThread->processTransfers();
    }
    if ( _location.empty() ) {
       *myThread->_file << " Warning: empty _location set, it is likely that an invalidation is ongoing for this region. " << std::endl;
    }
-   result = ( version <= this->getVersion() && _location.count( pe->getMemorySpaceId() ) > 0 );
+   result = ( version <= this->getVersion() && _location.count( loc ) > 0 );
    _setLock.release();
    return result;
 }
@@ -191,6 +221,12 @@ inline bool DirectoryEntryData::isLocatedIn( ProcessingElement *pe ) {
 
 inline bool DirectoryEntryData::isLocatedIn( memory_space_id_t loc ) {
    bool result;
+   unsigned int version;
+   uint64_t mask;
+   if ( loc < LocationSet::MaskWidth && readLocations( version, mask ) ) {
+      //mask = 0 means we are invalidating
+      return ( mask & LocationSet::bit( loc ) ) != 0 || ( mask == 0 && loc == 0 );
+   }
    while ( !_setLock.tryAcquire() ) {
       //myThread->processTransfers();
    }
@@ -204,7 +240,7 @@ inline bool DirectoryEntryData::isLocatedIn( memory_space_id_t loc ) {
 
 inline void DirectoryEntryData::print(std::ostream &o) const {
    o << " V: " << this->getVersion() << " Locs: ";
-   for ( std::set< memory_space_id_t >::iterator it = _location.begin(); it != _location.end(); it++ ) {
+   for ( LocationSet::const_iterator it = _location.begin(); it != _location.end(); it++ ) {
       o << *it << " ";
    }
    o << std::endl;
@@ -212,16 +248,26 @@ inline void DirectoryEntryData::print(std::ostream &o) const {
 
 inline int DirectoryEntryData::getFirstLocation() {
    int result;
+   unsigned int version;
+   uint64_t mask;
+   if ( readLocations( version, mask ) ) {
+      return mask != 0 ? __builtin_ctzll( mask ) : 0;
+   }
    while ( !_setLock.tryAcquire() ) {
       //myThread->processTransfers();
    }
-   result = *(_location.begin());
+   result = _location.first();
    _setLock.release();
    return result;
 }
 
 inline int DirectoryEntryData::getNumLocations() {
    int result;
+   unsigned int version;
+   uint64_t mask;
+   if ( readLocations( version, mask ) ) {
+      return __builtin_popcountll( mask );
+   }
    while ( !_setLock.tryAcquire() ) {
       //myThread->processTransfers();
    }
@@ -234,7 +280,7 @@ inline DeviceOps *DirectoryEntryData::getOps() {
    return &_ops;
 }
 
-inline std::set< memory_space_id_t > const &DirectoryEntryData::getLocations() const {
+inline LocationSet const &DirectoryEntryData::getLocations() const {
    return _location;
 }
 
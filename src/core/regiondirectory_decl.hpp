@@ -23,23 +23,34 @@
 #include "regiondict_decl.hpp"
 #include "globalregt_decl.hpp"
 #include "deviceops_decl.hpp"
+#include "locationset_decl.hpp"
 #include "workdescriptor_fwd.hpp"
 #include "processingelement_fwd.hpp"
 
 namespace nanos {
 
+   /*! \brief Version and locations of a region
+    *
+    *  Updates are serialized by _setLock. Queries do not lock unless a memory space does not fit in
+    *  the location mask: they read the version and the mask, and retry if an update (which makes
+    *  _updateSeq odd while in progress) happened meanwhile.
+    */
    class DirectoryEntryData : public Version {
       private:
          //int _writeLocation;
          //int _invalidated;
          DeviceOps _ops;
-         std::set< memory_space_id_t > _location;
-         std::set< ProcessingElement *> _pes;
+         LocationSet _location;
          memory_space_id_t _rooted;
          memory_space_id_t _home;
          Lock _setLock;
+         volatile unsigned int _updateSeq;
          ProcessingElement * _firstWriterPE;
          uint64_t _baseAddress;
+
+         void beginUpdate();
+         void endUpdate();
+         bool readLocations( unsigned int &version, uint64_t &mask ) const;
       public:
          DirectoryEntryData();
          DirectoryEntryData( memory_space_id_t home );
@@ -62,7 +73,7 @@ namespace nanos {
          ProcessingElement *getFirstWriterPE() const;
          int getNumLocations();
          void setOps( DeviceOps *ops );
-         std::set< memory_space_id_t > const &getLocations() const;
+         LocationSet const &getLocations() const;
          DeviceOps *getOps() ;
          void setBaseAddress(uint64_t addr);
          uint64_t getBaseAddress() const;
@@ -21,6 +21,7 @@
 #define NANOS_ROUTER_HPP
 
 #include "router_decl.hpp"
+#include "locationset.hpp"
 
 namespace nanos {
 
@@ -39,7 +40,7 @@ inline void Router::initialize() {
 }
 
 inline memory_space_id_t Router::getSource( memory_space_id_t destination,
-      std::set<memory_space_id_t> const &locs ) {
+      LocationSet const &locs ) {
    memory_space_id_t selected;
    unsigned int destination_node = destination != 0 ? sys.getSeparateMemory( destination ).getNodeNumber() : 0;
    if ( locs.size() > 1 ) {
@@ -48,7 +49,7 @@ inline memory_space_id_t Router::getSource( memory_space_id_t destination,
       memory_space_id_t tmp_locations[ locs.size() ];
       int local_locations_idx = 0;
       int remote_locations_idx = locs.size()-1;
-      for (std::set<memory_space_id_t>::const_iterator it = locs.begin();
+      for (LocationSet::const_iterator it = locs.begin();
             it != locs.end(); it++ ) {
          if ( *it == 0 || sys.getSeparateMemory( *it ).getNodeNumber() ) {
             tmp_locations[local_locations_idx] = *it;
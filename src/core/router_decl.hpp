@@ -23,6 +23,7 @@
 #include <set>
 #include <vector>
 #include "nanos-int.h"
+#include "locationset_decl.hpp"
 
 namespace nanos {
 
@@ -40,7 +41,7 @@ class Router {
       ~Router();
       void initialize();
       memory_space_id_t getSource( memory_space_id_t destination,
-            std::set<memory_space_id_t> const &locs );
+            LocationSet const &locs );
 };
 
 } // namespace nanos
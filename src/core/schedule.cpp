@@ -50,6 +50,10 @@ void SchedulerConf::config (Config &cfg)
 
    cfg.registerConfigOption ( "hold-tasks", NEW Config::FlagOption( _holdTasks ), "Do not submit tasks until a taskwait is reached." );
    cfg.registerArgOption ( "hold-tasks", "hold-tasks" );
+
+   cfg.registerConfigOption ( "stackless-tasks", NEW Config::FlagOption( _stacklessTasks ),
+                              "Idle threads run final tasks on their own stack instead of a user-level thread stack." );
+   cfg.registerArgOption ( "stackless-tasks", "stackless-tasks" );
 }
 
 void Scheduler::submit ( WD &wd, bool force_queue )
@@ -100,6 +104,7 @@ void Scheduler::_submit ( WD &wd, bool force_queue )
       * it in our scheduler system. Global ready task queue will take care about task/thread
       * architecture, while local ready task queue will wait until stealing. */
       mythread->getTeam()->getSchedulePolicy().queue( mythread, wd );
+      thread_manager->notifyReadyTasks();
 
       return;
    }
@@ -117,6 +122,7 @@ void Scheduler::_submit ( WD &wd, bool force_queue )
    myThread->unpause();
    // And go on
    WD *next = getMyThreadSafe()->getTeam()->getSchedulePolicy().atSubmit( myThread, wd );
+   thread_manager->notifyReadyTasks();
 
    /* If SchedulePolicy have returned a 'next' value, we have to context switch to
       that WorkDescriptor */
@@ -177,6 +183,7 @@ void Scheduler::_submit ( WD ** wds, size_t numElems )
    
    // Call the scheduling policy
    mythread->getTeam()->getSchedulePolicy().queue( threadList, wds, numElems );
+   sys.getThreadManager()->notifyReadyTasks();
    
    // Release
    delete[] threadList;
@@ -203,6 +210,26 @@ struct TestInputs {
    }
 };
 
+#ifdef NANOS_INSTRUMENTATION_ENABLED
+/*! \brief Raises (and resets) the lock contention counters of the current thread
+ */
+static inline void raiseLockContentionEvents ()
+{
+   if ( lockContention._contended == 0 ) return;
+
+   static InstrumentationDictionary *ID = sys.getInstrumentation()->getInstrumentationDictionary();
+   static nanos_event_key_t keys[2] = { ID->getEventKey("lock-contended"), ID->getEventKey("lock-spins") };
+
+   nanos_event_value_t values[2];
+   values[0] = (nanos_event_value_t) lockContention._contended;
+   values[1] = (nanos_event_value_t) lockContention._spins;
+   lockContention._contended = 0;
+   lockContention._spins = 0;
+
+   sys.getInstrumentation()->raisePointEvents( 2, keys, values );
+}
+#endif
+
 template<class behaviour>
 inline void Scheduler::idleLoop ()
 {
@@ -295,6 +322,7 @@ inline void Scheduler::idleLoop ()
          NANOS_INSTRUMENT ( if (total_scheds == 0 ) { event_num -= 2; } )
 
          NANOS_INSTRUMENT( sys.getInstrumentation()->raisePointEvents(event_num, &Keys[event_start], &Values[event_start]); )
+         NANOS_INSTRUMENT( raiseLockContentionEvents(); )
 
          thread->wait();
 
@@ -370,6 +398,7 @@ inline void Scheduler::idleLoop ()
          NANOS_INSTRUMENT ( if (total_scheds == 0 ) { event_num -= 2; } )
 
          NANOS_INSTRUMENT( sys.getInstrumentation()->raisePointEvents(event_num, &Keys[event_start], &Values[event_start]); )
+         NANOS_INSTRUMENT( raiseLockContentionEvents(); )
 
          thread->setIdle( false );
          sys.getSchedulerStats()._idleThreads--;
@@ -480,8 +509,8 @@ void Scheduler::waitOnCondition (GenericSyncCond *condition)
                thread_manager->acquireOne();
             }
 
-            //! Finally coming back to our Thread's WD (idle task)
-            if ( !next && supportULT && sys.getSchedulerConf().getSchedulerEnabled() ) {
+            //! Finally coming back to our Thread's WD (idle task), unless we are running on its stack
+            if ( !next && supportULT && !current->isStackless() && sys.getSchedulerConf().getSchedulerEnabled() ) {
                next = &(thread->getThreadWD());
             if ( next != NULL ) {
                 verbose("Got wd through getThreadWD");
@@ -534,6 +563,7 @@ void Scheduler::wakeUp ( WD *wd )
 
          ensure( myTeam, "Trying to wake up a WD from a thread without team." );
          next = myTeam->getSchedulePolicy().atWakeUp( myThread, *wd );
+         sys.getThreadManager()->notifyReadyTasks();
       }
 
       /* If SchedulePolicy have returned a 'next' value, we have to context switch to
@@ -573,7 +603,14 @@ struct WorkerBehaviour
 
    static void switchWD ( BaseThread *thread, WD *current, WD *next )
    {
-      Scheduler::switchTo(next);
+      if ( !next->started() && next->isFinal() && sys.getSchedulerConf().getStacklessTasksEnabled() ) {
+         //! Final tasks create no children to wait for, so they run on the thread stack without a ULT stack
+         if ( Scheduler::inlineWork( next, /*schedule*/ true ) ) {
+            sys.destroyWD( next );
+         }
+      } else {
+         Scheduler::switchTo(next);
+      }
    }
    static bool checkThreadRunning( WD *current) { return true; }
    static bool exiting() { return false; }
@@ -597,8 +634,7 @@ struct AsyncWorkerBehaviour
          // Since this is the async behavior, set schedule to false:
          // do not prefetch at this point, as the thread will be always prefetching
          if ( Scheduler::inlineWorkAsync ( next, /* schedule */ false ) ) {
-            next->~WorkDescriptor();
-            delete[] ( char * ) next;
+            sys.destroyWD( next );
          }
       }
    }
@@ -801,6 +837,12 @@ bool Scheduler::inlineWork ( WD *wd, bool schedule )
    debug( "switching(inlined) from task " << oldwd << ":" << oldwd->getId() <<
           " to " << wd << ":" << wd->getId() << " at node " << sys.getNetwork()->getNodeNum() );
 
+   // WDs inlined over the thread WD or over a stackless WD live on the thread stack
+   if ( oldwd->isStackless() || ( oldwd == &(thread->getThreadWD()) &&
+        sys.getSchedulerConf().getStacklessTasksEnabled() && thread->runningOn()->supportsUserLevelThreads() ) ) {
+      wd->setStackless();
+   }
+
    // Initializing wd if necessary. It will be started later in inlineWorkDependent call
    if ( !wd->started() ) { 
       if ( !wd->_mcontrol.isMemoryAllocated() ) {
@@ -927,7 +969,15 @@ void Scheduler::switchHelper (WD *oldWD, WD *newWD, void *arg)
 
 void Scheduler::switchTo ( WD *to )
 {
-   if ( myThread->runningOn()->supportsUserLevelThreads() ) {
+   WD *current = myThread->getCurrentWD();
+
+   if ( current->isStackless() && to->started() ) {
+      //! A stackless WD cannot be suspended, so a started WD has to wait in the ready queue
+      if ( to != &(myThread->getThreadWD()) ) myThread->getTeam()->getSchedulePolicy().queue( myThread, *to );
+      return;
+   }
+
+   if ( myThread->runningOn()->supportsUserLevelThreads() && !current->isStackless() ) {
 
       if (!to->started()) {
          to->_mcontrol.initialize( *(myThread->runningOn()) );
@@ -958,8 +1008,7 @@ void Scheduler::switchTo ( WD *to )
 
    } else {
       if (inlineWork(to, /*schedule*/ true)) {
-         to->~WorkDescriptor();
-         delete[] (char *)to;
+         sys.destroyWD( to );
       }
    }
 }
@@ -995,8 +1044,7 @@ void Scheduler::exitHelper (WD *oldWD, WD *newWD, void *arg)
 {
     myThread->exitHelperDependent(oldWD, newWD, arg);
     myThread->setCurrentWD( *newWD );
-    oldWD->~WorkDescriptor();
-    delete[] (char *)oldWD;
+    sys.destroyWD( oldWD );
 }
 
 struct ExitBehaviour
@@ -1013,8 +1061,7 @@ struct ExitBehaviour
       }
       else {
         if ( Scheduler::inlineWork ( next /*jb merge */, /*schedule*/ true ) ) {
-          next->~WorkDescriptor();
-          delete[] (char *)next;
+          sys.destroyWD( next );
         }
       }
    }
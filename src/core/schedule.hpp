@@ -79,6 +79,11 @@ inline bool SchedulerConf::getHoldTasksEnabled ( void ) const
    return _holdTasks;
 }
 
+inline bool SchedulerConf::getStacklessTasksEnabled ( void ) const
+{
+   return _stacklessTasks;
+}
+
 inline const std::string & SchedulePolicy::getName () const
 {
    return _name;
@@ -99,13 +99,14 @@ namespace nanos {
          bool                          _schedulerEnabled;  //!< Scheduler is enabled
          int                           _numStealAfterSpins;//!< Steal every so spins
          bool                          _holdTasks;         //!< Submit tasks when a taskwait is reached
+         bool                          _stacklessTasks;    //!< Run final tasks on the worker stack
       private: /* PRIVATE METHODS */
         //! \brief SchedulerConf default constructor (private)
         SchedulerConf() : _numSpins(1), _numChecks(1), _schedulerEnabled(true),
-        _numStealAfterSpins(1), _holdTasks(false) {}
+        _numStealAfterSpins(1), _holdTasks(false), _stacklessTasks(false) {}
         //! \brief SchedulerConf copy constructor (private)
         SchedulerConf ( SchedulerConf &sc ) : _numSpins(), _numChecks(),
-        _schedulerEnabled(), _holdTasks()
+        _schedulerEnabled(), _holdTasks(), _stacklessTasks()
         {
            fatal("SchedulerConf: Illegal use of class");
         }
@@ -128,6 +129,8 @@ namespace nanos {
          bool getSchedulerEnabled () const;
          //! \brief Returns if holding tasks is enabled 
          bool getHoldTasksEnabled () const;
+         //! \brief Returns if idle threads run final tasks on their own stack
+         bool getStacklessTasksEnabled () const;
 
          //! \brief Configure scheduler runtime options
          void config ( Config &cfg );
@@ -137,8 +140,11 @@ namespace nanos {
    {
          friend class WDDeque;
          friend class WDLFQueue;
+         friend class WDStealDeque;
          friend class WDPriorityQueue<WD::PriorityType>;
          friend class WDPriorityQueue<double>;
+         friend class WDBucketPriorityQueue;
+         friend class WDMPMCQueue;
          friend class Scheduler;
          friend class System;
 
@@ -137,9 +137,11 @@ System::System () :
 #endif
 #ifdef NANOS_INSTRUMENTATION_ENABLED
       , _enableEvents(), _disableEvents(), _instrumentDefault("default"), _enableCpuidEvent( false )
+      , _instrumentSampleTasks( 1 ), _instrumentWindowStart( 0 ), _instrumentWindowLength( 0 ), _instrumentKeyRates()
 #endif
       , _lockPoolSize(37), _lockPool( NULL ), _mainTeam (NULL), _simulator(false),  _task_max_retries(1), _affinityFailureCount( 0 )
       , _createLocalTasks( false )
+      , _wdCacheSize( 32 )
       , _verboseDevOps( false )
       , _verboseCopies( false )
       , _splitOutputForThreads( false )
@@ -399,6 +401,22 @@ void System::config ()
    cfg.registerConfigOption( "instrument-cpuid", NEW Config::FlagOption ( _enableCpuidEvent ),
                              "Add cpuid event when binding is disabled (expensive)" );
    cfg.registerArgOption( "instrument-cpuid", "instrument-cpuid" );
+
+   cfg.registerConfigOption( "instrument-sample-tasks", NEW Config::UintVar ( _instrumentSampleTasks ),
+                             "Record the lifecycle of one in N tasks (default: 1, all of them)" );
+   cfg.registerArgOption( "instrument-sample-tasks", "instrument-sample-tasks" );
+
+   cfg.registerConfigOption( "instrument-window-start", NEW Config::UintVar ( _instrumentWindowStart ),
+                             "Start (ms after the runtime start up) of the window recorded in full detail" );
+   cfg.registerArgOption( "instrument-window-start", "instrument-window-start" );
+
+   cfg.registerConfigOption( "instrument-window-length", NEW Config::UintVar ( _instrumentWindowLength ),
+                             "Length (ms) of the window recorded in full detail (default: 0, no window)" );
+   cfg.registerArgOption( "instrument-window-length", "instrument-window-length" );
+
+   cfg.registerConfigOption( "instrument-key-rate", NEW Config::StringVarList ( _instrumentKeyRates ),
+                             "Limit the events of a key: key:events-per-second[:burst]" );
+   cfg.registerArgOption( "instrument-key-rate", "instrument-key-rate" );
 #endif
 
    /* Cluster: load the cluster support */
@@ -472,6 +490,10 @@ void System::config ()
                              "Enables pre scheduling" );
    cfg.registerArgOption( "preschedule", "preschedule" );
 
+   cfg.registerConfigOption( "wd-cache-size", NEW Config::SizeVar( _wdCacheSize ),
+                             "Number of free WD chunks cached per thread and task definition (0 disables it)" );
+   cfg.registerArgOption( "wd-cache-size", "wd-cache-size" );
+
    _schedConf.config( cfg );
 
    _hwloc.config( cfg );
@@ -514,6 +536,7 @@ void System::start ()
 
    // Instrumentation startup
    NANOS_INSTRUMENT ( sys.getInstrumentation()->filterEvents( _instrumentDefault, _enableEvents, _disableEvents ) );
+   NANOS_INSTRUMENT ( sys.getInstrumentation()->setupSampling( _instrumentSampleTasks, _instrumentWindowStart, _instrumentWindowLength, _instrumentKeyRates ) );
    NANOS_INSTRUMENT ( sys.getInstrumentation()->initialize() );
 
    verbose0 ( "Starting runtime" );
@@ -941,6 +964,24 @@ void System::finish ()
  *  +---------------+
  *  </pre>
  */
+namespace {
+   //! \brief Free WD chunks of one task definition, cached by the current thread
+   struct WDChunkList {
+      void     *_head;     //!< First free chunk, chunks are linked through their first word
+      size_t    _size;     //!< Size of the chunks in the list
+      size_t    _count;    //!< Number of chunks in the list
+   };
+
+   const unsigned int WD_CHUNK_LISTS = 16;
+
+   __thread WDChunkList wdChunkLists[WD_CHUNK_LISTS];
+
+   inline WDChunkList & getWDChunkList ( const void *definition )
+   {
+      return wdChunkLists[ ( ( (uintptr_t) definition ) >> 4 ) % WD_CHUNK_LISTS ];
+   }
+}
+
 void System::createWD ( WD **uwd, size_t num_devices, nanos_device_t *devices, size_t data_size, size_t data_align,
                         void **data, WD *uwg, nanos_wd_props_t *props, nanos_wd_dyn_props_t *dyn_props,
                         size_t num_copies, nanos_copy_data_t **copies, size_t num_dimensions,
@@ -1007,7 +1048,17 @@ void System::createWD ( WD **uwd, size_t num_devices, nanos_device_t *devices, s
       total_size = NANOS_ALIGNED_MEMORY_OFFSET(offset_PMD,size_PMD,1);
    }
 
-   chunk = NEW char[total_size];
+   // Every WD of a task definition shares its devices array, so it identifies the definition
+   WDChunkList &chunks = getWDChunkList( devices );
+   const bool recyclable = ( *uwd == NULL );
+   if ( recyclable && chunks._head != NULL && chunks._size == total_size ) {
+      chunk = (char *) chunks._head;
+      chunks._head = *(void **) chunk;
+      chunks._count--;
+   } else {
+      chunk = NEW char[total_size];
+   }
+
    if ( props != NULL ) {
       if (props->clear_chunk)
           memset(chunk, 0, sizeof(char) * total_size);
@@ -1044,6 +1095,7 @@ void System::createWD ( WD **uwd, size_t num_devices, nanos_device_t *devices, s
    
    // Set total size
    wd->setTotalSize(total_size );
+   wd->setRecyclable( recyclable );
    
    if ( wd->getNUMANode() >= (int)sys.getNumNumaNodes() )
       throw NANOS_INVALID_PARAM;
@@ -1096,6 +1148,27 @@ void System::createWD ( WD **uwd, size_t num_devices, nanos_device_t *devices, s
    if (uwg) wd->copyReductions((WorkDescriptor *)uwg);
 }
 
+void System::destroyWD ( WD *wd )
+{
+   const bool recyclable = wd->isRecyclable();
+   const size_t size = wd->getTotalSize();
+   WDChunkList &chunks = getWDChunkList( (void *) wd->getVersionGroupId() );
+
+   wd->~WorkDescriptor();
+
+   if ( recyclable && chunks._count < _wdCacheSize ) {
+      if ( chunks._count == 0 ) chunks._size = size;
+      if ( chunks._size == size ) {
+         *(void **) wd = chunks._head;
+         chunks._head = wd;
+         chunks._count++;
+         return;
+      }
+   }
+
+   delete[] (char *) wd;
+}
+
 /*! \brief Duplicates the whole structure for a given WD
  *
  *  \param [out] uwd is the target addr for the new WD
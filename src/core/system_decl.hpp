@@ -225,6 +225,10 @@ namespace nanos {
          std::list<std::string>    _disableEvents;
          std::string               _instrumentDefault;
          bool                      _enableCpuidEvent;
+         unsigned int              _instrumentSampleTasks;
+         unsigned int              _instrumentWindowStart;
+         unsigned int              _instrumentWindowLength;
+         std::list<std::string>    _instrumentKeyRates;
 #endif
 
          const int                 _lockPoolSize;
@@ -248,6 +252,7 @@ namespace nanos {
          Atomic<int> _atomicSeedWg;
          Atomic<unsigned int> _affinityFailureCount;
          bool                      _createLocalTasks;
+         size_t                    _wdCacheSize;         //!< Free WD chunks cached per thread and task definition
          bool _verboseDevOps;
          bool _verboseCopies;
          bool _splitOutputForThreads;
@@ -315,6 +320,14 @@ namespace nanos {
 
          void duplicateWD ( WD **uwd, WD *wd );
 
+        /*! \brief Destroys a WD and frees its chunk
+         *
+         *  Chunks allocated by createWD are kept in a per-thread free-list of their task
+         *  definition (up to wd-cache-size of them) and handed back by the next createWD
+         *  of the same definition.
+         */
+         void destroyWD ( WD *wd );
+
         /* \brief prepares a WD to be scheduled/executed.
          * \param work WD to be set up
          */
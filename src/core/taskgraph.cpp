@@ -0,0 +1,206 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+#include <algorithm>
+#include "taskgraph_decl.hpp"
+#include "system.hpp"
+#include "workdescriptor.hpp"
+#include "dependenciesdomain.hpp"
+#include "dependableobjectwd.hpp"
+#include "schedule.hpp"
+#include "instrumentation.hpp"
+
+using namespace nanos;
+
+void TaskGraph::DORecord::dependenciesSatisfied ()
+{
+   // Balances the count done when the domain submitted this object
+   DependenciesDomain::decreaseTasksInGraph();
+}
+
+void * TaskGraph::DORecord::getRelatedObject ()
+{
+   return getWD();
+}
+
+const void * TaskGraph::DORecord::getRelatedObject () const
+{
+   return getWD();
+}
+
+TaskGraph::TaskGraph ( WorkDescriptor &recorder ) : _nodes(), _domain( sys.getDependenciesManager()->createDependenciesDomain() ),
+                                                    _recorder( &recorder )
+{
+   _recorder->setRecordingTaskGraph( this );
+}
+
+TaskGraph::~TaskGraph ()
+{
+   if ( isRecording() ) endRecording();
+
+   for ( NodeList::iterator it = _nodes.begin(); it != _nodes.end(); it++ ) {
+      sys.destroyWD( it->_template );
+   }
+}
+
+void TaskGraph::record ( WorkDescriptor &wd, size_t numDeps, DataAccess *deps )
+{
+   ensure( isRecording(), "Recording a task into a task graph which is not recording" );
+
+   // Templates never run, so they must not be waited for by the recorder
+   wd.removeFromGroup();
+
+   unsigned int index = _nodes.size();
+   _nodes.push_back( Node() );
+   Node &node = _nodes.back();
+   node._template = &wd;
+   node._record = NEW DORecord( &wd, index );
+
+   for ( size_t i = 0; i < numDeps; i++ ) {
+      if ( !deps[i].isCommutative() ) continue;
+      node._commutative.push_back( deps[i] );
+      node._commutative.back().dimensions = NULL;
+   }
+
+   if ( numDeps != 0 ) _domain->submitDependableObject( *node._record, numDeps, deps );
+}
+
+void TaskGraph::collectSuccessors ( DependableObject &depObj, Successors &successors,
+                                    std::vector<DependableObject *> &visited )
+{
+   DependableObject::DependableObjectVector &succ = depObj.getSuccessors();
+   for ( DependableObject::DependableObjectVector::iterator it = succ.begin(); it != succ.end(); it++ ) {
+      DependableObject *next = it->second;
+      DORecord *record = dynamic_cast<DORecord *>( next );
+      if ( record != NULL ) {
+         successors.push_back( record->getNode() );
+      } else if ( std::find( visited.begin(), visited.end(), next ) == visited.end() ) {
+         // Objects created by the domain (e.g. for commutative accesses) just forward the dependence
+         visited.push_back( next );
+         collectSuccessors( *next, successors, visited );
+      }
+   }
+}
+
+void TaskGraph::endRecording ()
+{
+   ensure( isRecording(), "Ending the recording of a task graph which is not recording" );
+
+   std::vector<DependableObject *> visited;
+   for ( NodeList::iterator it = _nodes.begin(); it != _nodes.end(); it++ ) {
+      Successors &successors = it->_successors;
+      visited.clear();
+      collectSuccessors( *it->_record, successors, visited );
+      std::sort( successors.begin(), successors.end() );
+      successors.erase( std::unique( successors.begin(), successors.end() ), successors.end() );
+   }
+
+   // Let the recorded objects go as if the tasks had run, in order
+   for ( NodeList::iterator it = _nodes.begin(); it != _nodes.end(); it++ ) {
+      it->_record->finished();
+   }
+   _domain->finalizeAllReductions();
+   _domain->clearDependenciesDomain();
+   for ( NodeList::iterator it = _nodes.begin(); it != _nodes.end(); it++ ) {
+      delete it->_record;
+      it->_record = NULL;
+   }
+   delete _domain;
+   _domain = NULL;
+
+   _recorder->setRecordingTaskGraph( NULL );
+   _recorder = NULL;
+}
+
+void * TaskGraph::rebind ( void *address, size_t numRebinds, nanos_tdg_rebind_t const *rebinds )
+{
+   for ( size_t i = 0; i < numRebinds; i++ ) {
+      uintptr_t offset = (uintptr_t) address - (uintptr_t) rebinds[i].original;
+      if ( offset < rebinds[i].size ) return (char *) rebinds[i].replacement + offset;
+   }
+   return address;
+}
+
+void TaskGraph::replay ( WorkDescriptor &parent, size_t numRebinds, nanos_tdg_rebind_t const *rebinds )
+{
+   ensure( !isRecording(), "Replaying a task graph which is still recording" );
+
+   size_t numTasks = _nodes.size();
+   if ( numTasks == 0 ) return;
+
+   SchedulePolicy *policy = sys.getDefaultSchedulePolicy();
+   std::vector<DOSubmit *> dos( numTasks, NULL );
+   std::vector<DataAccess> commutative;
+
+   for ( size_t i = 0; i < numTasks; i++ ) {
+      Node &node = _nodes[i];
+      WorkDescriptor *wd = NULL;
+      sys.duplicateWD( &wd, node._template );
+
+      // Arguments holding an address of the recorded data
+      if ( numRebinds != 0 ) {
+         void **args = (void **) wd->getData();
+         for ( size_t w = 0; w < wd->getDataSize() / sizeof( void * ); w++ ) {
+            args[w] = rebind( args[w], numRebinds, rebinds );
+         }
+      }
+      // Private copies point to the arguments of the template, which are not relative yet
+      CopyData *copies = wd->getCopies();
+      for ( size_t c = 0; c < wd->getNumCopies(); c++ ) {
+         char *address = (char *) copies[c].getBaseAddress();
+         if ( copies[c].isPrivate() ) {
+            copies[c].setBaseAddress( (char *) wd->getData() + ( address - (char *) node._template->getData() ) );
+         } else if ( numRebinds != 0 ) {
+            copies[c].setBaseAddress( rebind( address, numRebinds, rebinds ) );
+         }
+      }
+
+      commutative = node._commutative;
+      for ( std::vector<DataAccess>::iterator it = commutative.begin(); it != commutative.end(); it++ ) {
+         it->address = rebind( it->address, numRebinds, rebinds );
+      }
+
+      parent.addWork( *wd );
+      wd->copyReductions( &parent );
+      sys.setupWD( *wd, &parent );
+      policy->onSystemSubmit( *wd, SchedulePolicy::SYS_SUBMIT_WITH_DEPENDENCIES );
+
+      NANOS_INSTRUMENT ( sys.getInstrumentation()->raiseOpenPtPEvent ( NANOS_WD_DOMAIN, (nanos_event_id_t) wd->getId(), 0, 0 ); )
+
+      // The extra predecessor keeps the task from being released until the whole graph is linked
+      dos[i] = parent.createDOSubmit( *wd, commutative.size(), commutative.empty() ? NULL : &commutative[0] );
+      dos[i]->increasePredecessors();
+   }
+
+   for ( size_t i = 0; i < numTasks; i++ ) {
+      Successors &successors = _nodes[i]._successors;
+      for ( Successors::iterator it = successors.begin(); it != successors.end(); it++ ) {
+         dos[i]->addSuccessor( *dos[*it] );
+         dos[*it]->increasePredecessors();
+      }
+   }
+
+   for ( size_t i = 0; i < numTasks; i++ ) policy->atCreate( *dos[i] );
+
+   DependenciesDomain::increaseTasksInGraph( numTasks );
+   for ( size_t i = 0; i < numTasks; i++ ) {
+      dos[i]->submitted();
+      dos[i]->decreasePredecessors( NULL, NULL, false );
+   }
+}
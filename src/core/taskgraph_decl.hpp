@@ -0,0 +1,115 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+#ifndef _NANOS_TASK_GRAPH_DECL
+#define _NANOS_TASK_GRAPH_DECL
+
+#include <vector>
+#include "nanos-int.h"
+#include "dependableobject_decl.hpp"
+#include "dependenciesdomain_fwd.hpp"
+#include "dataaccess_decl.hpp"
+#include "workdescriptor_fwd.hpp"
+#include "taskgraph_fwd.hpp"
+
+namespace nanos {
+
+   /*! \class TaskGraph
+    *  \brief Task graph recorded once and submitted many times
+    *
+    *  While a WD records, the tasks it submits are not run: they are kept as templates and their
+    *  data accesses are submitted to a private dependencies domain, so that every dependence
+    *  is resolved to a direct edge between two recorded tasks whatever the deps plugin in use.
+    *
+    *  A replay duplicates the templates and links their DOSubmits with the recorded edges, without
+    *  going through a dependencies domain. Task arguments and copies pointing into the data used
+    *  while recording can be moved to other data (e.g. swapped buffers) with a list of rebinds.
+    *
+    *  Replayed tasks are not tracked by the domain of their parent, so they are not ordered with
+    *  respect to other tasks of the parent: these must be waited for before and after a replay.
+    */
+   class TaskGraph
+   {
+      public:
+         typedef std::vector<unsigned int> Successors;
+
+      private:
+         /*! \brief DependableObject representing a recorded task in the private domain
+          *
+          *  It is never satisfied until the recording ends, so the domain keeps every edge.
+          */
+         class DORecord : public DependableObject
+         {
+            private:
+               unsigned int _node;     /**< Index of the recorded task */
+            public:
+               DORecord ( WorkDescriptor *wd, unsigned int node ) : DependableObject( wd ), _node( node ) {}
+               virtual ~DORecord () {}
+
+               virtual void dependenciesSatisfied ();
+               virtual void * getRelatedObject ();
+               virtual const void * getRelatedObject () const;
+
+               unsigned int getNode () const { return _node; }
+         };
+
+         struct Node {
+            WorkDescriptor            *_template;      /**< Recorded task, never run */
+            std::vector<DataAccess>    _commutative;   /**< Commutative accesses, without dimensions */
+            Successors                 _successors;    /**< Recorded tasks depending on this one */
+            DORecord                  *_record;        /**< Only while recording */
+         };
+         typedef std::vector<Node> NodeList;
+
+         NodeList                _nodes;
+         DependenciesDomain     *_domain;     /**< Only while recording */
+         WorkDescriptor         *_recorder;   /**< WD recording the graph, NULL when it ended */
+
+         void collectSuccessors ( DependableObject &depObj, Successors &successors,
+                                  std::vector<DependableObject *> &visited );
+
+         static void * rebind ( void *address, size_t numRebinds, nanos_tdg_rebind_t const *rebinds );
+
+      private:
+         /*! \brief TaskGraph copy constructor (private) */
+         TaskGraph ( const TaskGraph & );
+         /*! \brief TaskGraph copy assignment operator (private) */
+         const TaskGraph & operator= ( const TaskGraph & );
+      public:
+         /*! \brief Starts recording the tasks submitted by recorder */
+         TaskGraph ( WorkDescriptor &recorder );
+         ~TaskGraph ();
+
+         bool isRecording () const { return _recorder != NULL; }
+         size_t getNumTasks () const { return _nodes.size(); }
+         Successors const & getSuccessors ( unsigned int task ) const { return _nodes[task]._successors; }
+
+         /*! \brief Keeps wd, created by the recorder, as the next task of the graph */
+         void record ( WorkDescriptor &wd, size_t numDeps, DataAccess *deps );
+
+         /*! \brief Resolves the edges between the recorded tasks and stops recording */
+         void endRecording ();
+
+         /*! \brief Submits a new instance of the graph as children of parent */
+         void replay ( WorkDescriptor &parent, size_t numRebinds, nanos_tdg_rebind_t const *rebinds );
+   };
+
+} // namespace nanos
+
+#endif
@@ -18,11 +18,12 @@
 /*************************************************************************************/
 
 #include "threadmanager_decl.hpp"
-#include "atomic_decl.hpp"
+#include "atomic.hpp"
 #include "lock_decl.hpp"
 #include "system.hpp"
 #include "config.hpp"
 #include "os.hpp"
+#include <limits.h>
 
 #ifdef DLB
 #include <DLB_interface.h>
@@ -63,6 +64,8 @@ using namespace nanos;
 
 const unsigned int ThreadManagerConf::DEFAULT_SLEEP_NS = 20000;
 const unsigned int ThreadManagerConf::DEFAULT_YIELDS = 10;
+const unsigned int ThreadManagerConf::DEFAULT_MAX_SPIN_NS = 100000;
+const unsigned int ThreadManagerConf::DEFAULT_PARK_NS = 1000000;
 
 /**********************************/
 /****** Thread Manager Conf *******/
@@ -70,6 +73,7 @@ const unsigned int ThreadManagerConf::DEFAULT_YIELDS = 10;
 
 ThreadManagerConf::ThreadManagerConf()
    : _tm(TM_UNDEFINED), _numYields(DEFAULT_YIELDS), _sleepTime(DEFAULT_SLEEP_NS),
+   _maxSpinTime(DEFAULT_MAX_SPIN_NS), _parkTime(DEFAULT_PARK_NS),
    _useYield(false), _useBlock(false), _useDLB(false),
    _forceTieMaster(false), _warmupThreads(false)
 {
@@ -83,6 +87,7 @@ void ThreadManagerConf::config( Config &cfg )
    tm_options->addOption( "none", TM_NONE );
    tm_options->addOption( "nanos", TM_NANOS );
    tm_options->addOption( "dlb", TM_DLB );
+   tm_options->addOption( "adaptive", TM_ADAPTIVE );
    cfg.registerConfigOption ( "thread-manager", tm_options, "Select which Thread Manager will be used" );
    cfg.registerArgOption( "thread-manager", "thread-manager" );
 
@@ -108,6 +113,16 @@ void ThreadManagerConf::config( Config &cfg )
    cfg.registerConfigOption ( "num-yields", NEW Config::UintVar( _numYields ), yield_sstream.str() );
    cfg.registerArgOption ( "num-yields", "yields" );
 
+   std::ostringstream spin_sstream;
+   spin_sstream << "Set the maximum time (in nsec) an idle thread spins before parking, adaptive thread manager only (default = " << DEFAULT_MAX_SPIN_NS << ")";
+   cfg.registerConfigOption ( "max-spin-time", NEW Config::UintVar( _maxSpinTime ), spin_sstream.str() );
+   cfg.registerArgOption ( "max-spin-time", "max-spin-time" );
+
+   std::ostringstream park_sstream;
+   park_sstream << "Set the maximum time (in nsec) an idle thread stays parked, adaptive thread manager only (default = " << DEFAULT_PARK_NS << ")";
+   cfg.registerConfigOption ( "park-time", NEW Config::UintVar( _parkTime ), park_sstream.str() );
+   cfg.registerArgOption ( "park-time", "park-time" );
+
    cfg.registerConfigOption( "enable-dlb", NEW Config::FlagOption ( _useDLB ),
          "Tune Nanos Runtime to be used with Dynamic Load Balancing library" );
    cfg.registerArgOption( "enable-dlb", "enable-dlb" );
@@ -140,6 +155,9 @@ ThreadManager* ThreadManagerConf::create()
    if ( _tm == TM_NONE && (_useYield || _useBlock || _useSleep || _useDLB) ) {
       warning0( "Thread Manager: Block, sleep, yield or dlb options are ignored when you explicitly choose --thread-manager=none" );
    }
+   if ( _tm == TM_ADAPTIVE && (_useYield || _useBlock || _useSleep || _useDLB) ) {
+      warning0( "Thread Manager: Block, sleep, yield or dlb options are ignored when you explicitly choose --thread-manager=adaptive" );
+   }
 #ifndef DLB
    if ( _useDLB  || _tm == TM_DLB ) {
       fatal_cond0( !DLB_SYMBOLS_DEFINED,
@@ -158,6 +176,8 @@ ThreadManager* ThreadManagerConf::create()
       }
    } else if ( _tm == TM_DLB ) {
       return NEW DlbThreadManager( _numYields, _warmupThreads );
+   } else if ( _tm == TM_ADAPTIVE ) {
+      return NEW AdaptiveThreadManager( _maxSpinTime, _parkTime, _warmupThreads );
    }
 
    fatal0( "Unknown Thread Manager" );
@@ -759,3 +779,112 @@ void DlbThreadManager::processMaskChanged()
 {
    DLB_NotifyProcessMaskChangeTo(_cpuProcessMask->get_cpu_set_pointer());
 }
+
+/**********************************/
+/**** Adaptive Thread Manager *****/
+/**********************************/
+
+namespace {
+   //! \brief Per-thread idle state of the AdaptiveThreadManager
+   struct AdaptiveIdleData {
+      double _spinTime;    //!< Time to spin before parking (seconds), negative until the first idle
+      double _waitTime;    //!< Moving average of the time waited for new work (seconds)
+   };
+
+   __thread AdaptiveIdleData adaptiveIdleData = { -1.0, 0.0 };
+}
+
+AdaptiveThreadManager::AdaptiveThreadManager( unsigned int max_spin_time, unsigned int park_time, bool warmup )
+   : ThreadManager(warmup), _maxSpinTime( max_spin_time * 1.0e-9 ), _parkTime(park_time),
+   _futex(0), _parked(0), _spinning(0)
+{
+}
+
+bool AdaptiveThreadManager::hasWork( BaseThread *thread ) const
+{
+   return sys.getSchedulerStats().getReadyTasks() > 0 || thread->hasNextWD()
+      || !thread->isRunning() || thread->isSleeping();
+}
+
+void AdaptiveThreadManager::wakeUp( int count )
+{
+   // Parked threads compare the futex word with the value read before parking,
+   // so changing it also prevents the ones about to park from doing so
+   _futex++;
+   OS::futexWake( &_futex.override(), count );
+}
+
+void AdaptiveThreadManager::idle( int& yields
+#ifdef NANOS_INSTRUMENTATION_ENABLED
+   , unsigned long long& total_yields, unsigned long long& total_blocks
+   , unsigned long long& time_yields, unsigned long long& time_blocks
+#endif
+   )
+{
+   if ( !_initialized ) return;
+
+   BaseThread *thread = getMyThreadSafe();
+   AdaptiveIdleData &data = adaptiveIdleData;
+   if ( data._spinTime < 0.0 ) data._spinTime = _maxSpinTime;
+
+   double begin = OS::getMonotonicTime();
+   double now = begin;
+
+   // Spin while new work is expected soon
+   _spinning++;
+   while ( !hasWork( thread ) && now - begin < data._spinTime ) {
+      for ( int i = 0; i < 32; i++ ) cpuRelax();
+      now = OS::getMonotonicTime();
+   }
+   _spinning--;
+
+   // Otherwise, park until a submission wakes us up or park-time expires
+   if ( !hasWork( thread ) ) {
+#ifdef NANOS_INSTRUMENTATION_ENABLED
+      total_blocks++;
+      unsigned long long begin_block = (unsigned long long) ( OS::getMonotonicTime() * 1.0e9  );
+#endif
+      int value = _futex.value();
+      _parked++;
+      memoryFence();
+      // Submitters increase the ready tasks before checking the parked threads
+      if ( !hasWork( thread ) ) OS::futexWait( &_futex.override(), value, _parkTime );
+      _parked--;
+#ifdef NANOS_INSTRUMENTATION_ENABLED
+      unsigned long long end_block = (unsigned long long) ( OS::getMonotonicTime() * 1.0e9  );
+      time_blocks += ( end_block - begin_block );
+#endif
+      now = OS::getMonotonicTime();
+   }
+
+   // Spin up to twice the recent waiting time, but only briefly when work
+   // usually takes longer than max-spin-time to arrive
+   data._waitTime = 0.75 * data._waitTime + 0.25 * ( now - begin );
+   if ( 2.0 * data._waitTime <= _maxSpinTime ) {
+      data._spinTime = 2.0 * data._waitTime;
+   } else {
+      data._spinTime = _maxSpinTime / 16;
+   }
+}
+
+void AdaptiveThreadManager::unblockThread( BaseThread* thread )
+{
+   if ( !_initialized ) return;
+
+   // All the threads park on the same futex, wake up all of them
+   memoryFence();
+   if ( _parked.value() > 0 ) wakeUp( INT_MAX );
+}
+
+void AdaptiveThreadManager::notifyReadyTasks()
+{
+   if ( !_initialized ) return;
+
+   memoryFence();
+   int parked = _parked.value();
+   if ( parked == 0 ) return;
+
+   // Ready tasks will be taken first by the spinning threads
+   int needed = sys.getSchedulerStats().getReadyTasks() - _spinning.value();
+   if ( needed > 0 ) wakeUp( std::min( needed, parked ) );
+}
@@ -71,6 +71,8 @@ namespace nanos {
          virtual void blockThread(BaseThread*) {}
          virtual void unblockThread(BaseThread*) {}
          virtual void processMaskChanged() {}
+         //! \brief Called after queueing ready tasks, to wake up idle threads if needed
+         virtual void notifyReadyTasks() {}
    };
 
    //! BlockingThreadManager class
@@ -184,6 +186,41 @@ namespace nanos {
          virtual void processMaskChanged();
    };
 
+   //! AdaptiveThreadManager class
+   /*!
+    * This derived class is used to neither burn the CPUs while idle nor pay a long
+    * wake up latency when new work arrives. Idle threads spin for a time tuned per
+    * thread from the time they recently waited for new work, and then park on a futex.
+    * Task submission only wakes as many parked threads as ready tasks are not going
+    * to be taken by spinning threads.
+    *
+    * Used when --thread-manager=adaptive
+    */
+   class AdaptiveThreadManager : public ThreadManager
+   {
+      private:
+         double            _maxSpinTime;     //!< Upper bound of the per-thread spin time (seconds)
+         unsigned int      _parkTime;        //!< Maximum time parked before checking for work again (ns)
+         Atomic<int>       _futex;           //!< Futex word, changed on every wake up
+         Atomic<int>       _parked;          //!< Number of threads parked on the futex
+         Atomic<int>       _spinning;        //!< Number of threads in the spinning phase
+
+         bool hasWork( BaseThread *thread ) const;
+         void wakeUp( int count );
+
+      public:
+         AdaptiveThreadManager( unsigned int max_spin_time, unsigned int park_time, bool warmup );
+         virtual ~AdaptiveThreadManager() {}
+         virtual void idle( int& yields
+#ifdef NANOS_INSTRUMENTATION_ENABLED
+                     , unsigned long long& total_yields, unsigned long long& total_blocks
+                     , unsigned long long& time_yields, unsigned long long& time_blocks
+#endif
+                     );
+         virtual void unblockThread(BaseThread*);
+         virtual void notifyReadyTasks();
+   };
+
    //! ThreadManagerConf class
    /*!
     * This class is used to construct the right Thread Manager object.
@@ -196,11 +233,13 @@ namespace nanos {
    class ThreadManagerConf
    {
       private:
-         typedef enum { TM_UNDEFINED = 0, TM_NONE, TM_NANOS, TM_DLB } ThreadManagerOption;
+         typedef enum { TM_UNDEFINED = 0, TM_NONE, TM_NANOS, TM_DLB, TM_ADAPTIVE } ThreadManagerOption;
 
          ThreadManagerOption  _tm;              //!< Thread Manager name option
          unsigned int         _numYields;       //!< Number of yields before block
          unsigned int         _sleepTime;       //!< Number of nanoseconds to sleep
+         unsigned int         _maxSpinTime;     //!< Maximum number of nanoseconds to spin before parking (adaptive)
+         unsigned int         _parkTime;        //!< Maximum number of nanoseconds parked (adaptive)
          bool                 _useYield;        //!< Yield is enabled
          bool                 _useBlock;        //!< Block is enabled
          bool                 _useSleep;        //!< Sleep is enabled
@@ -211,6 +250,8 @@ namespace nanos {
       public:
          static const unsigned int DEFAULT_SLEEP_NS;
          static const unsigned int DEFAULT_YIELDS;
+         static const unsigned int DEFAULT_MAX_SPIN_NS;
+         static const unsigned int DEFAULT_PARK_NS;
 
          ThreadManagerConf();
 
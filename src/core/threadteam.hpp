@@ -259,6 +259,41 @@ inline void ThreadTeam::computeVectorReductions ( void )
    }
 }
 
+inline void ThreadTeam::combineVectorReductions ( unsigned first, unsigned count )
+{
+   nanos_reduction_t *red;
+   ReductionList::iterator it;
+   for ( it = _redList.begin(); it != _redList.end(); it++) {
+      red = *it;
+      if ( red->vop ) continue;
+
+      char *privates = reinterpret_cast<char*>(red->privates);
+      char *target = privates + first * red->element_size;
+      for ( unsigned i = first + 1; i < first + count; i++ ) {
+         red->bop(target, privates + i * red->element_size, red->num_scalars);
+      }
+   }
+}
+
+inline void ThreadTeam::computeVectorReductions ( unsigned stride )
+{
+   nanos_reduction_t *red;
+   ReductionList::iterator it;
+   for ( it = _redList.begin(); it != _redList.end(); it++) {
+      red = *it;
+      if ( red->vop ) {
+         red->vop( this->size(), red->original, red->privates );
+      } else {
+         unsigned i;
+         char *privates = reinterpret_cast<char*>(red->privates);
+         for ( i = 0; i < this->size(); i += stride ) {
+             char* current = privates + i * red->element_size;
+             red->bop(red->original, current, red->num_scalars);
+         }
+      }
+   }
+}
+
 inline void *ThreadTeam::getReductionPrivateData ( void* s )
 {
    ReductionList::iterator it;
@@ -213,6 +213,18 @@ namespace nanos {
          */
          void computeVectorReductions ( void );
 
+        /*! \brief Combines the private copies of threads [first, first+count) into the one of 'first'
+         *
+         *  Only reductions with a scalar combiner (bop) are combined, vector combiners (vop) need all the
+         *  private copies and they are left untouched.
+         */
+         void combineVectorReductions ( unsigned first, unsigned count );
+
+        /*! \brief Compute reduction once private copies have been combined in groups of 'stride' threads
+         *  \see combineVectorReductions
+         */
+         void computeVectorReductions ( unsigned stride );
+
         /*! \brief Get final size
          */
          size_t getFinalSize ( void ) const;
@@ -34,3 +34,43 @@ void WDDeque::initDeviceList()
    }
 }
 
+WDBucketPriorityQueue::WDBucketPriorityQueue( bool enableDeviceCounter )
+   : _buckets(), _lastBucket( _buckets.end() ), _lock(), _nelems( 0 ), _ndevs(), _deviceCounter( enableDeviceCounter ),
+     _maxPriority( 0 ), _minPriority( 0 )
+{
+   if ( _deviceCounter ) {
+      DeviceList devs = sys.getSupportedDevices();
+
+      for ( DeviceList::iterator it = devs.begin(); it != devs.end(); it++ ) {
+         const Device * dev = *it;
+         Atomic<unsigned int> num = 0;
+         _ndevs.insert( std::make_pair( dev, num ) );
+      }
+   }
+}
+
+WDStealDeque::WDArray * WDStealDeque::WDArray::grow ( long bottom, long top ) const
+{
+   WDArray *a = NEW WDArray( capacity() * 2 );
+   for ( long i = top; i < bottom; i++ ) {
+      a->put( i, get( i ) );
+   }
+   return a;
+}
+
+WDStealDeque::~WDStealDeque()
+{
+   ensure( empty(), "Destroying non-empty queue" );
+   for ( RetiredArrays::iterator it = _retired.begin(); it != _retired.end(); it++ ) {
+      delete *it;
+   }
+   delete _array;
+}
+
+WDMPMCQueue::~WDMPMCQueue()
+{
+   ensure( empty(), "Destroying non-empty queue" );
+   for ( Rings::iterator it = _rings.begin(); it != _rings.end(); it++ ) {
+      delete *it;
+   }
+}
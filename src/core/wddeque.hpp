@@ -528,6 +528,652 @@ inline bool WDLFQueue::removeWD( BaseThread *thread, WorkDescriptor *toRem, Work
    return false;
 }
 
+/****************
+ * WDStealDeque *
+ ****************/
+
+inline WDStealDeque::WDStealDeque( long capacity ) : _top( 0 ), _bottom( 0 ), _array( NEW WDArray( capacity ) ),
+   _owner( NULL ), _overflow(), _overflowSize( 0 ), _lock(), _retired()
+{
+   fatal_cond( capacity <= 0 || ( capacity & ( capacity - 1 ) ) != 0, "WDStealDeque capacity must be a power of two" );
+}
+
+inline void WDStealDeque::setOwner ( BaseThread *owner )
+{
+   if ( _owner == NULL ) _owner = owner;
+}
+
+inline bool WDStealDeque::empty ( void ) const
+{
+   return _bottom.value() <= _top.value() && _overflowSize.value() == 0;
+}
+
+inline size_t WDStealDeque::size() const
+{
+   long n = _bottom.value() - _top.value();
+   return ( n > 0 ? (size_t) n : 0 ) + _overflowSize.value();
+}
+
+inline void WDStealDeque::pushBottom ( WorkDescriptor *wd )
+{
+   long b = _bottom.value();
+   long t = _top.value();
+   WDArray *a = _array;
+
+   if ( b - t >= a->capacity() - 1 ) {
+      // Thieves may still be reading the old array, it is released with the deque
+      _retired.push_back( a );
+      a = a->grow( b, t );
+      _array = a;
+   }
+   a->put( b, wd );
+   // Publish the element before the new bottom
+   memoryFence();
+   _bottom = b + 1;
+}
+
+inline WorkDescriptor * WDStealDeque::popBottom ()
+{
+   long b = _bottom.value() - 1;
+   WDArray *a = _array;
+   _bottom = b;
+   // Store-load ordering between _bottom and _top is required against a concurrent popTop
+   __sync_synchronize();
+   long t = _top.value();
+
+   if ( t > b ) {
+      _bottom = t;
+      return NULL;
+   }
+
+   WorkDescriptor *wd = a->get( b );
+   if ( t == b ) {
+      // Last element: race with thieves for it
+      if ( !compareAndSwap( &_top.override(), t, t + 1 ) ) wd = NULL;
+      _bottom = t + 1;
+   }
+   return wd;
+}
+
+inline WorkDescriptor * WDStealDeque::popTop ()
+{
+   long t = _top.value();
+   memoryFence();
+   long b = _bottom.value();
+
+   if ( t >= b ) return NULL;
+
+   WDArray *a = _array;
+   WorkDescriptor *wd = a->get( t );
+   if ( !compareAndSwap( &_top.override(), t, t + 1 ) ) return NULL;
+
+   return wd;
+}
+
+inline void WDStealDeque::pushOverflow ( WorkDescriptor *wd, bool front )
+{
+   if ( front ) _overflow.push_front( wd );
+   else _overflow.push_back( wd );
+   _overflowSize++;
+}
+
+inline void WDStealDeque::push_front ( WorkDescriptor *wd )
+{
+   wd->setMyQueue( this );
+   // TLS must be reloaded: this can be reached from a WD that has migrated
+   if ( getMyThreadSafe() == _owner ) {
+      pushBottom( wd );
+   } else {
+      LockBlock lock( _lock );
+      pushOverflow( wd, true );
+   }
+
+   int tasks = ++( sys.getSchedulerStats()._readyTasks );
+   increaseTasksInQueues(tasks);
+}
+
+inline void WDStealDeque::push_back ( WorkDescriptor *wd )
+{
+   wd->setMyQueue( this );
+   {
+      LockBlock lock( _lock );
+      pushOverflow( wd, false );
+   }
+
+   int tasks = ++( sys.getSchedulerStats()._readyTasks );
+   increaseTasksInQueues(tasks);
+}
+
+inline Lock& WDStealDeque::getLock()
+{
+   return _lock;
+}
+
+inline void WDStealDeque::push_front( WD** wds, size_t numElems )
+{
+   {
+      LockBlock lock( _lock );
+      for( size_t i = 0; i < numElems; ++i )
+      {
+         wds[i]->setMyQueue( this );
+         pushOverflow( wds[i], true );
+      }
+   }
+   int tasks = sys.getSchedulerStats()._readyTasks += numElems;
+   increaseTasksInQueues(tasks,numElems);
+}
+
+inline void WDStealDeque::push_back( WD** wds, size_t numElems )
+{
+   {
+      LockBlock lock( _lock );
+      for( size_t i = 0; i < numElems; ++i )
+      {
+         wds[i]->setMyQueue( this );
+         pushOverflow( wds[i], false );
+      }
+   }
+   int tasks = sys.getSchedulerStats()._readyTasks += numElems;
+   increaseTasksInQueues(tasks,numElems);
+}
+
+inline WorkDescriptor * WDStealDeque::pop_front ( BaseThread *thread )
+{
+   return popFrontWithConstraints<NoConstraints>(thread);
+}
+
+inline WorkDescriptor * WDStealDeque::pop_back ( BaseThread *thread )
+{
+   return popBackWithConstraints<NoConstraints>(thread);
+}
+
+inline bool WDStealDeque::removeWD( BaseThread *thread, WorkDescriptor *toRem, WorkDescriptor **next )
+{
+   return removeWDWithConstraints<NoConstraints>(thread,toRem,next);
+}
+
+template <typename Constraints>
+inline WorkDescriptor * WDStealDeque::take ( BaseThread const *thread, WorkDescriptor *wd, bool owner )
+{
+   WorkDescriptor *found = NULL;
+
+   if ( !Scheduler::checkBasicConstraints( *wd, *thread ) || !Constraints::check( *wd, *thread ) ) {
+      // Leave it where any other thread can find it
+      LockBlock lock( _lock );
+      pushOverflow( wd, false );
+      return NULL;
+   }
+
+   if ( wd->dequeue( &found ) ) {
+      wd->setMyQueue( NULL );
+      int tasks = --(sys.getSchedulerStats()._readyTasks);
+      decreaseTasksInQueues(tasks);
+   } else {
+      // Sliced WD: the remaining part stays queued
+      if ( owner ) pushBottom( wd );
+      else {
+         LockBlock lock( _lock );
+         pushOverflow( wd, true );
+      }
+   }
+
+   return found;
+}
+
+template <typename Constraints>
+inline WorkDescriptor * WDStealDeque::popOverflowWithConstraints ( BaseThread const *thread )
+{
+   WorkDescriptor *found = NULL;
+
+   if ( _overflowSize.value() == 0 ) return NULL;
+
+   LockBlock lock( _lock );
+
+   for ( Overflow::iterator it = _overflow.begin(); it != _overflow.end(); it++ ) {
+      WD &wd = *(WD *)*it;
+      if ( Scheduler::checkBasicConstraints( wd, *thread) && Constraints::check(wd,*thread) ) {
+         if ( wd.dequeue( &found ) ) {
+            _overflow.erase( it );
+            _overflowSize--;
+            wd.setMyQueue( NULL );
+            int tasks = --(sys.getSchedulerStats()._readyTasks);
+            decreaseTasksInQueues(tasks);
+         }
+         break;
+      }
+   }
+
+   return found;
+}
+
+template <typename Constraints>
+inline WorkDescriptor * WDStealDeque::popFrontWithConstraints ( BaseThread const *thread )
+{
+   WorkDescriptor *found = NULL;
+   bool owner = ( thread == _owner && getMyThreadSafe() == _owner );
+
+   if ( empty() ) return NULL;
+
+   WorkDescriptor *wd = owner ? popBottom() : popTop();
+   if ( wd != NULL ) found = take<Constraints>( thread, wd, owner );
+   if ( found == NULL ) found = popOverflowWithConstraints<Constraints>( thread );
+
+   ensure( !found || !found->isTied() || found->isTiedTo() == thread, "" );
+
+   return found;
+}
+
+template <typename Constraints>
+inline WorkDescriptor * WDStealDeque::popBackWithConstraints ( BaseThread const *thread )
+{
+   WorkDescriptor *found = NULL;
+
+   if ( empty() ) return NULL;
+
+   WorkDescriptor *wd = popTop();
+   if ( wd != NULL ) found = take<Constraints>( thread, wd, false );
+   if ( found == NULL ) found = popOverflowWithConstraints<Constraints>( thread );
+
+   ensure( !found || !found->isTied() || found->isTiedTo() == thread, "" );
+
+   return found;
+}
+
+template <typename Constraints>
+inline bool WDStealDeque::removeWDWithConstraints( BaseThread *thread, WorkDescriptor *toRem, WorkDescriptor **next )
+{
+   if ( toRem->getMyQueue() != this ) return false;
+
+   if ( !Scheduler::checkBasicConstraints( *toRem, *thread) || !Constraints::check(*toRem, *thread) ) return false;
+
+   *next = NULL;
+
+   // The WD is at the top of the circular array
+   long t = _top.value();
+   memoryFence();
+   if ( t < _bottom.value() && _array->get( t ) == toRem ) {
+      if ( compareAndSwap( &_top.override(), t, t + 1 ) ) {
+         if ( toRem->dequeue( next ) ) {
+            toRem->setMyQueue( NULL );
+            int tasks = --(sys.getSchedulerStats()._readyTasks);
+            decreaseTasksInQueues(tasks);
+         } else {
+            LockBlock lock( _lock );
+            pushOverflow( toRem, true );
+         }
+         return true;
+      }
+      return false;
+   }
+
+   // The WD is in the overflow list
+   if ( _overflowSize.value() == 0 ) return false;
+
+   LockBlock lock( _lock );
+   for ( Overflow::iterator it = _overflow.begin(); it != _overflow.end(); it++ ) {
+      if ( *it == toRem ) {
+         if ( toRem->dequeue( next ) ) {
+            _overflow.erase( it );
+            _overflowSize--;
+            toRem->setMyQueue( NULL );
+            int tasks = --(sys.getSchedulerStats()._readyTasks);
+            decreaseTasksInQueues(tasks);
+         }
+         return true;
+      }
+   }
+
+   return false;
+}
+
+inline void WDStealDeque::increaseTasksInQueues( int tasks, int increment )
+{
+   NANOS_INSTRUMENT(static nanos_event_key_t key = sys.getInstrumentation()->getInstrumentationDictionary()->getEventKey("num-ready");)
+   NANOS_INSTRUMENT( nanos_event_value_t nb =  (nanos_event_value_t ) tasks );
+   NANOS_INSTRUMENT(sys.getInstrumentation()->raisePointEvents(1, &key, &nb );)
+}
+
+inline void WDStealDeque::decreaseTasksInQueues( int tasks, int decrement )
+{
+   NANOS_INSTRUMENT(static nanos_event_key_t key = sys.getInstrumentation()->getInstrumentationDictionary()->getEventKey("num-ready");)
+   NANOS_INSTRUMENT( nanos_event_value_t nb =  (nanos_event_value_t ) tasks );
+   NANOS_INSTRUMENT(sys.getInstrumentation()->raisePointEvents(1, &key, &nb );)
+}
+
+/***************
+ * WDMPMCQueue *
+ ***************/
+
+inline WDMPMCQueue::WDRing::WDRing ( long capacity ) : _head( 0 ), _tail( 0 ), _mask( capacity - 1 ),
+   _cells( NEW Cell[capacity] )
+{
+   for ( long i = 0; i < capacity; i++ ) {
+      _cells[i]._sequence = i;
+      _cells[i]._wd = NULL;
+   }
+}
+
+inline size_t WDMPMCQueue::WDRing::size () const
+{
+   long n = _tail.value() - _head.value();
+   return n > 0 ? (size_t) n : 0;
+}
+
+inline bool WDMPMCQueue::WDRing::push ( WorkDescriptor *wd )
+{
+   long pos = _tail.value();
+   Cell *cell;
+
+   while ( true ) {
+      cell = &_cells[pos & _mask];
+      long diff = cell->_sequence.value() - pos;
+      if ( diff == 0 ) {
+         if ( compareAndSwap( &_tail.override(), pos, pos + 1 ) ) break;
+         pos = _tail.value();
+      } else if ( diff < 0 ) {
+         // The cell still holds a WD of the previous lap
+         return false;
+      } else {
+         pos = _tail.value();
+      }
+   }
+
+   cell->_wd = wd;
+   // Publish the WD before the cell is marked as full
+   memoryFence();
+   cell->_sequence = pos + 1;
+   return true;
+}
+
+inline WorkDescriptor * WDMPMCQueue::WDRing::pop ()
+{
+   long pos = _head.value();
+   Cell *cell;
+
+   while ( true ) {
+      cell = &_cells[pos & _mask];
+      long diff = cell->_sequence.value() - ( pos + 1 );
+      if ( diff == 0 ) {
+         if ( compareAndSwap( &_head.override(), pos, pos + 1 ) ) break;
+         pos = _head.value();
+      } else if ( diff < 0 ) {
+         return NULL;
+      } else {
+         pos = _head.value();
+      }
+   }
+
+   WorkDescriptor *wd = cell->_wd;
+   memoryFence();
+   // Free the cell for the next lap
+   cell->_sequence = pos + _mask + 1;
+   return wd;
+}
+
+inline bool WDMPMCQueue::WDRing::popIf ( WorkDescriptor *wd )
+{
+   long pos = _head.value();
+   Cell *cell = &_cells[pos & _mask];
+
+   if ( cell->_sequence.value() != pos + 1 || cell->_wd != wd ) return false;
+   // If the cell was reused meanwhile, _head has moved on and the CAS fails
+   if ( !compareAndSwap( &_head.override(), pos, pos + 1 ) ) return false;
+
+   memoryFence();
+   cell->_sequence = pos + _mask + 1;
+   return true;
+}
+
+inline WDMPMCQueue::WDMPMCQueue( long capacity ) : _devices(), _rings(), _overflow(), _overflowSize( 0 ), _lock()
+{
+   fatal_cond( capacity <= 0 || ( capacity & ( capacity - 1 ) ) != 0, "WDMPMCQueue capacity must be a power of two" );
+
+   DeviceList &devs = sys.getSupportedDevices();
+   for ( DeviceList::iterator it = devs.begin(); it != devs.end(); it++ ) {
+      _devices.push_back( *it );
+      _rings.push_back( NEW WDRing( capacity ) );
+   }
+}
+
+inline bool WDMPMCQueue::empty ( void ) const
+{
+   return size() == 0;
+}
+
+inline size_t WDMPMCQueue::size() const
+{
+   size_t n = _overflowSize.value();
+   for ( Rings::const_iterator it = _rings.begin(); it != _rings.end(); it++ ) {
+      n += (*it)->size();
+   }
+   return n;
+}
+
+inline WDMPMCQueue::WDRing * WDMPMCQueue::getRing ( WorkDescriptor *wd ) const
+{
+   if ( wd->getNumDevices() != 1 ) return NULL;
+
+   const Device *dev = wd->getDevices()[0]->getDevice();
+   for ( size_t i = 0; i < _devices.size(); i++ ) {
+      if ( _devices[i] == dev ) return _rings[i];
+   }
+   return NULL;
+}
+
+inline void WDMPMCQueue::pushOverflow ( WorkDescriptor *wd, bool front )
+{
+   if ( front ) _overflow.push_front( wd );
+   else _overflow.push_back( wd );
+   _overflowSize++;
+}
+
+inline void WDMPMCQueue::push ( WorkDescriptor *wd, bool front )
+{
+   WDRing *ring = front ? NULL : getRing( wd );
+
+   if ( ring == NULL || !ring->push( wd ) ) {
+      LockBlock lock( _lock );
+      pushOverflow( wd, front );
+   }
+}
+
+inline void WDMPMCQueue::push_front ( WorkDescriptor *wd )
+{
+   wd->setMyQueue( this );
+   push( wd, true );
+
+   int tasks = ++( sys.getSchedulerStats()._readyTasks );
+   increaseTasksInQueues(tasks);
+}
+
+inline void WDMPMCQueue::push_back ( WorkDescriptor *wd )
+{
+   wd->setMyQueue( this );
+   push( wd, false );
+
+   int tasks = ++( sys.getSchedulerStats()._readyTasks );
+   increaseTasksInQueues(tasks);
+}
+
+inline Lock& WDMPMCQueue::getLock()
+{
+   return _lock;
+}
+
+inline void WDMPMCQueue::push_front( WD** wds, size_t numElems )
+{
+   {
+      LockBlock lock( _lock );
+      for( size_t i = 0; i < numElems; ++i )
+      {
+         wds[i]->setMyQueue( this );
+         pushOverflow( wds[i], true );
+      }
+   }
+   int tasks = sys.getSchedulerStats()._readyTasks += numElems;
+   increaseTasksInQueues(tasks,numElems);
+}
+
+inline void WDMPMCQueue::push_back( WD** wds, size_t numElems )
+{
+   for( size_t i = 0; i < numElems; ++i )
+   {
+      wds[i]->setMyQueue( this );
+      push( wds[i], false );
+   }
+   int tasks = sys.getSchedulerStats()._readyTasks += numElems;
+   increaseTasksInQueues(tasks,numElems);
+}
+
+inline WorkDescriptor * WDMPMCQueue::pop_front ( BaseThread *thread )
+{
+   return popFrontWithConstraints<NoConstraints>(thread);
+}
+
+inline WorkDescriptor * WDMPMCQueue::pop_back ( BaseThread *thread )
+{
+   return popBackWithConstraints<NoConstraints>(thread);
+}
+
+inline bool WDMPMCQueue::removeWD( BaseThread *thread, WorkDescriptor *toRem, WorkDescriptor **next )
+{
+   return removeWDWithConstraints<NoConstraints>(thread,toRem,next);
+}
+
+template <typename Constraints>
+inline WorkDescriptor * WDMPMCQueue::take ( BaseThread const *thread, WorkDescriptor *wd )
+{
+   WorkDescriptor *found = NULL;
+
+   if ( !Scheduler::checkBasicConstraints( *wd, *thread ) || !Constraints::check( *wd, *thread ) ) {
+      // Leave it where any other thread can find it
+      LockBlock lock( _lock );
+      pushOverflow( wd, false );
+      return NULL;
+   }
+
+   if ( wd->dequeue( &found ) ) {
+      wd->setMyQueue( NULL );
+      int tasks = --(sys.getSchedulerStats()._readyTasks );
+      decreaseTasksInQueues(tasks);
+   } else {
+      // Sliced WD: the remaining part stays queued
+      LockBlock lock( _lock );
+      pushOverflow( wd, true );
+   }
+
+   return found;
+}
+
+template <typename Constraints>
+inline WorkDescriptor * WDMPMCQueue::popOverflowWithConstraints ( BaseThread const *thread )
+{
+   WorkDescriptor *found = NULL;
+
+   if ( _overflowSize.value() == 0 ) return NULL;
+
+   LockBlock lock( _lock );
+
+   for ( Overflow::iterator it = _overflow.begin(); it != _overflow.end(); it++ ) {
+      WD &wd = *(WD *)*it;
+      if ( Scheduler::checkBasicConstraints( wd, *thread) && Constraints::check(wd,*thread) ) {
+         if ( wd.dequeue( &found ) ) {
+            _overflow.erase( it );
+            _overflowSize--;
+            wd.setMyQueue( NULL );
+            int tasks = --(sys.getSchedulerStats()._readyTasks);
+            decreaseTasksInQueues(tasks);
+         }
+         break;
+      }
+   }
+
+   return found;
+}
+
+template <typename Constraints>
+inline WorkDescriptor * WDMPMCQueue::popFrontWithConstraints ( BaseThread const *thread )
+{
+   WorkDescriptor *found = NULL;
+
+   // Front pushes and rejected WDs are in the overflow list
+   found = popOverflowWithConstraints<Constraints>( thread );
+
+   for ( size_t i = 0; found == NULL && i < _rings.size(); i++ ) {
+      if ( !thread->runningOn()->supports( *_devices[i] ) ) continue;
+
+      WorkDescriptor *wd = _rings[i]->pop();
+      if ( wd != NULL ) found = take<Constraints>( thread, wd );
+   }
+
+   ensure( !found || !found->isTied() || found->isTiedTo() == thread, "" );
+
+   return found;
+}
+
+template <typename Constraints>
+inline WorkDescriptor * WDMPMCQueue::popBackWithConstraints ( BaseThread const *thread )
+{
+   return popFrontWithConstraints<Constraints>( thread );
+}
+
+template <typename Constraints>
+inline bool WDMPMCQueue::removeWDWithConstraints( BaseThread *thread, WorkDescriptor *toRem, WorkDescriptor **next )
+{
+   if ( toRem->getMyQueue() != this ) return false;
+
+   if ( !Scheduler::checkBasicConstraints( *toRem, *thread) || !Constraints::check(*toRem, *thread) ) return false;
+
+   *next = NULL;
+
+   // The WD is the oldest one of its ring
+   WDRing *ring = getRing( toRem );
+   if ( ring != NULL && ring->popIf( toRem ) ) {
+      if ( toRem->dequeue( next ) ) {
+         toRem->setMyQueue( NULL );
+         int tasks = --(sys.getSchedulerStats()._readyTasks);
+         decreaseTasksInQueues(tasks);
+      } else {
+         LockBlock lock( _lock );
+         pushOverflow( toRem, true );
+      }
+      return true;
+   }
+
+   // The WD is in the overflow list
+   if ( _overflowSize.value() == 0 ) return false;
+
+   LockBlock lock( _lock );
+   for ( Overflow::iterator it = _overflow.begin(); it != _overflow.end(); it++ ) {
+      if ( *it == toRem ) {
+         if ( toRem->dequeue( next ) ) {
+            _overflow.erase( it );
+            _overflowSize--;
+            toRem->setMyQueue( NULL );
+            int tasks = --(sys.getSchedulerStats()._readyTasks);
+            decreaseTasksInQueues(tasks);
+         }
+         return true;
+      }
+   }
+
+   return false;
+}
+
+inline void WDMPMCQueue::increaseTasksInQueues( int tasks, int increment )
+{
+   NANOS_INSTRUMENT(static nanos_event_key_t key = sys.getInstrumentation()->getInstrumentationDictionary()->getEventKey("num-ready");)
+   NANOS_INSTRUMENT( nanos_event_value_t nb =  (nanos_event_value_t ) tasks );
+   NANOS_INSTRUMENT(sys.getInstrumentation()->raisePointEvents(1, &key, &nb );)
+}
+
+inline void WDMPMCQueue::decreaseTasksInQueues( int tasks, int decrement )
+{
+   NANOS_INSTRUMENT(static nanos_event_key_t key = sys.getInstrumentation()->getInstrumentationDictionary()->getEventKey("num-ready");)
+   NANOS_INSTRUMENT( nanos_event_value_t nb =  (nanos_event_value_t ) tasks );
+   NANOS_INSTRUMENT(sys.getInstrumentation()->raisePointEvents(1, &key, &nb );)
+}
+
 template <typename T>
 inline WDPriorityQueue<T>::WDPriorityQueue( bool enableDeviceCounter, bool optimise, bool reverse, PriorityValueFun getter )
    : _dq(), _lock(), _nelems(0), _optimise( optimise ), _reverse( reverse ), _ndevs(), _deviceCounter( enableDeviceCounter ),
@@ -1012,6 +1658,313 @@ inline bool WDPriorityQueue<T>::testDequeue()
    return false;
 }
 
+inline bool WDBucketPriorityQueue::empty ( void ) const
+{
+   return _nelems == 0;
+}
+
+inline size_t WDBucketPriorityQueue::size() const
+{
+   return _nelems;
+}
+
+inline Lock& WDBucketPriorityQueue::getLock()
+{
+   return _lock;
+}
+
+inline WDBucketPriorityQueue::Bucket & WDBucketPriorityQueue::getBucket ( WD::PriorityType priority )
+{
+   // Consecutive insertions usually have the same priority
+   if ( _lastBucket != _buckets.end() && _lastBucket->first == priority ) return _lastBucket->second;
+
+   BucketMap::iterator it = _buckets.lower_bound( priority );
+   if ( it == _buckets.end() || it->first != priority ) {
+      it = _buckets.insert( it, std::make_pair( priority, Bucket() ) );
+   }
+   _lastBucket = it;
+
+   return it->second;
+}
+
+inline void WDBucketPriorityQueue::updatePriorities ()
+{
+   if ( _buckets.empty() ) {
+      _maxPriority = 0;
+      _minPriority = 0;
+   } else {
+      _maxPriority = _buckets.begin()->first;
+      _minPriority = _buckets.rbegin()->first;
+   }
+}
+
+inline void WDBucketPriorityQueue::updateDeviceCounters ( WorkDescriptor *wd, int increment )
+{
+   if ( _deviceCounter ) {
+      for ( unsigned int i = 0; i < wd->getNumDevices(); i++ ) {
+         _ndevs[( wd->getDevices()[i]->getDevice() )] += increment;
+      }
+   }
+}
+
+inline void WDBucketPriorityQueue::insertOrdered ( WorkDescriptor *wd, bool fifo )
+{
+   Bucket &bucket = getBucket( wd->getPriority() );
+
+   if ( fifo ) bucket.push_back( wd );
+   else bucket.push_front( wd );
+
+   updatePriorities();
+}
+
+inline bool WDBucketPriorityQueue::find ( WorkDescriptor *wd, BucketMap::iterator &bit, Bucket::iterator &it )
+{
+   // The WD usually is in the bucket of its priority, unless it has just been changed
+   bit = _buckets.find( wd->getPriority() );
+   if ( bit != _buckets.end() ) {
+      it = std::find( bit->second.begin(), bit->second.end(), wd );
+      if ( it != bit->second.end() ) return true;
+   }
+
+   for ( bit = _buckets.begin(); bit != _buckets.end(); bit++ ) {
+      it = std::find( bit->second.begin(), bit->second.end(), wd );
+      if ( it != bit->second.end() ) return true;
+   }
+
+   return false;
+}
+
+inline void WDBucketPriorityQueue::erase ( BucketMap::iterator bit, Bucket::iterator it )
+{
+   bit->second.erase( it );
+
+   if ( bit->second.empty() ) {
+      if ( _lastBucket == bit ) _lastBucket = _buckets.end();
+      _buckets.erase( bit );
+      updatePriorities();
+   }
+}
+
+inline void WDBucketPriorityQueue::push_back ( WorkDescriptor *wd )
+{
+   wd->setMyQueue( this );
+   {
+      LockBlock lock( _lock );
+      insertOrdered( wd, true );
+      updateDeviceCounters( wd, 1 );
+      int tasks = ++( sys.getSchedulerStats()._readyTasks );
+      increaseTasksInQueues(tasks);
+      memoryFence();
+   }
+}
+
+inline void WDBucketPriorityQueue::push_front ( WorkDescriptor *wd )
+{
+   wd->setMyQueue( this );
+   {
+      LockBlock lock( _lock );
+      insertOrdered( wd, false );
+      updateDeviceCounters( wd, 1 );
+      int tasks = ++( sys.getSchedulerStats()._readyTasks );
+      increaseTasksInQueues(tasks);
+      memoryFence();
+   }
+}
+
+inline void WDBucketPriorityQueue::push_front( WD** wds, size_t numElems )
+{
+   LockBlock lock( _lock );
+   for( size_t i = 0; i < numElems; ++i )
+   {
+      WD* wd = wds[i];
+      wd->setMyQueue( this );
+      insertOrdered( wd, false );
+      updateDeviceCounters( wd, 1 );
+   }
+   int tasks = sys.getSchedulerStats()._readyTasks += numElems;
+   increaseTasksInQueues(tasks,numElems);
+}
+
+inline void WDBucketPriorityQueue::push_back( WD** wds, size_t numElems )
+{
+   LockBlock lock( _lock );
+   fatal_cond( numElems == 0, "No reason to call push_back for 0 elements" );
+   for( size_t i = 0; i < numElems; ++i )
+   {
+      WD* wd = wds[i];
+      wd->setMyQueue( this );
+      insertOrdered( wd, true );
+      updateDeviceCounters( wd, 1 );
+   }
+   int tasks = sys.getSchedulerStats()._readyTasks += numElems;
+   increaseTasksInQueues(tasks,numElems);
+}
+
+inline WorkDescriptor * WDBucketPriorityQueue::pop_back ( BaseThread *thread )
+{
+   return popBackWithConstraints<NoConstraints>(thread);
+}
+
+inline WorkDescriptor * WDBucketPriorityQueue::pop_front ( BaseThread *thread )
+{
+   return popFrontWithConstraints<NoConstraints>(thread);
+}
+
+inline bool WDBucketPriorityQueue::removeWD( BaseThread *thread, WorkDescriptor *toRem, WorkDescriptor **next )
+{
+   return removeWDWithConstraints<NoConstraints>(thread,toRem,next);
+}
+
+// Only ensures tie semantics
+template <typename Constraints>
+inline WorkDescriptor * WDBucketPriorityQueue::popFrontWithConstraints ( BaseThread *thread )
+{
+   WorkDescriptor *found = NULL;
+
+   if ( empty() )
+      return NULL;
+   {
+      LockBlock lock( _lock );
+
+      memoryFence();
+
+      // Buckets are sorted from the highest priority, look for the first WD that can run here
+      bool checked = false;
+      for ( BucketMap::iterator bit = _buckets.begin(); bit != _buckets.end(); ++bit ) {
+         Bucket &bucket = bit->second;
+         for ( Bucket::iterator it = bucket.begin(); it != bucket.end(); ++it ) {
+            WD &wd = *(WD *)*it;
+            if ( Scheduler::checkBasicConstraints( wd, *thread) && Constraints::check(wd,*thread)) {
+               if ( wd.dequeue( &found ) ) {
+                  erase( bit, it );
+                  updateDeviceCounters( &wd, -1 );
+                  int tasks = --(sys.getSchedulerStats()._readyTasks);
+                  decreaseTasksInQueues(tasks);
+               }
+               checked = true;
+               break;
+            }
+         }
+         // Note that bit may have been erased
+         if ( checked ) break;
+      }
+
+      if ( found != NULL ) found->setMyQueue( NULL );
+
+   }
+
+   ensure( !found || !found->isTied() || found->isTiedTo() == thread, "" );
+
+   return found;
+}
+
+/*!
+ * \note As in WDPriorityQueue, this is implemented as popFrontWithConstraints
+ */
+template <typename Constraints>
+inline WorkDescriptor * WDBucketPriorityQueue::popBackWithConstraints ( BaseThread *thread )
+{
+   return popFrontWithConstraints<Constraints>( thread );
+}
+
+template <typename Constraints>
+inline bool WDBucketPriorityQueue::removeWDWithConstraints( BaseThread *thread, WorkDescriptor *toRem, WorkDescriptor **next )
+{
+   if ( empty() ) return false;
+
+   if ( !Scheduler::checkBasicConstraints( *toRem, *thread) || !Constraints::check(*toRem, *thread) ) return false;
+
+   *next = NULL;
+
+   {
+      LockBlock lock( _lock );
+
+      memoryFence();
+
+      BucketMap::iterator bit;
+      Bucket::iterator it;
+      if ( toRem->getMyQueue() == this && find( toRem, bit, it ) ) {
+         if ( toRem->dequeue( next ) ) {
+            erase( bit, it );
+            updateDeviceCounters( toRem, -1 );
+            int tasks = --(sys.getSchedulerStats()._readyTasks);
+            decreaseTasksInQueues(tasks);
+         }
+         (*next)->setMyQueue( NULL );
+         return true;
+      }
+   }
+
+   return false;
+}
+
+inline bool WDBucketPriorityQueue::reorderWD( WorkDescriptor *wd )
+{
+   // WDs that are not ready (e.g. predecessors found by the smart priority
+   // propagation) are not in the queue, do not look for them
+   if ( wd->getMyQueue() != this ) return false;
+
+   LockBlock l( _lock );
+
+   BucketMap::iterator bit;
+   Bucket::iterator it;
+   if ( !find( wd, bit, it ) ) return false;
+
+   // Already in the bucket of its priority
+   if ( bit->first == wd->getPriority() ) return true;
+
+   erase( bit, it );
+   insertOrdered( wd );
+
+   return true;
+}
+
+inline WD::PriorityType WDBucketPriorityQueue::maxPriority() const
+{
+   return _maxPriority;
+}
+
+inline WD::PriorityType WDBucketPriorityQueue::minPriority() const
+{
+   return _minPriority;
+}
+
+inline void WDBucketPriorityQueue::increaseTasksInQueues( int tasks, int increment )
+{
+   NANOS_INSTRUMENT(static nanos_event_key_t key = sys.getInstrumentation()->getInstrumentationDictionary()->getEventKey("num-ready");)
+   NANOS_INSTRUMENT( nanos_event_value_t nb =  (nanos_event_value_t ) tasks );
+   NANOS_INSTRUMENT(sys.getInstrumentation()->raisePointEvents(1, &key, &nb );)
+   _nelems += increment;
+}
+
+inline void WDBucketPriorityQueue::decreaseTasksInQueues( int tasks, int decrement )
+{
+   NANOS_INSTRUMENT(static nanos_event_key_t key = sys.getInstrumentation()->getInstrumentationDictionary()->getEventKey("num-ready");)
+   NANOS_INSTRUMENT( nanos_event_value_t nb =  (nanos_event_value_t ) tasks );
+   NANOS_INSTRUMENT(sys.getInstrumentation()->raisePointEvents(1, &key, &nb );)
+   _nelems -= decrement;
+}
+
+inline bool WDBucketPriorityQueue::testDequeue()
+{
+   if ( empty() )
+      return false;
+
+   // Auxiliary map to count successful commutative accesses
+   std::map<WD**, WD*> comm_accesses;
+   LockBlock lock( _lock );
+   for ( BucketMap::const_iterator bit = _buckets.begin(); bit != _buckets.end(); ++bit ) {
+      for ( Bucket::const_iterator it = bit->second.begin(); it != bit->second.end(); ++it ) {
+         const WD &wd = *(WD *)*it;
+         if ( wd.getConcurrencyLevel( comm_accesses ) > 0 )
+            return true;
+      }
+   }
+
+   return false;
+}
+
+
 } // namespace nanos
 
 #endif
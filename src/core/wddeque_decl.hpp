@@ -21,8 +21,10 @@
 #define _NANOS_LIB_WDDEQUE_DECL_H
 
 #include <list>
+#include <deque>
 #include <functional>
 #include <map>
+#include <vector>
 
 #include "debug.hpp"
 #include "atomic_decl.hpp"
@@ -247,7 +249,140 @@ namespace nanos {
          bool removeWD( BaseThread *thread, WorkDescriptor *toRem, WorkDescriptor **next );
 
    };
-   
+
+   /*! \brief Lock-free work-stealing deque (Chase-Lev).
+    *
+    *  The owner thread pushes and pops WDs at the bottom of a growable circular
+    *  array without locking, while any other thread steals from the top using a
+    *  single CAS. WDs that cannot follow that path (pushes from a thread which is
+    *  not the owner, batch insertions, push_back's and WDs that did not satisfy
+    *  the constraints of the thread that took them) are kept in a small locked
+    *  overflow list which is also checked by pops and steals.
+    *
+    *  \note The owner must be set through setOwner() before the deque is used.
+    */
+   class WDStealDeque : public WDPool
+   {
+      private:
+         /*! \brief Circular array of WDs, indexed by the deque positions
+          */
+         class WDArray
+         {
+            private:
+               long                        _mask;    /**< Capacity - 1 (capacity is a power of two) */
+               WorkDescriptor * volatile  *_items;   /**< Storage */
+            private:
+               /*! \brief WDArray copy constructor (private)
+                */
+               WDArray ( const WDArray & );
+               /*! \brief WDArray copy assignment operator (private)
+                */
+               const WDArray & operator= ( const WDArray & );
+            public:
+               /*! \brief WDArray constructor
+                */
+               WDArray ( long capacity ) : _mask( capacity - 1 ), _items( NEW WorkDescriptor *[capacity] ) {}
+               /*! \brief WDArray destructor
+                */
+               ~WDArray () { delete[] _items; }
+
+               long capacity () const { return _mask + 1; }
+               WorkDescriptor * get ( long i ) const { return _items[i & _mask]; }
+               void put ( long i, WorkDescriptor *wd ) { _items[i & _mask] = wd; }
+
+               /*! \brief Returns a new array with twice the capacity holding the elements in [top, bottom)
+                */
+               WDArray * grow ( long bottom, long top ) const;
+         };
+
+         typedef std::list<WorkDescriptor *> Overflow;
+         typedef std::vector<WDArray *>      RetiredArrays;
+
+         Atomic<long>         _top;              /**< Next position to be stolen */
+         char                 _pad0[64];         /**< Keeps thieves and owner on different cache lines */
+         Atomic<long>         _bottom;           /**< Next position to be pushed by the owner */
+         WDArray * volatile   _array;            /**< Current circular array */
+         BaseThread          *_owner;            /**< Only thread allowed to push/pop at the bottom */
+         char                 _pad1[64];
+         Overflow             _overflow;         /**< WDs out of the lock-free path */
+         Atomic<size_t>       _overflowSize;     /**< Number of elements in _overflow */
+         Lock                 _lock;             /**< Protects _overflow */
+         RetiredArrays        _retired;          /**< Old arrays, thieves may still be reading them */
+
+      private:
+         /*! \brief WDStealDeque copy constructor (private)
+          */
+         WDStealDeque ( const WDStealDeque & );
+         /*! \brief WDStealDeque copy assignment operator (private)
+          */
+         const WDStealDeque & operator= ( const WDStealDeque & );
+
+         /*! \brief Owner push at the bottom of the circular array
+          */
+         void pushBottom ( WorkDescriptor *wd );
+         /*! \brief Owner pop from the bottom of the circular array
+          */
+         WorkDescriptor * popBottom ();
+         /*! \brief CAS-based extraction from the top of the circular array
+          */
+         WorkDescriptor * popTop ();
+
+         /*! \brief Inserts a WD in the overflow list (the lock must be held)
+          */
+         void pushOverflow ( WorkDescriptor *wd, bool front );
+
+         /*! \brief Applies constraints and slicing to a WD removed from the circular array
+          */
+         template <typename Constraints>
+         WorkDescriptor * take ( BaseThread const *thread, WorkDescriptor *wd, bool owner );
+
+         template <typename Constraints>
+         WorkDescriptor * popOverflowWithConstraints ( BaseThread const *thread );
+
+      public:
+         /*! \brief WDStealDeque default constructor
+          */
+         WDStealDeque( long capacity = 256 );
+         /*! \brief WDStealDeque destructor
+          */
+         ~WDStealDeque();
+
+         /*! \brief Sets the thread owning the bottom of the deque (only the first call has effect)
+          */
+         void setOwner ( BaseThread *owner );
+
+         bool empty ( void ) const;
+         size_t size() const;
+
+         void push_front ( WorkDescriptor *wd );
+         void push_back( WorkDescriptor *wd );
+
+         Lock& getLock();
+         void push_front( WD** wds, size_t numElems );
+         void push_back( WD** wds, size_t numElems );
+
+         template <typename Constraints>
+         WorkDescriptor * popFrontWithConstraints ( BaseThread const *thread );
+         template <typename Constraints>
+         WorkDescriptor * popBackWithConstraints ( BaseThread const *thread );
+         template <typename Constraints>
+         bool removeWDWithConstraints( BaseThread *thread, WorkDescriptor *toRem, WorkDescriptor **next );
+
+         /*! \brief Owner: LIFO pop from the bottom. Other threads: steal from the top.
+          */
+         WorkDescriptor * pop_front ( BaseThread *thread );
+         /*! \brief Steals from the top (FIFO), whoever the caller is.
+          */
+         WorkDescriptor * pop_back ( BaseThread *thread );
+
+         /*! \brief Removes a WD only if it is in the overflow list or on the top of the deque
+          */
+         bool removeWD( BaseThread *thread, WorkDescriptor *toRem, WorkDescriptor **next );
+
+         void increaseTasksInQueues( int tasks, int increment = 1 );
+         void decreaseTasksInQueues( int tasks, int decrement = 1 );
+   };
+
    /*! \brief Class used to compare WDs by priority.
     *  \see WDPriorityQueue::push
     */
@@ -411,6 +546,254 @@ namespace nanos {
          bool testDequeue();
    };
 
+   /*! \brief Priority queue where WDs are kept in one bucket per priority value.
+    *
+    *  Buckets are ordered from the highest to the lowest priority, so inserting a WD
+    *  only depends on the number of different priorities in the queue (and is constant
+    *  when it has the same priority as the previous insertion) instead of on the number
+    *  of queued WDs. WDs with the same priority keep the FIFO/LIFO order of the
+    *  push_back/push_front operations, as WDPriorityQueue does.
+    */
+   class WDBucketPriorityQueue : public WDPool
+   {
+      public:
+         typedef std::map< const Device *, Atomic<unsigned int> > WDDeviceCounter;
+
+      private:
+         typedef std::deque<WorkDescriptor *> Bucket;
+         typedef std::map<WD::PriorityType, Bucket, std::greater<WD::PriorityType> > BucketMap;
+
+         BucketMap           _buckets;
+         /*! \brief Bucket used by the last insertion (or _buckets.end()) */
+         BucketMap::iterator _lastBucket;
+         Lock                _lock;
+         size_t              _nelems;
+
+         /*! \brief Counts the number of WDs in the queue for each architecture */
+         WDDeviceCounter     _ndevs;
+         bool                _deviceCounter;
+
+         /*! \brief Max and min priorities found at the queue. */
+         WD::PriorityType    _maxPriority, _minPriority;
+
+      private:
+         /*! \brief WDBucketPriorityQueue copy constructor (private)
+          */
+         WDBucketPriorityQueue ( const WDBucketPriorityQueue & );
+         /*! \brief WDBucketPriorityQueue copy assignment operator (private)
+          */
+         const WDBucketPriorityQueue & operator= ( const WDBucketPriorityQueue & );
+
+         /*! \brief Returns the bucket of the given priority, creating it if needed.
+          */
+         Bucket & getBucket ( WD::PriorityType priority );
+
+         /*! \brief Inserts a WD in the bucket of its priority.
+          *  \param fifo Insert the WD after the ones with the same priority?
+          */
+         void insertOrdered ( WorkDescriptor *wd, bool fifo = true );
+
+         /*! \brief Looks for a WD, first in the bucket of its current priority.
+          *  \return If the WD was found; bit and it are set to its position.
+          */
+         bool find ( WorkDescriptor *wd, BucketMap::iterator &bit, Bucket::iterator &it );
+
+         /*! \brief Removes the WD at the given position, dropping its bucket if it gets empty.
+          */
+         void erase ( BucketMap::iterator bit, Bucket::iterator it );
+
+         /*! \brief Updates the device counters of the given WD.
+          */
+         void updateDeviceCounters ( WorkDescriptor *wd, int increment );
+
+         void updatePriorities ();
+
+      public:
+         /*! \brief WDBucketPriorityQueue default constructor
+          */
+         WDBucketPriorityQueue( bool enableDeviceCounter = true );
+
+         /*! \brief WDBucketPriorityQueue destructor
+          */
+         ~WDBucketPriorityQueue() {}
+
+         bool empty ( void ) const;
+         size_t size() const;
+
+         void push_back( WorkDescriptor *wd );
+         void push_front( WorkDescriptor *wd );
+
+         Lock& getLock();
+         void push_front( WD** wds, size_t numElems );
+         void push_back( WD** wds, size_t numElems );
+
+         template <typename Constraints>
+         WorkDescriptor * popFrontWithConstraints ( BaseThread *thread );
+         template <typename Constraints>
+         WorkDescriptor * popBackWithConstraints ( BaseThread *thread );
+         template <typename Constraints>
+         bool removeWDWithConstraints( BaseThread *thread, WorkDescriptor *toRem, WorkDescriptor **next );
+
+         WorkDescriptor * pop_back ( BaseThread *thread );
+         WorkDescriptor * pop_front ( BaseThread *thread );
+
+         bool removeWD( BaseThread *thread, WorkDescriptor *toRem, WorkDescriptor **next );
+
+         /*! \brief Moves a WD to the bucket of its current priority.
+          * It is needed when the priority of a WD is changed.
+          * \return If the WD was found or not.
+          * \note This method sets the lock upon entry (using LockBlock).
+          */
+         bool reorderWD( WorkDescriptor *wd );
+
+         /*! \brief Returns the highest priority, without blocking.
+          */
+         WD::PriorityType maxPriority() const;
+
+         /*! \brief Returns the lowest priority, without blocking.
+          */
+         WD::PriorityType minPriority() const;
+
+         void increaseTasksInQueues( int tasks, int increment = 1 );
+         void decreaseTasksInQueues( int tasks, int decrement = 1 );
+
+         bool testDequeue();
+   };
+
+   /*! \brief Lock-free multi-producer multi-consumer queue with one sub-queue per device
+    *
+    *  WDs with a single implementation are kept in the bounded ring of their device, so a
+    *  thread only looks at the rings of the devices its PE supports. Rings are lock-free
+    *  (every cell has a sequence number telling whether it is free or holds a WD of the
+    *  current lap). WDs with several implementations, WDs pushed while their ring is full
+    *  and WDs rejected by the constraints of the thread that took them go to a locked
+    *  overflow list, which is only looked at when it is not empty.
+    */
+   class WDMPMCQueue : public WDPool
+   {
+      private:
+         /*! \brief Bounded FIFO ring of WDs
+          */
+         class WDRing
+         {
+            private:
+               struct Cell {
+                  Atomic<long>               _sequence;   /**< Position the cell is ready for */
+                  WorkDescriptor * volatile  _wd;
+               };
+
+               Atomic<long>   _head;           /**< Next position to be popped */
+               char           _pad0[64];       /**< Keeps producers and consumers on different cache lines */
+               Atomic<long>   _tail;           /**< Next position to be pushed */
+               char           _pad1[64];
+               long           _mask;           /**< Capacity - 1 (capacity is a power of two) */
+               Cell          *_cells;          /**< Storage */
+            private:
+               /*! \brief WDRing copy constructor (private)
+                */
+               WDRing ( const WDRing & );
+               /*! \brief WDRing copy assignment operator (private)
+                */
+               const WDRing & operator= ( const WDRing & );
+            public:
+               /*! \brief WDRing constructor
+                */
+               WDRing ( long capacity );
+               /*! \brief WDRing destructor
+                */
+               ~WDRing () { delete[] _cells; }
+
+               size_t size () const;
+
+               /*! \brief Returns false if the ring is full
+                */
+               bool push ( WorkDescriptor *wd );
+               /*! \brief Returns NULL if the ring is empty
+                */
+               WorkDescriptor * pop ();
+               /*! \brief Pops the WD only if it is the oldest one in the ring
+                */
+               bool popIf ( WorkDescriptor *wd );
+         };
+
+         typedef std::list<WorkDescriptor *> Overflow;
+         typedef std::vector<const Device *> Devices;
+         typedef std::vector<WDRing *>       Rings;
+
+         Devices              _devices;          /**< Device of each ring */
+         Rings                _rings;            /**< One ring per device */
+         Overflow             _overflow;         /**< WDs out of the lock-free path */
+         Atomic<size_t>       _overflowSize;     /**< Number of elements in _overflow */
+         Lock                 _lock;             /**< Protects _overflow */
+
+      private:
+         /*! \brief WDMPMCQueue copy constructor (private)
+          */
+         WDMPMCQueue ( const WDMPMCQueue & );
+         /*! \brief WDMPMCQueue copy assignment operator (private)
+          */
+         const WDMPMCQueue & operator= ( const WDMPMCQueue & );
+
+         /*! \brief Returns the ring for the WD, or NULL if it has to go to the overflow list
+          */
+         WDRing * getRing ( WorkDescriptor *wd ) const;
+
+         /*! \brief Inserts a WD in the overflow list (the lock must be held)
+          */
+         void pushOverflow ( WorkDescriptor *wd, bool front );
+
+         /*! \brief Pushes a WD in its ring, or in the overflow list when it does not fit
+          */
+         void push ( WorkDescriptor *wd, bool front );
+
+         /*! \brief Applies constraints and slicing to a WD popped from a ring
+          */
+         template <typename Constraints>
+         WorkDescriptor * take ( BaseThread const *thread, WorkDescriptor *wd );
+
+         template <typename Constraints>
+         WorkDescriptor * popOverflowWithConstraints ( BaseThread const *thread );
+
+      public:
+         /*! \brief WDMPMCQueue default constructor
+          *  \param capacity Size of each device ring (a power of two)
+          */
+         WDMPMCQueue( long capacity = 4096 );
+         /*! \brief WDMPMCQueue destructor
+          */
+         ~WDMPMCQueue();
+
+         bool empty ( void ) const;
+         size_t size() const;
+
+         /*! \brief Only WDs in the overflow list go to the front, the rings are FIFO
+          */
+         void push_front ( WorkDescriptor *wd );
+         void push_back( WorkDescriptor *wd );
+
+         Lock& getLock();
+         void push_front( WD** wds, size_t numElems );
+         void push_back( WD** wds, size_t numElems );
+
+         template <typename Constraints>
+         WorkDescriptor * popFrontWithConstraints ( BaseThread const *thread );
+         template <typename Constraints>
+         WorkDescriptor * popBackWithConstraints ( BaseThread const *thread );
+         template <typename Constraints>
+         bool removeWDWithConstraints( BaseThread *thread, WorkDescriptor *toRem, WorkDescriptor **next );
+
+         WorkDescriptor * pop_front ( BaseThread *thread );
+         /*! \brief Same as pop_front: rings can only be popped from their head
+          */
+         WorkDescriptor * pop_back ( BaseThread *thread );
+
+         /*! \brief Removes a WD only if it is in the overflow list or the oldest one of its ring
+          */
+         bool removeWD( BaseThread *thread, WorkDescriptor *toRem, WorkDescriptor **next );
+
+         void increaseTasksInQueues( int tasks, int increment = 1 );
+         void decreaseTasksInQueues( int tasks, int decrement = 1 );
+   };
 
 } // namespace nanos
 
@@ -26,7 +26,10 @@ namespace nanos {
    class WDPool;
    class WDDeque;
    class WDLFQueue;
+   class WDStealDeque;
    template<typename T> class WDPriorityQueue;
+   class WDBucketPriorityQueue;
+   class WDMPMCQueue;
 
 } // namespace nanos
 
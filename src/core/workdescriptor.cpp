@@ -17,6 +17,7 @@
 /*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
 /*************************************************************************************/
 
+#include <algorithm>
 #include "workdescriptor.hpp"
 #include "schedule.hpp"
 #include "processingelement.hpp"
@@ -435,6 +436,28 @@ void WorkDescriptor::printCopies()
 void WorkDescriptor::setNotifyCopyFunc( void (*func)(WD &, BaseThread const&) ) {
    _notifyCopy = func;
 }
+WorkDescriptor::CommutativeOwnerMap::~CommutativeOwnerMap ()
+{
+   for ( std::vector<WorkDescriptor **>::iterator it = _blocks.begin(); it != _blocks.end(); it++ )
+      delete[] *it;
+}
+
+WorkDescriptor ** WorkDescriptor::CommutativeOwnerMap::getOwner ( void *address )
+{
+   OwnerMap::iterator iter = _owners.find( address );
+   if ( iter != _owners.end() ) return iter->second;
+
+   if ( _freeWords == 0 ) {
+      WorkDescriptor **block = NEW WorkDescriptor *[BlockSize];
+      for ( size_t i = 0; i < BlockSize; i++ ) block[i] = NULL;
+      _blocks.push_back( block );
+      _freeWords = BlockSize;
+   }
+   WorkDescriptor **owner = &_blocks.back()[BlockSize - _freeWords--];
+   _owners.insert( std::make_pair( address, owner ) );
+   return owner;
+}
+
 void WorkDescriptor::initCommutativeAccesses( WorkDescriptor &wd, size_t numDeps, DataAccess* deps )
 {
    size_t numCommutative = 0;
@@ -448,29 +471,18 @@ void WorkDescriptor::initCommutativeAccesses( WorkDescriptor &wd, size_t numDeps
    if (wd._commutativeOwners == NULL) wd._commutativeOwners = NEW WorkDescriptorPtrList();
    wd._commutativeOwners->reserve(numCommutative);
 
+   // Owner words of the targets live in the parent WD
+   if ( _commutativeOwnerMap == NULL ) _commutativeOwnerMap = NEW CommutativeOwnerMap();
    for ( size_t i = 0; i < numDeps; i++ ) {
       if ( !deps[i].isCommutative() )
          continue;
-
-      if ( _commutativeOwnerMap == NULL ) _commutativeOwnerMap = NEW CommutativeOwnerMap();
-
-      // Lookup owner in map in parent WD
-      CommutativeOwnerMap::iterator iter = _commutativeOwnerMap->find( deps[i].getDepAddress() );
-
-      if ( iter != _commutativeOwnerMap->end() ) {
-         // Already in map => insert into owner list in child WD
-         wd._commutativeOwners->push_back( iter->second.get() );
-      }
-      else {
-         // Not in map => allocate new owner pointer container and insert
-         std::pair<CommutativeOwnerMap::iterator, bool> ret =
-               _commutativeOwnerMap->insert( std::make_pair( deps[i].getDepAddress(),
-                                                            TR1::shared_ptr<WorkDescriptor *>( NEW WorkDescriptor *(NULL) ) ) );
-
-         // Insert into owner list in child WD
-         wd._commutativeOwners->push_back( ret.first->second.get() );
-      }
+      wd._commutativeOwners->push_back( _commutativeOwnerMap->getOwner( deps[i].getDepAddress() ) );
    }
+
+   // All the tasks acquire their words in the same (address) order
+   std::sort( wd._commutativeOwners->begin(), wd._commutativeOwners->end() );
+   wd._commutativeOwners->erase( std::unique( wd._commutativeOwners->begin(), wd._commutativeOwners->end() ),
+                                 wd._commutativeOwners->end() );
 }
 
 bool WorkDescriptor::tryAcquireCommutativeAccesses()
@@ -478,6 +490,13 @@ bool WorkDescriptor::tryAcquireCommutativeAccesses()
    if ( _commutativeOwners == NULL ) return true;
 
    const size_t n = _commutativeOwners->size();
+
+   // Check the words before trying to take them: a blocked task fails without writing shared data
+   for ( size_t i = 0; i < n; i++ ) {
+      WorkDescriptor *owner = *(*_commutativeOwners)[i];
+      if ( owner != NULL && owner != this ) return false;
+   }
+
    for ( size_t i = 0; i < n; i++ ) {
 
       WorkDescriptor *owner = *(*_commutativeOwners)[i];
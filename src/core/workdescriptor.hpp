@@ -58,7 +58,7 @@ inline WorkDescriptor::WorkDescriptor ( int ndevices, DeviceData **devs, size_t
                                  _copiesNotInChunk(false), _description(description), _instrumentationContextData(), _slicer(NULL),
                                  _taskReductions(),
                                  _notifyCopy( NULL ), _notifyThread( NULL ), _remoteAddr( NULL ), _callback(0), _arguments(0),
-                                 _submittedWDs( NULL ), _reachedTaskwait( false ), _schedPredecessorLocs(),
+                                 _submittedWDs( NULL ), _reachedTaskwait( false ), _recordingGraph( NULL ), _schedPredecessorLocs(),
                                  _mcontrol( this, numCopies )
                                  {
                                     _flags.is_final = 0;
@@ -95,7 +95,7 @@ inline WorkDescriptor::WorkDescriptor ( DeviceData *device, size_t data_size, si
                                  _priority( 0 ),  _commutativeOwnerMap(NULL), _commutativeOwners(NULL),
                                  _copiesNotInChunk(false), _description(description), _instrumentationContextData(), _slicer(NULL), _taskReductions(),
                                  _notifyCopy( NULL ), _notifyThread( NULL ), _remoteAddr( NULL ), _callback(0), _arguments(0), 
-                                 _submittedWDs( NULL ), _reachedTaskwait( false ), _schedPredecessorLocs(),
+                                 _submittedWDs( NULL ), _reachedTaskwait( false ), _recordingGraph( NULL ), _schedPredecessorLocs(),
                                  _mcontrol( this, numCopies )
                                  {
                                      _devices = new DeviceData*[1];
@@ -135,7 +135,7 @@ inline WorkDescriptor::WorkDescriptor ( const WorkDescriptor &wd, DeviceData **d
                                  _priority( wd._priority ), _commutativeOwnerMap(NULL), _commutativeOwners(NULL),
                                  _copiesNotInChunk( wd._copiesNotInChunk), _description(description), _instrumentationContextData(), _slicer(wd._slicer), _taskReductions(),
                                  _notifyCopy( NULL ), _notifyThread( NULL ), _remoteAddr( NULL ), _callback(0), _arguments(0),
-                                 _submittedWDs( NULL ), _reachedTaskwait( false ), _schedPredecessorLocs(),
+                                 _submittedWDs( NULL ), _reachedTaskwait( false ), _recordingGraph( NULL ), _schedPredecessorLocs(),
                                  _mcontrol( this, wd._numCopies )
                                  {
                                     if ( wd._parent != NULL ) wd._parent->addWork(*this);
@@ -181,6 +181,10 @@ inline WorkDescriptor::~WorkDescriptor()
 
     if (_copiesNotInChunk)
         delete[] _copies;
+
+    //! Delete commutative ownership (children are done, see WorkDescriptor::done)
+    delete _commutativeOwnerMap;
+    delete _commutativeOwners;
 }
 
 /* DeviceData inlined functions */
@@ -198,6 +202,8 @@ inline size_t WorkDescriptor::getDataAlignment () const { return _data_align; }
 
 inline void WorkDescriptor::setTotalSize ( size_t size ) { _totalSize = size; }
 
+inline size_t WorkDescriptor::getTotalSize () const { return _totalSize; }
+
 inline WorkDescriptor * WorkDescriptor::getParent() const { return _parent!=NULL?_parent:_forcedParent ; }
 inline void WorkDescriptor::forceParent ( WorkDescriptor * p ) { _forcedParent = p; }
 
@@ -372,16 +378,23 @@ inline int WorkDescriptor::getNumDepsPredecessors() { return ( _doSubmit == NULL
 
 inline bool WorkDescriptor::hasDepsPredecessors() { return ( _doSubmit == NULL ? false : ( _doSubmit->numPredecessors() != 0 ) ); }
 
-inline void WorkDescriptor::submitWithDependencies( WorkDescriptor &wd, size_t numDeps, DataAccess* deps )
+inline DOSubmit * WorkDescriptor::createDOSubmit( WorkDescriptor &wd, size_t numDeps, DataAccess* deps )
 {
    wd._doSubmit = NEW DOSubmit();
    wd._doSubmit->setWD(&wd);
 
+   initCommutativeAccesses( wd, numDeps, deps );
+
+   return wd._doSubmit;
+}
+
+inline void WorkDescriptor::submitWithDependencies( WorkDescriptor &wd, size_t numDeps, DataAccess* deps )
+{
+   createDOSubmit( wd, numDeps, deps );
+
    // Defining call back (cb)
    SchedulePolicySuccessorFunctor cb( *sys.getDefaultSchedulePolicy() );
    
-   initCommutativeAccesses( wd, numDeps, deps );
-   
    _depsDomain->submitDependableObject( *(wd._doSubmit), numDeps, deps, &cb );
    if ( sys._preSchedule ) {
       sys._slots[wd._doSubmit->getNum()].insert(&wd);
@@ -471,6 +484,8 @@ inline void WorkDescriptor::releaseCommutativeAccesses()
 {
    if ( _commutativeOwners == NULL ) return;
    const size_t n = _commutativeOwners->size();
+   // The next owner must see the data written by this task
+   memoryFence();
    for ( size_t i = 0; i < n; i++ )
       *(*_commutativeOwners)[i] = NULL;
 } 
@@ -489,6 +504,17 @@ inline void WorkDescriptor::setImplicit( bool b )
 
 inline bool WorkDescriptor::isImplicit( void ) { return _flags.is_implicit; }
 
+inline void WorkDescriptor::removeFromGroup( void )
+{
+   if ( _parent != NULL ) {
+      _parent->exitWork(*this);
+      _parent = NULL;
+   }
+}
+
+inline void WorkDescriptor::setRecordingTaskGraph( TaskGraph *graph ) { _recordingGraph = graph; }
+inline TaskGraph * WorkDescriptor::getRecordingTaskGraph( void ) const { return _recordingGraph; }
+
 inline void WorkDescriptor::setRuntimeTask( bool b )
 {
   _flags.is_runtime_task = b;
@@ -496,6 +522,14 @@ inline void WorkDescriptor::setRuntimeTask( bool b )
 
 inline bool WorkDescriptor::isRuntimeTask( void ) const { return _flags.is_runtime_task; }
 
+inline void WorkDescriptor::setStackless( bool b ) { _flags.is_stackless = b; }
+
+inline bool WorkDescriptor::isStackless( void ) const { return _flags.is_stackless; }
+
+inline void WorkDescriptor::setRecyclable( bool b ) { _flags.is_recyclable = b; }
+
+inline bool WorkDescriptor::isRecyclable( void ) const { return _flags.is_recyclable; }
+
 inline const char * WorkDescriptor::getDescription ( void ) const  { return _description; }
 
 inline void WorkDescriptor::addWork ( WorkDescriptor &work )
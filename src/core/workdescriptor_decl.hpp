@@ -45,6 +45,7 @@
 #include "task_reduction_decl.hpp"
 #include "simpleallocator_decl.hpp"
 #include "schedule_fwd.hpp"   // ScheduleWDData
+#include "taskgraph_fwd.hpp"
 
 namespace nanos {
 
@@ -202,7 +203,28 @@ typedef std::set<const Device *>  DeviceList;
       public: /* types */
          typedef enum { IsNotAUserLevelThread=false, IsAUserLevelThread=true } ULTFlag;
          typedef std::vector<WorkDescriptor **> WorkDescriptorPtrList;
-         typedef TR1::unordered_map<void *, TR1::shared_ptr<WorkDescriptor *> > CommutativeOwnerMap;
+         /*! \brief Ownership words of the commutative targets of the children of a WD
+          *
+          *  A word holds the child that has exclusive access to the target, or NULL. Words are
+          *  allocated in blocks and never move, as children keep pointers to them.
+          */
+         class CommutativeOwnerMap {
+            private:
+               typedef TR1::unordered_map<void *, WorkDescriptor **> OwnerMap;
+               static const size_t BlockSize = 64;
+
+               OwnerMap                        _owners;
+               std::vector<WorkDescriptor **>  _blocks;
+               size_t                          _freeWords;   //!< Unused words of the last block
+
+               CommutativeOwnerMap ( const CommutativeOwnerMap & );
+               const CommutativeOwnerMap & operator= ( const CommutativeOwnerMap & );
+            public:
+               CommutativeOwnerMap () : _owners(), _blocks(), _freeWords( 0 ) {}
+               ~CommutativeOwnerMap ();
+               //! \brief Ownership word of the target at address, allocated the first time
+               WorkDescriptor ** getOwner ( void *address );
+         };
          typedef struct {
             bool is_final;         //!< Work descriptor will not create more work descriptors
             bool is_initialized;   //!< Work descriptor is initialized
@@ -215,6 +237,8 @@ typedef std::set<const Device *>  DeviceList;
             bool is_recoverable;   //!< Flags a task as recoverable, that is, it can be re-executed if it finished with errors.
             bool is_invalid;       //!< Flags an invalid workdescriptor. Used in resiliency when a task fails.
             bool is_runtime_task;  //!< Is the WD a task for doing runtime jobs?
+            bool is_stackless;     //!< Is the WD running on the worker stack (it cannot be suspended)?
+            bool is_recyclable;    //!< Can the WD chunk be cached for WDs of the same definition?
          } WDFlags;
          typedef enum { INIT, START, READY, BLOCKED } State;
          typedef int PriorityType;
@@ -277,6 +301,7 @@ typedef std::set<const Device *>  DeviceList;
          void                         *_arguments;
          std::vector<WorkDescriptor *>*_submittedWDs;
          bool                          _reachedTaskwait;
+         TaskGraph                    *_recordingGraph;         //!< Task graph recording the children of this WD (if any)
       public:
          int                           _schedValues[8];
          std::map<memory_space_id_t,unsigned int>   _schedPredecessorLocs;
@@ -403,6 +428,8 @@ typedef std::set<const Device *>  DeviceList;
 
          void setTotalSize ( size_t size );
 
+         size_t getTotalSize () const;
+
          void setBlocked ();
 
          bool isReady () const;
@@ -597,6 +624,13 @@ typedef std::set<const Device *>  DeviceList;
           */
          bool hasDepsPredecessors();
 
+         /*! \brief Creates the DOSubmit of wd, a child of this WD, without submitting it to the domain
+          *  \param numDeps Number of commutative accesses in deps
+          *  \param deps Commutative accesses of wd
+          *  \sa TaskGraph::replay
+          */
+         DOSubmit * createDOSubmit( WorkDescriptor &wd, size_t numDeps, DataAccess* deps );
+
          /*! \brief Add a new WD to the domain of this WD.
           *  \param wd Must be a WD created by "this". wd will be submitted to the
           *  scheduler when its dependencies are satisfied.
@@ -676,9 +710,31 @@ typedef std::set<const Device *>  DeviceList;
          void setImplicit( bool b = true );
          bool isImplicit( void );
 
+         //! \brief Detaches the WD from its parent, which will no longer wait for it
+         void removeFromGroup( void );
+
+         /*! \brief Sets the task graph recording the tasks submitted by this WD (NULL to stop)
+          *  \sa TaskGraph
+          */
+         void setRecordingTaskGraph( TaskGraph *graph );
+         TaskGraph * getRecordingTaskGraph( void ) const;
+
          void setRuntimeTask( bool b = true );
          bool isRuntimeTask( void ) const;
 
+         /*! \brief Flags the WD as running on its worker stack instead of its own ULT stack
+          *  A stackless WD cannot be switched away from, so while it waits it only inlines
+          *  not-started work.
+          */
+         void setStackless( bool b = true );
+         bool isStackless( void ) const;
+
+         /*! \brief Flags the WD as starting a chunk allocated by System::createWD
+          *  \sa System::destroyWD
+          */
+         void setRecyclable( bool b = true );
+         bool isRecyclable( void ) const;
+
          /*! \brief Set copies for a given WD
           * We call this when copies cannot be set at creation time of the work descriptor
           * Note that this should only be done between creation and submit.
@@ -0,0 +1,217 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+
+#include "barrier.hpp"
+#include "system.hpp"
+#include "atomic.hpp"
+#include "schedule.hpp"
+#include "plugin.hpp"
+#include "synchronizedcondition.hpp"
+#include "smpbaseplugin_decl.hpp"
+#include "threadteam.hpp"
+#include <algorithm>
+
+namespace nanos {
+   namespace ext {
+
+      /*! \class HierarchicalBarrier
+       *  \brief implements a two level combining barrier
+       *
+       *  Participants are split in groups of consecutive team ids (one group per socket by
+       *  default). Each group has its own counter and release flag, so most participants only
+       *  touch data shared with their own socket. The last participant arriving to a group
+       *  combines the group's reduction private copies and arrives to the top level; the last
+       *  group arriving completes the reductions and releases every group through its flag.
+       *  Both levels are sense-reversing.
+       */
+      class HierarchicalBarrier: public Barrier
+      {
+         public:
+            static int _groupSize;             /**< Participants per group (0 = CPUs per socket) */
+
+         private:
+            /*! \brief Counter and release flag of a level of the barrier, in its own cache line */
+            struct Node {
+               Atomic<int> _arrived;
+#ifdef HAVE_NEW_GCC_ATOMIC_OPS
+               bool        _flag;
+#else
+               volatile bool _flag;
+#endif
+               int         _size;
+               MultipleSyncCond<EqualConditionChecker<bool> > _syncCondTrue;
+               MultipleSyncCond<EqualConditionChecker<bool> > _syncCondFalse;
+               char        _pad[128];
+
+               Node ( int size ) : _arrived(0), _flag(false), _size(size),
+                  _syncCondTrue( EqualConditionChecker<bool>( &_flag, true ), size ),
+                  _syncCondFalse( EqualConditionChecker<bool>( &_flag, false ), size ) {}
+
+               /*! \brief Arrives to the node, returns true for the last participant (which must call release) */
+               bool arrive ( bool &sense );
+               /*! \brief Releases all the participants waiting in the node */
+               void release ( bool sense );
+            };
+
+            typedef std::vector<Node *> NodeList;
+
+            NodeList _groups;
+            Node    *_top;
+            int      _numParticipants;
+            int      _participantsPerGroup;
+
+            void destroy ();
+
+         public:
+            HierarchicalBarrier () : Barrier(), _groups(), _top(NULL), _numParticipants(0), _participantsPerGroup(1) {}
+            HierarchicalBarrier ( const HierarchicalBarrier& orig ) : Barrier(orig), _groups(), _top(NULL),
+               _numParticipants(0), _participantsPerGroup(1)
+               { init( orig._numParticipants ); }
+
+            const HierarchicalBarrier & operator= ( const HierarchicalBarrier & barrier );
+
+            virtual ~HierarchicalBarrier() { destroy(); }
+
+            void init ( int numParticipants );
+            void resize ( int numThreads );
+
+            void barrier ( int participant );
+      };
+
+      int HierarchicalBarrier::_groupSize = 0;
+
+      bool HierarchicalBarrier::Node::arrive ( bool &sense )
+      {
+         // The flag does not change until every participant of the node has arrived
+         sense = !_flag;
+
+         if ( ++_arrived == _size ) return true;
+
+         if ( sense ) _syncCondTrue.wait();
+         else _syncCondFalse.wait();
+
+         return false;
+      }
+
+      void HierarchicalBarrier::Node::release ( bool sense )
+      {
+         _arrived = 0;
+         _flag = sense;
+
+         if ( sense ) _syncCondTrue.signal();
+         else _syncCondFalse.signal();
+      }
+
+      const HierarchicalBarrier & HierarchicalBarrier::operator= ( const HierarchicalBarrier & orig )
+      {
+         // self-assignment
+         if ( &orig == this ) return *this;
+
+         Barrier::operator=(orig);
+         resize(orig._numParticipants);
+
+         return *this;
+      }
+
+      void HierarchicalBarrier::destroy ()
+      {
+         for ( NodeList::iterator it = _groups.begin(); it != _groups.end(); it++ ) delete *it;
+         _groups.clear();
+         delete _top;
+         _top = NULL;
+      }
+
+      void HierarchicalBarrier::init( int numParticipants )
+      {
+         destroy();
+
+         _numParticipants = numParticipants;
+         if ( _numParticipants == 0 ) return;
+
+         _participantsPerGroup = _groupSize > 0 ? _groupSize : sys.getSMPPlugin()->getCPUsPerSocket();
+         if ( _participantsPerGroup <= 0 || _participantsPerGroup > _numParticipants ) _participantsPerGroup = _numParticipants;
+
+         int numGroups = ( _numParticipants + _participantsPerGroup - 1 ) / _participantsPerGroup;
+         for ( int i = 0; i < numGroups; i++ ) {
+            int size = std::min( _participantsPerGroup, _numParticipants - i * _participantsPerGroup );
+            _groups.push_back( NEW Node( size ) );
+         }
+         _top = NEW Node( numGroups );
+      }
+
+      void HierarchicalBarrier::resize( int numParticipants )
+      {
+         if ( numParticipants != _numParticipants ) init( numParticipants );
+      }
+
+      void HierarchicalBarrier::barrier( int participant )
+      {
+         int groupId = participant / _participantsPerGroup;
+         Node &group = *_groups[groupId];
+         bool groupSense, topSense;
+
+         if ( !group.arrive( groupSense ) ) return;
+
+         // Last participant of the group: combine the group into its first participant
+         ThreadTeam *team = myThread->getTeam();
+         team->combineVectorReductions( groupId * _participantsPerGroup, group._size );
+
+         if ( _top->arrive( topSense ) ) {
+            team->computeVectorReductions( _participantsPerGroup );
+            team->cleanUpReductionList();
+            _top->release( topSense );
+         }
+
+         group.release( groupSense );
+      }
+
+
+      static Barrier * createHierarchicalBarrier()
+      {
+          return NEW HierarchicalBarrier();
+      }
+
+
+      /*! \class HierarchicalBarrierPlugin
+       *  \brief plugin of the related HierarchicalBarrier class
+       *  \see HierarchicalBarrier
+       */
+      class HierarchicalBarrierPlugin : public Plugin
+      {
+
+         public:
+            HierarchicalBarrierPlugin() : Plugin( "Hierarchical Barrier Plugin",1 ) {}
+
+            virtual void config( Config &cfg )
+            {
+               cfg.setOptionsSection( "Hierarchical barrier", "Socket-aware combining barrier" );
+
+               cfg.registerConfigOption ( "barrier-group-size", NEW Config::PositiveVar( HierarchicalBarrier::_groupSize ),
+                                          "Participants combined at the first level of the barrier (default = cpus per socket)" );
+               cfg.registerArgOption ( "barrier-group-size", "barrier-group-size" );
+            }
+
+            virtual void init() {
+               sys.setDefaultBarrFactory( createHierarchicalBarrier );
+            }
+      };
+
+   }
+}
+
+DECLARE_PLUGIN("barr-hierarchical",nanos::ext::HierarchicalBarrierPlugin);
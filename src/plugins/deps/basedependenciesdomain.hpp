@@ -113,65 +113,71 @@ inline void BaseDependenciesDomain::dependOnLastWriter ( DependableObject &depOb
    }
 }
 
-inline void BaseDependenciesDomain::dependOnReaders( DependableObject &depObj, TrackableObject &status, BaseDependency const &target,
-                                                     SchedulePolicySuccessorFunctor* callback, AccessType const &accessType )
+inline void BaseDependenciesDomain::dependOnReader( DependableObject &depObj, DependableObject &reader, BaseDependency const &target,
+                                                    SchedulePolicySuccessorFunctor* callback, AccessType const &accessType )
 {
-   TrackableObject::DependableObjectList &readersList = status.getReaders();
-   SyncLockBlock lock4( status.getReadersLock() );
-   for ( TrackableObject::DependableObjectList::iterator i = readersList.begin(); i != readersList.end(); i++) {
-      DependableObject * predecessorReader = *i;
-      if ( predecessorReader == &depObj ) continue;
-
-      SyncLockBlock lock5(predecessorReader->getLock());
+   SyncLockBlock lock5( reader.getLock() );
 
-      // new instrument event: dependence predecessorReader -> depObj
-      NANOS_INSTRUMENT ( WorkDescriptor *wd_sender = (WorkDescriptor *) predecessorReader->getRelatedObject(); )
-      NANOS_INSTRUMENT ( WorkDescriptor *wd_receiver = (WorkDescriptor *) depObj.getRelatedObject(); )
-      NANOS_INSTRUMENT ( int id_sender = wd_sender ? wd_sender->getId() : predecessorReader->getId(); )
-      NANOS_INSTRUMENT ( int id_receiver = wd_receiver ? wd_receiver->getId() : depObj.getId(); )
+   // new instrument event: dependence reader -> depObj
+   NANOS_INSTRUMENT ( WorkDescriptor *wd_sender = (WorkDescriptor *) reader.getRelatedObject(); )
+   NANOS_INSTRUMENT ( WorkDescriptor *wd_receiver = (WorkDescriptor *) depObj.getRelatedObject(); )
+   NANOS_INSTRUMENT ( int id_sender = wd_sender ? wd_sender->getId() : reader.getId(); )
+   NANOS_INSTRUMENT ( int id_receiver = wd_receiver ? wd_receiver->getId() : depObj.getId(); )
 
-      NANOS_INSTRUMENT ( nanos_event_value_t Values[3]; )
-      NANOS_INSTRUMENT ( Values[0] = ( ((nanos_event_value_t) id_sender) << 32 ) + id_receiver; )
+   NANOS_INSTRUMENT ( nanos_event_value_t Values[3]; )
+   NANOS_INSTRUMENT ( Values[0] = ( ((nanos_event_value_t) id_sender) << 32 ) + id_receiver; )
 
-      NANOS_INSTRUMENT ( if ( wd_sender && wd_receiver ) { )
-         NANOS_INSTRUMENT ( Values[1] = ((nanos_event_value_t) 2); )
-      NANOS_INSTRUMENT ( } else if ( wd_sender && !wd_receiver ) { )
+   NANOS_INSTRUMENT ( if ( wd_sender && wd_receiver ) { )
+      NANOS_INSTRUMENT ( Values[1] = ((nanos_event_value_t) 2); )
+   NANOS_INSTRUMENT ( } else if ( wd_sender && !wd_receiver ) { )
 
-         NANOS_INSTRUMENT ( if ( accessType.concurrent ) { );
-            NANOS_INSTRUMENT ( Values[1] = ((nanos_event_value_t) 4); )
-         NANOS_INSTRUMENT ( } else if ( accessType.commutative ) {)
-            NANOS_INSTRUMENT ( Values[1] = ((nanos_event_value_t) 6); )
-         NANOS_INSTRUMENT ( } else {)
-            NANOS_INSTRUMENT ( Values[1] = ((nanos_event_value_t) 8); )
-         NANOS_INSTRUMENT ( })
-
-      NANOS_INSTRUMENT ( } else if ( !wd_sender && wd_receiver ) {)
+      NANOS_INSTRUMENT ( if ( accessType.concurrent ) { );
+         NANOS_INSTRUMENT ( Values[1] = ((nanos_event_value_t) 4); )
+      NANOS_INSTRUMENT ( } else if ( accessType.commutative ) {)
+         NANOS_INSTRUMENT ( Values[1] = ((nanos_event_value_t) 6); )
+      NANOS_INSTRUMENT ( } else {)
+         NANOS_INSTRUMENT ( Values[1] = ((nanos_event_value_t) 8); )
+      NANOS_INSTRUMENT ( })
 
-         NANOS_INSTRUMENT ( if ( accessType.concurrent ) { );
-            NANOS_INSTRUMENT ( Values[1] = ((nanos_event_value_t) 5); )
-         NANOS_INSTRUMENT ( } else if ( accessType.commutative ) {)
-            NANOS_INSTRUMENT ( Values[1] = ((nanos_event_value_t) 7); )
-         NANOS_INSTRUMENT ( } else {)
-            NANOS_INSTRUMENT ( Values[1] = ((nanos_event_value_t) 9); )
-         NANOS_INSTRUMENT ( })
+   NANOS_INSTRUMENT ( } else if ( !wd_sender && wd_receiver ) {)
 
+      NANOS_INSTRUMENT ( if ( accessType.concurrent ) { );
+         NANOS_INSTRUMENT ( Values[1] = ((nanos_event_value_t) 5); )
+      NANOS_INSTRUMENT ( } else if ( accessType.commutative ) {)
+         NANOS_INSTRUMENT ( Values[1] = ((nanos_event_value_t) 7); )
       NANOS_INSTRUMENT ( } else {)
-         NANOS_INSTRUMENT ( Values[1] = ((nanos_event_value_t) 0); )
-      NANOS_INSTRUMENT ( } )
+         NANOS_INSTRUMENT ( Values[1] = ((nanos_event_value_t) 9); )
+      NANOS_INSTRUMENT ( })
 
-      NANOS_INSTRUMENT ( Values[2] = ((nanos_event_value_t) target.getAddress() ); )
-      NANOS_INSTRUMENT ( sys.getInstrumentation()->raisePointEvents(3, _insKeyDeps, Values); )
+   NANOS_INSTRUMENT ( } else {)
+      NANOS_INSTRUMENT ( Values[1] = ((nanos_event_value_t) 0); )
+   NANOS_INSTRUMENT ( } )
 
-      if ( predecessorReader->addSuccessor( depObj ) ) {
-         // new dependence predecessorReader -> depObj
-         depObj.increasePredecessors();
-         if ( callback != NULL ) {
-            ( *callback )( predecessorReader, &depObj );
-         }
+   NANOS_INSTRUMENT ( Values[2] = ((nanos_event_value_t) target.getAddress() ); )
+   NANOS_INSTRUMENT ( sys.getInstrumentation()->raisePointEvents(3, _insKeyDeps, Values); )
+
+   if ( reader.addSuccessor( depObj ) ) {
+      // new dependence reader -> depObj
+      depObj.increasePredecessors();
+      if ( callback != NULL ) {
+         ( *callback )( &reader, &depObj );
       }
    }
 }
 
+inline void BaseDependenciesDomain::dependOnReaders( DependableObject &depObj, TrackableObject &status, BaseDependency const &target,
+                                                     SchedulePolicySuccessorFunctor* callback, AccessType const &accessType )
+{
+   TrackableObject::DependableObjectList &readersList = status.getReaders();
+   SyncLockBlock lock4( status.getReadersLock() );
+   for ( TrackableObject::DependableObjectList::iterator i = readersList.begin(); i != readersList.end(); i++) {
+      DependableObject * predecessorReader = *i;
+      if ( predecessorReader == &depObj ) continue;
+
+      dependOnReader( depObj, *predecessorReader, target, callback, accessType );
+   }
+}
+
 inline void BaseDependenciesDomain::setAsWriter( DependableObject &depObj, TrackableObject &status, BaseDependency const &target )
 {
    {
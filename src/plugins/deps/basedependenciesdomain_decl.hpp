@@ -60,6 +60,15 @@ namespace nanos {
          inline void dependOnLastWriter( DependableObject &depObj, TrackableObject const &status, BaseDependency const &target,
                                           SchedulePolicySuccessorFunctor* callback, AccessType const &accessType );
          
+         /*! \brief Makes a DependableObject depend on one reader of a region.
+          *  \param depObj target DependableObject
+          *  \param reader reader of the region, with the readers lock of the region held
+          *  \param target accessed base address/region
+          *  \param callback Function to call if an immediate predecessor is found.
+          */
+         inline void dependOnReader( DependableObject &depObj, DependableObject &reader, BaseDependency const &target,
+                                     SchedulePolicySuccessorFunctor* callback, AccessType const &accessType );
+
          /*! \brief Makes a DependableObject depend on the the readers of a set of regions.
           *  \param depObj target DependableObject
           *  \param[in] status status of the address/region
@@ -0,0 +1,576 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+#include "basedependenciesdomain.hpp"
+#include "plugin.hpp"
+#include "system.hpp"
+#include "config.hpp"
+#include "compatibility.hpp"
+#include <algorithm>
+#include <vector>
+#include <list>
+
+namespace nanos {
+   namespace ext {
+
+      /*! \class IntervalRegion
+       *  \brief Memory accessed by a multidimensional data access
+       *
+       *  The access is kept as blocks of _width contiguous bytes starting at _start, repeated along up
+       *  to MAX_DIMENSIONS (stride, count) pairs. Dimensions which continue the previous one without a
+       *  gap are merged, so whole rows or planes become a single interval. An access which still needs
+       *  more dimensions is widened to its bounding interval, which only adds dependences.
+       */
+      class IntervalRegion : public BaseDependency
+      {
+         public:
+            enum { MAX_DIMENSIONS = 4 };
+         private:
+            uintptr_t         _start;                     /**< First accessed byte */
+            uintptr_t         _end;                       /**< One past the last accessed byte */
+            size_t            _width;                     /**< Contiguous bytes of every block */
+            short             _numDimensions;             /**< Block repetitions, 0 for a single interval */
+            size_t            _stride[MAX_DIMENSIONS];    /**< Bytes between repetitions */
+            size_t            _count[MAX_DIMENSIONS];     /**< Number of repetitions */
+            TrackableObject  *_trackable;                 /**< Status of this region in the domain */
+
+            static int64_t floorDiv ( int64_t a, int64_t b )
+            {
+               return a >= 0 ? a / b : -( ( -a + b - 1 ) / b );
+            }
+
+            /*! \brief Exact test for two blocks of rows with the same pitch
+             *
+             *  Row i of this region overlaps row j of region iff delta - width < (i - j) * pitch < delta + region.width,
+             *  with delta the distance between both starts. Every value of i - j in [-(rows of region - 1), rows - 1]
+             *  is reached by some pair of rows, so it is enough to intersect both ranges.
+             */
+            bool overlapRows ( const IntervalRegion &region, size_t pitch ) const
+            {
+               int64_t p = (int64_t) pitch;
+               int64_t delta = (int64_t) ( region._start - _start );
+               int64_t rows = _numDimensions != 0 ? (int64_t) _count[0] : 1;
+               int64_t regionRows = region._numDimensions != 0 ? (int64_t) region._count[0] : 1;
+
+               int64_t low = floorDiv( delta - (int64_t) _width, p ) + 1;
+               int64_t high = -floorDiv( -( delta + (int64_t) region._width ), p ) - 1;
+               if ( low < 1 - regionRows ) low = 1 - regionRows;
+               if ( high > rows - 1 ) high = rows - 1;
+               return low <= high;
+            }
+
+         public:
+            /*! \brief Builds the region accessed by access */
+            IntervalRegion ( DataAccess const &access ) : BaseDependency(), _start( (uintptr_t) access.getDepAddress() ), _end( 0 ),
+                                                          _width( 0 ), _numDimensions( 0 ), _trackable( NULL )
+            {
+               nanos_region_dimension_internal_t const *dimensions = access.getDimensions();
+
+               // First dimension is in bytes, the others in terms of the previous one
+               _width = dimensions[0].accessed_length;
+               size_t stride = dimensions[0].size;
+               size_t span = _width;
+               bool bounding = false;
+               for ( short d = 1; d < access.getNumDimensions(); d++ ) {
+                  size_t length = dimensions[d].accessed_length;
+                  if ( length > 1 ) {
+                     span += ( length - 1 ) * stride;
+                     if ( _numDimensions == 0 && _width == stride ) {
+                        _width *= length;
+                     } else if ( _numDimensions != 0 && _stride[_numDimensions-1] * _count[_numDimensions-1] == stride ) {
+                        _count[_numDimensions-1] *= length;
+                     } else if ( _numDimensions < MAX_DIMENSIONS ) {
+                        _stride[_numDimensions] = stride;
+                        _count[_numDimensions] = length;
+                        _numDimensions++;
+                     } else {
+                        bounding = true;
+                     }
+                  }
+                  stride *= dimensions[d].size;
+               }
+
+               if ( bounding ) {
+                  _width = span;
+                  _numDimensions = 0;
+               }
+               // Empty accesses still order the tasks using the same address
+               if ( _width == 0 ) {
+                  _width = span = 1;
+                  _numDimensions = 0;
+               }
+               _end = _start + span;
+            }
+
+            /*! \brief Builds the single interval [address, address + size) */
+            IntervalRegion ( void *address, size_t size ) : BaseDependency(), _start( (uintptr_t) address ),
+                                                            _end( (uintptr_t) address + size ), _width( size ),
+                                                            _numDimensions( 0 ), _trackable( NULL ) {}
+
+            IntervalRegion ( const IntervalRegion &obj ) : BaseDependency(), _start( obj._start ), _end( obj._end ),
+                                                           _width( obj._width ), _numDimensions( obj._numDimensions ),
+                                                           _trackable( obj._trackable )
+            {
+               for ( short d = 0; d < _numDimensions; d++ ) {
+                  _stride[d] = obj._stride[d];
+                  _count[d] = obj._count[d];
+               }
+            }
+
+            ~IntervalRegion () {}
+
+            BaseDependency* clone() const { return new IntervalRegion( *this ); }
+
+            //! \brief Returns dependence base address
+            virtual void * getAddress () const { return (void *) _start; }
+
+            uintptr_t getStart () const { return _start; }
+            uintptr_t getEnd () const { return _end; }
+
+            TrackableObject* getTrackable() const { return _trackable; }
+            void setTrackable( TrackableObject* trackable ) { _trackable = trackable; }
+
+            bool operator== ( const IntervalRegion &obj ) const
+            {
+               if ( _start != obj._start || _end != obj._end || _width != obj._width ||
+                    _numDimensions != obj._numDimensions ) return false;
+               for ( short d = 0; d < _numDimensions; d++ ) {
+                  if ( _stride[d] != obj._stride[d] || _count[d] != obj._count[d] ) return false;
+               }
+               return true;
+            }
+
+            /*! \brief Overlap regions operator.
+             *
+             *  Exact for single intervals and for blocks of rows with the same pitch, other shapes only
+             *  compare their bounding intervals.
+             */
+            bool overlap ( const BaseDependency &obj ) const
+            {
+               const IntervalRegion &region( static_cast<const IntervalRegion &>( obj ) );
+               if ( region._end <= _start || _end <= region._start ) return false;
+               if ( _numDimensions > 1 || region._numDimensions > 1 ) return true;
+               if ( _numDimensions == 0 && region._numDimensions == 0 ) return true;
+
+               size_t pitch = _numDimensions != 0 ? _stride[0] : region._stride[0];
+               if ( _numDimensions != 0 && region._numDimensions != 0 && region._stride[0] != pitch ) return true;
+               return overlapRows( region, pitch );
+            }
+      };
+
+      class IntervalDependenciesDomain : public BaseDependenciesDomain
+      {
+         private:
+            /*! \brief Readers of an overlapping region already ordered before the last writer of a region
+             *
+             *  Readers are submitted in order, so the ones up to _lastReader were seen by that writer. They are
+             *  predecessors of anyone who waits for the writer, and the next writer of the region only needs the
+             *  newer ones. Otherwise halos which are read but never written would accumulate readers forever.
+             */
+            struct ReadMark {
+               TrackableObject  *_status;
+               unsigned int      _lastReader;    /**< Id of the last DependableObject considered */
+            };
+            typedef std::vector<ReadMark> ReadMarks;
+
+            /*! \brief A region accessed in the domain and its status */
+            struct Entry {
+               IntervalRegion    _region;
+               TrackableObject   _status;
+               ReadMarks         _marks;
+
+               Entry ( const IntervalRegion &region ) : _region( region ), _status(), _marks()
+               {
+                  _region.setTrackable( &_status );
+               }
+
+               ReadMark * findMark ( TrackableObject *status )
+               {
+                  for ( ReadMarks::iterator it = _marks.begin(); it != _marks.end(); it++ ) {
+                     if ( it->_status == status ) return &(*it);
+                  }
+                  return NULL;
+               }
+            };
+
+            /*! \brief Orders entries by their first byte */
+            struct StartsBefore {
+               bool operator() ( Entry const *entry, uintptr_t address ) const { return entry->_region.getStart() < address; }
+               bool operator() ( uintptr_t address, Entry const *entry ) const { return address < entry->_region.getStart(); }
+            };
+
+            typedef std::vector<Entry *> EntryList;
+            enum { NUM_CLASSES = 64 };
+
+         private:
+            /*! Entries whose span is in [2^c, 2^(c+1)) are kept in _classes[c], sorted by their first byte, so an
+             *  overlapping entry can only start in the 2^(c+1) bytes before a query and is found by binary search.
+             */
+            EntryList   _classes[NUM_CLASSES];
+            uint64_t    _usedClasses;    /**< Bit c is set when _classes[c] is not empty */
+
+         private:
+            static unsigned int getClass ( uintptr_t span )
+            {
+               return sizeof( unsigned long long ) * 8 - 1 - __builtin_clzll( (unsigned long long) span );
+            }
+
+            /*! \brief Appends to result every entry overlapping target */
+            void findOverlapping ( IntervalRegion const &target, EntryList &result )
+            {
+               for ( uint64_t used = _usedClasses; used != 0; used &= used - 1 ) {
+                  unsigned int c = __builtin_ctzll( used );
+                  EntryList &entries = _classes[c];
+
+                  uintptr_t reach = c + 1 < NUM_CLASSES ? (uintptr_t) 1 << ( c + 1 ) : ~(uintptr_t) 0;
+                  uintptr_t from = target.getStart() >= reach ? target.getStart() - reach + 1 : 0;
+                  EntryList::iterator it = std::lower_bound( entries.begin(), entries.end(), from, StartsBefore() );
+                  for ( ; it != entries.end() && (*it)->_region.getStart() < target.getEnd(); it++ ) {
+                     if ( (*it)->_region.overlap( target ) ) result.push_back( *it );
+                  }
+               }
+            }
+
+            /*! \brief Looks for the region accessed by target, creating it if needed, and the other regions it overlaps.
+             *  \param target Region to be checked.
+             *  \param overlapping Receives the status of every other overlapping region.
+             */
+            Entry & lookupDependency ( IntervalRegion const &target, std::vector<TrackableObject *> &overlapping )
+            {
+               EntryList found;
+               findOverlapping( target, found );
+
+               Entry *exact = NULL;
+               for ( EntryList::iterator it = found.begin(); it != found.end(); it++ ) {
+                  if ( exact == NULL && (*it)->_region == target ) exact = *it;
+                  else overlapping.push_back( &(*it)->_status );
+               }
+
+               if ( exact == NULL ) {
+                  exact = NEW Entry( target );
+                  unsigned int c = getClass( target.getEnd() - target.getStart() );
+                  EntryList &entries = _classes[c];
+                  entries.insert( std::upper_bound( entries.begin(), entries.end(), target.getStart(), StartsBefore() ), exact );
+                  _usedClasses |= (uint64_t) 1 << c;
+               }
+               return *exact;
+            }
+
+            /*! \brief Makes depObj depend on the readers of status submitted after lastReader */
+            void dependOnNewReaders ( DependableObject &depObj, TrackableObject &status, BaseDependency const &target,
+                                      SchedulePolicySuccessorFunctor* callback, AccessType const &accessType, unsigned int lastReader )
+            {
+               TrackableObject::DependableObjectList &readersList = status.getReaders();
+               SyncLockBlock lock4( status.getReadersLock() );
+               TrackableObject::DependableObjectList::iterator it = readersList.end();
+               while ( it != readersList.begin() ) {
+                  DependableObject *predecessorReader = *(--it);
+                  if ( (int) ( predecessorReader->getId() - lastReader ) <= 0 ) break;
+                  if ( predecessorReader == &depObj ) continue;
+
+                  dependOnReader( depObj, *predecessorReader, target, callback, accessType );
+               }
+            }
+
+            void deleteEntries ()
+            {
+               for ( unsigned int c = 0; c < NUM_CLASSES; c++ ) {
+                  for ( EntryList::iterator it = _classes[c].begin(); it != _classes[c].end(); it++ ) {
+                     delete *it;
+                  }
+                  _classes[c].clear();
+               }
+               _usedClasses = 0;
+            }
+
+         protected:
+            /*! \brief Assigns the DependableObject depObj an id in this domain and adds it to the domains dependency system.
+             *  \param depObj DependableObject to be added to the domain.
+             *  \param begin Iterator to the start of the list of dependencies to be associated to the Dependable Object.
+             *  \param end Iterator to the end of the mentioned list.
+             *  \param callback A function to call when a WD has a successor [Optional].
+             *  \sa Dependency DependableObject TrackableObject
+             */
+            template<typename iterator>
+            void submitDependableObjectInternal ( DependableObject &depObj, iterator begin, iterator end, SchedulePolicySuccessorFunctor* callback )
+            {
+               depObj.setId ( _lastDepObjId++ );
+               depObj.init();
+               depObj.setDependenciesDomain( this );
+
+               // Object is not ready to get its dependencies satisfied
+               // so we increase the number of predecessors to permit other dependableObjects to free some of
+               // its dependencies without triggering the "dependenciesSatisfied" method
+               depObj.increasePredecessors();
+
+               // Accesses to the same region are put in common
+               std::vector<IntervalRegion> targets;
+               std::vector<AccessType> accessTypes;
+               for ( iterator it = begin; it != end; it++ ) {
+                  DataAccess const &dataAccess = *it;
+
+                  // if address == NULL, just ignore it
+                  if ( dataAccess.getDepAddress() == NULL ) continue;
+
+                  IntervalRegion target( dataAccess );
+                  size_t i = 0;
+                  while ( i < targets.size() && !( targets[i] == target ) ) i++;
+                  if ( i == targets.size() ) {
+                     targets.push_back( target );
+                     accessTypes.push_back( AccessType() );
+                  }
+                  accessTypes[i] |= dataAccess.flags;
+               }
+
+               // This list is needed for waiting
+               std::list<uint64_t> flushDeps;
+
+               for ( size_t i = 0; i < targets.size(); i++ ) {
+                  submitDependableObjectDataAccess( depObj, targets[i], accessTypes[i], callback );
+                  flushDeps.push_back( (uint64_t) targets[i].getStart() );
+               }
+               sys.getDefaultSchedulePolicy()->atCreate( depObj );
+
+               // To keep the count consistent we have to increase the number of tasks in the graph before releasing the fake dependency
+               increaseTasksInGraph();
+
+               depObj.submitted();
+
+               // now everything is ready
+               depObj.decreasePredecessors( &flushDeps, NULL, false, true );
+            }
+
+            /*! \brief Adds a region access of a DependableObject to the domains dependency system.
+             *
+             *  The region itself gets the usual treatment. The task also depends on the last writer of every
+             *  other region it overlaps and, when it writes, on their readers too.
+             *
+             *  \param depObj target DependableObject
+             *  \param region accessed memory region
+             *  \param accessType kind of region access
+             *  \param callback Function to call if an immediate predecessor is found.
+             */
+            void submitDependableObjectDataAccess( DependableObject &depObj, IntervalRegion const &region, AccessType const &accessType, SchedulePolicySuccessorFunctor* callback )
+            {
+               if ( accessType.concurrent || accessType.commutative ) {
+                  if ( !( accessType.input && accessType.output ) || depObj.waits() ) {
+                     fatal( "Commutation/concurrent task must be inout" );
+                  }
+               }
+
+               if ( accessType.concurrent && accessType.commutative ) {
+                  fatal( "Task cannot be concurrent AND commutative" );
+               }
+
+               SyncRecursiveLockBlock lock1( getInstanceLock() );
+
+               std::vector<TrackableObject *> overlapping;
+               Entry &entry = lookupDependency( region, overlapping );
+               IntervalRegion const &target = entry._region;
+               TrackableObject &status = entry._status;
+
+               if ( accessType.concurrent || accessType.commutative ) {
+                  submitDependableObjectCommutativeDataAccess( depObj, target, accessType, status, callback );
+               } else if ( accessType.input && accessType.output ) {
+                  submitDependableObjectInoutDataAccess( depObj, target, accessType, status, callback );
+                  if ( !depObj.waits() ) depObj.addReadTarget( target );
+               } else if ( accessType.output ) {
+                  submitDependableObjectOutputDataAccess( depObj, target, accessType, status, callback );
+               } else if ( accessType.input ) {
+                  submitDependableObjectInputDataAccess( depObj, target, accessType, status, callback );
+                  if ( !depObj.waits() ) depObj.addReadTarget( target );
+               } else {
+                  fatal( "Invalid data access" );
+               }
+
+               // Commutative and concurrent accesses only commute with accesses to the very same region
+               bool writes = accessType.output || accessType.concurrent || accessType.commutative;
+               // Only a task which becomes the last writer of the region can rely on (and update) its marks
+               bool lastWriter = accessType.output && !accessType.concurrent && !accessType.commutative && !depObj.waits();
+               for ( std::vector<TrackableObject *>::iterator it = overlapping.begin(); it != overlapping.end(); it++ ) {
+                  TrackableObject &other = *(*it);
+                  finalizeReduction( other, target );
+                  dependOnLastWriter( depObj, other, target, callback, accessType );
+                  if ( !writes ) continue;
+
+                  ReadMark *mark = lastWriter ? entry.findMark( &other ) : NULL;
+                  if ( mark != NULL ) {
+                     dependOnNewReaders( depObj, other, target, callback, accessType, mark->_lastReader );
+                  } else {
+                     dependOnReaders( depObj, other, target, callback, accessType );
+                  }
+
+                  if ( lastWriter ) {
+                     if ( mark == NULL ) {
+                        entry._marks.push_back( ReadMark() );
+                        mark = &entry._marks.back();
+                        mark->_status = &other;
+                     }
+                     mark->_lastReader = depObj.getId();
+                  }
+               }
+            }
+
+            // Regions are not removed until the domain is cleared, so their status is released without taking the domain lock
+
+            inline void deleteLastWriter ( DependableObject &depObj, BaseDependency const &target )
+            {
+               const IntervalRegion& region( static_cast<const IntervalRegion&>( target ) );
+               region.getTrackable()->deleteLastWriter( depObj );
+            }
+
+            inline void deleteReader ( DependableObject &depObj, BaseDependency const &target )
+            {
+               const IntervalRegion& region( static_cast<const IntervalRegion&>( target ) );
+               TrackableObject &status = *region.getTrackable();
+               {
+                  SyncLockBlock lock2( status.getReadersLock() );
+                  status.deleteReader( depObj );
+               }
+            }
+
+            inline void removeCommDO ( CommutationDO *commDO, BaseDependency const &target )
+            {
+               const IntervalRegion& region( static_cast<const IntervalRegion&>( target ) );
+               TrackableObject &status = *region.getTrackable();
+
+               if ( status.getCommDO ( ) == commDO ) {
+                  status.setCommDO ( 0 );
+               }
+            }
+
+         private:
+            /*! \brief IntervalDependenciesDomain copy constructor (private) */
+            IntervalDependenciesDomain ( const IntervalDependenciesDomain &depDomain );
+            /*! \brief IntervalDependenciesDomain copy assignment operator (private) */
+            const IntervalDependenciesDomain & operator= ( const IntervalDependenciesDomain &depDomain );
+         public:
+            IntervalDependenciesDomain() : BaseDependenciesDomain(), _usedClasses( 0 ) {}
+
+            ~IntervalDependenciesDomain()
+            {
+               deleteEntries();
+            }
+
+            /*!
+             *  \note This function cannot be implemented in
+             *  BaseDependenciesDomain since it calls a template function,
+             *  and they cannot be virtual.
+             */
+            inline void submitDependableObject ( DependableObject &depObj, std::vector<DataAccess> &deps, SchedulePolicySuccessorFunctor* callback )
+            {
+               submitDependableObjectInternal ( depObj, deps.begin(), deps.end(), callback );
+            }
+
+            /*!
+             *  \note This function cannot be implemented in
+             *  BaseDependenciesDomain since it calls a template function,
+             *  and they cannot be virtual.
+             */
+            inline void submitDependableObject ( DependableObject &depObj, size_t numDeps, DataAccess* deps, SchedulePolicySuccessorFunctor* callback )
+            {
+               submitDependableObjectInternal ( depObj, deps, deps+numDeps, callback );
+            }
+
+            bool haveDependencePendantWrites ( void *addr )
+            {
+               SyncRecursiveLockBlock lock1( getInstanceLock() );
+               EntryList found;
+               findOverlapping( IntervalRegion( addr, 1 ), found );
+               for ( EntryList::iterator it = found.begin(); it != found.end(); it++ ) {
+                  if ( (*it)->_status.getLastWriter() != NULL ) return true;
+               }
+               return false;
+            }
+
+            void finalizeAllReductions ( void )
+            {
+               for ( unsigned int c = 0; c < NUM_CLASSES; c++ ) {
+                  for ( EntryList::iterator it = _classes[c].begin(); it != _classes[c].end(); it++ ) {
+                     TrackableObject &status = (*it)->_status;
+                     CommutationDO *commDO = status.getCommDO();
+                     if ( commDO != NULL ) {
+                        status.setCommDO( NULL );
+                        status.setLastWriter( *commDO );
+
+                        TaskReduction *tr = myThread->getCurrentWD()->getTaskReduction( (const void *) (*it)->_region.getAddress() );
+                        if ( tr != NULL ) {
+                           if ( myThread->getCurrentWD()->getDepth() == tr->getDepth() ) commDO->setTaskReduction( tr );
+                        }
+
+                        commDO->resetReferences();
+
+                        //! Finally decrease dummy dependence added in createCommutationDO
+                        std::list<uint64_t> flushDeps;
+                        commDO->decreasePredecessors( &flushDeps, NULL, false, false );
+                     }
+                  }
+               }
+            }
+
+            //! \brief Clear current dependencies domain
+            //!
+            //! This function should be called withing a thread safe area. It is, when other
+            //! tasks can not update the domain: after a taskwait and before any task submission.
+            void clearDependenciesDomain ( void )
+            {
+               deleteEntries();
+            }
+      };
+
+      template void IntervalDependenciesDomain::submitDependableObjectInternal ( DependableObject &depObj, DataAccess* begin, DataAccess* end, SchedulePolicySuccessorFunctor* callback );
+      template void IntervalDependenciesDomain::submitDependableObjectInternal ( DependableObject &depObj, std::vector<DataAccess>::iterator begin, std::vector<DataAccess>::iterator end, SchedulePolicySuccessorFunctor* callback );
+
+      /*! \brief Default plugin implementation.
+       */
+      class IntervalDependenciesManager : public DependenciesManager
+      {
+         public:
+            IntervalDependenciesManager() : DependenciesManager("Nanos interval regions dependencies domain") {}
+            virtual ~IntervalDependenciesManager () {}
+
+            /*! \brief Creates a default dependencies domain.
+             */
+            DependenciesDomain* createDependenciesDomain () const
+            {
+               return NEW IntervalDependenciesDomain();
+            }
+      };
+
+      class NanosDepsPlugin : public Plugin
+      {
+         public:
+            NanosDepsPlugin() : Plugin( "Nanos++ interval regions dependencies management plugin",1 )
+            {
+            }
+
+            virtual void config ( Config &cfg )
+            {
+            }
+
+            virtual void init()
+            {
+               sys.setDependenciesManager(NEW IntervalDependenciesManager());
+            }
+      };
+
+   }
+}
+
+DECLARE_PLUGIN("deps-intervals",nanos::ext::NanosDepsPlugin);
@@ -0,0 +1,363 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+
+#include "basedependenciesdomain.hpp"
+#include "plugin.hpp"
+#include "system.hpp"
+#include "config.hpp"
+#include "address.hpp"
+#include "compatibility.hpp"
+
+namespace nanos {
+   namespace ext {
+
+#define NANOS_SHARDED_DEPS_INLINE 16   /* Accesses per task handled without alloca */
+
+      /*! \brief Dependencies domain where the address map is split in shards.
+       *
+       *  Each shard has its own lock, so submitting a task only serializes with the
+       *  tasks accessing addresses of the same shard (instead of taking the domain
+       *  recursive lock), and finishing tasks only lock the shards of their accesses.
+       *  The lookups of all the accesses of a task are done in a batch, and no temporary
+       *  containers are allocated during the submission.
+       */
+      class ShardedDependenciesDomain : public BaseDependenciesDomain
+      {
+         public:
+            static unsigned int _numShards;   /**< Number of shards (a power of two) */
+
+         private:
+            typedef TR1::unordered_map<Address::TargetType, TrackableObject*> DepsMap; /**< Maps addresses to Trackable objects */
+
+            /*! \brief A part of the address map with its own lock, padded to avoid false sharing */
+            struct Shard {
+               Lock     _lock;
+               DepsMap  _map;
+               char     _pad[128];
+            };
+
+         private:
+            Shard         *_shards;     /**< Address map shards */
+            unsigned int   _shardMask;  /**< _numShards - 1 */
+
+         private:
+            Shard & getShard ( Address::TargetType address ) const
+            {
+               // Skip the lower bits, consecutive objects usually are aligned
+               uintptr_t key = ( (uintptr_t) address ) >> 4;
+               key ^= key >> 11;
+               return _shards[ key & _shardMask ];
+            }
+
+            //! \brief Looks for the dependency's address, returns the trackableObject associated
+            //! \param shard Shard of the address, it must be locked by the caller
+            //! \param target Accessed address
+            TrackableObject* lookupDependency ( Shard &shard, const Address& target )
+            {
+               DepsMap::iterator it = shard._map.find( target() );
+               if ( it != shard._map.end() ) return it->second;
+
+               TrackableObject *status = NEW TrackableObject();
+               shard._map.insert( std::make_pair( target(), status ) );
+               return status;
+            }
+
+            TrackableObject* findDependency ( Shard &shard, const Address& target )
+            {
+               DepsMap::iterator it = shard._map.find( target() );
+               return it != shard._map.end() ? it->second : NULL;
+            }
+
+         protected:
+            //! \brief Assigns the DependableObject depObj an id in this domain and adds it to the domains dependency system.
+            //! \param depObj DependableObject to be added to the domain.
+            //! \param begin Iterator to the start of the list of dependencies to be associated to the Dependable Object.
+            //! \param end Iterator to the end of the mentioned list.
+            //! \param callback A function to call when a WD has a successor [Optional].
+            //! \sa Dependency DependableObject TrackableObject
+            template<typename iterator>
+            void submitDependableObjectInternal ( DependableObject &depObj, iterator begin, iterator end,
+                                                  SchedulePolicySuccessorFunctor* callback )
+            {
+               // Initializing several properties of the depObject
+               depObj.setId ( _lastDepObjId++ );
+               depObj.init();
+               depObj.setDependenciesDomain( this );
+
+               // Object is not ready to get its dependencies satisfied, so we increase the
+               // number of predecessors to permit other dependableObjects to free some of
+               // its dependencies without triggering the "dependenciesSatisfied" method.
+               depObj.increasePredecessors();
+
+               // Look up the trackable objects of all the accesses first, locking each shard once
+               // for consecutive accesses of the same shard. The accesses are added afterwards
+               // without holding any shard lock (it is taken by finishing tasks with other
+               // locks held, see deleteLastWriter).
+               TrackableObject *statusBuffer[NANOS_SHARDED_DEPS_INLINE];
+               size_t numDeps = end - begin;
+               TrackableObject **status = numDeps <= NANOS_SHARDED_DEPS_INLINE ?
+                  statusBuffer : (TrackableObject **) alloca( sizeof(TrackableObject *) * numDeps );
+
+               Shard *locked = NULL;
+               size_t i = 0;
+               for ( iterator it = begin; it != end; it++, i++ ) {
+                  Address::TargetType target = it->getDepAddress();
+                  if ( target == NULL ) continue;
+
+                  Shard &shard = getShard( target );
+                  if ( &shard != locked ) {
+                     if ( locked != NULL ) locked->_lock.release();
+                     shard._lock.acquire();
+                     locked = &shard;
+                  }
+                  status[i] = lookupDependency( shard, target );
+               }
+               if ( locked != NULL ) locked->_lock.release();
+
+               // Iterate from begin to end, just to handle each data access
+               i = 0;
+               for ( iterator it = begin; it != end; it++, i++ ) {
+                  DataAccess &dep = (*it);
+                  Address target = dep.getDepAddress();
+
+                  // if address == NULL, just ignore it
+                  if ( target() == NULL ) continue;
+                  AccessType const &accessType = dep.flags;
+
+                  submitDependableObjectDataAccess( depObj, *status[i], target, accessType, callback );
+               }
+
+               // Calling scheduler policy "atCreate"
+               sys.getDefaultSchedulePolicy()->atCreate( depObj );
+
+               // To Task In Graph count consistent before releasing the fake dependency
+               increaseTasksInGraph();
+
+               depObj.submitted();
+
+               // Now everything is ready, release fake dependency (flushDeps are not used)
+               depObj.decreasePredecessors( NULL, NULL, false, true );
+            }
+
+            //! \brief Adds a region access of a DependableObject to the domains dependency system.
+            //! \param depObj target DependableObject
+            //! \param status status of the accessed address
+            //! \param target accessed memory address
+            //! \param accessType kind of region access
+            //! \param callback Function to call if an immediate predecessor is found.
+            void submitDependableObjectDataAccess( DependableObject &depObj, TrackableObject &status, Address const &target,
+                                                   AccessType const &accessType, SchedulePolicySuccessorFunctor* callback )
+            {
+
+               ensure(!(accessType.concurrent && accessType.commutative),"Task cannot be concurrent AND commutative");
+
+               if ( status.getLastWriter() == &depObj ) return;
+
+               if ( accessType.concurrent || accessType.commutative ) {
+                  ensure(accessType.input && accessType.output,"Commutative & concurrent must be inout");
+                  ensure(!depObj.waits(), "Commutative & concurrent should not wait" );
+                  submitDependableObjectCommutativeDataAccess( depObj, target, accessType, status, callback );
+               } else if ( accessType.output && accessType.input ) {
+                  submitDependableObjectInoutDataAccess( depObj, target, accessType, status, callback );
+                  // See PlainDependenciesDomain, write targets are added when finding a writer
+                  if ( !depObj.waits() ) depObj.addReadTarget( target );
+               } else if ( accessType.output ) {
+                  submitDependableObjectOutputDataAccess( depObj, target, accessType, status, callback );
+               } else if ( accessType.input  ) {
+                  submitDependableObjectInputDataAccess( depObj, target, accessType, status, callback );
+                  if ( !depObj.waits() ) depObj.addReadTarget( target );
+               } else {
+                  fatal( "Invalid data access" );
+               }
+
+            }
+
+            inline void deleteLastWriter ( DependableObject &depObj, BaseDependency const &target )
+            {
+               const Address& address( static_cast<const Address&>( target ) );
+               Shard &shard = getShard( address() );
+               LockBlock lock1( shard._lock );
+               TrackableObject *status = findDependency( shard, address );
+
+               if ( status != NULL ) status->deleteLastWriter(depObj);
+            }
+
+            inline void deleteReader ( DependableObject &depObj, BaseDependency const &target )
+            {
+               const Address& address( static_cast<const Address&>( target ) );
+               Shard &shard = getShard( address() );
+               LockBlock lock1( shard._lock );
+               TrackableObject *status = findDependency( shard, address );
+
+               if ( status != NULL ) {
+                  SyncLockBlock lock2( status->getReadersLock() );
+                  status->deleteReader(depObj);
+               }
+            }
+
+            inline void removeCommDO ( CommutationDO *commDO, BaseDependency const &target )
+            {
+               const Address& address( static_cast<const Address&>( target ) );
+               Shard &shard = getShard( address() );
+               LockBlock lock1( shard._lock );
+               TrackableObject *status = findDependency( shard, address );
+
+               if ( status != NULL && status->getCommDO ( ) == commDO ) {
+                  status->setCommDO ( 0 );
+               }
+            }
+
+            void createShards ()
+            {
+               _shards = NEW Shard[_numShards];
+               _shardMask = _numShards - 1;
+            }
+
+         public:
+            ShardedDependenciesDomain() : BaseDependenciesDomain(), _shards( NULL ), _shardMask( 0 ) { createShards(); }
+            ShardedDependenciesDomain ( const ShardedDependenciesDomain &depDomain )
+               : BaseDependenciesDomain( depDomain ), _shards( NULL ), _shardMask( 0 )
+            {
+               createShards();
+               for ( unsigned int i = 0; i < _numShards; i++ ) {
+                  _shards[i]._map = depDomain._shards[i]._map;
+               }
+            }
+
+            ~ShardedDependenciesDomain()
+            {
+               for ( unsigned int i = 0; i < _numShards; i++ ) {
+                  DepsMap &map = _shards[i]._map;
+                  for ( DepsMap::iterator it = map.begin(); it != map.end(); it++ ) {
+                     delete it->second;
+                  }
+               }
+               delete[] _shards;
+            }
+
+            /*!
+             *  \note This function cannot be implemented in
+             *  BaseDependenciesDomain since it calls a template function,
+             *  and they cannot be virtual.
+             */
+            inline void submitDependableObject ( DependableObject &depObj, std::vector<DataAccess> &deps, SchedulePolicySuccessorFunctor* callback )
+            {
+               submitDependableObjectInternal ( depObj, deps.begin(), deps.end(), callback );
+            }
+
+            /*!
+             *  \note This function cannot be implemented in
+             *  BaseDependenciesDomain since it calls a template function,
+             *  and they cannot be virtual.
+             */
+            inline void submitDependableObject ( DependableObject &depObj, size_t numDeps, DataAccess* deps, SchedulePolicySuccessorFunctor* callback )
+            {
+               submitDependableObjectInternal ( depObj, deps, deps+numDeps, callback );
+            }
+
+            bool haveDependencePendantWrites ( void *addr )
+            {
+               Shard &shard = getShard( addr );
+               LockBlock lock1( shard._lock );
+               TrackableObject *status = findDependency( shard, addr );
+
+               return status != NULL && status->getLastWriter() != NULL;
+            }
+
+            void finalizeAllReductions ( void )
+            {
+               for ( unsigned int i = 0; i < _numShards; i++ ) {
+                  DepsMap &map = _shards[i]._map;
+                  for ( DepsMap::iterator it = map.begin(); it != map.end(); it++ ) {
+                     TrackableObject& status = *( it->second );
+                     Address::TargetType target = it->first;
+                     CommutationDO *commDO = status.getCommDO();
+                     if ( commDO != NULL ) {
+                        status.setCommDO( NULL );
+                        status.setLastWriter( *commDO );
+
+                        TaskReduction *tr = myThread->getCurrentWD()->getTaskReduction( (const void *) target );
+                        if ( tr != NULL ) {
+                           if ( myThread->getCurrentWD()->getDepth() == tr->getDepth() )
+                              commDO->setTaskReduction( tr );
+                        }
+
+                        commDO->resetReferences();
+
+                        //! Finally decrease dummy dependence added in createCommutationDO
+                        commDO->decreasePredecessors( NULL, NULL, false, false );
+                     }
+                  }
+               }
+            }
+      };
+
+      unsigned int ShardedDependenciesDomain::_numShards = 64;
+
+      template void ShardedDependenciesDomain::submitDependableObjectInternal ( DependableObject &depObj, DataAccess* begin, DataAccess* end, SchedulePolicySuccessorFunctor* callback );
+      template void ShardedDependenciesDomain::submitDependableObjectInternal ( DependableObject &depObj, std::vector<DataAccess>::iterator begin, std::vector<DataAccess>::iterator end, SchedulePolicySuccessorFunctor* callback );
+
+      /*! \brief Sharded dependencies plugin implementation.
+       */
+      class ShardedDependenciesManager : public DependenciesManager
+      {
+         public:
+            ShardedDependenciesManager() : DependenciesManager("Nanos sharded dependencies domain") {}
+            virtual ~ShardedDependenciesManager () {}
+
+            /*! \brief Creates a sharded dependencies domain.
+             */
+            DependenciesDomain* createDependenciesDomain () const
+            {
+               return NEW ShardedDependenciesDomain();
+            }
+      };
+
+      class NanosShardedDepsPlugin : public Plugin
+      {
+
+         public:
+            NanosShardedDepsPlugin() : Plugin( "Nanos++ sharded dependencies management plugin",1 )
+            {
+            }
+
+            virtual void config ( Config &cfg )
+            {
+               cfg.setOptionsSection( "Sharded deps module", "Sharded dependencies management module" );
+
+               cfg.registerConfigOption ( "deps-shards", NEW Config::UintVar( ShardedDependenciesDomain::_numShards ),
+                                          "Number of shards of the address map of each dependencies domain (default = 64)" );
+               cfg.registerArgOption ( "deps-shards", "deps-shards" );
+               cfg.registerEnvOption ( "deps-shards", "NX_DEPS_SHARDS" );
+            }
+
+            virtual void init()
+            {
+               // Round the number of shards up to a power of two
+               unsigned int shards = 1;
+               while ( shards < ShardedDependenciesDomain::_numShards ) shards <<= 1;
+               ShardedDependenciesDomain::_numShards = shards;
+
+               sys.setDependenciesManager(NEW ShardedDependenciesManager());
+            }
+      };
+
+   }
+}
+
+DECLARE_PLUGIN("deps-sharded",nanos::ext::NanosShardedDepsPlugin);
@@ -0,0 +1,249 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+#include <map>
+#include <string>
+#include <sstream>
+#include <stdio.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include "plugin.hpp"
+#include "system.hpp"
+#include "os.hpp"
+#include "instrumentation.hpp"
+#include "bufferedinstrumentation_decl.hpp"
+#include "instrumentationcontext_decl.hpp"
+#include "binarytrace.hpp"
+
+namespace nanos {
+
+class InstrumentationBinaryTrace: public BufferedInstrumentation
+{
+   public:
+      static std::string _traceDirectory;
+
+#ifndef NANOS_INSTRUMENTATION_ENABLED
+   public:
+      // constructor
+      InstrumentationBinaryTrace() : BufferedInstrumentation() {}
+      // destructor
+      ~InstrumentationBinaryTrace() {}
+
+      // low-level instrumentation interface (mandatory functions)
+      void initialize( void ) {}
+      void finalize( void ) {}
+      void disable( void ) {}
+      void enable( void ) {}
+      void addResumeTask( WorkDescriptor &w ) {}
+      void addSuspendTask( WorkDescriptor &w, bool last ) {}
+      void addEventList ( unsigned int count, Event *events ) {}
+      void threadStart( BaseThread &thread ) {}
+      void threadFinish ( BaseThread &thread ) {}
+#else
+   private:
+      // Stream file of a thread, only accessed by the drainer
+      struct Stream {
+         FILE                *_file;
+         unsigned long long   _lastTime;
+         Stream () : _file( NULL ), _lastTime( 0 ) {}
+      };
+      typedef std::map<int, Stream> Streams;
+
+      Streams        _streams;
+      bool           _failed;      // the trace directory could not be written, records are dropped
+      unsigned char  _record[BinaryTrace::MAX_RECORD];
+
+      static void writeString ( FILE *file, const std::string &str )
+      {
+         unsigned char buf[BinaryTrace::MAX_VARINT];
+         fwrite( buf, 1, BinaryTrace::encode( buf, str.size() ), file );
+         fwrite( str.c_str(), 1, str.size(), file );
+      }
+
+      FILE * openFile ( const std::string &name, int thread, unsigned long long baseTime )
+      {
+         std::string path = _traceDirectory + "/" + name;
+         FILE *file = fopen( path.c_str(), "w" );
+         if ( file == NULL ) {
+            warning0( "Binary trace: could not create " << path << ", the trace will be incomplete" );
+            _failed = true;
+            return NULL;
+         }
+         BinaryTrace::FileHeader header;
+         BinaryTrace::initHeader( header, thread, baseTime );
+         fwrite( &header, sizeof( header ), 1, file );
+         return file;
+      }
+
+      Stream & getStream ( int thread, unsigned long long time )
+      {
+         Stream &stream = _streams[thread];
+         if ( stream._file == NULL && !_failed ) {
+            std::ostringstream name;
+            name << "thread." << thread;
+            stream._file = openFile( name.str(), thread, time );
+            stream._lastTime = time;
+         }
+         return stream;
+      }
+
+      void writeDictionary ( void )
+      {
+         FILE *file = openFile( "dictionary", -1, 0 );
+         if ( file == NULL ) return;
+
+         unsigned char buf[2 * BinaryTrace::MAX_VARINT + 1];
+         InstrumentationDictionary *iD = getInstrumentationDictionary();
+         InstrumentationDictionary::ConstKeyMapIterator itK;
+         InstrumentationKeyDescriptor::ConstValueMapIterator itV;
+
+         for ( itK = iD->beginKeyMap(); itK != iD->endKeyMap(); itK++ ) {
+            InstrumentationKeyDescriptor *kD = itK->second;
+            if ( kD->getId() == 0 ) continue; // disabled, never raised
+            size_t n = 0;
+            buf[n++] = 'K';
+            n += BinaryTrace::encode( &buf[n], kD->getId() );
+            buf[n++] = kD->isStacked() ? 1 : 0;
+            fwrite( buf, 1, n, file );
+            writeString( file, itK->first );
+            writeString( file, kD->getDescription() );
+
+            for ( itV = kD->beginValueMap(); itV != kD->endValueMap(); itV++ ) {
+               n = 0;
+               buf[n++] = 'V';
+               n += BinaryTrace::encode( &buf[n], kD->getId() );
+               n += BinaryTrace::encode( &buf[n], itV->second->getId() );
+               fwrite( buf, 1, n, file );
+               writeString( file, itV->first );
+               writeString( file, itV->second->getDescription() );
+            }
+         }
+         fclose( file );
+      }
+
+   public:
+      // constructor
+      InstrumentationBinaryTrace() : BufferedInstrumentation( *new InstrumentationContextDisabled() ),
+                                     _streams(), _failed( false ) {}
+      // destructor
+      ~InstrumentationBinaryTrace() {}
+
+      // low-level instrumentation interface (mandatory functions)
+      void initialize( void )
+      {
+         if ( _traceDirectory.empty() ) {
+            std::string program = OS::getArg( 0 );
+            size_t slash = program.find_last_of( "/" );
+            if ( slash != std::string::npos ) program = program.substr( slash + 1 );
+            std::ostringstream dir;
+            dir << program << "_" << getpid() << ".nxbt";
+            _traceDirectory = dir.str();
+         }
+         if ( mkdir( _traceDirectory.c_str(), 0755 ) != 0 && errno != EEXIST ) {
+            warning0( "Binary trace: could not create directory " << _traceDirectory << ", no trace will be written" );
+            _failed = true;
+         }
+
+         BufferedInstrumentation::initialize();
+      }
+      void finalize( void )
+      {
+         BufferedInstrumentation::finalize();
+
+         for ( Streams::iterator it = _streams.begin(); it != _streams.end(); it++ ) {
+            if ( it->second._file != NULL ) fclose( it->second._file );
+            it->second._file = NULL;
+         }
+         if ( !_failed ) {
+            writeDictionary();
+            message0( "Binary trace written to " << _traceDirectory << " (see nanox-trace to convert it)" );
+         }
+      }
+      void disable( void ) {}
+      void enable( void ) {}
+      void addResumeTask( WorkDescriptor &w ) {}
+      void addSuspendTask( WorkDescriptor &w, bool last ) {}
+      void threadStart( BaseThread &thread ) {}
+      void threadFinish ( BaseThread &thread ) {}
+
+   protected:
+      void processEvents ( unsigned int count, const EventRecord *records )
+      {
+         if ( _failed ) return;
+
+         Stream *stream = NULL;
+         for ( unsigned int i = 0; i < count; i++ ) {
+            const EventRecord &r = records[i];
+            // Records of a buffer come from the same OS thread, but it may not be a runtime thread yet
+            if ( stream == NULL || r._thread != records[i-1]._thread ) {
+               stream = &getStream( r._thread, r._time );
+               if ( stream->_file == NULL ) return;
+            }
+
+            // Several non-runtime threads share stream -1, keep its timestamps monotonic
+            unsigned long long time = r._time > stream->_lastTime ? r._time : stream->_lastTime;
+            const Event &e = r._event;
+            size_t n = BinaryTrace::encode( _record, time - stream->_lastTime );
+            _record[n++] = (unsigned char) e.getType();
+            n += BinaryTrace::encode( &_record[n], e.getKey() );
+            n += BinaryTrace::encode( &_record[n], e.getValue() );
+            if ( e.getType() == NANOS_PTP_START || e.getType() == NANOS_PTP_END ) {
+               n += BinaryTrace::encode( &_record[n], e.getDomain() );
+               n += BinaryTrace::encode( &_record[n], BinaryTrace::zigzag( e.getId() ) );
+               n += BinaryTrace::encode( &_record[n], e.getPartner() );
+            }
+            fwrite( _record, 1, n, stream->_file );
+            stream->_lastTime = time;
+         }
+      }
+#endif
+};
+
+std::string InstrumentationBinaryTrace::_traceDirectory = "";
+
+namespace ext {
+
+class InstrumentationBinaryTracePlugin : public Plugin {
+   public:
+      InstrumentationBinaryTracePlugin () : Plugin("Instrumentation which writes a compact binary trace.",1) {}
+      ~InstrumentationBinaryTracePlugin () {}
+
+      void config( Config &cfg )
+      {
+         cfg.setOptionsSection( "Binary trace plugin", "Binary trace instrumentation plugin specific options" );
+         cfg.registerConfigOption( "binary-trace-dir", NEW Config::StringVar( InstrumentationBinaryTrace::_traceDirectory ),
+                                   "Directory where the trace is written (default: <program>_<pid>.nxbt)" );
+         cfg.registerArgOption( "binary-trace-dir", "binary-trace-dir" );
+
+         BufferedInstrumentation::config( cfg );
+      }
+
+      void init ()
+      {
+         sys.setInstrumentation( new InstrumentationBinaryTrace() );
+      }
+};
+
+} // namespace ext
+
+} // namespace nanos
+
+DECLARE_PLUGIN("instrumentation-binary_trace",nanos::ext::InstrumentationBinaryTracePlugin);
@@ -0,0 +1,151 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+#include <map>
+#include "plugin.hpp"
+#include "system.hpp"
+#include "instrumentation.hpp"
+#include "bufferedinstrumentation_decl.hpp"
+#include "instrumentationcontext_decl.hpp"
+
+namespace nanos {
+
+class InstrumentationEventCount: public BufferedInstrumentation
+{
+#ifndef NANOS_INSTRUMENTATION_ENABLED
+   public:
+      // constructor
+      InstrumentationEventCount() : BufferedInstrumentation() {}
+      // destructor
+      ~InstrumentationEventCount() {}
+
+      // low-level instrumentation interface (mandatory functions)
+      void initialize( void ) {}
+      void finalize( void ) {}
+      void disable( void ) {}
+      void enable( void ) {}
+      void addResumeTask( WorkDescriptor &w ) {}
+      void addSuspendTask( WorkDescriptor &w, bool last ) {}
+      void addEventList ( unsigned int count, Event *events ) {}
+      void threadStart( BaseThread &thread ) {}
+      void threadFinish ( BaseThread &thread ) {}
+#else
+   private:
+      struct ThreadCount {
+         unsigned long        _events;
+         unsigned long long   _first;   // timestamp of the first event
+         unsigned long long   _last;    // timestamp of the last event
+         ThreadCount () : _events( 0 ), _first( 0 ), _last( 0 ) {}
+      };
+      typedef std::map<nanos_event_key_t, unsigned long> KeyCounts;
+      typedef std::map<int, ThreadCount> ThreadCounts;
+
+      KeyCounts      _keyCounts;      // only accessed by the drainer
+      KeyCounts      _burstStarts;    // only accessed by the drainer
+      KeyCounts      _burstEnds;      // only accessed by the drainer
+      ThreadCounts   _threadCounts;   // only accessed by the drainer
+      unsigned long  _stateCount;
+
+   public:
+      // constructor
+      InstrumentationEventCount() : BufferedInstrumentation( *new InstrumentationContextDisabled() ),
+                                    _keyCounts(), _burstStarts(), _burstEnds(),
+                                    _threadCounts(), _stateCount( 0 ) {}
+      // destructor
+      ~InstrumentationEventCount() {}
+
+      // low-level instrumentation interface (mandatory functions)
+      void finalize( void )
+      {
+         BufferedInstrumentation::finalize();
+
+         InstrumentationDictionary *iD = getInstrumentationDictionary();
+         for ( ThreadCounts::iterator it = _threadCounts.begin(); it != _threadCounts.end(); it++ ) {
+            fprintf( stderr, "NANOS++: (EVENTS) Thread %d raised %lu events in %.3f ms\n", it->first, it->second._events,
+                     (double) ( it->second._last - it->second._first ) * 1.0e-6 );
+         }
+         fprintf( stderr, "NANOS++: (EVENTS) %lu state events\n", _stateCount );
+         // Bursts may end in another thread, but never end more times than they start
+         unsigned long unmatched = 0;
+         for ( KeyCounts::iterator it = _burstEnds.begin(); it != _burstEnds.end(); it++ ) {
+            unsigned long starts = _burstStarts[it->first];
+            if ( it->second > starts ) unmatched += it->second - starts;
+         }
+         fprintf( stderr, "NANOS++: (EVENTS) %lu burst ends without a start\n", unmatched );
+         for ( KeyCounts::iterator it = _keyCounts.begin(); it != _keyCounts.end(); it++ ) {
+            fprintf( stderr, "NANOS++: (EVENTS) %lu events of %s\n", it->second, iD->getKeyDescription( it->first ).c_str() );
+         }
+      }
+      void disable( void ) {}
+      void enable( void ) {}
+      void addResumeTask( WorkDescriptor &w ) {}
+      void addSuspendTask( WorkDescriptor &w, bool last ) {}
+      void threadStart( BaseThread &thread ) {}
+      void threadFinish ( BaseThread &thread ) {}
+
+   protected:
+      void processEvents ( unsigned int count, const EventRecord *records )
+      {
+         ThreadCount *thread = NULL;
+
+         for ( unsigned int i = 0; i < count; i++ ) {
+            // Records of a buffer come from the same OS thread, but it may not be a runtime thread yet
+            if ( thread == NULL || records[i]._thread != records[i-1]._thread ) {
+               thread = &_threadCounts[records[i]._thread];
+               if ( thread->_events == 0 ) thread->_first = records[i]._time;
+            }
+            thread->_events++;
+            thread->_last = records[i]._time;
+
+            const Event &e = records[i]._event;
+            if ( e.getType() == NANOS_STATE_START || e.getType() == NANOS_STATE_END || e.getType() == NANOS_SUBSTATE_START ||
+                 e.getType() == NANOS_SUBSTATE_END ) _stateCount++;
+            else if ( e.getKey() != 0 ) {
+               _keyCounts[e.getKey()]++;
+               if ( e.getType() == NANOS_BURST_START ) _burstStarts[e.getKey()]++;
+               else if ( e.getType() == NANOS_BURST_END ) _burstEnds[e.getKey()]++;
+            }
+         }
+      }
+#endif
+};
+
+namespace ext {
+
+class InstrumentationEventCountPlugin : public Plugin {
+   public:
+      InstrumentationEventCountPlugin () : Plugin("Instrumentation which counts the events of each thread and key.",1) {}
+      ~InstrumentationEventCountPlugin () {}
+
+      void config( Config &cfg )
+      {
+         BufferedInstrumentation::config( cfg );
+      }
+
+      void init ()
+      {
+         sys.setInstrumentation( new InstrumentationEventCount() );
+      }
+};
+
+} // namespace ext
+
+} // namespace nanos
+
+DECLARE_PLUGIN("instrumentation-event_count",nanos::ext::InstrumentationEventCountPlugin);
@@ -2107,7 +2107,7 @@ namespace nanos {
                // }
                if ( locs.empty() ) {
                   //(*myThread->_file) << "empty list, version "<<  wd._mcontrol._memCacheCopies[ i ]._version << std::endl;
-                  for ( std::set< memory_space_id_t >::const_iterator locIt = wd._mcontrol._memCacheCopies[ i ]._reg.getLocations().begin();
+                  for ( LocationSet::const_iterator locIt = wd._mcontrol._memCacheCopies[ i ]._reg.getLocations().begin();
                         locIt != wd._mcontrol._memCacheCopies[ i ]._reg.getLocations().end(); locIt++ ) {
                      memory_space_id_t loc = *locIt;
                      unsigned int score_idx = ( loc != 0 ? sys.getSeparateMemory( loc ).getNodeNumber() : 0 );
@@ -2131,7 +2131,7 @@ namespace nanos {
                      global_reg_t data_source_reg( it->second, wd._mcontrol._memCacheCopies[ i ]._reg.key );
                      global_reg_t region_shape( it->first, wd._mcontrol._memCacheCopies[ i ]._reg.key );
 
-                     for ( std::set< memory_space_id_t >::const_iterator locIt = data_source_reg.getLocations().begin();
+                     for ( LocationSet::const_iterator locIt = data_source_reg.getLocations().begin();
                            locIt != data_source_reg.getLocations().end(); locIt++ ) {
                         memory_space_id_t loc = *locIt;
 
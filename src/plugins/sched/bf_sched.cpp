@@ -35,7 +35,8 @@ namespace nanos {
 
               TeamData () : ScheduleTeamData(), _readyQueue( NULL )
               {
-                if ( _usePriority || _useSmartPriority ) _readyQueue = NEW WDPriorityQueue<>( true /* enableDeviceCounter */, true /* optimise option */ );
+                if ( _usePriority || _useSmartPriority ) _readyQueue = NEW WDBucketPriorityQueue( true /* enableDeviceCounter */ );
+                else if ( _useLockFreeQueue ) _readyQueue = NEW WDMPMCQueue();
                 else _readyQueue = NEW WDDeque( true /* enableDeviceCounter */ );
               }
               ~TeamData () { delete _readyQueue; }
@@ -45,6 +46,7 @@ namespace nanos {
            static bool       _useStack;
            static bool       _usePriority;
            static bool       _useSmartPriority;
+           static bool       _useLockFreeQueue;
 
            BreadthFirst() : SchedulePolicy("Breadth First")
            {
@@ -157,7 +159,7 @@ namespace nanos {
                   
                   // Reorder
                   TeamData &tdata = (TeamData &) *myThread->getTeam()->getScheduleData();
-                  WDPriorityQueue<> *q = (WDPriorityQueue<> *) tdata._readyQueue;
+                  WDBucketPriorityQueue *q = (WDBucketPriorityQueue *) tdata._readyQueue;
                   q->reorderWD( pred );
                }
             }
@@ -182,7 +184,7 @@ namespace nanos {
            {
               WD * found = current.getImmediateSuccessor(*thread);
               if ( found && (_usePriority || _useSmartPriority) ) {
-                 WDPriorityQueue<> &tdata = (WDPriorityQueue<> &) *((TeamData *) thread->getTeam()->getScheduleData())->_readyQueue;
+                 WDBucketPriorityQueue &tdata = (WDBucketPriorityQueue &) *((TeamData *) thread->getTeam()->getScheduleData())->_readyQueue;
                  if (found->getPriority() < tdata.maxPriority() ) {
                     queue(thread, *found);
                     found = NULL;
@@ -195,7 +197,7 @@ namespace nanos {
            {
               WD * found = current.getImmediateSuccessor(*thread);
               if ( found && (_usePriority || _useSmartPriority) && schedule ) {
-                 WDPriorityQueue<> &tdata = (WDPriorityQueue<> &) *((TeamData *) thread->getTeam()->getScheduleData())->_readyQueue;
+                 WDBucketPriorityQueue &tdata = (WDBucketPriorityQueue &) *((TeamData *) thread->getTeam()->getScheduleData())->_readyQueue;
                  if (found->getPriority() < tdata.maxPriority() ) {
                     queue(thread, *found);
                     found = NULL;
@@ -208,7 +210,7 @@ namespace nanos {
             {
               //! \bug FIXME flags of priority must be in queue
                if ( _usePriority || _useSmartPriority ) {
-                  WDPriorityQueue<> *q = (WDPriorityQueue<> *) wd->getMyQueue();
+                  WDBucketPriorityQueue *q = (WDBucketPriorityQueue *) wd->getMyQueue();
                   return q? q->reorderWD( wd ) : true;
                } else {
                   return true;
@@ -230,6 +232,7 @@ namespace nanos {
       bool BreadthFirst::_useStack = false;
       bool BreadthFirst::_usePriority = true;
       bool BreadthFirst::_useSmartPriority = false;
+      bool BreadthFirst::_useLockFreeQueue = false;
 
       class BFSchedPlugin : public Plugin
       {
@@ -252,6 +255,9 @@ namespace nanos {
                cfg.registerConfigOption ( "schedule-smart-priority", NEW Config::FlagOption( BreadthFirst::_useSmartPriority ), "Smart priority queue propagates high priorities to predecessors");
                cfg.registerArgOption( "schedule-smart-priority", "schedule-smart-priority" );
 
+               cfg.registerConfigOption ( "bf-lock-free-queue", NEW Config::FlagOption( BreadthFirst::_useLockFreeQueue ), "Use a lock-free queue with one ring per device as ready queue when priorities are not used");
+               cfg.registerArgOption( "bf-lock-free-queue", "bf-lock-free-queue" );
+
             }
 
             virtual void init() {
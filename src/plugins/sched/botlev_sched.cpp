@@ -127,10 +127,10 @@ namespace nanos {
             struct TeamData : public ScheduleTeamData
             {
                /*! queues of ready tasks to be executed */
-               WDPriorityQueue<> *_readyQueues;
+               WDBucketPriorityQueue *_readyQueues;
                TeamData () : ScheduleTeamData()
                {
-                  _readyQueues = NEW WDPriorityQueue<>[3];
+                  _readyQueues = NEW WDBucketPriorityQueue[3];
                }
                virtual ~TeamData () { delete[] _readyQueues; }
             };
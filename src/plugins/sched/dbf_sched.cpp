@@ -30,6 +30,7 @@ namespace nanos {
          public:
             static bool       _usePriority;
             static bool       _useSmartPriority;
+            static bool       _useStealDeque;
          private:
             /** \brief DistributedBF Scheduler data associated to each thread
               *
@@ -38,13 +39,19 @@ namespace nanos {
             {
                /*! queue of ready tasks to be executed */
                WDPool *_readyQueue;
+               WDStealDeque *_stealDeque;
 
-               ThreadData () : ScheduleThreadData(), _readyQueue( NULL )
+               ThreadData () : ScheduleThreadData(), _readyQueue( NULL ), _stealDeque( NULL )
                {
-                 if ( _usePriority || _useSmartPriority ) _readyQueue = NEW WDPriorityQueue<>( true /* enableDeviceCounter */, true /* optimise option */ );
+                 if ( _usePriority || _useSmartPriority ) _readyQueue = NEW WDBucketPriorityQueue( true /* enableDeviceCounter */ );
+                 else if ( _useStealDeque ) _readyQueue = _stealDeque = NEW WDStealDeque();
                  else _readyQueue = NEW WDDeque( true /* enableDeviceCounter */ );
                }
                virtual ~ThreadData () { delete _readyQueue; }
+
+               /*! \brief Binds the queue to the thread owning this data (needed by the steal deque)
+                */
+               void bind ( BaseThread *thread ) { if ( _stealDeque ) _stealDeque->setOwner( thread ); }
             };
 
             /* disable copy and assigment */
@@ -114,7 +121,7 @@ namespace nanos {
 
                   // Reorder
                   ThreadData &tdata = (ThreadData &) *myThread->getTeam()->getScheduleData();
-                  WDPriorityQueue<> *q = (WDPriorityQueue<> *) tdata._readyQueue;
+                  WDBucketPriorityQueue *q = (WDBucketPriorityQueue *) tdata._readyQueue;
                   q->reorderWD( pred );
                }
             }
@@ -131,6 +138,7 @@ namespace nanos {
                if ( targetThread ) targetThread->addNextWD(&wd);
                else {
                   ThreadData &data = ( ThreadData & ) *thread->getTeamData()->getScheduleData();
+                  data.bind( thread );
                   data._readyQueue->push_front( &wd );
                   sys.getThreadManager()->unblockThread(thread);
                }
@@ -162,7 +170,7 @@ namespace nanos {
             {
               //! \bug FIXME flags of priority must be in queue
                if ( _usePriority || _useSmartPriority ) {
-                  WDPriorityQueue<> *q = (WDPriorityQueue<> *) wd->getMyQueue();
+                  WDBucketPriorityQueue *q = (WDBucketPriorityQueue *) wd->getMyQueue();
                   return q? q->reorderWD( wd ) : true;
                } else {
                   return true;
@@ -197,6 +205,7 @@ namespace nanos {
          WorkDescriptor * next = NULL; 
 
          ThreadData &data = ( ThreadData & ) *thread->getTeamData()->getScheduleData();
+         data.bind( thread );
 
          //! First try to schedule the thread with a task from its queue
          if ( ( wd = data._readyQueue->pop_front ( thread ) ) != NULL ) {
@@ -227,6 +236,7 @@ namespace nanos {
 
                if ( victim.getTeam() != NULL ) {
                  ThreadData &tdata = ( ThreadData & ) *victim.getTeamData()->getScheduleData();
+                 tdata.bind( &victim );
                  wd = tdata._readyQueue->pop_back ( thread );
                }
 
@@ -240,6 +250,7 @@ namespace nanos {
 
       bool DistributedBFPolicy::_usePriority = true;
       bool DistributedBFPolicy::_useSmartPriority = false;
+      bool DistributedBFPolicy::_useStealDeque = false;
 
       class DistributedBFSchedPlugin : public Plugin
       {
@@ -257,6 +268,9 @@ namespace nanos {
                cfg.registerConfigOption ( "schedule-smart-priority", NEW Config::FlagOption( DistributedBFPolicy::_useSmartPriority ), "Smart priority queue propagates high priorities to predecessors");
                cfg.registerArgOption( "schedule-smart-priority", "schedule-smart-priority" );
 
+               cfg.registerConfigOption ( "schedule-steal-deque", NEW Config::FlagOption( DistributedBFPolicy::_useStealDeque ), "Use a lock-free work-stealing deque as ready queue when priorities are not used");
+               cfg.registerArgOption( "schedule-steal-deque", "schedule-steal-deque" );
+
                
             }
 
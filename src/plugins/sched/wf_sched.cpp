@@ -32,12 +32,22 @@ namespace nanos {
             struct ThreadData : public ScheduleThreadData
             {
                /*! queue of ready tasks to be executed */
-               WDDeque _readyQueue;
+               WDPool *_readyQueue;
+               WDStealDeque *_stealDeque;
 
-               ThreadData () : _readyQueue() {}
+               ThreadData () : _readyQueue( NULL ), _stealDeque( NULL )
+               {
+                  if ( _useStealDeque ) _readyQueue = _stealDeque = NEW WDStealDeque();
+                  else _readyQueue = NEW WDDeque();
+               }
                virtual ~ThreadData () {
-                  ensure(_readyQueue.empty(),"Destroying non-empty queue");
+                  ensure(_readyQueue->empty(),"Destroying non-empty queue");
+                  delete _readyQueue;
                }
+
+               /*! \brief Binds the queue to the thread owning this data (needed by the steal deque)
+                */
+               void bind ( BaseThread *thread ) { if ( _stealDeque ) _stealDeque->setOwner( thread ); }
             };
 
             WorkFirst ( const WorkFirst & );
@@ -48,6 +58,7 @@ namespace nanos {
 
             //alex: FIX: this should be defaults and not common to all instances
             static bool          _stealParent;
+            static bool          _useStealDeque;
             static QueuePolicy   _localPolicy;
             static QueuePolicy   _stealPolicy;
 
@@ -71,16 +82,16 @@ namespace nanos {
             /*! \brief Extracts a WD from the queue either from the beginning or the end of the queue
              *
              *  This function allows to simplify the code to extract code from the queues.
-             *  It's a wrapper around the WDDeque
+             *  It's a wrapper around the WDPool
              *  functions with the actual function chosen with the policy argument.
              *
              *   \param [inout] q The queue from we want to extract a WD
              *   \param [in] policy Either FIFO/LIFO to specify if we extract from the beginning or the end of the queue
              *   \param [in] thread The thread trying to extract the thread
              *   \returns either a WD if one was available in the queues or NULL
-             *   \sa WDDeque::pop_front, WDDeque::pop_back
+             *   \sa WDPool::pop_front, WDPool::pop_back
              */
-            WD * pop ( WDDeque &q, QueuePolicy policy, BaseThread *thread )
+            WD * pop ( WDPool &q, QueuePolicy policy, BaseThread *thread )
             {
                return policy == LIFO  ? q.pop_front(thread) : q.pop_back(thread);
             }
@@ -94,7 +105,8 @@ namespace nanos {
             virtual void queue ( BaseThread *thread, WD &wd )
             {
                 ThreadData &data = ( ThreadData & ) *thread->getTeamData()->getScheduleData();
-                data._readyQueue.push_front ( &wd );
+                data.bind( thread );
+                data._readyQueue->push_front ( &wd );
             }
 
             virtual void queue ( BaseThread ** threads, WD ** wds, size_t numElems )
@@ -126,6 +138,7 @@ namespace nanos {
       };
 
       bool WorkFirst::_stealParent = true;
+      bool WorkFirst::_useStealDeque = false;
       WorkFirst::QueuePolicy WorkFirst::_localPolicy = WorkFirst::LIFO;
       WorkFirst::QueuePolicy WorkFirst::_stealPolicy = WorkFirst::FIFO;
 
@@ -143,11 +156,12 @@ namespace nanos {
          WorkDescriptor * next = NULL; 
 
          ThreadData &data = ( ThreadData & ) *thread->getTeamData()->getScheduleData();
+         data.bind( thread );
 
          /*
           *  First try to schedule the thread with a task from its queue
           */
-         if ( ( wd = pop( data._readyQueue, _localPolicy, thread ) ) != NULL ) {
+         if ( ( wd = pop( *data._readyQueue, _localPolicy, thread ) ) != NULL ) {
             return wd;
          } else {
             /*
@@ -181,7 +195,8 @@ namespace nanos {
 
                if ( victim.getTeam() != NULL ) {
                  ThreadData &tdata = ( ThreadData & ) *victim.getTeamData()->getScheduleData();
-                 wd = pop( tdata._readyQueue, _stealPolicy, thread );
+                 tdata.bind( &victim );
+                 wd = pop( *tdata._readyQueue, _stealPolicy, thread );
                }
 
                count++;
@@ -207,6 +222,10 @@ namespace nanos {
                                              "Defines if tries to steal the parent" );
                cfg.registerArgOption ( "schedule-steal-parent", "schedule-parent" );
 
+               cfg.registerConfigOption ( "schedule-steal-deque", NEW Config::FlagOption( WorkFirst::_useStealDeque ),
+                                             "Use a lock-free work-stealing deque as ready queue (LIFO local, FIFO steal)" );
+               cfg.registerArgOption ( "schedule-steal-deque", "schedule-steal-deque" );
+
                typedef Config::MapVar<WorkFirst::QueuePolicy> QueueConfig;
                
                QueueConfig *queuePolicyLocalConfig = NEW QueueConfig ( WorkFirst::_localPolicy );
@@ -145,8 +145,7 @@ void SlicerCompoundWD::executeWDs ( nanos_compound_wd_data_t *data )
    for ( int i = 0; i < data->nsect; i++ ) {
       slice = (WorkDescriptor*)data->lwd[i];
       Scheduler::inlineWork( slice, /*schedule*/ false );
-      slice->~WorkDescriptor();
-      delete[] (char *)slice;
+      sys.destroyWD( slice );
    }
 
 }
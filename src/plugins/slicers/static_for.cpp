@@ -22,6 +22,9 @@
 #include "system.hpp"
 #include "smpdd.hpp"
 
+#include <map>
+#include <vector>
+
 namespace nanos {
 namespace ext {
 
@@ -40,6 +43,73 @@ class SlicerStaticFor: public Slicer
       bool dequeue ( WorkDescriptor *wd, WorkDescriptor **slice ) { *slice = wd; return true; }
 };
 
+/* Slices of a static loop that a group leader creates for the other threads
+ * of its NUMA node before running its own slice. This spreads slice creation
+ * among the nodes, and slices are allocated by a thread of their own node.
+ */
+struct StaticLoopGroup
+{
+   void                      *_workFct;
+   WorkDescriptor            *_parent;
+   int64_t                    _stride;
+   std::vector<BaseThread *>  _threads;
+   std::vector<int64_t>       _lowers;
+   std::vector<int64_t>       _chunks;
+
+   StaticLoopGroup ( void *workFct, WorkDescriptor *parent, int64_t stride )
+      : _workFct( workFct ), _parent( parent ), _stride( stride ), _threads(), _lowers(), _chunks() {}
+
+   void addSlice ( BaseThread *thread, int64_t lower, int64_t chunk )
+   {
+      _threads.push_back( thread );
+      _lowers.push_back( lower );
+      _chunks.push_back( chunk );
+   }
+};
+
+static void staticLoop ( void *arg );
+
+static void submitSlice ( WorkDescriptor &work, WorkDescriptor *parent, BaseThread &target_thread,
+                          int64_t lower, int64_t chunk, int64_t stride, void ( *loopFct )( void * ) )
+{
+   WorkDescriptor *slice = NULL;
+   sys.duplicateWD( &slice, &work );
+
+   debug ( "Creating task " << slice << ":" << slice->getId() << " from sliced one " << &work << ":" << work.getId() );
+
+   // Computing specific loop boundaries for current slice
+   nanos_loop_info_t *loop_info = ( nanos_loop_info_t * ) slice->getData();
+   loop_info->lower = lower;
+   loop_info->chunk = chunk;
+   loop_info->stride = stride;
+
+   SMPDD &dd = ( SMPDD & ) slice->getActiveDevice();
+   dd = SMPDD(loopFct);
+
+   // Submit: slice (WorkDescriptor i, running on Thread i)
+   sys.setupWD ( *slice, parent );
+   slice->tieTo( target_thread );
+   target_thread.addNextWD(slice);
+}
+
+static void staticGroupLoop ( void *arg )
+{
+   debug ( "Executing static loop group leader wrapper");
+
+   nanos_loop_info_t * loop_info = (nanos_loop_info_t *) arg;
+   StaticLoopGroup *group = ( StaticLoopGroup * ) loop_info->args;
+   WorkDescriptor &work = *myThread->getCurrentWD();
+
+   loop_info->args = group->_workFct;
+   for ( size_t i = 0; i < group->_threads.size(); i++ ) {
+      submitSlice( work, group->_parent, *group->_threads[i], group->_lowers[i], group->_chunks[i],
+                   group->_stride, staticLoop );
+   }
+   delete group;
+
+   staticLoop( arg );
+}
+
 static void staticLoop ( void *arg )
 {
    debug ( "Executing static loop wrapper");
@@ -94,7 +164,6 @@ void SlicerStaticFor::submit ( WorkDescriptor &work )
    
    BaseThread *mythread = myThread;
    ThreadTeam *team = mythread->getTeam();
-   WorkDescriptor *slice = NULL;
    nanos_loop_info_t *loop_info;
    int i;
 
@@ -131,13 +200,19 @@ void SlicerStaticFor::submit ( WorkDescriptor &work )
    loop_info = ( nanos_loop_info_t * ) work.getData();
 
    SMPDD &dd = ( SMPDD & ) work.getActiveDevice();
-   loop_info->args = ( void * ) dd.getWorkFct();
+   void *workFct = ( void * ) dd.getWorkFct();
+   loop_info->args = workFct;
    dd = SMPDD(staticLoop);
 
    int64_t _chunk = loop_info->chunk;
    int64_t _lower = loop_info->lower;
    int64_t _upper = loop_info->upper;
    int64_t _step  = loop_info->step;
+   int64_t _stride;
+
+   /* Loop boundaries of the slices 1..N, WorkDescriptor 0 is the sliced one */
+   std::vector<int> slice_threads;
+   std::vector<int64_t> slice_lowers, slice_chunks;
 
    if ( _chunk == 0 ) {
 
@@ -145,77 +220,84 @@ void SlicerStaticFor::submit ( WorkDescriptor &work )
       int64_t _niters = (((_upper - _lower) / _step ) + 1 );
       int64_t _adjust = _niters % valid_threads;
       _chunk = ((_niters / valid_threads) ) * _step;
+      _stride = _niters * _step;
       // Computing specific loop boundaries for WorkDescriptor 0
       loop_info->chunk = _chunk + (( _adjust > 0 ) ? _step : 0);
-      loop_info->stride = _niters * _step; 
-      // Creating additional WorkDescriptors: 1..N
+      loop_info->stride = _stride;
+      // Computing boundaries for additional WorkDescriptors: 1..N
       for ( i = 1; i < valid_threads; i++ ) {
-
          // Computing lower and upper bound
          _lower += _chunk + (( _adjust > (i-1) ) ? _step : 0);
-         // Duplicating slice
-         slice = NULL;
-         sys.duplicateWD( &slice, &work );
-   
-         debug ( "Creating task " << slice << ":" << slice->getId() << " from sliced one " << &work << ":" << work.getId() );
-
-         // Computing specific loop boundaries for current slice
-         loop_info = ( nanos_loop_info_t * ) slice->getData();
-         loop_info->lower = _lower;
-         loop_info->chunk = _chunk + (( _adjust > i ) ? _step : 0);
-         loop_info->stride = _niters * _step; 
-
-         // Submit: slice (WorkDescriptor i, running on Thread i)
-         sys.setupWD ( *slice, work.getParent() );
-         BaseThread &target_thread = *target_threads[i];
-         slice->tieTo( target_thread );
-         target_thread.addNextWD(slice);
+         slice_threads.push_back( i );
+         slice_lowers.push_back( _lower );
+         slice_chunks.push_back( _chunk + (( _adjust > i ) ? _step : 0) );
       }
    } else {
       // Computing offset between threads
       int _sign = ( _step < 0 ) ? -1 : +1;
       int64_t _offset = _chunk * _step;
+      _stride = _offset * valid_threads;
       // setting new arguments
-      loop_info = (nanos_loop_info_t *) work.getData();
       loop_info->lower = _lower;
       loop_info->upper = _upper; 
       loop_info->step = _step;
       loop_info->chunk = _offset; 
-      loop_info->stride = _offset * valid_threads; 
-      // Init and Submit WorkDescriptors: 1..N
+      loop_info->stride = _stride; 
+      // Computing boundaries for additional WorkDescriptors: 1..N
       for ( i = 1; i < valid_threads; i++ ) {
          // Avoiding to create 'empty' WorkDescriptors
          if ( ((_lower + (i * _offset)) * _sign) > ( _upper * _sign ) ) break;
-         // Duplicating slice into wd
-         slice = NULL;
-         sys.duplicateWD( &slice, &work );
-
-         debug ( "Creating task " << slice << ":" << slice->getId() << " from sliced one " << &work << ":" << work.getId() );
-
-         // Computing specific loop boundaries for current slice
-         loop_info = ( nanos_loop_info_t * ) slice->getData();
-         loop_info->lower = _lower + ( i * _offset);
-         loop_info->upper = _upper;
-         loop_info->step = _step;
-         loop_info->chunk = _offset;
-         loop_info->stride = _offset * valid_threads; 
-
-         // Submit: slice (WorkDescriptor i, running on Thread i)
-         sys.setupWD ( *slice, work.getParent() );
-         BaseThread &target_thread = *target_threads[i];
-         slice->tieTo( target_thread );
-         target_thread.addNextWD(slice);
+         slice_threads.push_back( i );
+         slice_lowers.push_back( _lower + ( i * _offset) );
+         slice_chunks.push_back( _offset );
+      }
+   }
+
+   /* Slices for threads in the NUMA node of thread 'first' are created here.
+    * For each other node, only the slice of its first thread is created here,
+    * and that slice creates the rest of the slices of the node when it runs.
+    */
+   unsigned int first_node = target_threads[first_valid_thread]->runningOn()->getNumaNode();
+   std::map<unsigned int, StaticLoopGroup *> groups;
+   std::vector<size_t> leaders;
+   std::vector<StaticLoopGroup *> leader_groups;
+   for ( size_t s = 0; s < slice_threads.size(); s++ ) {
+      BaseThread *target_thread = target_threads[ slice_threads[s] ];
+      unsigned int node = target_thread->runningOn()->getNumaNode();
+      if ( node == first_node ) continue;
+      std::map<unsigned int, StaticLoopGroup *>::iterator it = groups.find( node );
+      if ( it == groups.end() ) {
+         StaticLoopGroup *group = NEW StaticLoopGroup( workFct, work.getParent(), _stride );
+         groups.insert( std::make_pair( node, group ) );
+         leaders.push_back( s );
+         leader_groups.push_back( group );
+      } else {
+         it->second->addSlice( target_thread, slice_lowers[s], slice_chunks[s] );
       }
    }
 
+   // Leaders first, so that the other nodes start creating their slices early
+   for ( size_t l = 0; l < leaders.size(); l++ ) {
+      size_t s = leaders[l];
+      loop_info->args = ( void * ) leader_groups[l];
+      submitSlice( work, work.getParent(), *target_threads[ slice_threads[s] ], slice_lowers[s], slice_chunks[s],
+                   _stride, staticGroupLoop );
+   }
+   loop_info->args = workFct;
+
+   for ( size_t s = 0; s < slice_threads.size(); s++ ) {
+      BaseThread &target_thread = *target_threads[ slice_threads[s] ];
+      if ( target_thread.runningOn()->getNumaNode() != first_node ) continue;
+      submitSlice( work, work.getParent(), target_thread, slice_lowers[s], slice_chunks[s], _stride, staticLoop );
+   }
+
    // Submit: work (WorkDescriptor 0, running on thread 'first')
    BaseThread &first_thread = *target_threads[first_valid_thread];
    work.convertToRegularWD();
    work.tieTo( first_thread );
    if ( mythread == &first_thread ) {
       if ( Scheduler::inlineWork( &work, false ) ) {
-         work.~WorkDescriptor();
-         delete[] (char *) &work;
+         sys.destroyWD( &work );
       }
    }
    else
@@ -0,0 +1,259 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+#include "nanos-int.h"
+#include "atomic.hpp"
+#include "lock.hpp"
+#include "plugin.hpp"
+#include "system.hpp"
+#include "worksharing_decl.hpp"
+
+namespace nanos {
+namespace ext {
+
+//! \brief Range of units [begin, end) owned by a thread
+//!
+//! The owner takes units from the begin and thieves take them from the end. The owner only
+//! writes 'begin' and checks 'end' afterwards, thieves are serialized by 'lock' and restore
+//! 'end' if they crossed the owner. Owner and thieves only take the lock when they meet.
+typedef struct {
+   volatile int64_t          begin;        // next unit to be taken by the owner
+   volatile int64_t          end;          // end of the range, lowered by thieves
+   Lock                      lock;         // serializes thieves (and the owner when they meet)
+   char                      pad[64];      // keeps ranges of different threads in different cache lines
+} WorkSharingStealRange;
+
+typedef struct {
+   int64_t                   lowerBound;   // loop lower bound
+   int64_t                   upperBound;   // loop upper bound
+   int64_t                   loopStep;     // loop step
+   int64_t                   chunkSize;    // loop chunk size
+   int64_t                   niters;       // number of iterations
+   int64_t                   unitSize;     // iterations per unit (a chunk when dynamic, one iteration when guided)
+   int64_t                   numOfUnits;   // number of units of the loop
+   int                       numOfRanges;  // one range per thread in the team
+   WorkSharingStealRange    *ranges;       // per thread ranges
+} WorkSharingStealLoopInfo;
+
+class WorkSharingStealFor : public WorkSharing {
+   private:
+      bool _guided; //!< Chunks shrink with the remaining iterations of the range
+
+   public:
+      WorkSharingStealFor ( bool guided ) : _guided( guided ) {}
+
+   private:
+      //! \brief Number of units the owner takes from a range with 'remaining' units
+      int64_t getTakeSize ( WorkSharingStealLoopInfo *loop_data, int64_t remaining ) const
+      {
+         if ( !_guided ) return 1;
+         int64_t units = remaining / 2;
+         return ( units < loop_data->chunkSize ) ? loop_data->chunkSize : units;
+      }
+
+      //! \brief Takes units from the begin of the own range
+      bool takeOwn ( WorkSharingStealLoopInfo *loop_data, WorkSharingStealRange &range, int64_t *first, int64_t *last )
+      {
+         int64_t b = range.begin;
+         int64_t e = range.end;
+         if ( b >= e ) return false;
+
+         int64_t nb = b + getTakeSize( loop_data, e - b );
+         range.begin = nb;
+         memoryFence(); // The new begin must be visible before checking for thieves
+
+         if ( nb <= range.end ) {
+            *first = b;
+            *last = nb;
+            return true;
+         }
+
+         // A thief took part of what we wanted
+         LockBlock lock( range.lock );
+         e = range.end;
+         if ( b >= e ) {
+            range.begin = e;
+            return false;
+         }
+         nb = std::min( b + getTakeSize( loop_data, e - b ), e );
+         range.begin = nb;
+         *first = b;
+         *last = nb;
+         return true;
+      }
+
+      //! \brief Moves half of the remaining units of a victim to the own range
+      bool steal ( WorkSharingStealLoopInfo *loop_data, int thid )
+      {
+         int n = loop_data->numOfRanges;
+
+         for ( int i = 1; i < n; i++ ) {
+            WorkSharingStealRange &victim = loop_data->ranges[(thid + i) % n];
+            if ( victim.begin >= victim.end ) continue;
+
+            int64_t first, last;
+            {
+               LockBlock lock( victim.lock );
+               int64_t e = victim.end;
+               int64_t remaining = e - victim.begin;
+               if ( remaining <= 0 ) continue;
+
+               int64_t stolen = remaining - remaining / 2;
+               victim.end = e - stolen;
+               memoryFence(); // The new end must be visible before checking the owner
+
+               if ( victim.begin > e - stolen ) {
+                  // The owner went past the new end: retry with whatever is left
+                  victim.end = e;
+                  memoryFence();
+                  remaining = e - victim.begin;
+                  if ( remaining <= 0 ) continue;
+                  stolen = remaining - remaining / 2;
+                  victim.end = e - stolen;
+                  memoryFence();
+                  if ( victim.begin > e - stolen ) {
+                     victim.end = e;
+                     continue;
+                  }
+               }
+               first = e - stolen;
+               last = e;
+            }
+
+            WorkSharingStealRange &own = loop_data->ranges[thid];
+            LockBlock lock( own.lock );
+            own.end = last;
+            own.begin = first;
+            return true;
+         }
+
+         return false;
+      }
+
+   public:
+      //! \brief create a loop descriptor
+      //! \return only one thread per loop will get 'true' (single like behaviour)
+      bool create( nanos_ws_desc_t **wsd, nanos_ws_info_t *info )
+      {
+         nanos_ws_info_loop_t *loop_info = (nanos_ws_info_loop_t *) info;
+         bool single = false;
+
+         *wsd = myThread->getTeamWorkSharingDescriptor( &single );
+
+         if ( single ) {
+
+            WorkSharingStealLoopInfo *loop_data = NEW WorkSharingStealLoopInfo();
+
+            // Computing Lower and upper bound. Loop step.
+            loop_data->lowerBound = loop_info->lower_bound;
+            loop_data->upperBound = loop_info->upper_bound;
+            loop_data->loopStep   = loop_info->loop_step;
+
+            // Computing chunk size
+            int64_t chunk_size = (1 < loop_info->chunk_size) ? loop_info->chunk_size : 1;
+            loop_data->chunkSize  = chunk_size;
+
+            // Computing number of units
+            int64_t niters = (((loop_info->upper_bound - loop_info->lower_bound) / loop_info->loop_step ) + 1 );
+            if ( niters < 0 ) niters = 0;
+            loop_data->niters = niters;
+            loop_data->unitSize = _guided ? 1 : chunk_size;
+            loop_data->numOfUnits = niters / loop_data->unitSize;
+            if ( niters % loop_data->unitSize != 0 ) loop_data->numOfUnits++;
+
+            // Splitting the units among the threads of the team
+            int num_threads = myThread->getTeam()->getFinalSize();
+            loop_data->numOfRanges = num_threads;
+            loop_data->ranges = NEW WorkSharingStealRange[num_threads];
+
+            int64_t per_thread = loop_data->numOfUnits / num_threads;
+            int64_t adjust = loop_data->numOfUnits % num_threads;
+            int64_t begin = 0;
+            for ( int i = 0; i < num_threads; i++ ) {
+               int64_t size = per_thread + ( ( adjust > i ) ? 1 : 0 );
+               loop_data->ranges[i].begin = begin;
+               loop_data->ranges[i].end = begin + size;
+               begin += size;
+            }
+
+            (*wsd)->data = loop_data;
+
+            memoryFence();     // Split initialization phase (before) from make it visible (after)
+
+            (*wsd)->ws = this; // Once 'ws' field has a value, any other thread can use the structure
+
+         }
+
+         // Wait until worksharing descriptor is initialized
+         while ( (*wsd)->ws == NULL ) {;}
+
+         return single;
+      }
+
+      //! \brief Get next chunk of iterations
+      void nextItem( nanos_ws_desc_t *wsd, nanos_ws_item_t *item )
+      {
+         nanos_ws_item_loop_t *loop_item = ( nanos_ws_item_loop_t *) item;
+         WorkSharingStealLoopInfo *loop_data = ( WorkSharingStealLoopInfo *) wsd->data;
+
+         int thid = myThread->getTeamId();
+         WorkSharingStealRange &range = loop_data->ranges[thid];
+
+         int64_t first, last;
+         bool found = takeOwn( loop_data, range, &first, &last );
+         while ( !found && steal( loop_data, thid ) ) {
+            found = takeOwn( loop_data, range, &first, &last );
+         }
+
+         if ( !found ) {
+            loop_item->execute = false;
+            return;
+         }
+
+         int64_t first_iter = first * loop_data->unitSize;
+         int64_t last_iter = std::min( last * loop_data->unitSize, loop_data->niters );
+
+         loop_item->lower = loop_data->lowerBound + first_iter * loop_data->loopStep;
+         loop_item->upper = loop_data->lowerBound + ( last_iter - 1 ) * loop_data->loopStep;
+         loop_item->last = last == loop_data->numOfUnits;
+         loop_item->execute = true;
+      }
+
+      void duplicateWS ( nanos_ws_desc_t *orig, nanos_ws_desc_t **copy) {}
+
+};
+
+class WorkSharingStealForPlugin : public Plugin {
+   public:
+      WorkSharingStealForPlugin () : Plugin("Worksharing plugin for loops using per thread ranges and work stealing",1) {}
+     ~WorkSharingStealForPlugin () {}
+
+      virtual void config( Config& cfg ) {}
+
+      void init ()
+      {
+         sys.registerWorkSharing("steal_for", NEW WorkSharingStealFor( false ) );
+         sys.registerWorkSharing("guided_steal_for", NEW WorkSharingStealFor( true ) );
+      }
+};
+
+} // namespace ext
+} // namespace nanos
+
+DECLARE_PLUGIN( "placeholder-name", nanos::ext::WorkSharingStealForPlugin );
@@ -65,6 +65,11 @@ namespace nanos
                              "Configures the number of OpenMP Threads to use" );
          cfg.registerEnvOption("omp-threads","OMP_NUM_THREADS");
 
+         _stealLoops = false;
+         cfg.registerConfigOption( "omp-steal-loops", NEW Config::FlagOption( _stealLoops ),
+                             "Dynamic and guided loops split the iterations among the threads and steal from each other" );
+         cfg.registerArgOption( "omp-steal-loops", "omp-steal-loops" );
+
          // OMP_SCHEDULE
          // OMP_DYNAMIC
          // OMP_NESTED
@@ -121,6 +126,12 @@ namespace nanos
          sys.setUntieMaster(false);
 
          // Loading plugins for OpenMP worksharing policies
+         if ( _stealLoops ) {
+            ws_names[omp_sched_dynamic] = std::string("steal_for");
+            ws_names[omp_sched_guided] = std::string("guided_steal_for");
+            // Both policies are registered by the same plugin
+            if ( sys.getWorkSharing( "steal_for" ) == NULL && !sys.loadPlugin( "worksharing-steal_for" ) ) fatal0( "Could not load steal_for worksharing" );
+         }
          for (int i = omp_sched_static; i <= omp_sched_auto; i++) {
             ws_plugins[i] = sys.getWorkSharing ( ws_names[i] );
             if ( ws_plugins[i] == NULL ){
@@ -327,6 +338,12 @@ namespace nanos
          sys.setUntieMaster( sys.getThreadManagerConf().canUntieMaster() );
 
          // Loading plugins for OpenMP worksharing policies
+         if ( _stealLoops ) {
+            ws_names[omp_sched_dynamic] = std::string("steal_for");
+            ws_names[omp_sched_guided] = std::string("guided_steal_for");
+            // Both policies are registered by the same plugin
+            if ( sys.getWorkSharing( "steal_for" ) == NULL && !sys.loadPlugin( "worksharing-steal_for" ) ) fatal0( "Could not load steal_for worksharing" );
+         }
          for (int i = omp_sched_static; i <= omp_sched_auto; i++) {
             ws_plugins[i] = sys.getWorkSharing ( ws_names[i] );
             if ( ws_plugins[i] == NULL ){
@@ -39,6 +39,7 @@ namespace nanos {
             nanos_ws_t  ws_plugins[NANOS_OMP_WS_TSIZE];
             int _numThreads;
             int _numThreadsOMP;
+            bool _stealLoops;        /**< Use per thread ranges with work stealing for dynamic and guided loops */
             virtual void start () ;
 
          private:
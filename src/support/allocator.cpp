@@ -39,24 +39,38 @@ Allocator & nanos::getAllocator ( void )
    else return my_thread->getAllocator();
 }
 
-void * Allocator::Arena::allocate ( void )
+Allocator::Arena::Arena ( size_t objectSize, unsigned int sizeClass, Heap *heap, Arena *next )
+   : _objectSize(objectSize), _numObjects(NANOS_ARENA_SIZE/objectSize), _used(0), _sizeClass(sizeClass),
+     _heap(heap), _arena(NULL), _next(next)
 {
-   unsigned int obj;
+   if ( _numObjects > NANOS_OBJECTS_PER_ARENA ) _numObjects = NANOS_OBJECTS_PER_ARENA;
+   if ( _numObjects == 0 ) _numObjects = 1;
 
-   if ( !_free ) return NULL;
-
-   for ( obj = 0 ; obj < numObjects ; obj++ ) {
-      if ( _bitmap[obj]._bit ) break;
-   }
+   _arena = (char *) malloc( objectSize * _numObjects );
+   if ( _arena == NULL ) throw(NANOS_ENOMEM);
+}
 
-   if (obj == numObjects) {
-      _free = false;
-      return NULL; 
+Allocator::Heap::Heap () : _arenas(NULL)
+{
+   for ( unsigned int i = 0; i < NANOS_ALLOCATOR_SIZE_CLASSES; i++ ) {
+      _classes[i]._free = NULL;
+      _classes[i]._arena = NULL;
+      _classes[i]._remote = NULL;
    }
-
-   _bitmap[obj]._bit = false;
-
-   return (void *) &_arena[obj*_objectSize];
 }
 
+Allocator::Heap * Allocator::createHeap ( void )
+{
+   Heap *heap = (Heap *) malloc( sizeof(Heap) );
+   if ( heap == NULL ) throw(NANOS_ENOMEM);
+   new ( heap ) Heap();
+   _heap = heap;
+   return heap;
+}
 
+Allocator::Heap * Allocator::getMyHeap ( void )
+{
+   BaseThread *my_thread = getMyThreadSafe();
+   if ( my_thread == NULL ) return NULL;
+   return my_thread->getAllocator()._heap;
+}
@@ -20,7 +20,7 @@
 #ifndef _NANOS_ALLOCATOR_HPP
 #define _NANOS_ALLOCATOR_HPP
 #include "allocator_decl.hpp"
-#include <vector>
+#include "atomic.hpp"
 #include <cstdlib>
 #include <cstring>
 #include <iostream>
@@ -34,17 +34,27 @@ inline size_t Allocator::Arena::getObjectSize () const
    return _objectSize;
 }
 
-inline void Allocator::Arena::deallocate ( void *object )
+inline unsigned int Allocator::Arena::getSizeClass () const
 {
-   unsigned long offset = ((char *) object - _arena);
-   unsigned long index = offset / _objectSize;
+   return _sizeClass;
+}
+
+inline Allocator::Heap * Allocator::Arena::getHeap () const
+{
+   return _heap;
+}
+
+inline void * Allocator::Arena::allocate ( void )
+{
+   if ( _used == _numObjects ) return NULL;
+
+   ObjectHeader *ptr = (ObjectHeader *) &_arena[_used*_objectSize];
+   _used++;
 
-   //if (sys.getNetwork()->getNodeNum() == 0 && _objectSize > 32768) std::cerr << "Free object size " << _objectSize << " : " << (void *) _objectSize << " addr range is " << (void *) object << ":" << ((void *) (((char*)object)+_objectSize)) << " this is arena " << (void*) this << std::endl;
-   _free = true;
-   _bitmap[index]._bit = true;
+   // The header is written once, it is kept while the object is in a free list
+   ptr->_arena = this;
 
-   //if (sys.getNetwork()->getNodeNum() == 0 && _objectSize > 32768) std::cerr << "memset from " << (void *) &_arena[index*_objectSize] << " to " << (void*) (&_arena[index*_objectSize+_objectSize]) << std::endl;
-   //memset( &_arena[index*_objectSize], 0, _objectSize );
+   return ((char *) ptr ) + _headerSize;
 }
 
 inline Allocator::Arena * Allocator::Arena::getNext ( void ) const
@@ -52,9 +62,55 @@ inline Allocator::Arena * Allocator::Arena::getNext ( void ) const
    return _next;
 }
 
-inline void Allocator::Arena::setNext ( Arena * a )
+inline void * Allocator::Heap::allocate ( unsigned int sizeClass )
+{
+   SizeClass &sc = _classes[sizeClass];
+
+   FreeObject *obj = sc._free;
+   if ( obj == NULL && sc._remote != NULL ) {
+      // Reclaim all the objects freed by other threads at once
+      obj = __sync_lock_test_and_set( &sc._remote, (FreeObject *) NULL );
+   }
+
+   if ( obj != NULL ) {
+      sc._free = obj->_next;
+      return obj;
+   }
+
+   void *ptr = sc._arena != NULL ? sc._arena->allocate() : NULL;
+   if ( ptr == NULL ) {
+      Arena *arena = (Arena *) malloc ( sizeof(Arena) );
+      if ( arena == NULL ) throw(NANOS_ENOMEM);
+      new ( arena ) Arena( ((size_t) 1) << sizeClass, sizeClass, this, _arenas );
+      _arenas = arena;
+      sc._arena = arena;
+      ptr = arena->allocate();
+   }
+
+   return ptr;
+}
+
+inline void Allocator::Heap::deallocateLocal ( FreeObject *object, unsigned int sizeClass )
+{
+   SizeClass &sc = _classes[sizeClass];
+   object->_next = sc._free;
+   sc._free = object;
+}
+
+inline void Allocator::Heap::deallocateRemote ( FreeObject *object, unsigned int sizeClass )
+{
+   SizeClass &sc = _classes[sizeClass];
+   FreeObject *head;
+   do {
+      head = sc._remote;
+      object->_next = head;
+   } while ( !compareAndSwap( &sc._remote, head, object ) );
+}
+
+inline unsigned int Allocator::getSizeClass ( size_t size )
 {
-   _next = a;
+   /* Object size is (size + header )'s next power of 2, the size class is its log2 */
+   return sizeof(unsigned long) * 8 - __builtin_clzl( (unsigned long) size );
 }
 
 inline void * Allocator::allocateBigObject ( size_t size )
@@ -72,52 +128,10 @@ inline void * Allocator::allocate ( size_t size, const char* file, int line )
 {
    if ( size > _sizeOfBig ) return allocateBigObject(size);
 
-   /* realSize is (size + header )'s next power of 2 */
-   size_t realSize = size + _headerSize + 1;
-   realSize |= realSize >> 1;
-   realSize |= realSize >> 2;
-   realSize |= realSize >> 4;
-   realSize |= realSize >> 8;
-   realSize |= realSize >> 16;
-   realSize++;
- 
-
-   ArenaCollection::iterator it;
-   for ( it = _arenas.begin(); it != _arenas.end(); it++ ) {
-      if ( (*it)->getObjectSize() == realSize ) break;
-   }
-
-   Arena *arena = NULL;
-
-   if ( it == _arenas.end() ) {
-      // no arena found for that size, create a new one
-      arena = (Arena *) malloc ( sizeof(Arena) );
-      if ( arena == NULL ) throw(NANOS_ENOMEM);
-      new ( arena ) Arena( realSize );
-      _arenas.push_back( arena );
-   }
-   else arena = *it;
+   Heap *heap = _heap;
+   if ( heap == NULL ) heap = createHeap();
 
-
-   ObjectHeader * ptr = NULL;
-
-   while ( ptr == NULL ) {
-      ptr = (ObjectHeader *) arena->allocate();
-      if ( ptr == NULL ) { 
-          if ( arena->getNext() == NULL ) {
-             Arena *next = ( Arena *) malloc ( sizeof(Arena) );
-             if ( next == NULL ) throw(NANOS_ENOMEM);
-             new (next) Arena(realSize);
-             arena->setNext( next );
-          }
-          arena = arena->getNext(); 
-      }
-   }
-
-   ptr->_arena = arena;
-   //if (sys.getNetwork()->getNodeNum() == 0 && realSize > 32768) std::cerr << "Allocate object size " << realSize << " : " << (void *) realSize << " addr range is " << (void *) ptr << ":" << ((void *) (((char*)ptr)+realSize)) << " this is arena " << (void *) arena << std::endl;
-
-   return  ((char *) ptr ) + _headerSize;
+   return heap->allocate( getSizeClass( size + _headerSize ) );
 }
 
 inline void Allocator::deallocate ( void *object, const char *file, int line )
@@ -129,10 +143,14 @@ inline void Allocator::deallocate ( void *object, const char *file, int line )
    Arena *arena = ptr->_arena;
 
    // If there is no arena then it was a big object that just needs to be freed
-   if ( arena == NULL )
-     free(ptr);
-   else
-     arena->deallocate(ptr);
+   if ( arena == NULL ) {
+      free(ptr);
+      return;
+   }
+
+   Heap *heap = arena->getHeap();
+   if ( heap == getMyHeap() ) heap->deallocateLocal( (FreeObject *) object, arena->getSizeClass() );
+   else heap->deallocateRemote( (FreeObject *) object, arena->getSizeClass() );
 }
 
 inline size_t Allocator::getObjectSize ( void *object )
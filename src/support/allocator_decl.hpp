@@ -31,6 +31,8 @@
 
 #define NANOS_CACHELINE 128 /* FIXME: This definition must be architectural dependant */
 #define NANOS_OBJECTS_PER_ARENA 1000
+#define NANOS_ARENA_SIZE (256*1024) /* Target size of an Arena, it holds at most NANOS_OBJECTS_PER_ARENA objects */
+#define NANOS_ALLOCATOR_SIZE_CLASSES 25 /* Up to 2^24 bytes, enough for Allocator::_sizeOfBig plus the header */
 
 namespace nanos {
 
@@ -85,27 +87,41 @@ class InternalAllocator
        inline void destroy( pointer p ) { p->~T(); }
 };
 /*! \class Allocator
+ *
+ *  Per-thread slab allocator. Requests are rounded up (with the object header)
+ *  to a power of two which also identifies its size class. Each size class keeps
+ *  a free list that is only accessed by the owner thread, so allocations and
+ *  local deallocations are O(1) and do not need atomic operations. Objects freed
+ *  by any other thread are pushed (lock-free) into the remote free list of their
+ *  size class and the owner reclaims the whole list at once when its local list
+ *  runs out.
  */
 class Allocator
 {
    private:
+     /*! \brief Objects in a free list (the link is stored after the object header)
+      */
+      struct FreeObject {
+         FreeObject       *_next;
+      };
+
+      class Heap;
+
      /*! \class Arena
+      *
+      *  Slab of objects of the same size. Objects are handed out with a bump
+      *  pointer the first time and through the size class free lists afterwards.
       */
       class Arena
       {
          private: /* Arena data members and disabled constructors */
-            static const size_t numObjects = NANOS_OBJECTS_PER_ARENA;      /** Number of maximum objects allocated in this arena*/
-
-            union bitmap_entry {
-               bool             _bit;
-               char             pad[NANOS_CACHELINE];
-            };                                         /**< bitmap_entry struct */
-
             size_t            _objectSize;            /**< Object size in current Arena  */
+            size_t            _numObjects;            /**< Number of objects in the Arena */
+            size_t            _used;                  /**< Objects already handed out by the bump pointer */
+            unsigned int      _sizeClass;             /**< Size class of the objects */
+            Heap             *_heap;                  /**< Heap owning this Arena */
             char             *_arena;                 /**< Memory region used by Arena */
-            bitmap_entry     *_bitmap;                /**< Bit map (free/busy) */
-            Arena            *_next;                  /**< Next Arena in the list */
-            bool              _free;                  /**< Are there free entries */
+            Arena            *_next;                  /**< Next Arena in the Heap */
             /*! \brief Arena copy constructor (disabled)
              */
             Arena ( const Arena &a );
@@ -118,40 +134,66 @@ class Allocator
          public: /* Arena method members */
            /*! \brief Arena constructor
             */
-            Arena ( size_t objectSize ) : _objectSize(objectSize), _next (NULL), _free(true)
-            {
-               _arena = (char *) malloc( (objectSize + sizeof(bitmap_entry) ) * numObjects );
-               if ( _arena == NULL ) throw ( NANOS_ENOMEM );
-               _bitmap = (bitmap_entry *) (_arena + objectSize * numObjects);
-               for ( size_t i = 0; i < numObjects; i++ ) _bitmap[i]._bit = true;
-            }
+            Arena ( size_t objectSize, unsigned int sizeClass, Heap *heap, Arena *next );
            /*! \brief Arena destructor
             */
-            ~Arena ()
-            {
-               delete _next;
-               free(_arena);
-               free(_bitmap);
-            }
+            ~Arena () { free(_arena); }
            /*! \brief Returns the size of allocated object
             */
-            size_t getObjectSize ( void ) const ; 
-           /*! \brief Returns a free object address (and mark it as busy)
+            size_t getObjectSize ( void ) const ;
+           /*! \brief Returns the size class of allocated objects
             */
-            void * allocate ( void ) ;
-           /*! \brief Mark 'object' as free
+            unsigned int getSizeClass ( void ) const ;
+           /*! \brief Returns the Heap owning this Arena
             */
-            void deallocate ( void *object ) ;
+            Heap * getHeap ( void ) const ;
+           /*! \brief Returns a never used object address, or NULL if the Arena is exhausted
+            */
+            void * allocate ( void ) ;
            /*! \brief Returns next Arena object in the list
             */
             Arena * getNext ( void ) const;
-           /*! \brief Set as next Arena object 'a'
-            */
-            void setNext ( Arena * a );
       };
-      template<typename T>
-      struct InternalCollection {
-         typedef std::list<T, InternalAllocator<T> > type;
+
+     /*! \brief Free lists of a size class. The remote list lives in its own cache line
+      */
+      struct SizeClass {
+         FreeObject          *_free;                  /**< Local free list (owner only) */
+         Arena               *_arena;                 /**< Arena used by the bump pointer */
+         char                 _pad0[NANOS_CACHELINE - 2 * sizeof(void *)];
+         FreeObject * volatile _remote;               /**< Objects freed by other threads */
+         char                 _pad1[NANOS_CACHELINE - sizeof(void *)];
+      };
+
+     /*! \brief Per-thread allocation state.
+      *
+      *  The Heap (and its Arenas) are not released with the Allocator as
+      *  objects may still be alive and be freed later on from other threads.
+      */
+      class Heap
+      {
+         private:
+            SizeClass         _classes[NANOS_ALLOCATOR_SIZE_CLASSES];   /**< Size classes, indexed by log2 of the object size */
+            Arena            *_arenas;                                  /**< All the Arenas of this Heap */
+            /*! \brief Heap copy constructor (disabled)
+             */
+            Heap ( const Heap &h );
+            /*! \brief Heap copy assignment operator (disabled)
+             */
+            Heap & operator= ( const Heap &h );
+         public:
+            /*! \brief Heap default constructor
+             */
+            Heap ();
+            /*! \brief Returns an object of size 2^sizeClass
+             */
+            void * allocate ( unsigned int sizeClass );
+            /*! \brief Returns an object to the local free list (owner only)
+             */
+            void deallocateLocal ( FreeObject *object, unsigned int sizeClass );
+            /*! \brief Returns an object to the remote free list (any thread)
+             */
+            void deallocateRemote ( FreeObject *object, unsigned int sizeClass );
       };
 
       struct ObjectHeader {
@@ -159,9 +201,7 @@ class Allocator
       };
 
    private: /* Allocator data members */
-      typedef InternalCollection<Arena *>::type  ArenaCollection;
-
-      ArenaCollection               _arenas;      /**< Vector of Arenas in Allocator*/
+      Heap                         *_heap;        /**< Allocation state, created on first use */
       static size_t                 _headerSize;  /**< Size of ObjectHeader */
 
       static const size_t                  _sizeOfBig = 1024*1024*10;
@@ -177,23 +217,34 @@ class Allocator
      /*! \brief Alternative allocation method for big objects */
       void * allocateBigObject ( size_t size ); 
 
+     /*! \brief Creates the Heap of this Allocator */
+      Heap * createHeap ( void );
+
+     /*! \brief Returns the size class for a request of 'size' bytes (header included) */
+      static unsigned int getSizeClass ( size_t size );
+
+     /*! \brief Returns the Heap of the calling thread's Allocator (NULL if it is not a runtime thread) */
+      static Heap * getMyHeap ( void );
+
    public: /* Allocator method members */
     /*! \brief Allocator default constructor 
      */
-     Allocator ( ) : _arenas() {}
+     Allocator ( ) : _heap( NULL ) {}
     /*! \brief Allocator destructor 
      */
      ~Allocator () { }
     /*! \brief Allocates 'size' bytes in memory and returns memory pointer
      *
-     *  This function will check in his list of Arenas looking for one who
-     *  stores objects of the given 'size'. If Allocator finds an Arena region
-     *  with this 'size' will ask to it for a new object. If none of the current
-     *  Arenas works with the given 'size' Allocator will create a new Arena entry
-     *  in order to manage this (and future) objects of the given 'size'.
+     *  The size class of the request is computed directly from 'size' and the
+     *  object is taken from the local free list of that class. If it is empty the
+     *  remote free list is reclaimed and, if that is empty too, the object is taken
+     *  from the current Arena of the class or from a new one.
      */
      void * allocate ( size_t size, const char *file = NULL, int line = 0 ) ;
     /*! \brief Deallocates 'object' (object has a header which identifies related Arena
+     *
+     *  If the calling thread owns the Arena the object goes back to its local free
+     *  list, otherwise it is pushed to the remote free list of its owner.
      */
      static void deallocate ( void *object, const char *file = NULL, int line = 0 ) ;
     /*! \brief Get 'object' size for a given pointer
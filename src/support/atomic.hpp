@@ -231,6 +231,21 @@ inline void memoryFence ()
 #endif
 }
 
+/*! \brief Hints the processor that the caller is busy-waiting
+ */
+inline void cpuRelax ()
+{
+#if defined(__x86_64__) || defined(__i386__)
+   __asm__ __volatile__("pause" ::: "memory");
+#elif defined(__aarch64__)
+   __asm__ __volatile__("yield" ::: "memory");
+#elif defined(__powerpc__) || defined(__powerpc64__)
+   __asm__ __volatile__("or 27,27,27" ::: "memory");
+#else
+   __asm__ __volatile__("" ::: "memory");
+#endif
+}
+
 #ifdef HAVE_NEW_GCC_ATOMIC_OPS
 template<typename T>
 inline bool compareAndSwap( T *ptr, T oldval, T  newval )
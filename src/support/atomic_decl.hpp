@@ -106,6 +106,8 @@ namespace nanos {
 
    void memoryFence ();
 
+   void cpuRelax ();
+
    template<typename T>
 #ifdef HAVE_NEW_GCC_ATOMIC_OPS
    bool compareAndSwap( T *ptr, T oldval, T  newval );
@@ -0,0 +1,116 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+#ifndef _NANOS_BINARY_TRACE_HPP
+#define _NANOS_BINARY_TRACE_HPP
+
+#include <stddef.h>
+#include <string.h>
+
+namespace nanos {
+
+/*!\class BinaryTrace
+ * \brief Layout of the traces written by the binary_trace instrumentation plugin
+ *
+ * A trace is a directory holding a dictionary file and one stream file per thread. Every file
+ * starts with a FileHeader. Integers are LEB128 varints (7 bits per byte, low bits first).
+ *
+ * Stream records (files "thread.<n>", appended in the order the thread raised the events):
+ *    varint   time delta (ns since the previous record, the first one since FileHeader::_baseTime)
+ *    byte     event type (nanos_event_type_t)
+ *    varint   key (0 for state events)
+ *    varint   value (the state for state events)
+ *    PtP events only: varint domain, zigzag varint id, varint partner
+ *
+ * Dictionary entries (file "dictionary", written when the trace is closed):
+ *    byte 'K'  varint key, byte stacked, string name, string description
+ *    byte 'V'  varint key, varint value, string name, string description
+ * where a string is a varint length followed by the characters (not null terminated).
+ */
+   class BinaryTrace
+   {
+      public:
+         static const unsigned int FORMAT_VERSION = 1;
+         static const size_t MAX_VARINT = 10;   /**< Bytes of the longest 64 bit varint */
+         static const size_t MAX_RECORD = 1 + 5 * MAX_VARINT;
+
+         struct FileHeader {
+            char                 _magic[4];     /**< "NXBT" */
+            unsigned int         _version;
+            int                  _thread;       /**< Id of the thread of a stream, -1 for the dictionary */
+            unsigned int         _reserved;
+            unsigned long long   _baseTime;     /**< Nanoseconds of the monotonic clock */
+         };
+
+         static void initHeader ( FileHeader &header, int thread, unsigned long long baseTime )
+         {
+            memcpy( header._magic, "NXBT", 4 );
+            header._version = FORMAT_VERSION;
+            header._thread = thread;
+            header._reserved = 0;
+            header._baseTime = baseTime;
+         }
+
+         static bool checkHeader ( const FileHeader &header )
+         {
+            return memcmp( header._magic, "NXBT", 4 ) == 0 && header._version == FORMAT_VERSION;
+         }
+
+         /*! \brief Writes v at buf, returns the number of bytes written */
+         static size_t encode ( unsigned char *buf, unsigned long long v )
+         {
+            size_t n = 0;
+            while ( v >= 0x80 ) {
+               buf[n++] = (unsigned char) ( v | 0x80 );
+               v >>= 7;
+            }
+            buf[n++] = (unsigned char) v;
+            return n;
+         }
+
+         /*! \brief Reads a varint from [buf, end) into v, returns the number of bytes read (0 if truncated) */
+         static size_t decode ( const unsigned char *buf, const unsigned char *end, unsigned long long &v )
+         {
+            size_t n = 0;
+            unsigned int shift = 0;
+            v = 0;
+            while ( buf + n < end && n < MAX_VARINT ) {
+               unsigned char b = buf[n++];
+               v |= (unsigned long long) ( b & 0x7f ) << shift;
+               if ( ( b & 0x80 ) == 0 ) return n;
+               shift += 7;
+            }
+            return 0;
+         }
+
+         /*! \brief Maps signed integers to unsigned ones keeping small magnitudes small */
+         static unsigned long long zigzag ( long long v )
+         {
+            return ( (unsigned long long) v << 1 ) ^ (unsigned long long) ( v >> 63 );
+         }
+
+         static long long unzigzag ( unsigned long long v )
+         {
+            return (long long) ( v >> 1 ) ^ -(long long) ( v & 1 );
+         }
+   };
+
+} // namespace nanos
+
+#endif
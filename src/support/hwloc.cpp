@@ -150,6 +150,22 @@ void Hwloc::getNumSockets(unsigned int &allowedNodes, int &numSockets, unsigned
 #endif
 }
 
+bool Hwloc::bindMemoryToNumaNode( void *addr, std::size_t len, unsigned int node )
+{
+#ifdef HWLOC
+   hwloc_obj_t numaNode = NULL;
+   while ( ( numaNode = hwloc_get_next_obj_by_type( _hwlocTopology, HWLOC_OBJ_NODE, numaNode ) ) != NULL ) {
+      if ( numaNode->os_index == node ) break;
+   }
+   // Not a NUMA machine
+   if ( numaNode == NULL ) return false;
+
+   return hwloc_set_area_membind_nodeset( _hwlocTopology, addr, len, numaNode->nodeset, HWLOC_MEMBIND_BIND, 0 ) == 0;
+#else
+   return false;
+#endif
+}
+
 unsigned int Hwloc::getNumaNodeOfGpu( unsigned int gpu ) {
    unsigned int node = 0;
 #ifdef GPU_DEV
@@ -23,6 +23,7 @@
 
 #include <config.hpp>
 #include <string>
+#include <cstddef>
 
 #ifdef HWLOC
 #include <hwloc.h>
@@ -52,6 +53,14 @@ class Hwloc {
       unsigned int getNumaNodeOfGpu( unsigned int gpu );
       void getNumSockets(unsigned int &allowedNodes, int &numSockets, unsigned int &hwThreads);
 
+      /*!
+       * \brief Binds the pages of a memory area that have not been touched yet
+       * to a NUMA node. Returns false if the area could not be bound.
+       *
+       * @param node OS NUMA node index.
+       */
+      bool bindMemoryToNumaNode( void *addr, std::size_t len, unsigned int node );
+
       /*!
        * \brief Checks if we can see the CPU, to create the PE.
        * If hwloc has no info on that CPU, we should not continue creating
@@ -0,0 +1,76 @@
+/*************************************************************************************/
+/*      Copyright 2009 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+
+#include "atomic.hpp"
+#include "lock.hpp"
+
+using namespace nanos;
+
+#ifdef NANOS_INSTRUMENTATION_ENABLED
+__thread LockContention nanos::lockContention = { 0, 0 };
+#endif
+
+#ifdef NANOS_TICKET_LOCK
+
+void Lock::waitTicket ( ticket_t ticket, bool instrumented )
+{
+   unsigned long long spins = 0;
+
+   for ( ; ; ) {
+      ticket_t serving = ( loadWord() >> SERVING_SHIFT ) & TICKET_MASK;
+      if ( serving == ticket ) break;
+
+      // Back off proportionally to the number of waiters ahead of us
+      unsigned int delay = ( ( ticket - serving ) & TICKET_MASK ) * NANOS_LOCK_TICKET_BACKOFF;
+      for ( unsigned int i = 0; i < delay; i++ ) cpuRelax();
+      spins += delay;
+   }
+   memoryFence();
+
+#ifdef NANOS_INSTRUMENTATION_ENABLED
+   if ( instrumented ) {
+      lockContention._contended++;
+      lockContention._spins += spins;
+   }
+#endif
+}
+
+#else
+
+void Lock::acquireContended ( bool instrumented )
+{
+   unsigned long long spins = 0;
+   unsigned int backoff = NANOS_LOCK_MIN_BACKOFF;
+
+   do {
+      while ( getState() == NANOS_LOCK_BUSY ) {
+         for ( unsigned int i = 0; i < backoff; i++ ) cpuRelax();
+         spins += backoff;
+         if ( backoff < NANOS_LOCK_MAX_BACKOFF ) backoff <<= 1;
+      }
+   } while ( !tryAcquire() );
+
+#ifdef NANOS_INSTRUMENTATION_ENABLED
+   if ( instrumented ) {
+      lockContention._contended++;
+      lockContention._spins += spins;
+   }
+#endif
+}
+
+#endif
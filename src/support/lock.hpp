@@ -30,6 +30,25 @@ inline Lock::state_t Lock::operator* () const
    return getState();
 }
 
+#ifdef NANOS_TICKET_LOCK
+
+inline Lock::ticket_t Lock::loadWord () const
+{
+#ifdef HAVE_NEW_GCC_ATOMIC_OPS
+   return __atomic_load_n( (const ticket_t *) &state_, __ATOMIC_ACQUIRE );
+#else
+   return *(const volatile ticket_t *) &state_;
+#endif
+}
+
+inline Lock::state_t Lock::getState () const
+{
+   ticket_t w = loadWord();
+   return ( ( w >> SERVING_SHIFT ) & TICKET_MASK ) == ( w & TICKET_MASK ) ? NANOS_LOCK_FREE : NANOS_LOCK_BUSY;
+}
+
+#else
+
 inline Lock::state_t Lock::getState () const
 {
 #ifdef HAVE_NEW_GCC_ATOMIC_OPS
@@ -39,6 +58,8 @@ inline Lock::state_t Lock::getState () const
 #endif
 }
 
+#endif
+
 inline void Lock::operator++ ( int val )
 {
    acquire();
@@ -51,18 +72,19 @@ inline void Lock::operator-- ( int val )
 
 inline void Lock::acquire ( void )
 {
+#ifdef NANOS_TICKET_LOCK
 #ifdef HAVE_NEW_GCC_ATOMIC_OPS
-   acquire_noinst();
+   ticket_t w = __atomic_fetch_add( word(), 1, __ATOMIC_ACQ_REL );
 #else
-   if ( (state_ == NANOS_LOCK_FREE) &&  !__sync_lock_test_and_set( &state_,NANOS_LOCK_BUSY ) ) return;
+   ticket_t w = __sync_fetch_and_add( word(), 1 );
+#endif
+   if ( ( ( w >> SERVING_SHIFT ) & TICKET_MASK ) != ( w & TICKET_MASK ) ) waitTicket( w & TICKET_MASK, true );
+#else
+   if ( tryAcquire() ) return;
 
    // Disabling lock instrumentation; do not remove follow code which can be reenabled for testing purposes
    // NANOS_INSTRUMENT( InstrumentState inst(NANOS_ACQUIRING_LOCK) )
-spin:
-   while ( state_ == NANOS_LOCK_BUSY ) {}
-
-   if ( __sync_lock_test_and_set( &state_,NANOS_LOCK_BUSY ) ) goto spin;
-
+   acquireContended( true );
    // NANOS_INSTRUMENT( inst.close() )
 #endif
 }
@@ -74,17 +96,30 @@ inline void Lock::lock()
 
 inline void Lock::acquire_noinst ( void )
 {
+#ifdef NANOS_TICKET_LOCK
 #ifdef HAVE_NEW_GCC_ATOMIC_OPS
-   while (__atomic_exchange_n( &state_, NANOS_LOCK_BUSY, __ATOMIC_ACQ_REL) == NANOS_LOCK_BUSY ) { }
+   ticket_t w = __atomic_fetch_add( word(), 1, __ATOMIC_ACQ_REL );
+#else
+   ticket_t w = __sync_fetch_and_add( word(), 1 );
+#endif
+   if ( ( ( w >> SERVING_SHIFT ) & TICKET_MASK ) != ( w & TICKET_MASK ) ) waitTicket( w & TICKET_MASK, false );
 #else
-spin:
-   while ( state_ == NANOS_LOCK_BUSY ) {}
-   if ( __sync_lock_test_and_set( &state_,NANOS_LOCK_BUSY ) ) goto spin;
+   if ( tryAcquire() ) return;
+   acquireContended( false );
 #endif
 }
 
 inline bool Lock::tryAcquire ( void )
 {
+#ifdef NANOS_TICKET_LOCK
+   ticket_t w = loadWord();
+   if ( ( ( w >> SERVING_SHIFT ) & TICKET_MASK ) != ( w & TICKET_MASK ) ) return false;
+#ifdef HAVE_NEW_GCC_ATOMIC_OPS
+   return __atomic_compare_exchange_n( word(), &w, w + 1, false, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED );
+#else
+   return __sync_bool_compare_and_swap( word(), w, w + 1 );
+#endif
+#else
 #ifdef HAVE_NEW_GCC_ATOMIC_OPS
    if (__atomic_load_n(&state_, __ATOMIC_ACQUIRE) == NANOS_LOCK_FREE)
    {
@@ -103,6 +138,7 @@ inline bool Lock::tryAcquire ( void )
       else return true;
    } else return false;
 #endif
+#endif
 }
 
 inline bool Lock::try_lock()
@@ -112,11 +148,21 @@ inline bool Lock::try_lock()
 
 inline void Lock::release ( void )
 {
+#ifdef NANOS_TICKET_LOCK
+#ifdef HAVE_NEW_GCC_ATOMIC_OPS
+   ticket_t w = __atomic_fetch_add( word(), 1 << SERVING_SHIFT, __ATOMIC_RELEASE );
+   if ( w & TICKET_CARRY ) __atomic_fetch_and( word(), ~TICKET_CARRY, __ATOMIC_RELAXED );
+#else
+   ticket_t w = __sync_fetch_and_add( word(), 1 << SERVING_SHIFT );
+   if ( w & TICKET_CARRY ) __sync_fetch_and_and( word(), ~TICKET_CARRY );
+#endif
+#else
 #ifdef HAVE_NEW_GCC_ATOMIC_OPS
    __atomic_store_n(&state_, 0, __ATOMIC_RELEASE);
 #else
    __sync_lock_release( &state_ );
 #endif
+#endif
 }
 
 inline void Lock::unlock()
@@ -22,13 +22,59 @@
 
 #include "nanos-int.h"
 
+#ifndef NANOS_LOCK_MIN_BACKOFF
+#define NANOS_LOCK_MIN_BACKOFF 4        /* Initial number of pauses between test-and-set attempts */
+#endif
+#ifndef NANOS_LOCK_MAX_BACKOFF
+#define NANOS_LOCK_MAX_BACKOFF 256      /* Upper bound of the exponential backoff */
+#endif
+#ifndef NANOS_LOCK_TICKET_BACKOFF
+#define NANOS_LOCK_TICKET_BACKOFF 64    /* Pauses per waiter ahead of us in a ticket lock */
+#endif
+
 namespace nanos {
 
+#ifdef NANOS_INSTRUMENTATION_ENABLED
+   /*! \brief Lock contention counters of the current thread (reported by the Scheduler idle loop)
+    */
+   struct LockContention {
+      unsigned long long _contended;   /**< Number of acquires that found the lock busy */
+      unsigned long long _spins;       /**< Number of pauses spent waiting for a lock */
+   };
+
+   extern __thread LockContention lockContention;
+#endif
+
+  /*! \class Lock
+   *
+   *  By default Lock is a test-and-set lock with exponential backoff. When Nanos++ is
+   *  configured with --with-lock=ticket, it is a FIFO ticket lock with backoff
+   *  proportional to the number of waiters ahead. The ticket lock keeps both counters
+   *  in the nanos_lock_t word (next ticket in the low half, ticket being served in
+   *  the high half) so nanos_lock_t size and NANOS_INIT_LOCK_* values are not changed.
+   */
    class Lock : public nanos_lock_t
    {
       private:
          typedef nanos_lock_state_t state_t;
 
+#ifdef NANOS_TICKET_LOCK
+         typedef unsigned int ticket_t __attribute__(( may_alias ));
+
+         static const ticket_t TICKET_MASK = 0x7fff;    /**< Tickets are compared modulo 2^15 */
+         static const ticket_t TICKET_CARRY = 0x8000;   /**< Absorbs the next ticket overflow */
+         static const unsigned int SERVING_SHIFT = 16;
+
+         volatile ticket_t * word() { return (volatile ticket_t *) &state_; }
+         ticket_t loadWord() const;
+
+         /*! \brief Waits until 'ticket' is being served */
+         void waitTicket ( ticket_t ticket, bool instrumented );
+#else
+         /*! \brief Spins with exponential backoff until the lock is acquired */
+         void acquireContended ( bool instrumented );
+#endif
+
          // disable copy constructor and assignment operator
          Lock( const Lock &lock );
          const Lock & operator= ( const Lock& );
@@ -142,6 +142,45 @@ inline void MemoryChunk::cutAfter( MemoryChunk const &mc ) {
 }
 
 
+template < typename _Entry, std::size_t _InlineSize >
+ChunkBuffer< _Entry, _InlineSize >::ChunkBuffer( ChunkBuffer const &cb ) : _entries( _inline ), _size( 0 ), _capacity( _InlineSize ) {
+   *this = cb;
+}
+
+template < typename _Entry, std::size_t _InlineSize >
+ChunkBuffer< _Entry, _InlineSize >::~ChunkBuffer() {
+   if ( _entries != _inline ) delete[] _entries;
+}
+
+template < typename _Entry, std::size_t _InlineSize >
+ChunkBuffer< _Entry, _InlineSize > &ChunkBuffer< _Entry, _InlineSize >::operator=( ChunkBuffer const &cb ) {
+   if ( this != &cb ) {
+      _size = 0;
+      for ( const_iterator it = cb.begin(); it != cb.end(); it++ ) {
+         push_back( *it );
+      }
+   }
+   return *this;
+}
+
+template < typename _Entry, std::size_t _InlineSize >
+void ChunkBuffer< _Entry, _InlineSize >::grow() {
+   std::size_t capacity = _capacity * 2;
+   _Entry *entries = NEW _Entry[ capacity ];
+   for ( std::size_t idx = 0; idx < _size; idx += 1 ) {
+      entries[ idx ] = _entries[ idx ];
+   }
+   if ( _entries != _inline ) delete[] _entries;
+   _entries = entries;
+   _capacity = capacity;
+}
+
+template < typename _Entry, std::size_t _InlineSize >
+inline void ChunkBuffer< _Entry, _InlineSize >::push_back( _Entry const &entry ) {
+   if ( _size == _capacity ) grow();
+   _entries[ _size++ ] = entry;
+}
+
 template < typename _Type >
 void MemoryMap< _Type >::insertWithOverlap( const MemoryChunk &key, typename BaseMap::iterator &hint, MemChunkList &ptrList )
 {
@@ -95,6 +95,45 @@ class MemoryChunk {
       static void partitionEnd( MemoryChunk &mcA, MemoryChunk const &mcB );
 };
 
+/*! \brief Result buffer of the MemoryMap queries
+ *
+ *  Queries usually return one or two chunks, which fit in the inline storage of the buffer (it is
+ *  declared by the caller, normally on its stack), so no memory is allocated. Larger results are
+ *  moved to the heap. Only the std::list operations used on query results are provided.
+ */
+template <typename _Entry, std::size_t _InlineSize>
+class ChunkBuffer {
+   private:
+      _Entry       _inline[ _InlineSize ];
+      _Entry      *_entries;
+      std::size_t  _size;
+      std::size_t  _capacity;
+
+      void grow();
+   public:
+      typedef _Entry value_type;
+      typedef _Entry *iterator;
+      typedef _Entry const *const_iterator;
+
+      ChunkBuffer() : _entries( _inline ), _size( 0 ), _capacity( _InlineSize ) { }
+      ChunkBuffer( ChunkBuffer const &cb );
+      ~ChunkBuffer();
+      ChunkBuffer &operator=( ChunkBuffer const &cb );
+
+      void push_back( _Entry const &entry );
+      void clear() { _size = 0; }
+      std::size_t size() const { return _size; }
+      bool empty() const { return _size == 0; }
+      _Entry &front() { return _entries[ 0 ]; }
+      _Entry const &front() const { return _entries[ 0 ]; }
+      _Entry &back() { return _entries[ _size - 1 ]; }
+      _Entry const &back() const { return _entries[ _size - 1 ]; }
+      iterator begin() { return _entries; }
+      const_iterator begin() const { return _entries; }
+      iterator end() { return _entries + _size; }
+      const_iterator end() const { return _entries + _size; }
+};
+
 template <typename _Type>
 class MemoryMap : public std::map< MemoryChunk, _Type * > { 
    using std::map< MemoryChunk, _Type *>::operator=;
@@ -104,9 +143,9 @@ class MemoryMap : public std::map< MemoryChunk, _Type * > {
       //typedef enum { MEM_CHUNK_FOUND, MEM_CHUNK_NOT_FOUND, MEM_CHUNK_NOT_FOUND_BUT_ALLOCATED } QueryResult;
       typedef std::map< MemoryChunk, _Type * > BaseMap;
       typedef std::pair< const MemoryChunk *, _Type ** > MemChunkPair;
-      typedef std::list< MemChunkPair > MemChunkList;
+      typedef ChunkBuffer< MemChunkPair, 4 > MemChunkList;
       typedef std::pair< MemoryChunk, _Type * > ConstMemChunkPair;
-      typedef std::list< ConstMemChunkPair > ConstMemChunkList;
+      typedef ChunkBuffer< ConstMemChunkPair, 4 > ConstMemChunkList;
       typedef typename BaseMap::iterator iterator;
       typedef typename BaseMap::const_iterator const_iterator;
 
@@ -20,112 +20,171 @@
 #include "packer_decl.hpp"
 #include "system.hpp"
 
+#include <cstring>
 #include <iostream>
 
 using namespace nanos;
 
+/* Size classes are multiples of a cache line, released packs only
+ * hold up to a quarter of the pack segment
+ */
+#define PACK_CLASS_GRANULARITY 64
+#define PACK_CACHE_FRACTION 4
 
-bool Packer::PackInfo::operator<( Packer::PackInfo const &pack ) const {
-   return _addr < pack._addr;
+namespace {
+
+template < std::size_t LEN >
+inline void packLines( char *pack, char const *src, std::size_t count, std::size_t ld )
+{
+   for ( std::size_t i = 0; i < count; i += 1 ) {
+      ::memcpy( &pack[ i * LEN ], &src[ i * ld ], LEN );
+   }
 }
 
-bool Packer::PackInfo::overlaps( uint64_t addr ) const {
-   return addr < ( _addr + _len * _count );
+template < std::size_t LEN >
+inline void unpackLines( char *dst, char const *pack, std::size_t count, std::size_t ld )
+{
+   for ( std::size_t i = 0; i < count; i += 1 ) {
+      ::memcpy( &dst[ i * ld ], &pack[ i * LEN ], LEN );
+   }
 }
 
-bool Packer::PackInfo::sizeMatch( std::size_t len, std::size_t count ) const {
-   return len == _len && count == _count ;
+} // namespace
+
+std::size_t Packer::sizeClass( std::size_t len ) {
+   return ( ( len + PACK_CLASS_GRANULARITY - 1 ) / PACK_CLASS_GRANULARITY ) * PACK_CLASS_GRANULARITY;
 }
 
-void * Packer::give_pack( uint64_t addr, std::size_t len, std::size_t count ) {
+void *Packer::allocate( std::size_t size ) {
    void *result = NULL;
-   PackInfo key( addr, len, count );
-
-#if 1 /* simple implementation */
-   _lock.acquire();
-   if ( _allocator == NULL ) _allocator = sys.getNetwork()->getPackerAllocator();
-   _allocator->lock();
-   result = _allocator->allocate( len * count );
-   _allocator->unlock();
-   _lock.release();
-#else
-   _lock.acquire();
-   //std::map< PackInfo, void *>::iterator it = _packs.lower_bound( key );
-   mapIterator it = _packs.lower_bound( key );
-   if ( it == _packs.end() || _packs.key_comp()( key, it->first ) || !it->first.sizeMatch( len, count ) ) {
-      if ( it == _packs.end() ) { /* not found */
-         if ( it != _packs.begin() ) {
-            mapIterator previous = it;
-            //std::map< PackInfo, void *>::iterator previous = it;
-            previous--;
-            //if ( previous->first.overlaps( addr ) ) {
-            //   std::cerr << "overlap with previous" << std::endl;
-            //} else {
-               if ( _allocator == NULL ) _allocator = sys.getNetwork()->getPackerAllocator();
-               _allocator->lock();
-               result = _allocator->allocate( len * count );
-               _allocator->unlock();
-               _packs.insert( it, std::make_pair( key, PackMemory( result ) ) );
-            //}
-         } else { 
-            //std::cerr << "begin chunk" << std::endl;
-            if ( _allocator == NULL ) _allocator = sys.getNetwork()->getPackerAllocator();
-            _allocator->lock();
-            result = _allocator->allocate( len * count );
-            _allocator->unlock();
-            _packs.insert( it, std::make_pair( key, PackMemory( result ) ) );
-         }
-      } else if ( _packs.key_comp()( key, it->first )  ) { /* not equal: key < it */
-         //std::cerr << "not equal addr equal addr" << std::endl;
-         if ( _allocator == NULL ) _allocator = sys.getNetwork()->getPackerAllocator();
+   FreePacks::iterator it = _freePacks.find( size );
+   if ( it != _freePacks.end() && !it->second.empty() ) {
+      result = it->second.back();
+      it->second.pop_back();
+      _cachedBytes -= size;
+   } else {
+      _allocator->lock();
+      result = _allocator->allocate( size );
+      _allocator->unlock();
+      if ( result == NULL && _cachedBytes > 0 ) {
+         /* the segment may be full of packs of other sizes */
+         releaseCachedPacks();
          _allocator->lock();
-         result = _allocator->allocate( len * count );
+         result = _allocator->allocate( size );
          _allocator->unlock();
-         _packs.insert( it, std::make_pair( key, result ) );
-      } else { /* eq addr, no size match*/
-         if (sys.getNetwork()->getNodeNum() == 0) std::cerr << "equal addr, different size" << std::endl;
-         fatal("Unhandled case\n");
       }
-   } else { /* exact match */
-      if (sys.getNetwork()->getNodeNum() == 0) std::cerr << "exact match chunk " << (void *) addr << " pack addr "<< it->second.getMemory()  << std::endl;
-      result = it->second.getMemoryAndIncreaseReferences();
    }
+   return result;
+}
+
+void Packer::releaseCachedPacks() {
+   _allocator->lock();
+   for ( FreePacks::iterator it = _freePacks.begin(); it != _freePacks.end(); it++ ) {
+      for ( std::vector< void * >::iterator pit = it->second.begin(); pit != it->second.end(); pit++ ) {
+         _allocator->free( *pit );
+      }
+   }
+   _allocator->unlock();
+   _freePacks.clear();
+   _cachedBytes = 0;
+}
+
+void * Packer::give_pack( uint64_t addr, std::size_t len, std::size_t count ) {
+   void *result = NULL;
+
+   _lock.acquire();
+   if ( _allocator == NULL ) _allocator = sys.getNetwork()->getPackerAllocator();
+   result = allocate( sizeClass( len * count ) );
    _lock.release();
-#endif
+
    if ( result == NULL ) {
       std::cerr << "Error: could not get a memory area to pack data. Requested " << ( len*count) << " bytes, capacity " << _allocator->getCapacity() << " bytes."<< std::endl;
       printBt(std::cerr);
    }
-   //std::cerr <<"pack returrns "<<  result << std::endl;
    return result;
 }
 
 bool Packer::free_pack( uint64_t addr, std::size_t len, std::size_t count, void *allocAddr ) {
    bool result = true;
-#if 1
-   _lock.acquire();
-   _allocator->lock();
-   if ( _allocator->free( allocAddr ) == 0 ) {
-      result = false;
-   }
-   _allocator->unlock();
-   _lock.release();
-#else
-   PackInfo key( addr, len, count );
+   std::size_t size = sizeClass( len * count );
+
    _lock.acquire();
-   _allocator->lock();
-   mapIterator it = _packs.find( key );
-   //if (sys.getNetwork()->getNodeNum() == 0) std::cerr <<"pack frees h: " << (void *) addr << " pack addr " <<  it->second << std::endl;
-   if ( it->second.decreaseReferences() == 0 ) {
-      _allocator->free( it->second.getMemory() );
-      _packs.erase( it );
+   if ( _cachedBytes + size <= _allocator->getCapacity() / PACK_CACHE_FRACTION ) {
+      _freePacks[ size ].push_back( allocAddr );
+      _cachedBytes += size;
+   } else {
+      _allocator->lock();
+      if ( _allocator->free( allocAddr ) == 0 ) {
+         result = false;
+      }
+      _allocator->unlock();
    }
-   _allocator->unlock();
    _lock.release();
-#endif
    return result;
 }
 
 void Packer::setAllocator( SimpleAllocator *alloc ) {
    _allocator = alloc;
 }
+
+void Packer::pack( char *pack, char const *src, std::size_t len, std::size_t count, std::size_t ld ) {
+   if ( ld == len ) {
+      ::memcpy( pack, src, len * count );
+      return;
+   }
+   /* Fixed size lines are copied with register moves instead of a memcpy call per line */
+   switch ( len ) {
+      case 4:  packLines<4>( pack, src, count, ld ); break;
+      case 8:  packLines<8>( pack, src, count, ld ); break;
+      case 16: packLines<16>( pack, src, count, ld ); break;
+      case 32: packLines<32>( pack, src, count, ld ); break;
+      case 64: packLines<64>( pack, src, count, ld ); break;
+      default:
+         for ( std::size_t i = 0; i < count; i += 1 ) {
+            ::memcpy( &pack[ i * len ], &src[ i * ld ], len );
+         }
+   }
+}
+
+void Packer::packRange( char *pack, char const *src, std::size_t len, std::size_t ld, std::size_t offset, std::size_t size ) {
+   std::size_t line = offset / len;
+   std::size_t lineOffset = offset % len;
+   std::size_t end = offset + size;
+
+   /* leading part of a line */
+   if ( lineOffset != 0 ) {
+      std::size_t bytes = ( len - lineOffset < size ) ? len - lineOffset : size;
+      ::memcpy( &pack[ offset ], &src[ line * ld + lineOffset ], bytes );
+      offset += bytes;
+      line += 1;
+   }
+   /* whole lines */
+   std::size_t lines = ( end - offset ) / len;
+   if ( lines > 0 ) {
+      Packer::pack( &pack[ offset ], &src[ line * ld ], len, lines, ld );
+      offset += lines * len;
+      line += lines;
+   }
+   /* trailing part of a line */
+   if ( offset < end ) {
+      ::memcpy( &pack[ offset ], &src[ line * ld ], end - offset );
+   }
+}
+
+void Packer::unpack( char *dst, char const *pack, std::size_t len, std::size_t count, std::size_t ld ) {
+   if ( ld == len ) {
+      ::memcpy( dst, pack, len * count );
+      return;
+   }
+   switch ( len ) {
+      case 4:  unpackLines<4>( dst, pack, count, ld ); break;
+      case 8:  unpackLines<8>( dst, pack, count, ld ); break;
+      case 16: unpackLines<16>( dst, pack, count, ld ); break;
+      case 32: unpackLines<32>( dst, pack, count, ld ); break;
+      case 64: unpackLines<64>( dst, pack, count, ld ); break;
+      default:
+         for ( std::size_t i = 0; i < count; i += 1 ) {
+            ::memcpy( &dst[ i * ld ], &pack[ i * len ], len );
+         }
+   }
+}
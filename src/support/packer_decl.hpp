@@ -22,54 +22,50 @@
 
 #include <stdint.h>
 #include <map>
+#include <vector>
 #include "simpleallocator_decl.hpp"
 
 namespace nanos {
 
+/*! \brief Pack buffers for strided transfers and the kernels to fill and drain them
+ *
+ *  Buffers are taken from the network pack segment, which is already
+ *  registered with the network, and are kept in per size class free lists
+ *  when released so that repeated transfers of the same shape (halo
+ *  exchanges) do not go through the segment allocator again.
+ *  There is a single Packer, owned by the Network, and every user of the
+ *  pack segment allocates through it: cached packs are only given back to
+ *  the segment when an allocation made through the Packer fails.
+ */
 class Packer {
 
-   class PackInfo {
-      uint64_t    _addr;
-      std::size_t _len;
-      std::size_t _count;
+   typedef std::map< std::size_t, std::vector< void * > > FreePacks;
 
-      public:
-         PackInfo() : _addr( 0 ), _len ( 0 ), _count( 0 ) { }
-         PackInfo( uint64_t addr, std::size_t len, std::size_t count ) : _addr( addr ), _len ( len ), _count( count ) { }
-         PackInfo( PackInfo const &pack ) : _addr( pack._addr ), _len ( pack._len ), _count( pack._count ) { }
-         bool operator<( PackInfo const &pack ) const;
-         bool overlaps( uint64_t addr ) const;
-         bool sizeMatch( std::size_t len, std::size_t count ) const;
-   };
-
-   class PackMemory {
-      void * _memory;
-      Atomic<unsigned int> _refCounter;
-
-      public:
-         PackMemory() : _memory( NULL ), _refCounter( 0 ) { }
-         PackMemory( void *mem ) : _memory( mem ), _refCounter( 1 ) { }
-         PackMemory( PackMemory const &pm ) : _memory( pm._memory ), _refCounter( pm._refCounter.value() ) { }
-         void *getMemoryAndIncreaseReferences() { _refCounter++; return _memory; }
-         unsigned int decreaseReferences() { unsigned int value = --_refCounter; return value; }
-         void *getMemory() const { return _memory; }
-   };
-
-   std::map< PackInfo, PackMemory > _packs;
+   FreePacks _freePacks;      //!< Released buffers, by size class
+   std::size_t _cachedBytes;  //!< Bytes held in _freePacks
    SimpleAllocator *_allocator;
    Lock _lock;
 
-   typedef std::map< PackInfo, PackMemory >::iterator mapIterator;
-
    private:
       Packer( Packer const &p );
       bool operator=( Packer const &p );
 
+      static std::size_t sizeClass( std::size_t len );
+      void *allocate( std::size_t size );
+      void releaseCachedPacks();
+
    public:
-      Packer() : _packs(), _allocator( NULL ) {}
+      Packer() : _freePacks(), _cachedBytes( 0 ), _allocator( NULL ) {}
       void *give_pack( uint64_t addr, std::size_t len, std::size_t count );
       bool free_pack( uint64_t addr, std::size_t len, std::size_t count, void *allocAddr );
       void setAllocator( SimpleAllocator *alloc );
+
+      //! \brief Gathers count lines of len bytes, ld bytes apart, into pack
+      static void pack( char *pack, char const *src, std::size_t len, std::size_t count, std::size_t ld );
+      //! \brief Gathers bytes [offset, offset+size) of the packed representation into pack+offset
+      static void packRange( char *pack, char const *src, std::size_t len, std::size_t ld, std::size_t offset, std::size_t size );
+      //! \brief Scatters count lines of len bytes from pack to lines ld bytes apart
+      static void unpack( char *dst, char const *pack, std::size_t len, std::size_t count, std::size_t ld );
 };
 
 } // namespace nanos
@@ -0,0 +1,520 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+// Offline converter of the traces written by the binary_trace instrumentation plugin
+
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "nanos-int.h"
+#include "binarytrace.hpp"
+
+using namespace nanos;
+
+namespace {
+
+// Names of nanos_event_state_value_t
+const char *stateNames[] = { "NOT_CREATED", "NOT_RUNNING", "STARTUP", "SHUTDOWN", "ERROR", "IDLE",
+                             "RUNTIME", "RUNNING", "SYNCHRONIZATION", "SCHEDULING", "CREATION",
+                             "MEM_TRANSFER_ISSUE", "CACHE", "YIELD", "ACQUIRING_LOCK", "CONTEXT_SWITCH",
+                             "FILL1", "WAKINGUP", "STOPPED", "SYNCED_RUNNING", "DEBUG" };
+
+// Names of nanos_event_type_t
+const char *typeNames[] = { "state-start", "state-end", "substate-start", "substate-end",
+                            "burst-start", "burst-end", "ptp-start", "ptp-end", "point" };
+
+// Paraver event types of the keys (same base as the Extrae plugin)
+const unsigned int prvEventBase = 9200000;
+const unsigned int prvSubstate = 9000000;
+
+void fail ( const std::string &msg )
+{
+   std::cerr << "nanox-trace: " << msg << std::endl;
+   exit( 1 );
+}
+
+class MappedFile
+{
+   private:
+      const unsigned char *_data;
+      size_t               _size;
+
+      MappedFile ( const MappedFile & );
+      const MappedFile & operator= ( const MappedFile & );
+   public:
+      MappedFile ( const std::string &path ) : _data( NULL ), _size( 0 )
+      {
+         int fd = open( path.c_str(), O_RDONLY );
+         if ( fd < 0 ) fail( "cannot open " + path );
+         struct stat st;
+         if ( fstat( fd, &st ) != 0 ) fail( "cannot stat " + path );
+         _size = st.st_size;
+         if ( _size < sizeof( BinaryTrace::FileHeader ) ) fail( path + " is not a binary trace file" );
+         void *data = mmap( NULL, _size, PROT_READ, MAP_PRIVATE, fd, 0 );
+         if ( data == MAP_FAILED ) fail( "cannot map " + path );
+         close( fd );
+         _data = (const unsigned char *) data;
+         madvise( data, _size, MADV_SEQUENTIAL );
+         if ( !BinaryTrace::checkHeader( header() ) ) fail( path + " is not a binary trace file (or has another version)" );
+      }
+      ~MappedFile () { munmap( (void *) _data, _size ); }
+
+      const BinaryTrace::FileHeader & header () const { return *(const BinaryTrace::FileHeader *) _data; }
+      const unsigned char * begin () const { return _data + sizeof( BinaryTrace::FileHeader ); }
+      const unsigned char * end () const { return _data + _size; }
+};
+
+struct Record {
+   unsigned long long   _time;      // ns since the start of the trace
+   int                  _thread;
+   unsigned int         _type;
+   nanos_event_key_t    _key;
+   nanos_event_value_t  _value;
+   unsigned int         _domain;
+   long long            _id;
+   unsigned int         _partner;
+};
+
+// Sequential decoder of the stream of a thread
+class StreamReader
+{
+   private:
+      MappedFile           _file;
+      const unsigned char *_pos;
+      unsigned long long   _time;
+      bool                 _truncated;
+
+      bool read ( unsigned long long &v )
+      {
+         size_t n = BinaryTrace::decode( _pos, _file.end(), v );
+         _pos += n;
+         return n != 0;
+      }
+   public:
+      StreamReader ( const std::string &path ) : _file( path ), _pos( _file.begin() ), _time( _file.header()._baseTime ),
+                                                 _truncated( false ) {}
+
+      int getThread () const { return _file.header()._thread; }
+      unsigned long long getBaseTime () const { return _file.header()._baseTime; }
+      bool isTruncated () const { return _truncated; }
+
+      // Decodes the next record, times are absolute
+      bool next ( Record &r )
+      {
+         if ( _pos >= _file.end() ) return false;
+
+         unsigned long long delta, key, value, domain = 0, id = 0, partner = 0;
+         bool ok = read( delta ) && _pos < _file.end();
+         if ( ok ) r._type = *_pos++;
+         ok = ok && read( key ) && read( value );
+         if ( ok && ( r._type == NANOS_PTP_START || r._type == NANOS_PTP_END ) )
+            ok = read( domain ) && read( id ) && read( partner );
+         if ( !ok ) {
+            // The program did not finish cleanly, ignore the partially written record
+            _truncated = true;
+            _pos = _file.end();
+            return false;
+         }
+
+         _time += delta;
+         r._time = _time;
+         r._thread = getThread();
+         r._key = (nanos_event_key_t) key;
+         r._value = value;
+         r._domain = (unsigned int) domain;
+         r._id = BinaryTrace::unzigzag( id );
+         r._partner = (unsigned int) partner;
+         return true;
+      }
+};
+
+struct KeyInfo {
+   std::string                                  _name;
+   std::string                                  _description;
+   bool                                         _stacked;
+   std::map<nanos_event_value_t, std::string>   _values;    // value -> description
+};
+typedef std::map<nanos_event_key_t, KeyInfo> Dictionary;
+
+class Trace
+{
+   private:
+      typedef std::vector<StreamReader *> Streams;
+
+      Dictionary           _dictionary;
+      Streams              _streams;
+      std::vector<Record>  _pending;     // next record of every stream
+      std::vector<bool>    _valid;
+      unsigned long long   _start;       // earliest base time
+
+      static std::string readString ( const unsigned char *&pos, const unsigned char *end )
+      {
+         unsigned long long len;
+         size_t n = BinaryTrace::decode( pos, end, len );
+         if ( n == 0 || pos + n + len > end ) fail( "corrupted dictionary" );
+         pos += n;
+         std::string str( (const char *) pos, len );
+         pos += len;
+         return str;
+      }
+
+      void readDictionary ( const std::string &path )
+      {
+         MappedFile file( path );
+         const unsigned char *pos = file.begin(), *end = file.end();
+         while ( pos < end ) {
+            unsigned char kind = *pos++;
+            unsigned long long key, value;
+            size_t n = BinaryTrace::decode( pos, end, key );
+            if ( n == 0 ) fail( "corrupted dictionary" );
+            pos += n;
+            if ( kind == 'K' ) {
+               if ( pos >= end ) fail( "corrupted dictionary" );
+               KeyInfo &info = _dictionary[key];
+               info._stacked = *pos++ != 0;
+               info._name = readString( pos, end );
+               info._description = readString( pos, end );
+            } else if ( kind == 'V' ) {
+               n = BinaryTrace::decode( pos, end, value );
+               if ( n == 0 ) fail( "corrupted dictionary" );
+               pos += n;
+               readString( pos, end );
+               _dictionary[key]._values[value] = readString( pos, end );
+            } else fail( "corrupted dictionary" );
+         }
+      }
+
+   public:
+      Trace ( const std::string &dir ) : _dictionary(), _streams(), _pending(), _valid(), _start( 0 )
+      {
+         DIR *d = opendir( dir.c_str() );
+         if ( d == NULL ) fail( "cannot open trace directory " + dir );
+         struct dirent *entry;
+         while ( ( entry = readdir( d ) ) != NULL ) {
+            std::string name( entry->d_name );
+            if ( name.compare( 0, 7, "thread." ) == 0 ) _streams.push_back( new StreamReader( dir + "/" + name ) );
+         }
+         closedir( d );
+         if ( _streams.empty() ) fail( "no thread streams in " + dir );
+
+         struct stat st;
+         if ( stat( ( dir + "/dictionary" ).c_str(), &st ) == 0 ) readDictionary( dir + "/dictionary" );
+         else std::cerr << "nanox-trace: warning: " << dir << " has no dictionary, keys will not be described" << std::endl;
+
+         _pending.resize( _streams.size() );
+         _valid.resize( _streams.size() );
+         _start = _streams[0]->getBaseTime();
+         for ( size_t i = 0; i < _streams.size(); i++ ) {
+            if ( _streams[i]->getBaseTime() < _start ) _start = _streams[i]->getBaseTime();
+            _valid[i] = _streams[i]->next( _pending[i] );
+         }
+      }
+
+      ~Trace ()
+      {
+         for ( size_t i = 0; i < _streams.size(); i++ ) {
+            if ( _streams[i]->isTruncated() )
+               std::cerr << "nanox-trace: warning: stream of thread " << _streams[i]->getThread() << " is truncated" << std::endl;
+            delete _streams[i];
+         }
+      }
+
+      const Dictionary & getDictionary () const { return _dictionary; }
+
+      std::set<int> getThreads () const
+      {
+         std::set<int> threads;
+         for ( size_t i = 0; i < _streams.size(); i++ ) threads.insert( _streams[i]->getThread() );
+         return threads;
+      }
+
+      // Next record of the trace in time order (merging the streams)
+      bool next ( Record &r )
+      {
+         size_t min = _streams.size();
+         for ( size_t i = 0; i < _streams.size(); i++ ) {
+            if ( _valid[i] && ( min == _streams.size() || _pending[i]._time < _pending[min]._time ) ) min = i;
+         }
+         if ( min == _streams.size() ) return false;
+
+         r = _pending[min];
+         r._time -= _start;
+         _valid[min] = _streams[min]->next( _pending[min] );
+         return true;
+      }
+
+      std::string describeKey ( nanos_event_key_t key ) const
+      {
+         Dictionary::const_iterator it = _dictionary.find( key );
+         return it == _dictionary.end() ? std::string() : it->second._name;
+      }
+
+      std::string describeValue ( nanos_event_key_t key, nanos_event_value_t value ) const
+      {
+         Dictionary::const_iterator it = _dictionary.find( key );
+         if ( it == _dictionary.end() ) return std::string();
+         std::map<nanos_event_value_t, std::string>::const_iterator v = it->second._values.find( value );
+         return v == it->second._values.end() ? std::string() : v->second;
+      }
+};
+
+std::string quoteCsv ( const std::string &str )
+{
+   if ( str.find_first_of( ",\"" ) == std::string::npos ) return str;
+   std::string quoted = "\"";
+   for ( size_t i = 0; i < str.size(); i++ ) {
+      if ( str[i] == '"' ) quoted += '"';
+      quoted += str[i];
+   }
+   return quoted + "\"";
+}
+
+void toCsv ( Trace &trace, std::ostream &out )
+{
+   out << "time,thread,type,key,value,domain,id,partner,key_name,value_description" << std::endl;
+   Record r;
+   while ( trace.next( r ) ) {
+      bool state = r._type <= NANOS_SUBSTATE_END;
+      out << r._time << "," << r._thread << "," << ( r._type < EVENT_TYPES ? typeNames[r._type] : "unknown" ) << ","
+          << r._key << "," << r._value << ",";
+      if ( r._type == NANOS_PTP_START || r._type == NANOS_PTP_END ) out << r._domain << "," << r._id << "," << r._partner;
+      else out << ",,";
+      out << ",";
+      if ( state ) out << ",";
+      else out << quoteCsv( trace.describeKey( r._key ) ) << ",";
+      if ( state ) out << ( r._value < NANOS_EVENT_STATE_TYPES ? stateNames[r._value] : "" );
+      else out << quoteCsv( trace.describeValue( r._key, r._value ) );
+      out << std::endl;
+   }
+}
+
+void toDot ( Trace &trace, std::ostream &out )
+{
+   // See the dep-direction values raised by the dependences plugins
+   static const char *depStyle[] = { "", "color=black", "color=red", "color=blue", "color=gray", "color=gray",
+                                     "color=green", "color=green" };
+   const Dictionary &dict = trace.getDictionary();
+   nanos_event_key_t dependence = 0, direction = 0;
+   for ( Dictionary::const_iterator it = dict.begin(); it != dict.end(); it++ ) {
+      if ( it->second._name == "dependence" ) dependence = it->first;
+      else if ( it->second._name == "dep-direction" ) direction = it->first;
+   }
+   if ( dependence == 0 ) fail( "the dictionary has no dependence key, cannot build the graph" );
+
+   typedef std::pair<nanos_event_value_t, nanos_event_value_t> Edge;
+   std::set<Edge> edges;
+   std::map<int, nanos_event_value_t> lastDependence;   // per thread, waiting for its direction
+   Record r;
+
+   out << "digraph trace {" << std::endl;
+   while ( trace.next( r ) ) {
+      if ( r._type > NANOS_SUBSTATE_END && r._key == dependence ) {
+         lastDependence[r._thread] = r._value;
+      } else if ( r._type > NANOS_SUBSTATE_END && r._key == direction && lastDependence.count( r._thread ) ) {
+         nanos_event_value_t dep = lastDependence[r._thread];
+         lastDependence.erase( r._thread );
+         Edge edge( ( dep >> 32 ) & 0xFFFFFFFF, dep & 0xFFFFFFFF );
+         if ( !edges.insert( edge ).second ) continue;
+         out << "   " << edge.first << " -> " << edge.second;
+         if ( r._value < sizeof( depStyle ) / sizeof( depStyle[0] ) && depStyle[r._value][0] != '\0' )
+            out << " [" << depStyle[r._value] << "]";
+         out << ";" << std::endl;
+      }
+   }
+   out << "}" << std::endl;
+}
+
+// Paraver wants the records sorted by begin time, but a state record is only known when the state ends
+class ParaverRecords
+{
+   private:
+      typedef std::multimap<unsigned long long, std::string> Records;
+      Records              _records;
+      std::ostringstream   _current;
+      unsigned long long   _time;
+      bool                 _open;
+
+   public:
+      ParaverRecords () : _records(), _current(), _time( 0 ), _open( false ) {}
+
+      // Starts a record which begins at time, the caller writes it to the returned stream
+      std::ostream & add ( unsigned long long time )
+      {
+         flush();
+         _time = time;
+         _open = true;
+         return _current;
+      }
+
+      void flush ()
+      {
+         if ( !_open ) return;
+         _records.insert( std::make_pair( _time, _current.str() ) );
+         _current.str( "" );
+         _open = false;
+      }
+
+      void write ( std::ostream &out )
+      {
+         flush();
+         for ( Records::iterator it = _records.begin(); it != _records.end(); it++ ) out << it->second << "\n";
+      }
+};
+
+void toParaver ( Trace &trace, const std::string &base )
+{
+   std::set<int> threadSet = trace.getThreads();
+   std::map<int, int> prvThread;     // trace thread -> paraver thread (1..n)
+   int n = 0;
+   for ( std::set<int>::iterator it = threadSet.begin(); it != threadSet.end(); it++ ) prvThread[*it] = ++n;
+
+   ParaverRecords body;
+
+   std::map<int, std::vector<unsigned int> > states;        // state stack per thread
+   std::map<int, unsigned long long> stateStart;
+   unsigned long long endTime = 0;
+   Record r;
+   while ( trace.next( r ) ) {
+      int th = prvThread[r._thread];
+      std::vector<unsigned int> &stack = states[th];
+      endTime = r._time;
+
+      switch ( r._type ) {
+         case NANOS_STATE_START:
+         case NANOS_STATE_END:
+            if ( !stack.empty() && r._time > stateStart[th] )
+               body.add( stateStart[th] ) << "1:" << th << ":1:1:" << th << ":" << stateStart[th] << ":" << r._time << ":" << stack.back();
+            if ( r._type == NANOS_STATE_START ) stack.push_back( (unsigned int) r._value );
+            else if ( !stack.empty() ) stack.pop_back();
+            stateStart[th] = r._time;
+            break;
+         case NANOS_SUBSTATE_START:
+         case NANOS_SUBSTATE_END:
+            body.add( r._time ) << "2:" << th << ":1:1:" << th << ":" << r._time << ":" << prvSubstate << ":"
+                                << ( r._type == NANOS_SUBSTATE_START ? r._value : 0 );
+            break;
+         case NANOS_BURST_END:
+            body.add( r._time ) << "2:" << th << ":1:1:" << th << ":" << r._time << ":" << prvEventBase + r._key << ":0";
+            break;
+         default:
+            if ( r._key != 0 )
+               body.add( r._time ) << "2:" << th << ":1:1:" << th << ":" << r._time << ":" << prvEventBase + r._key << ":"
+                                   << r._value;
+            break;
+      }
+   }
+   for ( std::map<int, std::vector<unsigned int> >::iterator it = states.begin(); it != states.end(); it++ ) {
+      if ( !it->second.empty() && endTime > stateStart[it->first] )
+         body.add( stateStart[it->first] ) << "1:" << it->first << ":1:1:" << it->first << ":" << stateStart[it->first]
+                                           << ":" << endTime << ":" << it->second.back();
+   }
+
+   // Header (one node with a cpu per thread, one application with one task) and body
+   std::string prv = base + ".prv";
+   std::ofstream trc( prv.c_str() );
+   if ( !trc ) fail( "cannot write " + prv );
+   char date[64];
+   time_t now = time( NULL );
+   strftime( date, sizeof( date ), "%d/%m/%y at %H:%M", localtime( &now ) );
+   trc << "#Paraver (" << date << "):" << endTime << "_ns:1(" << n << "):1:1(" << n << ":1)\n";
+   body.write( trc );
+   trc.close();
+
+   // Configuration file
+   std::string pcfName = base + ".pcf";
+   std::ofstream pcf( pcfName.c_str() );
+   if ( !pcf ) fail( "cannot write " + pcfName );
+   pcf << "STATES\n";
+   for ( unsigned int i = 0; i < NANOS_EVENT_STATE_TYPES; i++ ) pcf << i << "    " << stateNames[i] << "\n";
+   pcf << "\nEVENT_TYPE\n0    " << prvSubstate << "    Substate\nVALUES\n";
+   for ( unsigned int i = 0; i < NANOS_EVENT_STATE_TYPES; i++ ) pcf << i << "    " << stateNames[i] << "\n";
+   const Dictionary &dict = trace.getDictionary();
+   for ( Dictionary::const_iterator it = dict.begin(); it != dict.end(); it++ ) {
+      if ( it->first == 0 ) continue;
+      pcf << "\nEVENT_TYPE\n0    " << prvEventBase + it->first << "    " << it->second._description << "\n";
+      if ( !it->second._values.empty() ) {
+         pcf << "VALUES\n0    End\n";
+         for ( std::map<nanos_event_value_t, std::string>::const_iterator v = it->second._values.begin();
+               v != it->second._values.end(); v++ )
+            pcf << v->first << "    " << v->second << "\n";
+      }
+   }
+   pcf.close();
+
+   std::cout << "Paraver trace written to " << prv << " and " << pcfName << std::endl;
+}
+
+void usage ( const char *program )
+{
+   std::cout << "usage: " << program << " --prv|--dot|--csv <trace directory> [output]" << std::endl;
+   std::cout << "   --prv   Paraver trace (output is the base name of the .prv and .pcf files)" << std::endl;
+   std::cout << "   --dot   Task dependence graph (written to output or stdout)" << std::endl;
+   std::cout << "   --csv   One line per event (written to output or stdout)" << std::endl;
+   exit( 1 );
+}
+
+} // namespace
+
+int main ( int argc, char* argv[] )
+{
+   if ( argc < 3 || argc > 4 ) usage( argv[0] );
+
+   std::string format( argv[1] );
+   std::string dir( argv[2] );
+   while ( dir.size() > 1 && dir[dir.size()-1] == '/' ) dir.erase( dir.size() - 1 );
+   std::string output = argc == 4 ? argv[3] : "";
+
+   if ( format != "--prv" && format != "--dot" && format != "--csv" ) usage( argv[0] );
+
+   Trace trace( dir );
+
+   if ( format == "--prv" ) {
+      if ( output.empty() ) {
+         output = dir;
+         if ( output.size() > 5 && output.compare( output.size() - 5, 5, ".nxbt" ) == 0 ) output.erase( output.size() - 5 );
+      } else if ( output.size() > 4 && output.compare( output.size() - 4, 4, ".prv" ) == 0 ) {
+         output.erase( output.size() - 4 );
+      }
+      toParaver( trace, output );
+   } else {
+      std::ofstream file;
+      if ( !output.empty() ) {
+         file.open( output.c_str() );
+         if ( !file ) fail( "cannot write " + output );
+      }
+      std::ostream &out = output.empty() ? std::cout : file;
+      if ( format == "--dot" ) toDot( trace, out );
+      else toCsv( trace, out );
+   }
+
+   return 0;
+}
@@ -72,7 +72,7 @@ scheduling_performance=[]
 scheduling_small=['--schedule=dbf','--schedule=dbf --schedule-priority']
 scheduling_large=['--schedule=bf --bf-stack','--schedule=bf --no-bf-stack','--schedule=dbf', '--schedule=affinity']
 throttle=['--throttle=dummy','--throttle=idlethreads','--throttle=numtasks','--throttle=readytasks','--throttle=taskdepth']
-barriers=['--barrier=centralized','--barrier=tree']
+barriers=['--barrier=centralized','--barrier=tree','--barrier=hierarchical']
 binding=['--disable-binding','--no-disable-binding']
 architecture=['--architecture=smp']
 
@@ -0,0 +1,108 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+/*
+<testinfo>
+test_generator="gens/api-generator -a \"--stackless-tasks|--smp-stack-cache=0 --smp-stack-watermark=0|--stackless-tasks --smp-stack-cache=1 --smp-stack-watermark=1\""
+</testinfo>
+*/
+
+#include <stdio.h>
+#include <nanos.h>
+
+#define N 16
+#define FIB_N 987
+
+typedef struct {
+   int n;
+   int *res;
+} task_args;
+
+void fib_task( void *ptr );
+
+nanos_smp_args_t task_device_arg = { fib_task };
+
+struct nanos_const_wd_definition_1
+{
+     nanos_const_wd_definition_t base;
+     nanos_device_t devices[1];
+};
+
+struct nanos_const_wd_definition_1 const_data =
+{
+   {{
+      .mandatory_creation = true,
+      .tied = false},
+   __alignof__(task_args),
+   0,
+   1,0,NULL},
+   {
+      {
+         nanos_smp_factory,
+         &task_device_arg
+      }
+   }
+};
+
+static void create_task ( int n, int *res )
+{
+   nanos_wd_t wd=0;
+   task_args *args=0;
+   nanos_wd_dyn_props_t dyn_props = {0};
+
+   /* Leaves are final: they never block, so they can run on the worker stack */
+   dyn_props.flags.is_final = ( n < 2 );
+
+   NANOS_SAFE( nanos_create_wd_compact ( &wd, &const_data.base, &dyn_props, sizeof( task_args ), ( void ** )&args,
+                                        nanos_current_wd(), NULL, NULL ) );
+   args->n = n;
+   args->res = res;
+
+   NANOS_SAFE( nanos_submit( wd,0,0,0 ) );
+}
+
+/* Every task but the leaves blocks on its children, so tasks get suspended and resumed */
+void fib_task( void *ptr )
+{
+   task_args * args = ( task_args * )ptr;
+   int x = 0, y = 0;
+
+   if ( args->n < 2 ) {
+      *args->res = args->n;
+      return;
+   }
+
+   create_task( args->n - 1, &x );
+   create_task( args->n - 2, &y );
+   NANOS_SAFE( nanos_wg_wait_completion( nanos_current_wd(), false ) );
+
+   *args->res = x + y;
+}
+
+int main ( int argc, char **argv )
+{
+   int res = 0;
+
+   create_task( N, &res );
+   NANOS_SAFE( nanos_wg_wait_completion( nanos_current_wd(), false ) );
+
+   fprintf(stdout, "Result is %s\n", res != FIB_N ? "UNSUCCESSFUL":"successful");
+
+   return res != FIB_N;
+}
@@ -0,0 +1,122 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+/* DESCRIPTION: Checking Allocator's remote frees. Every thread allocates objects from
+ * its own Allocator and they are deallocated by another thread. Once all of them have
+ * been deallocated, the owner allocates again and it must get back (some of) the
+ * objects released by the other thread.
+ */
+
+/*<testinfo>
+test_generator="gens/core-generator -a \"--gpus=0\""
+</testinfo>*/
+
+#include <iostream>
+#include <string.h>
+#include <set>
+#include "config.hpp"
+#include "smpprocessor.hpp"
+#include "system.hpp"
+#include "allocator.hpp"
+
+using namespace std;
+using namespace nanos;
+using namespace nanos::ext;
+
+#define TIMES 1000
+#define OBJECT_SIZE 3000
+#define CHECK_VALUE 3456
+
+bool check = true;
+
+void allocate( void *args );
+void deallocate ( void *ptr );
+
+void deallocate ( void *ptr )
+{
+   Allocator::deallocate( ptr );
+}
+
+void allocate( void *args )
+{
+   int num_pes = sys.getSMPPlugin()->getNumWorkers();
+   int id = *((int *) args);
+
+   Allocator &allocator = getAllocator();
+   WD *wg = getMyThreadSafe()->getCurrentWD();
+   std::set<void *> released;
+
+   for ( int n = 0; n < TIMES; n++ ) {
+      int *ptr = (int *) allocator.allocate( OBJECT_SIZE );
+      if ( ptr == NULL || Allocator::getObjectSize( ptr ) < OBJECT_SIZE ) check = false;
+      for ( unsigned int j = 0; j < OBJECT_SIZE/sizeof(int); j++ ) ptr[j]=CHECK_VALUE;
+
+      released.insert( ptr );
+
+      // Creating a work descriptor to deallocate ptr in other thread
+      ThreadTeam &team = *getMyThreadSafe()->getTeam();
+      WD * wd = new WD( new SMPDD( deallocate ), sizeof( void * ), __alignof__( void * ), ptr  );
+      wg->addWork( *wd );
+      wd->tieTo(team[(id+1)%num_pes]);
+      sys.submit( *wd );
+   }
+
+   // Waiting decendants (deallocators) before allocating again
+   wg->waitCompletion();
+
+   // The waiting thread may be a different one, use its allocator
+   Allocator &current = getAllocator();
+   if ( &current != &allocator ) return;
+
+   int reused = 0;
+   std::set<void *> allocated;
+   for ( int n = 0; n < TIMES; n++ ) {
+      void *ptr = current.allocate( OBJECT_SIZE );
+      if ( !allocated.insert( ptr ).second ) check = false;
+      if ( released.count( ptr ) ) reused++;
+   }
+   if ( reused == 0 ) check = false;
+
+   for ( std::set<void *>::iterator it = allocated.begin(); it != allocated.end(); it++ ) {
+      Allocator::deallocate( *it );
+   }
+}
+
+int main ( int argc, char **argv )
+{
+   int num_pes = sys.getSMPPlugin()->getNumWorkers();
+   int id[num_pes];
+
+   // Work Group affiliation
+   WD *wg = getMyThreadSafe()->getCurrentWD();
+
+   ThreadTeam &team = *getMyThreadSafe()->getTeam();
+   for ( int i = 0; i < num_pes; i++ ) {
+      id[i] = i;
+      WD * wd = new WD( new SMPDD( allocate ), sizeof( int ), __alignof__( int ), &id[i]  );
+      wg->addWork( *wd );
+      wd->tieTo(team[i]);
+      sys.submit( *wd );
+   }
+
+   // barrier (kind of)
+   wg->waitCompletion();
+
+   if (check) { return 0; } else { return -1; }
+}
@@ -0,0 +1,146 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+/*
+<testinfo>
+test_generator=gens/api-generator
+exec_versions="smp_private_mem smp_private_mem_pieces"
+
+declare test_ENV_smp_private_mem="NX_SMP_PRIVATE_MEMORY=true"
+declare test_ENV_smp_private_mem_pieces="NX_SMP_PRIVATE_MEMORY=true NX_SMP_TRANSFER_CHUNK=1000 NX_SMP_TRANSFER_STREAMING=4096"
+
+</testinfo>
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <nanos.h>
+
+/* A block of COLS x ROWS elements in a grid whose rows are PITCH elements long,
+ * and a contiguous buffer whose size is not a multiple of the transfer pieces
+ */
+#define ROWS   300
+#define COLS   700
+#define PITCH  1003
+#define FIRST  3
+#define BIG    ( ( 1 << 20 ) + 13 )
+#define ITERS  3
+
+typedef struct {
+   double *grid;
+   char *big;
+} my_args;
+
+void update( void *ptr );
+void update( void *ptr )
+{
+   double *grid;
+   char *big;
+   int i, j;
+
+   nanos_get_addr( 0, (void **) &grid, nanos_current_wd() );
+   nanos_get_addr( 1, (void **) &big, nanos_current_wd() );
+
+   for ( i = 0; i < ROWS; i++ ) {
+      for ( j = FIRST; j < FIRST + COLS; j++ ) {
+         grid[i * PITCH + j] += 1.0;
+      }
+   }
+   for ( i = 0; i < BIG; i++ ) {
+      big[i] += 1;
+   }
+}
+
+nanos_smp_args_t update_device_arg = { update };
+
+struct nanos_const_wd_definition_1
+{
+     nanos_const_wd_definition_t base;
+     nanos_device_t devices[1];
+};
+
+struct nanos_const_wd_definition_1 const_data =
+{
+   {{
+      .mandatory_creation = true,
+      .tied = false},
+   __alignof__(my_args),
+   2,
+   1,
+   3,NULL},
+   {
+      {
+         nanos_smp_factory,
+         &update_device_arg
+      }
+   }
+};
+
+double grid[ROWS * PITCH];
+char big[BIG];
+
+int main ( int argc, char **argv )
+{
+   int i, j, it;
+   int errors = 0;
+   nanos_wd_dyn_props_t dyn_props = {0};
+
+   for ( i = 0; i < ROWS * PITCH; i++ ) grid[i] = i;
+   for ( i = 0; i < BIG; i++ ) big[i] = i % 100;
+
+   for ( it = 0; it < ITERS; it++ ) {
+      my_args *args = 0;
+      nanos_copy_data_t *cd = 0;
+      nanos_region_dimension_internal_t *dims = 0;
+      nanos_wd_t wd = 0;
+
+      NANOS_SAFE( nanos_create_wd_compact( &wd, &const_data.base, &dyn_props, sizeof(my_args), (void **) &args,
+                                           nanos_current_wd(), &cd, &dims ) );
+      args->grid = grid;
+      args->big = big;
+
+      dims[0] = (nanos_region_dimension_internal_t) { PITCH * sizeof(double), FIRST * sizeof(double), COLS * sizeof(double) };
+      dims[1] = (nanos_region_dimension_internal_t) { ROWS, 0, ROWS };
+      dims[2] = (nanos_region_dimension_internal_t) { BIG, 0, BIG };
+
+      cd[0] = (nanos_copy_data_t) { (void *) grid, NANOS_SHARED, {true, true}, 2, &dims[0], 0 };
+      cd[1] = (nanos_copy_data_t) { (void *) big, NANOS_SHARED, {true, true}, 1, &dims[2], 0 };
+
+      NANOS_SAFE( nanos_submit( wd, 0, 0, 0 ) );
+      NANOS_SAFE( nanos_wg_wait_completion( nanos_current_wd(), false ) );
+   }
+
+   for ( i = 0; i < ROWS; i++ ) {
+      for ( j = 0; j < PITCH; j++ ) {
+         double expected = i * PITCH + j + ( j >= FIRST && j < FIRST + COLS ? ITERS : 0 );
+         if ( grid[i * PITCH + j] != expected ) errors++;
+      }
+   }
+   for ( i = 0; i < BIG; i++ ) {
+      if ( big[i] != i % 100 + ITERS ) errors++;
+   }
+
+   if ( errors != 0 ) {
+      printf( "Checking strided and contiguous copies... FAIL (%d wrong elements)\n", errors );
+      return 1;
+   }
+   printf( "Checking strided and contiguous copies... PASS\n" );
+   return 0;
+}
@@ -20,7 +20,9 @@
 /*
 <testinfo>
 test_generator=gens/api-generator
-test_deps_plugins=plain,regions,perfect-regions
+test_deps_plugins=plain,regions,perfect-regions,intervals,sharded
+exec_versions="default odd_shards"
+declare test_ENV_odd_shards="NX_DEPS_SHARDS=3"
 </testinfo>
 */
 
@@ -0,0 +1,173 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+/*
+<testinfo>
+test_generator=gens/api-generator
+test_deps_plugins=regions,perfect-regions,intervals
+</testinfo>
+*/
+#include <stdio.h>
+#include <nanos.h>
+
+/* Blocks of BS x BS elements in a grid whose rows are padded up to PITCH elements */
+#define NB     4
+#define BS     8
+#define N      ( NB * BS )
+#define PITCH  ( N + 3 )
+#define SWEEPS 4
+
+typedef struct {
+   int (*grid)[PITCH];
+   int row;
+   int col;
+} block_args;
+
+/* In-place 5-point update of a block, the result depends on the order of the blocks */
+void update_block( int (*grid)[PITCH], int row, int col );
+void update_block( int (*grid)[PITCH], int row, int col )
+{
+   int i, j;
+   for ( i = row; i < row + BS; i++ ) {
+      for ( j = col; j < col + BS; j++ ) {
+         int sum = grid[i][j];
+         if ( i > 0 ) sum += grid[i-1][j];
+         if ( i < N - 1 ) sum += grid[i+1][j];
+         if ( j > 0 ) sum += grid[i][j-1];
+         if ( j < N - 1 ) sum += grid[i][j+1];
+         grid[i][j] = sum % 1000 + 1;
+      }
+   }
+}
+
+void block_task(void *ptr);
+void block_task(void *ptr)
+{
+   block_args *args = (block_args *) ptr;
+   update_block( args->grid, args->row, args->col );
+}
+
+nanos_smp_args_t block_device_arg = { block_task };
+
+struct nanos_const_wd_definition_1
+{
+     nanos_const_wd_definition_t base;
+     nanos_device_t devices[1];
+};
+
+struct nanos_const_wd_definition_1 block_data =
+{
+   {{
+      .mandatory_creation = true,
+      .tied = false},
+   __alignof__(block_args),
+   0,
+   1,
+   0,NULL},
+   {
+      {
+         nanos_smp_factory,
+         &block_device_arg
+      }
+   }
+};
+
+nanos_wd_dyn_props_t dyn_props = {0};
+
+int grid[N][PITCH];
+int ref_grid[N][PITCH];
+
+/* Region of rows [row0, row1) and columns [col0, col1) of the grid */
+void set_region( nanos_data_access_t *access, nanos_region_dimension_t *dimensions, bool input, bool output,
+                 int row0, int row1, int col0, int col1 );
+void set_region( nanos_data_access_t *access, nanos_region_dimension_t *dimensions, bool input, bool output,
+                 int row0, int row1, int col0, int col1 )
+{
+   dimensions[0].size = PITCH * sizeof(int);
+   dimensions[0].lower_bound = col0 * sizeof(int);
+   dimensions[0].accessed_length = ( col1 - col0 ) * sizeof(int);
+   dimensions[1].size = N;
+   dimensions[1].lower_bound = row0;
+   dimensions[1].accessed_length = row1 - row0;
+
+   access->address = grid;
+   access->flags.input = input;
+   access->flags.output = output;
+   access->flags.can_rename = 0;
+   access->flags.concurrent = 0;
+   access->flags.commutative = 0;
+   access->dimension_count = 2;
+   access->dimensions = dimensions;
+   access->offset = ( row0 * PITCH + col0 ) * sizeof(int);
+}
+
+int main ( int argc, char **argv )
+{
+   int i, j, s;
+   bool error = false;
+
+   for ( i = 0; i < N; i++ ) {
+      for ( j = 0; j < PITCH; j++ ) {
+         grid[i][j] = ref_grid[i][j] = i * PITCH + j;
+      }
+   }
+
+   for ( s = 0; s < SWEEPS; s++ ) {
+      for ( i = 0; i < N; i += BS ) {
+         for ( j = 0; j < N; j += BS ) {
+            block_args *args = 0;
+            nanos_wd_t wd = 0;
+            nanos_region_dimension_t block_dims[2], halo_dims[2];
+            nanos_data_access_t deps[2];
+
+            /* The block and its halo, which overlaps the neighbouring blocks */
+            set_region( &deps[0], block_dims, true, true, i, i + BS, j, j + BS );
+            set_region( &deps[1], halo_dims, true, false, i > 0 ? i - 1 : 0, i + BS < N ? i + BS + 1 : N,
+                        j > 0 ? j - 1 : 0, j + BS < N ? j + BS + 1 : N );
+
+            NANOS_SAFE( nanos_create_wd_compact( &wd, &block_data.base, &dyn_props, sizeof( block_args ), ( void ** ) &args,
+                                                 nanos_current_wd(), NULL, NULL ) );
+            args->grid = grid;
+            args->row = i;
+            args->col = j;
+            NANOS_SAFE( nanos_submit( wd, 2, deps, 0 ) );
+
+            update_block( ref_grid, i, j );
+         }
+      }
+   }
+
+   NANOS_SAFE( nanos_wg_wait_completion( nanos_current_wd(), false ) );
+
+   for ( i = 0; i < N; i++ ) {
+      for ( j = 0; j < PITCH; j++ ) {
+         if ( grid[i][j] != ref_grid[i][j] ) {
+            printf( "Element (%d,%d) is %d instead of %d\n", i, j, grid[i][j], ref_grid[i][j] );
+            error = true;
+         }
+      }
+   }
+
+   if ( error ) {
+      printf( "FAIL\n" );
+      return 1;
+   }
+   printf( "PASS\n" );
+   return 0;
+}
@@ -0,0 +1,252 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+/*
+<testinfo>
+test_generator=gens/api-generator
+test_deps_plugins=plain,regions,perfect-regions,intervals,sharded
+</testinfo>
+*/
+#include <stdio.h>
+#include <string.h>
+#include <nanos.h>
+
+#define N      16
+#define ITERS  8
+
+/* Task arguments only hold pointers, so every word can be rebound */
+typedef struct {
+   int *src;
+   int *dst;
+} step_args;
+
+typedef struct {
+   int *left;
+   int *right;
+   int *dst;
+} combine_args;
+
+typedef struct {
+   int *value;
+   int *total;
+} sum_args;
+
+void step(void *ptr);
+void step(void *ptr)
+{
+   step_args *args = (step_args *) ptr;
+   *args->dst = *args->src + 1;
+}
+
+void combine(void *ptr);
+void combine(void *ptr)
+{
+   combine_args *args = (combine_args *) ptr;
+   *args->dst = *args->left + *args->right;
+}
+
+void sum(void *ptr);
+void sum(void *ptr)
+{
+   sum_args *args = (sum_args *) ptr;
+   *args->total += *args->value;
+}
+
+nanos_smp_args_t step_device_arg = { step };
+nanos_smp_args_t combine_device_arg = { combine };
+nanos_smp_args_t sum_device_arg = { sum };
+
+struct nanos_const_wd_definition_1
+{
+     nanos_const_wd_definition_t base;
+     nanos_device_t devices[1];
+};
+
+struct nanos_const_wd_definition_1 step_data = 
+{
+   {{
+      .mandatory_creation = true,
+      .tied = false},
+   __alignof__(step_args),
+   0,
+   1,
+   0,NULL},
+   {
+      {
+         nanos_smp_factory,
+         &step_device_arg
+      }
+   }
+};
+
+struct nanos_const_wd_definition_1 combine_data = 
+{
+   {{
+      .mandatory_creation = true,
+      .tied = false},
+   __alignof__(combine_args),
+   0,
+   1,
+   0,NULL},
+   {
+      {
+         nanos_smp_factory,
+         &combine_device_arg
+      }
+   }
+};
+
+struct nanos_const_wd_definition_1 sum_data = 
+{
+   {{
+      .mandatory_creation = true,
+      .tied = false},
+   __alignof__(sum_args),
+   0,
+   1,
+   0,NULL},
+   {
+      {
+         nanos_smp_factory,
+         &sum_device_arg
+      }
+   }
+};
+
+nanos_wd_dyn_props_t dyn_props = {0};
+
+int a[N], b[N], total;
+int ref_a[N], ref_b[N], ref_total;
+
+/* One iteration: dst = src + 1, then src[i] = dst[i] + dst[i+1] and total += src[i] */
+void submit_iteration( int *src, int *dst );
+void submit_iteration( int *src, int *dst )
+{
+   int i;
+   nanos_region_dimension_t dimensions[1] = {{sizeof(int), 0, sizeof(int)}};
+
+   for ( i = 0; i < N; i++ ) {
+      step_args *args = 0;
+      nanos_wd_t wd = 0;
+      nanos_data_access_t deps[2] = {{&src[i], {1,0,0,0,0}, 1, dimensions, 0},
+                                     {&dst[i], {0,1,0,0,0}, 1, dimensions, 0}};
+      NANOS_SAFE( nanos_create_wd_compact( &wd, &step_data.base, &dyn_props, sizeof( step_args ), ( void ** ) &args,
+                                           nanos_current_wd(), NULL, NULL ) );
+      args->src = &src[i];
+      args->dst = &dst[i];
+      NANOS_SAFE( nanos_submit( wd, 2, deps, 0 ) );
+   }
+
+   for ( i = 0; i < N; i++ ) {
+      combine_args *args = 0;
+      nanos_wd_t wd = 0;
+      nanos_data_access_t deps[3] = {{&dst[i], {1,0,0,0,0}, 1, dimensions, 0},
+                                     {&dst[(i+1)%N], {1,0,0,0,0}, 1, dimensions, 0},
+                                     {&src[i], {0,1,0,0,0}, 1, dimensions, 0}};
+      NANOS_SAFE( nanos_create_wd_compact( &wd, &combine_data.base, &dyn_props, sizeof( combine_args ), ( void ** ) &args,
+                                           nanos_current_wd(), NULL, NULL ) );
+      args->left = &dst[i];
+      args->right = &dst[(i+1)%N];
+      args->dst = &src[i];
+      NANOS_SAFE( nanos_submit( wd, 3, deps, 0 ) );
+   }
+
+   for ( i = 0; i < N; i++ ) {
+      sum_args *args = 0;
+      nanos_wd_t wd = 0;
+      nanos_data_access_t deps[2] = {{&src[i], {1,0,0,0,0}, 1, dimensions, 0},
+                                     {&total, {1,1,0,0,1}, 1, dimensions, 0}};
+      NANOS_SAFE( nanos_create_wd_compact( &wd, &sum_data.base, &dyn_props, sizeof( sum_args ), ( void ** ) &args,
+                                           nanos_current_wd(), NULL, NULL ) );
+      args->value = &src[i];
+      args->total = &total;
+      NANOS_SAFE( nanos_submit( wd, 2, deps, 0 ) );
+   }
+}
+
+void reference_iteration( int *src, int *dst );
+void reference_iteration( int *src, int *dst )
+{
+   int i;
+   for ( i = 0; i < N; i++ ) dst[i] = src[i] + 1;
+   for ( i = 0; i < N; i++ ) src[i] = dst[i] + dst[(i+1)%N];
+   for ( i = 0; i < N; i++ ) ref_total += src[i];
+}
+
+int main ( int argc, char **argv )
+{
+   int i, it;
+   bool error = false;
+   nanos_tdg_t tdg, other;
+
+   for ( i = 0; i < N; i++ ) {
+      a[i] = ref_a[i] = i;
+      b[i] = ref_b[i] = 0;
+   }
+   total = ref_total = 0;
+
+   NANOS_SAFE( nanos_tdg_record_begin( &tdg ) );
+   if ( nanos_tdg_record_begin( &other ) != NANOS_INVALID_REQUEST ) {
+      printf( "Nested recording was not rejected\n" );
+      error = true;
+   }
+   submit_iteration( a, b );
+   NANOS_SAFE( nanos_tdg_record_end( tdg ) );
+
+   /* Recording must not run any task */
+   NANOS_SAFE( nanos_wg_wait_completion( nanos_current_wd(), false ) );
+   for ( i = 0; i < N; i++ ) {
+      if ( a[i] != i || b[i] != 0 ) error = true;
+   }
+   if ( total != 0 ) error = true;
+   if ( error ) printf( "Tasks ran while recording\n" );
+
+   /* Odd iterations swap the buffers */
+   nanos_tdg_rebind_t swap[2] = {{a, b, sizeof( a )}, {b, a, sizeof( b )}};
+   for ( it = 0; it < ITERS; it++ ) {
+      if ( it % 2 == 0 ) {
+         NANOS_SAFE( nanos_tdg_replay( tdg, 0, NULL ) );
+         reference_iteration( ref_a, ref_b );
+      } else {
+         NANOS_SAFE( nanos_tdg_replay( tdg, 2, swap ) );
+         reference_iteration( ref_b, ref_a );
+      }
+      NANOS_SAFE( nanos_wg_wait_completion( nanos_current_wd(), false ) );
+   }
+
+   NANOS_SAFE( nanos_tdg_destroy( tdg ) );
+
+   for ( i = 0; i < N; i++ ) {
+      if ( a[i] != ref_a[i] || b[i] != ref_b[i] ) {
+         printf( "Element %d is (%d,%d) instead of (%d,%d)\n", i, a[i], b[i], ref_a[i], ref_b[i] );
+         error = true;
+      }
+   }
+   if ( total != ref_total ) {
+      printf( "Total is %d instead of %d\n", total, ref_total );
+      error = true;
+   }
+
+   if ( error ) {
+      printf( "FAIL\n" );
+      return 1;
+   }
+   printf( "PASS\n" );
+   return 0;
+}
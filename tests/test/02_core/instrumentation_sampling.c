@@ -0,0 +1,173 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+/*
+<testinfo>
+test_generator=gens/api-generator
+</testinfo>
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <nanos.h>
+
+/* The test runs itself again with the event_count instrumentation and several sampling options,
+ * and checks that no burst end is recorded without its start.
+ */
+#define CHILD_ENV "NX_TEST_SAMPLING_CHILD"
+#define DEPTH     10
+
+const char *sampling_args[] = {
+   "--instrument-sample-tasks=3",
+   "--instrument-key-rate=api:500:1 --instrument-key-rate=wd-id:1000:2",
+   "--instrument-sample-tasks=2 --instrument-key-rate=api:500:1 --instrument-window-start=1 --instrument-window-length=1",
+};
+
+void tree( int depth );
+
+typedef struct {
+   int depth;
+} tree_args;
+
+void tree_task( void *ptr );
+void tree_task( void *ptr )
+{
+   tree_args *args = ( tree_args * ) ptr;
+   tree( args->depth );
+}
+
+nanos_smp_args_t tree_device_arg = { tree_task };
+
+struct nanos_const_wd_definition_1
+{
+     nanos_const_wd_definition_t base;
+     nanos_device_t devices[1];
+};
+
+struct nanos_const_wd_definition_1 const_data =
+{
+   {{
+      .mandatory_creation = true,
+      .tied = false},
+   __alignof__(tree_args),
+   0,
+   1,0,NULL},
+   {
+      {
+         nanos_smp_factory,
+         &tree_device_arg
+      }
+   }
+};
+
+nanos_wd_dyn_props_t dyn_props = {0};
+
+/* Binary tree of tasks with a taskwait in each node, so that tasks are suspended with open bursts */
+void tree( int depth )
+{
+   int i;
+
+   if ( depth == 0 ) return;
+
+   for ( i = 0; i < 2; i++ ) {
+      nanos_wd_t wd = 0;
+      tree_args *args = 0;
+
+      NANOS_SAFE( nanos_create_wd_compact( &wd, &const_data.base, &dyn_props, sizeof( tree_args ), ( void ** ) &args,
+                                           nanos_current_wd(), NULL, NULL ) );
+      args->depth = depth - 1;
+
+      NANOS_SAFE( nanos_submit( wd, 0, 0, 0 ) );
+   }
+
+   NANOS_SAFE( nanos_wg_wait_completion( nanos_current_wd(), false ) );
+}
+
+int run_child( const char *self, const char *args, int instrumented );
+int run_child( const char *self, const char *args, int instrumented )
+{
+   char line[1024];
+   char *nx_args = getenv( "NX_ARGS" );
+   size_t len = strlen( args ) + ( nx_args ? strlen( nx_args ) : 0 ) + 2;
+   char *child_args = malloc( len );
+   char *command = malloc( strlen( self ) + 8 );
+   unsigned long unmatched = 0;
+   int found = 0;
+   FILE *child;
+
+   snprintf( child_args, len, "%s %s", nx_args ? nx_args : "", args );
+   snprintf( command, strlen( self ) + 8, "%s 2>&1", self );
+
+   setenv( CHILD_ENV, "1", 1 );
+   setenv( "NX_INSTRUMENTATION", "event_count", 1 );
+   setenv( "NX_ARGS", child_args, 1 );
+
+   child = popen( command, "r" );
+   if ( child == NULL ) {
+      printf( "Could not run the instrumented test\n" );
+      return 1;
+   }
+   while ( fgets( line, sizeof( line ), child ) != NULL ) {
+      if ( strstr( line, "burst ends without a start" ) == NULL ) continue;
+      if ( sscanf( line, "NANOS++: (EVENTS) %lu", &unmatched ) == 1 ) found = 1;
+   }
+   int status = pclose( child );
+
+   if ( nx_args ) setenv( "NX_ARGS", nx_args, 1 );
+   else unsetenv( "NX_ARGS" );
+   free( child_args );
+   free( command );
+
+   if ( status != 0 ) {
+      printf( "Sampling with '%s'... FAIL (exit status %d)\n", args, status );
+      return 1;
+   }
+   if ( instrumented && !found ) {
+      printf( "Sampling with '%s'... FAIL (no event counts)\n", args );
+      return 1;
+   }
+   if ( unmatched != 0 ) {
+      printf( "Sampling with '%s'... FAIL (%lu burst ends without a start)\n", args, unmatched );
+      return 1;
+   }
+   printf( "Sampling with '%s'... PASS\n", args );
+   return 0;
+}
+
+int main ( int argc, char **argv )
+{
+   nanos_event_key_t api_key = 0;
+   unsigned int i;
+   int errors = 0;
+
+   if ( getenv( CHILD_ENV ) != NULL ) {
+      tree( DEPTH );
+      return 0;
+   }
+
+   /* Without instrumentation there are no keys, and nothing to check in the output */
+   NANOS_SAFE( nanos_instrument_get_key( "api", &api_key ) );
+
+   for ( i = 0; i < sizeof( sampling_args ) / sizeof( sampling_args[0] ); i++ ) {
+      errors += run_child( argv[0], sampling_args[i], api_key != 0 );
+   }
+
+   return errors != 0;
+}
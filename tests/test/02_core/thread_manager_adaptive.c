@@ -0,0 +1,103 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+/*
+<testinfo>
+test_generator="gens/api-generator -a \"--thread-manager=adaptive|--thread-manager=adaptive --max-spin-time=0\""
+</testinfo>
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <nanos.h>
+
+#define NUM_BURSTS  50
+#define NUM_TASKS   100
+
+typedef struct {
+   int *x;
+} task_args;
+
+void task( void *ptr );
+void task( void *ptr )
+{
+   task_args * args = ( task_args * )ptr;
+   __sync_fetch_and_add( args->x, 1 );
+}
+
+nanos_smp_args_t task_device_arg = { task };
+
+struct nanos_const_wd_definition_1
+{
+     nanos_const_wd_definition_t base;
+     nanos_device_t devices[1];
+};
+
+struct nanos_const_wd_definition_1 const_data =
+{
+   {{
+      .mandatory_creation = true,
+      .tied = false},
+   __alignof__(task_args),
+   0,
+   1,0,NULL},
+   {
+      {
+         nanos_smp_factory,
+         &task_device_arg
+      }
+   }
+};
+
+nanos_wd_dyn_props_t dyn_props = {0};
+
+static void create_task ( int *x )
+{
+   nanos_wd_t wd=0;
+   task_args *args=0;
+
+   NANOS_SAFE( nanos_create_wd_compact ( &wd, &const_data.base, &dyn_props, sizeof( task_args ), ( void ** )&args,
+                                        nanos_current_wd(), NULL, NULL ) );
+   args->x = x;
+
+   NANOS_SAFE( nanos_submit( wd,0,0,0 ) );
+}
+
+int main ( int argc, char **argv )
+{
+   int i, j, error = 0;
+   int counter;
+
+   /* Bursts of tasks separated by idle periods long enough for the workers to park */
+   for ( i = 0; i < NUM_BURSTS; i++ ) {
+      counter = 0;
+      for ( j = 0; j < NUM_TASKS; j++ ) {
+         create_task( &counter );
+      }
+      NANOS_SAFE( nanos_wg_wait_completion( nanos_current_wd(), false ) );
+      if ( counter != NUM_TASKS ) error++;
+
+      usleep( ( i % 5 ) * 1000 );
+   }
+
+   fprintf(stdout, "Result is %s\n", error? "UNSUCCESSFUL":"successful");
+
+   return error;
+}
@@ -0,0 +1,150 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+/*
+<testinfo>
+test_generator="gens/api-generator -a \"--wd-cache-size=0|--wd-cache-size=1|--wd-cache-size=64\""
+</testinfo>
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <nanos.h>
+
+#define NUM_ROUNDS 100
+#define NUM_TASKS  64
+#define BIG_SIZE   100
+
+/* Two task definitions with different argument sizes, so their WD chunks differ */
+typedef struct {
+   int *x;
+} small_args;
+
+typedef struct {
+   int *x;
+   int values[BIG_SIZE];
+} big_args;
+
+void small_task( void *ptr );
+void small_task( void *ptr )
+{
+   small_args * args = ( small_args * )ptr;
+   __sync_fetch_and_add( args->x, 1 );
+}
+
+void big_task( void *ptr );
+void big_task( void *ptr )
+{
+   big_args * args = ( big_args * )ptr;
+   int i, sum = 0;
+   for ( i = 0; i < BIG_SIZE; i++ ) sum += args->values[i];
+   __sync_fetch_and_add( args->x, sum );
+}
+
+nanos_smp_args_t small_device_arg = { small_task };
+nanos_smp_args_t big_device_arg = { big_task };
+
+struct nanos_const_wd_definition_1
+{
+     nanos_const_wd_definition_t base;
+     nanos_device_t devices[1];
+};
+
+struct nanos_const_wd_definition_1 small_const_data =
+{
+   {{
+      .mandatory_creation = true,
+      .tied = false},
+   __alignof__(small_args),
+   0,
+   1,0,NULL},
+   {
+      {
+         nanos_smp_factory,
+         &small_device_arg
+      }
+   }
+};
+
+struct nanos_const_wd_definition_1 big_const_data =
+{
+   {{
+      .mandatory_creation = true,
+      .tied = false},
+   __alignof__(big_args),
+   0,
+   1,0,NULL},
+   {
+      {
+         nanos_smp_factory,
+         &big_device_arg
+      }
+   }
+};
+
+nanos_wd_dyn_props_t dyn_props = {0};
+
+static void create_small_task ( int *x )
+{
+   nanos_wd_t wd=0;
+   small_args *args=0;
+
+   NANOS_SAFE( nanos_create_wd_compact ( &wd, &small_const_data.base, &dyn_props, sizeof( small_args ), ( void ** )&args,
+                                        nanos_current_wd(), NULL, NULL ) );
+   args->x = x;
+
+   NANOS_SAFE( nanos_submit( wd,0,0,0 ) );
+}
+
+static void create_big_task ( int *x )
+{
+   nanos_wd_t wd=0;
+   big_args *args=0;
+   int i;
+
+   NANOS_SAFE( nanos_create_wd_compact ( &wd, &big_const_data.base, &dyn_props, sizeof( big_args ), ( void ** )&args,
+                                        nanos_current_wd(), NULL, NULL ) );
+   args->x = x;
+   for ( i = 0; i < BIG_SIZE; i++ ) args->values[i] = 1;
+
+   NANOS_SAFE( nanos_submit( wd,0,0,0 ) );
+}
+
+int main ( int argc, char **argv )
+{
+   int i, j, error = 0;
+   int small_counter, big_counter;
+
+   /* Reused chunks must behave as fresh ones for both definitions */
+   for ( i = 0; i < NUM_ROUNDS; i++ ) {
+      small_counter = 0;
+      big_counter = 0;
+      for ( j = 0; j < NUM_TASKS; j++ ) {
+         create_small_task( &small_counter );
+         create_big_task( &big_counter );
+      }
+      NANOS_SAFE( nanos_wg_wait_completion( nanos_current_wd(), false ) );
+      if ( small_counter != NUM_TASKS ) error++;
+      if ( big_counter != NUM_TASKS * BIG_SIZE ) error++;
+   }
+
+   fprintf(stdout, "Result is %s\n", error? "UNSUCCESSFUL":"successful");
+
+   return error;
+}
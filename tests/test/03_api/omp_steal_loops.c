@@ -0,0 +1,175 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+/*
+<testinfo>
+test_generator=gens/api-omp-generator
+</testinfo>
+*/
+
+#include <stdio.h>
+#include "nanos.h"
+#include "omp.h"
+
+#define NUM_ITERS   1000
+#define NUM_LOOPS   6
+
+struct nanos_const_wd_definition_1
+{
+  nanos_const_wd_definition_t base;
+  nanos_device_t devices[1];
+};
+
+struct nanos_args_1_t
+{
+  int dummy;
+};
+
+typedef struct {
+   const char *policy;
+   int lower;
+   int upper;
+   int step;
+   int chunk;
+} loop_t;
+
+/* Every iteration must be executed once, and only the chunk with the last iteration is 'last' */
+loop_t loops[NUM_LOOPS] = {
+   { "steal_for",         0, NUM_ITERS - 1,  1, 1 },
+   { "steal_for",         0, NUM_ITERS - 1,  1, 7 },
+   { "steal_for",         NUM_ITERS - 1, 0, -1, 3 },
+   { "guided_steal_for",  0, NUM_ITERS - 1,  1, 1 },
+   { "guided_steal_for",  0, NUM_ITERS - 1,  3, 5 },
+   { "guided_steal_for",  NUM_ITERS - 1, 0, -2, 1 },
+};
+
+int hits[NUM_LOOPS][NUM_ITERS];
+int lasts[NUM_LOOPS];
+int wrong_last[NUM_LOOPS];
+
+static void smp_ol_main_1(struct nanos_args_1_t *const args);
+
+int main()
+{
+  int i, j, error = 0;
+  nanos_err_t err;
+  nanos_wd_dyn_props_t dyn_props;
+  unsigned int nth_i;
+  struct nanos_args_1_t imm_args;
+  nanos_data_access_t dependences[1];
+  static nanos_smp_args_t smp_ol_main_1_args = {.outline = (void (*)(void *))(void (*)(struct nanos_args_1_t *))&smp_ol_main_1};
+  static struct nanos_const_wd_definition_1 nanos_wd_const_data = {.base = {.props = {.mandatory_creation = 1, .tied = 1, .clear_chunk = 0, .reserved0 = 0, .reserved1 = 0, .reserved2 = 0, .reserved3 = 0, .reserved4 = 0}, .data_alignment = __alignof__(struct nanos_args_1_t), .num_copies = 0, .num_devices = 1, .num_dimensions = 0, .description = 0}, .devices = {[0] = {.factory = &nanos_smp_factory, .arg = &smp_ol_main_1_args}}};
+  unsigned int nanos_num_threads = nanos_omp_get_num_threads_next_parallel(0);
+  nanos_team_t nanos_team = (nanos_team_t)0;
+  nanos_thread_t nanos_team_threads[nanos_num_threads];
+
+  /* Loading the plugin registers both policies */
+  if ( nanos_find_worksharing( "steal_for" ) == 0 ) nanos_handle_error(NANOS_UNIMPLEMENTED);
+
+  err = nanos_create_team(&nanos_team, (nanos_sched_t)0, &nanos_num_threads, (nanos_constraint_t *)0, 1, nanos_team_threads, NULL );
+  if (err != NANOS_OK) nanos_handle_error(err);
+
+  dyn_props.tie_to = (nanos_thread_t)0;
+  dyn_props.priority = 0;
+  dyn_props.flags.is_final = 0;
+  for (nth_i = 1; nth_i < nanos_num_threads; nth_i = nth_i + 1) {
+     struct nanos_args_1_t *ol_args = 0;
+     nanos_wd_t nanos_wd_ = (nanos_wd_t)0;
+     dyn_props.tie_to = nanos_team_threads[nth_i];
+     err = nanos_create_wd_compact(&nanos_wd_, &nanos_wd_const_data.base, &dyn_props, sizeof(struct nanos_args_1_t), (void **)&ol_args, nanos_current_wd(), (nanos_copy_data_t **)0, (nanos_region_dimension_internal_t **)0);
+     if (err != NANOS_OK) nanos_handle_error(err);
+     err = nanos_submit(nanos_wd_, 0, (nanos_data_access_t *)0, (nanos_team_t)0);
+     if (err != NANOS_OK) nanos_handle_error(err);
+  }
+  dyn_props.tie_to = nanos_team_threads[0];
+  err = nanos_create_wd_and_run_compact(&nanos_wd_const_data.base, &dyn_props, sizeof(struct nanos_args_1_t), &imm_args, 0, dependences, (nanos_copy_data_t *)0, (nanos_region_dimension_internal_t *)0, (nanos_translate_args_t)0);
+  if (err != NANOS_OK) nanos_handle_error(err);
+  err = nanos_end_team(nanos_team);
+  if (err != NANOS_OK) nanos_handle_error(err);
+
+  for ( i = 0; i < NUM_LOOPS; i++ ) {
+     int step = loops[i].step < 0 ? -loops[i].step : loops[i].step;
+     for ( j = 0; j < NUM_ITERS; j++ ) {
+        int expected = ( ( loops[i].step > 0 ? j - loops[i].lower : loops[i].lower - j ) % step == 0 ) ? 1 : 0;
+        if ( hits[i][j] != expected ) error++;
+     }
+     if ( lasts[i] != 1 || wrong_last[i] != 0 ) error++;
+  }
+
+  fprintf(stdout, "Result is %s\n", error? "UNSUCCESSFUL":"successful");
+
+  return error;
+}
+
+static void run_loop( int l )
+{
+  nanos_err_t err;
+  nanos_ws_info_loop_t info;
+  nanos_ws_item_loop_t item;
+  nanos_ws_desc_t *wsd;
+  _Bool single_guard;
+  int i;
+
+  nanos_ws_t ws = nanos_find_worksharing( loops[l].policy );
+  if ( ws == 0 ) nanos_handle_error(NANOS_UNIMPLEMENTED);
+
+  info.lower_bound = loops[l].lower;
+  info.upper_bound = loops[l].upper;
+  info.loop_step = loops[l].step;
+  info.chunk_size = loops[l].chunk;
+  err = nanos_worksharing_create(&wsd, ws, (void **)&info, &single_guard);
+  if (err != NANOS_OK) nanos_handle_error(err);
+
+  err = nanos_worksharing_next_item(wsd, (void **)&item);
+  if (err != NANOS_OK) nanos_handle_error(err);
+  while ( item.execute ) {
+     if ( loops[l].step > 0 ) {
+        for ( i = item.lower; i <= item.upper; i += loops[l].step ) __sync_fetch_and_add( &hits[l][i], 1 );
+     } else {
+        for ( i = item.lower; i >= item.upper; i += loops[l].step ) __sync_fetch_and_add( &hits[l][i], 1 );
+     }
+     if ( item.last ) {
+        __sync_fetch_and_add( &lasts[l], 1 );
+        /* The last chunk contains the last iteration of the loop */
+        if ( ( loops[l].step > 0 && item.upper + loops[l].step <= loops[l].upper ) ||
+             ( loops[l].step < 0 && item.upper + loops[l].step >= loops[l].upper ) ) __sync_fetch_and_add( &wrong_last[l], 1 );
+     }
+     err = nanos_worksharing_next_item(wsd, (void **)&item);
+     if (err != NANOS_OK) nanos_handle_error(err);
+  }
+
+  err = nanos_omp_barrier();
+  if (err != NANOS_OK) nanos_handle_error(err);
+}
+
+static void smp_ol_main_1(struct nanos_args_1_t *const args)
+{
+  nanos_err_t err;
+  int l;
+
+  err = nanos_omp_set_implicit(nanos_current_wd());
+  if (err != NANOS_OK) nanos_handle_error(err);
+  err = nanos_enter_team();
+  if (err != NANOS_OK) nanos_handle_error(err);
+
+  for ( l = 0; l < NUM_LOOPS; l++ ) run_loop( l );
+
+  err = nanos_leave_team();
+  if (err != NANOS_OK) nanos_handle_error(err);
+}
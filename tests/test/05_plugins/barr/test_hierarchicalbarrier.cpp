@@ -0,0 +1,116 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+
+/*
+<testinfo>
+test_generator="gens/core-generator -a \"--gpus=0 --barrier=hierarchical --barrier-group-size=2\""
+</testinfo>
+*/
+
+#include "config.hpp"
+#include "nanos.h"
+#include <iostream>
+#include "smpprocessor.hpp"
+#include "system.hpp"
+#include "threadteam.hpp"
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+using namespace std;
+using namespace nanos;
+using namespace nanos::ext;
+
+#define BARR_NUM 10
+
+int* counts;
+int size;
+int result = 0;
+
+void barrier_code ( void * );
+
+void sum ( void *out, void *in, int num_scalars )
+{
+   *(int *) out += *(int *) in;
+}
+
+void cleanup ( void *descriptor )
+{
+   free( descriptor );
+}
+
+/*! Checks the barrier and the reduction computed with the first barrier */
+void barrier_code ( void * )
+{
+       int id = getMyThreadSafe()->getTeamId();
+       int *privates = (int *) getMyThreadSafe()->getTeam()->getReductionPrivateData( &result );
+       privates[id] = id + 1;
+
+       nanos_team_barrier();
+
+       if ( result != size * ( size + 1 ) / 2 ) {
+          cerr << "Error: wrong reduction result " << result << std::endl;
+          abort();
+       }
+
+       for ( int i = 0; i < BARR_NUM; i++ ) {
+              nanos_team_barrier();
+
+              counts[id]++;
+
+              nanos_team_barrier();
+
+              if ( counts[ (id+1)%size ] != i+1 ) {
+                 cerr << "Error: the barrier is broken." << std::endl;
+                 abort();
+              }
+       }
+}
+
+int main (int argc, char **argv)
+{
+       ThreadTeam &team = *getMyThreadSafe()->getTeam();
+
+       size = team.size();
+       counts = new int[team.size()];
+       for ( unsigned i = 0; i < team.size(); i++ ) counts[i] = 0;
+
+       nanos_reduction_t *red = (nanos_reduction_t *) malloc( sizeof(nanos_reduction_t) );
+       red->original = &result;
+       red->privates = malloc( sizeof(int) * size );
+       red->element_size = sizeof(int);
+       red->num_scalars = 1;
+       red->descriptor = red->privates;
+       red->bop = sum;
+       red->vop = NULL;
+       red->cleanup = cleanup;
+       team.createReduction( red );
+
+       for ( unsigned i = 1; i < team.size(); i++ ) {
+              WD * wd = new WD(new SMPDD(barrier_code));
+              wd->tieTo(team[i]);
+              sys.submit(*wd);
+       }
+       usleep(100);
+
+       WD *wd = getMyThreadSafe()->getCurrentWD();
+       wd->tieTo(*getMyThreadSafe());
+       barrier_code(NULL);
+
+       cout << "end" << endl;
+}
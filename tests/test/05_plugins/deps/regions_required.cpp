@@ -20,7 +20,7 @@
 /*
 <testinfo>
 test_generator=gens/core-generator
-test_deps_plugins=regions,plain,perfect-regions
+test_deps_plugins=regions,plain,perfect-regions,intervals
 test_schedule=bf
 </testinfo>
 */
@@ -0,0 +1,139 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+/*
+<testinfo>
+test_generator=gens/api-generator
+test_schedule="bf --bf-lock-free-queue"
+</testinfo>
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <nanos.h>
+
+#define NUM_ITERS   10
+#define NUM_TASKS   5000
+
+int cutoff_value = 10;
+
+typedef struct {
+   int n;
+   int d;
+   int *x;
+} fib_args;
+
+int fib ( int n, int d );
+
+int fib_seq ( int n );
+int fib_seq ( int n )
+{
+   if ( n < 2 ) return n;
+   return fib_seq( n-1 ) + fib_seq( n-2 );
+}
+
+void fib_task( void *ptr );
+void fib_task( void *ptr )
+{
+   fib_args * args = ( fib_args * )ptr;
+   *args->x = fib( args->n, args->d+1 );
+}
+
+nanos_smp_args_t fib_device_arg = { fib_task };
+
+struct nanos_const_wd_definition_1
+{
+     nanos_const_wd_definition_t base;
+     nanos_device_t devices[1];
+};
+
+struct nanos_const_wd_definition_1 const_data =
+{
+   {{
+      .mandatory_creation = true,
+      .tied = false},
+   __alignof__(fib_args),
+   0,
+   1,0,NULL},
+   {
+      {
+         nanos_smp_factory,
+         &fib_device_arg
+      }
+   }
+};
+
+nanos_wd_dyn_props_t dyn_props = {0};
+
+static void create_fib_task ( int n, int d, int *x )
+{
+   nanos_wd_t wd=0;
+   fib_args *args=0;
+
+   NANOS_SAFE( nanos_create_wd_compact ( &wd, &const_data.base, &dyn_props, sizeof( fib_args ), ( void ** )&args,
+                                        nanos_current_wd(), NULL, NULL ) );
+   args->n = n;
+   args->d = d;
+   args->x = x;
+
+   NANOS_SAFE( nanos_submit( wd,0,0,0 ) );
+}
+
+int fib ( int n, int d )
+{
+   int x, y;
+
+   if ( n < 2 ) return n;
+
+   if ( d < cutoff_value ) {
+      create_fib_task( n-1, d, &x );
+      create_fib_task( n-2, d, &y );
+      NANOS_SAFE( nanos_wg_wait_completion( nanos_current_wd(), false ) );
+   } else {
+      x = fib_seq( n-1 );
+      y = fib_seq( n-2 );
+   }
+
+   return x + y;
+}
+
+int main ( int argc, char **argv )
+{
+   int i, j, error = 0;
+   int results[NUM_TASKS];
+
+   /* Deep recursion: threads push and pop concurrently on the device ring */
+   if ( fib( 25, 0 ) != 75025 ) error++;
+
+   /* Flat bursts: more ready tasks than ring cells, the rest go to the overflow list */
+   for ( i = 0; i < NUM_ITERS; i++ ) {
+      for ( j = 0; j < NUM_TASKS; j++ ) {
+         results[j] = -1;
+         create_fib_task( 10, cutoff_value, &results[j] );
+      }
+      NANOS_SAFE( nanos_wg_wait_completion( nanos_current_wd(), false ) );
+      for ( j = 0; j < NUM_TASKS; j++ ) {
+         if ( results[j] != 55 ) error++;
+      }
+   }
+
+   fprintf(stdout, "Result is %s\n", error? "UNSUCCESSFUL":"successful");
+
+   return error;
+}